@@ -56,9 +56,17 @@ endfunction(piglit_include_target_api)
 # In addition to calling `add_executable`, it adds to each object file
 # a dependency on piglit_dispatch's generated files.
 #
+# If PIGLIT_BUILD_MULTICALL is enabled the test is added to the multicall
+# executable of the current API instead, see piglit_add_multicall_test.
+#
 function(piglit_add_executable name)
 
     list(REMOVE_AT ARGV 0)
+    if(PIGLIT_BUILD_MULTICALL)
+        piglit_add_multicall_test(${name} ${ARGV})
+        return()
+    endif(PIGLIT_BUILD_MULTICALL)
+
     add_executable(${name} ${ARGV})
     add_dependencies(${name} piglit_dispatch_gen)
 
@@ -89,3 +97,111 @@ function(piglit_add_library name)
     endif()
 
 endfunction(piglit_add_library)
+
+#
+# function piglit_add_multicall_test
+#
+# Build a test as a static library of a single object, whose only global
+# symbol is the test's main() renamed to piglit_multicall_main_${name}.
+# Hiding every other symbol lets tests that define the same functions, like
+# piglit_init, be linked into one executable.
+#
+# The library keeps the name and link libraries of the test, so
+# target_link_libraries and friends work as they do for an executable.
+#
+function(piglit_add_multicall_test name)
+
+    list(REMOVE_AT ARGV 0)
+    string(REGEX REPLACE "[^A-Za-z0-9_]" "_" entry
+        "piglit_multicall_main_${name}")
+
+    get_property(entries GLOBAL PROPERTY PIGLIT_MULTICALL_ENTRIES)
+    list(FIND entries ${entry} index)
+    if(NOT index EQUAL -1)
+        message(FATAL_ERROR "Multicall entry point ${entry} of ${name} "
+            "is used by another test")
+    endif(NOT index EQUAL -1)
+    set_property(GLOBAL APPEND PROPERTY PIGLIT_MULTICALL_ENTRIES ${entry})
+
+    add_library(${name} STATIC ${ARGV})
+    add_dependencies(${name} piglit_dispatch_gen)
+
+    # main is never mangled, even in C++, so it can be renamed after the
+    # objects have been merged.
+    set(object ${CMAKE_CURRENT_BINARY_DIR}/${name}.multicall.o)
+    add_custom_command(TARGET ${name} POST_BUILD
+        COMMAND ${CMAKE_LINKER} -r --whole-archive $<TARGET_FILE:${name}>
+            -o ${object}
+        COMMAND ${CMAKE_OBJCOPY} --redefine-sym main=${entry} ${object}
+        COMMAND ${CMAKE_OBJCOPY} --keep-global-symbol=${entry} ${object}
+        COMMAND ${CMAKE_COMMAND} -E remove $<TARGET_FILE:${name}>
+        COMMAND ${CMAKE_AR} rcs $<TARGET_FILE:${name}> ${object}
+        VERBATIM)
+
+    set_property(GLOBAL APPEND PROPERTY
+        PIGLIT_MULTICALL_TESTS_${piglit_target_api} ${name})
+
+endfunction(piglit_add_multicall_test)
+
+#
+# function piglit_add_multicall_executable
+#
+# Link every test of the current API into piglit-multicall-${api}, and make
+# a symlink to it named after each test, so that the tests are run exactly
+# as if they were separate executables. Does nothing unless
+# PIGLIT_BUILD_MULTICALL is enabled.
+#
+function(piglit_add_multicall_executable)
+
+    if(NOT PIGLIT_BUILD_MULTICALL)
+        return()
+    endif(NOT PIGLIT_BUILD_MULTICALL)
+
+    get_property(tests GLOBAL PROPERTY
+        PIGLIT_MULTICALL_TESTS_${piglit_target_api})
+    if(NOT tests)
+        return()
+    endif(NOT tests)
+
+    # The table is searched with bsearch() and strcmp()
+    list(SORT tests)
+
+    set(PIGLIT_MULTICALL_DECLS "")
+    set(PIGLIT_MULTICALL_TESTS "")
+    foreach(test ${tests})
+        string(REGEX REPLACE "[^A-Za-z0-9_]" "_" entry
+            "piglit_multicall_main_${test}")
+        set(PIGLIT_MULTICALL_DECLS
+            "${PIGLIT_MULTICALL_DECLS}int ${entry}(int argc, char **argv);\n")
+        set(PIGLIT_MULTICALL_TESTS
+            "${PIGLIT_MULTICALL_TESTS}\t{ \"${test}\", ${entry} },\n")
+    endforeach(test)
+
+    set(multicall piglit-multicall-${piglit_target_api})
+    configure_file(${piglit_SOURCE_DIR}/cmake/piglit-multicall.c.in
+        ${CMAKE_CURRENT_BINARY_DIR}/${multicall}.c @ONLY)
+
+    add_executable(${multicall} ${CMAKE_CURRENT_BINARY_DIR}/${multicall}.c)
+    target_link_libraries(${multicall} ${tests})
+    install(TARGETS ${multicall} DESTINATION ${PIGLIT_INSTALL_LIBDIR}/bin)
+
+    # The same script makes the links in the build and install trees
+    set(script ${CMAKE_CURRENT_BINARY_DIR}/${multicall}-links.cmake)
+    file(WRITE ${script}
+        "foreach(test ${tests})\n"
+        "    execute_process(COMMAND \${CMAKE_COMMAND} -E create_symlink\n"
+        "        ${multicall} \${DIR}/\${test})\n"
+        "endforeach(test)\n")
+
+    add_custom_command(TARGET ${multicall} POST_BUILD
+        COMMAND ${CMAKE_COMMAND} -DDIR=${piglit_BINARY_DIR}/bin -P ${script}
+        VERBATIM)
+    if(IS_ABSOLUTE ${PIGLIT_INSTALL_LIBDIR})
+        set(bindir ${PIGLIT_INSTALL_LIBDIR}/bin)
+    else(IS_ABSOLUTE ${PIGLIT_INSTALL_LIBDIR})
+        set(bindir \${CMAKE_INSTALL_PREFIX}/${PIGLIT_INSTALL_LIBDIR}/bin)
+    endif(IS_ABSOLUTE ${PIGLIT_INSTALL_LIBDIR})
+    install(CODE "set(DIR \"\$ENV{DESTDIR}${bindir}\")
+                  include(\"${script}\")")
+
+endfunction(piglit_add_multicall_executable)
@@ -145,7 +145,10 @@ def load(file_path):
             return _extension(file_path)
         else:
             for file_ in os.listdir(file_path):
-                if file_.startswith('result') and not file_.endswith('.old'):
+                # Skip backups, and the journals that sqlite keeps next to the
+                # database while it is open
+                if file_.startswith('result') and not file_.endswith(
+                        ('.old', '-wal', '-shm', '-journal')):
                     return _extension(file_)
 
         tests = os.path.join(file_path, 'tests')
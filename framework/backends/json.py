@@ -42,12 +42,15 @@ __all__ = [
 ]
 
 # The current version of the JSON results
-CURRENT_JSON_VERSION = 8
+CURRENT_JSON_VERSION = 9
 
 # The level to indent a final file
 INDENT = 4
 
 _DECODER_TABLE = {
+    'Blob': results.BlobRef,
+    'BlobTable': results.BlobTable,
+    'Measurement': results.Measurement,
     'Subtests': results.Subtests,
     'TestResult': results.TestResult,
     'TestrunResult': results.TestrunResult,
@@ -291,6 +294,7 @@ def _update_results(results, filepath):
             5: _update_five_to_six,
             6: _update_six_to_seven,
             7: _update_seven_to_eight,
+            8: _update_eight_to_nine,
         }
 
         while results.results_version < CURRENT_JSON_VERSION:
@@ -588,6 +592,19 @@ def _update_seven_to_eight(result):
     return result
 
 
+def _update_eight_to_nine(result):
+    """Update json results from version 8 to 9.
+
+    Version 9 may store strings shared between tests in a blob table. Version
+    8 results have no such table, and all of the strings are inline, so
+    nothing needs to be changed.
+
+    """
+    result.results_version = 9
+
+    return result
+
+
 REGISTRY = Registry(
     extensions=['', '.json'],
     backend=JSONBackend,
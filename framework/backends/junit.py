@@ -88,34 +88,43 @@ class JUnitBackend(FileBackend):
         os.mkdir(tests)
 
     def finalize(self, metadata=None):
-        """ Scoop up all of the individual peices and put them together """
-        root = etree.Element('testsuites')
-        piglit = etree.Element('testsuite', name='piglit')
-        root.append(piglit)
-        for each in os.listdir(os.path.join(self._dest, 'tests')):
-            with open(os.path.join(self._dest, 'tests', each), 'r') as f:
-                # parse returns an element tree, and that's not what we want,
-                # we want the first (and only) Element node
-                # If the element cannot be properly parsed then consider it a
-                # failed transaction and ignore it.
-                try:
-                    piglit.append(etree.parse(f).getroot())
-                except etree.ParseError:
-                    continue
-
-        # set the test count by counting the number of tests.
-        # This must be bytes or unicode
-        piglit.attrib['tests'] = str(len(piglit))
+        """ Scoop up all of the individual peices and put them together
+
+        The final document is streamed out rather than built as a single
+        element tree, each per-test snippet is checked for well-formedness
+        and then copied verbatim into the testsuite element. This keeps
+        memory use proportional to the largest single test rather than to the
+        whole run.
+
+        """
+        testsdir = os.path.join(self._dest, 'tests')
+        body = os.path.join(self._dest, 'results.xml.tests')
+
+        # Copy the tests that can be parsed into a scratch file, discarding
+        # the ones that cannot (these are failed transactions). The test
+        # count has to be written in the testsuite element before any of
+        # the tests, so it is only known once they have all been read.
+        count = 0
+        with open(body, 'w') as f:
+            for each in os.listdir(testsdir):
+                snippet = _read_snippet(os.path.join(testsdir, each))
+                if snippet is not None:
+                    f.write(snippet)
+                    f.write('\n')
+                    count += 1
 
         with open(os.path.join(self._dest, 'results.xml'), 'w') as f:
             f.write("<?xml version='1.0' encoding='utf-8'?>\n")
-            # lxml has a pretty print we want to use
-            if etree.__name__ == 'lxml.etree':
-                f.write(etree.tostring(root, pretty_print=True))
-            else:
-                f.write(etree.tostring(root))
+            f.write('<testsuites>\n')
+            # This must be bytes or unicode
+            f.write('  <testsuite name="piglit" tests="{}">\n'.format(count))
+            with open(body, 'r') as tests:
+                shutil.copyfileobj(tests, f)
+            f.write('  </testsuite>\n')
+            f.write('</testsuites>\n')
 
-        shutil.rmtree(os.path.join(self._dest, 'tests'))
+        os.unlink(body)
+        shutil.rmtree(testsdir)
 
     def _write(self, f, name, data):
 
@@ -221,6 +230,66 @@ class JUnitBackend(FileBackend):
         f.write(etree.tostring(element))
 
 
+def _read_snippet(filename):
+    """Read a single per-test xml file and return it as a string.
+
+    Returns None if the file does not contain a well formed element, which
+    happens when a test was interrupted in the middle of being written. Any
+    xml declaration is stripped so that the snippet can be embedded in
+    another document.
+
+    """
+    with open(filename, 'r') as f:
+        snippet = f.read()
+
+    try:
+        etree.fromstring(snippet)
+    except (etree.ParseError, ValueError):
+        return None
+
+    if snippet.startswith('<?xml'):
+        snippet = snippet[snippet.index('?>') + 2:].lstrip()
+    return snippet.rstrip()
+
+
+def _load_test(test):
+    """Convert a testcase element into a name and a TestResult."""
+    result = results.TestResult()
+    # Take the class name minus the 'piglit.' element, replace junit's '.'
+    # separator with piglit's separator, and join the group and test names
+    name = test.attrib['classname'].split('.', 1)[1]
+    name = name.replace('.', grouptools.SEPARATOR)
+    name = grouptools.join(name, test.attrib['name'])
+
+    # Remove the trailing _ if they were added (such as to api and search)
+    if name.endswith('_'):
+        name = name[:-1]
+
+    result.result = test.attrib['status']
+
+    # This is the fallback path, we'll try to overwrite this with the value
+    # in stderr
+    result.time = results.TimeAttribute(end=float(test.attrib['time']))
+    result.err = test.find('system-err').text
+
+    # The command is prepended to system-out, so we need to separate those
+    # into two separate elements
+    out = test.find('system-out').text.split('\n')
+    result.command = out[0]
+    result.out = '\n'.join(out[1:])
+
+    # Try to get the values in stderr for time
+    if 'time start' in result.err:
+        for line in result.err.split('\n'):
+            if line.startswith('time start:'):
+                result.time.start = float(line[len('time start: '):])
+            elif line.startswith('time end:'):
+                result.time.end = float(line[len('time end: '):])
+                break
+
+    return name, result
+
+
 def _load(results_file):
     """Load a junit results instance and return a TestrunResult.
 
@@ -230,6 +299,10 @@ def _load(results_file):
     This tries to not make too many assumptions about the strucuter of the
     JUnit document.
 
+    The document is read with iterparse, and each testcase element is
+    discarded as soon as it has been converted, so the whole tree is never
+    held in memory at once.
+
     """
     run_result = results.TestrunResult()
 
@@ -241,42 +314,43 @@ def _load(results_file):
     else:
         run_result.name = 'junit result'
 
-    tree = etree.parse(results_file).getroot().find('.//testsuite[@name="piglit"]')
-    for test in tree.iterfind('testcase'):
-        result = results.TestResult()
-        # Take the class name minus the 'piglit.' element, replace junit's '.'
-        # separator with piglit's separator, and join the group and test names
-        name = test.attrib['classname'].split('.', 1)[1]
-        name = name.replace('.', grouptools.SEPARATOR)
-        name = grouptools.join(name, test.attrib['name'])
-
-        # Remove the trailing _ if they were added (such as to api and search)
-        if name.endswith('_'):
-            name = name[:-1]
-
-        result.result = test.attrib['status']
-
-        # This is the fallback path, we'll try to overwrite this with the value
-        # in stderr
-        result.time = results.TimeAttribute(end=float(test.attrib['time']))
-        result.err = test.find('system-err').text
-
-        # The command is prepended to system-out, so we need to separate those
-        # into two separate elements
-        out = test.find('system-out').text.split('\n')
-        result.command = out[0]
-        result.out = '\n'.join(out[1:])
-
-        # Try to get the values in stderr for time
-        if 'time start' in result.err:
-            for line in result.err.split('\n'):
-                if line.startswith('time start:'):
-                    result.time.start = float(line[len('time start: '):])
-                elif line.startswith('time end:'):
-                    result.time.end = float(line[len('time end: '):])
-                    break
-
-        run_result.tests[name] = result
+    # Only testcases that are direct children of the first testsuite named
+    # 'piglit' are loaded, everything else is skipped.
+    #
+    # Clearing an element leaves it attached to its parent, so anything
+    # outside of a testcase is removed from its parent once it ends;
+    # otherwise the testsuite would still hold an empty element for every
+    # test. The elements inside a testcase are needed until it ends, and go
+    # with it.
+    stack = []
+    in_testcase = 0
+    piglit_depth = None
+    seen_piglit = False
+    for event, elem in etree.iterparse(results_file, events=('start', 'end')):
+        if event == 'start':
+            stack.append(elem)
+            if elem.tag == 'testcase':
+                in_testcase += 1
+            elif (not seen_piglit and elem.tag == 'testsuite' and
+                    elem.attrib.get('name') == 'piglit'):
+                seen_piglit = True
+                piglit_depth = len(stack)
+            continue
+
+        stack.pop()
+        depth = len(stack)
+        if elem.tag == 'testcase':
+            in_testcase -= 1
+            if piglit_depth is not None and depth == piglit_depth:
+                name, result = _load_test(elem)
+                run_result.tests[name] = result
+        elif elem.tag == 'testsuite' and depth + 1 == piglit_depth:
+            piglit_depth = None
+
+        if not in_testcase:
+            elem.clear()
+            if stack:
+                stack[-1].remove(elem)
 
     run_result.calculate_group_totals()
 
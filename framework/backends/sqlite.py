@@ -0,0 +1,311 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Module providing a sqlite3 backend for piglit.
+
+Unlike the json and junit backends this backend doesn't write a file per test
+and merge them at the end; each result is inserted into a single database as
+soon as it completes. The database is a valid result at any point during the
+run, so it can be resumed or summarized without an aggregation step.
+
+The database has three tables:
+metadata -- key/value pairs of json encoded run metadata
+tests -- one row per test, with the full json encoded TestResult
+statuses -- one row per test or subtest, with its status. This is what
+            framework.summary queries when comparing runs.
+
+"""
+
+from __future__ import print_function, absolute_import
+import contextlib
+import os
+import sqlite3
+import threading
+import time
+
+try:
+    import simplejson as json
+except ImportError:
+    import json
+
+from framework import grouptools, results, status, exceptions
+from .abstract import Backend
+from .json import piglit_encoder, piglit_decoder
+from .register import Registry
+
+__all__ = [
+    'REGISTRY',
+    'SQLiteBackend',
+    'completed',
+    'db_path',
+    'is_sqlite',
+    'load_metadata',
+]
+
+# The current version of the database schema
+CURRENT_SQLITE_VERSION = 1
+
+# The name of the database in a results directory
+RESULTS_DB = 'results.db'
+
+_SCHEMA = """
+    CREATE TABLE IF NOT EXISTS metadata (
+        key TEXT PRIMARY KEY,
+        value TEXT
+    );
+    CREATE TABLE IF NOT EXISTS tests (
+        name TEXT PRIMARY KEY,
+        result TEXT NOT NULL,
+        data TEXT NOT NULL
+    );
+    CREATE TABLE IF NOT EXISTS statuses (
+        name TEXT PRIMARY KEY,
+        test TEXT NOT NULL,
+        result TEXT NOT NULL
+    );
+    CREATE INDEX IF NOT EXISTS statuses_test ON statuses (test);
+    CREATE INDEX IF NOT EXISTS statuses_result ON statuses (result);
+"""
+
+
+def db_path(path):
+    """Return the path to the database for a results directory or file."""
+    if os.path.isdir(path):
+        return os.path.join(path, RESULTS_DB)
+    return path
+
+
+def is_sqlite(path):
+    """Return True if path is a sqlite result or a directory containing one."""
+    path = db_path(path)
+    return path.endswith('.db') and os.path.isfile(path)
+
+
+def connect(path):
+    """Open a connection to a results database.
+
+    The connection may be shared between threads, it is the responsibility of
+    the caller to serialize access to it.
+
+    """
+    conn = sqlite3.connect(db_path(path), check_same_thread=False)
+    conn.text_factory = unicode
+    return conn
+
+
+class SQLiteBackend(Backend):
+    """Backend that writes results into a sqlite3 database.
+
+    Results are written inside of transactions which are committed in
+    batches, either every sqlite_batch results or sqlite_interval seconds,
+    whichever comes first. A test whose transaction never made it to disk is
+    simply missing from the database, and will be run again on resume.
+
+    Arguments:
+    dest -- a results directory, the database is created inside of it
+
+    Keyword Arguments:
+    file_fsync -- If truthy then every commit is synced to disk, otherwise
+                  sqlite is allowed to defer syncing until a checkpoint.
+                  Default: False
+    sqlite_batch -- the number of results to write per transaction.
+                    Default: 64
+    sqlite_interval -- the maximum number of seconds a completed result may
+                       wait to be committed. Default: 5
+
+    """
+    def __init__(self, dest, file_fsync=False, sqlite_batch=64,
+                 sqlite_interval=5, **options):
+        self._dest = dest
+        self._batch = sqlite_batch
+        self._interval = sqlite_interval
+        self._pending = 0
+        self._last_commit = time.time()
+        self._lock = threading.Lock()
+
+        self._conn = connect(os.path.join(dest, RESULTS_DB))
+        # WAL lets summaries read the database while the run is writing it
+        self._conn.execute('PRAGMA journal_mode=WAL')
+        self._conn.execute('PRAGMA synchronous={}'.format(
+            'FULL' if file_fsync else 'NORMAL'))
+
+    def _set_metadata(self, metadata):
+        self._conn.executemany(
+            'INSERT OR REPLACE INTO metadata (key, value) VALUES (?, ?)',
+            ((k, json.dumps(v, default=piglit_encoder))
+             for k, v in metadata.iteritems()))
+
+    def _commit(self, force=False):
+        """Commit the current transaction if the batch is full.
+
+        Must be called with self._lock held.
+
+        """
+        now = time.time()
+        if force or self._pending >= self._batch or \
+                now - self._last_commit >= self._interval:
+            self._conn.commit()
+            self._pending = 0
+            self._last_commit = now
+
+    def _insert(self, name, data):
+        """Insert or replace a result, and the statuses derived from it."""
+        self._conn.execute(
+            'INSERT OR REPLACE INTO tests (name, result, data) VALUES (?, ?, ?)',
+            (name, str(data.result),
+             json.dumps(data, default=piglit_encoder)))
+        self._conn.execute('DELETE FROM statuses WHERE test = ?', (name, ))
+        if data.subtests:
+            rows = ((grouptools.join(name, k), name, str(v))
+                    for k, v in data.subtests.iteritems())
+        else:
+            rows = [(name, name, str(data.result))]
+        self._conn.executemany(
+            'INSERT OR REPLACE INTO statuses (name, test, result) '
+            'VALUES (?, ?, ?)', rows)
+
+    def initialize(self, metadata):
+        """Create the tables and write the initial metadata."""
+        metadata['results_version'] = CURRENT_SQLITE_VERSION
+
+        with self._lock:
+            self._conn.executescript(_SCHEMA)
+            self._set_metadata(metadata)
+            self._commit(force=True)
+
+    def finalize(self, metadata=None):
+        """Write any remaining results and metadata and close the database."""
+        with self._lock:
+            if metadata:
+                self._set_metadata(metadata)
+            self._commit(force=True)
+            # Return to a rollback journal so that the database is a single
+            # self contained file once the run is over.
+            self._conn.execute('PRAGMA journal_mode=DELETE')
+            self._conn.close()
+
+    @contextlib.contextmanager
+    def write_test(self, name):
+        """Write a test.
+
+        An incomplete result is inserted before the test is run, and replaced
+        with the final result when the yielded function is called. Both are
+        part of the current batch.
+
+        """
+        def finish(val):
+            with self._lock:
+                self._insert(name, val)
+                self._pending += 1
+                self._commit()
+
+        with self._lock:
+            self._insert(name, results.TestResult(status.INCOMPLETE))
+            self._commit()
+
+        yield finish
+
+
+def completed(file_path, include_incomplete=False):
+    """Return the set of test names that do not need to be run on resume.
+
+    Keyword Arguments:
+    include_incomplete -- if True incomplete tests are included, so they will
+                          not be retried. Default: False
+
+    """
+    conn = connect(file_path)
+    try:
+        if include_incomplete:
+            rows = conn.execute('SELECT name FROM tests')
+        else:
+            rows = conn.execute('SELECT name FROM tests WHERE result != ?',
+                                (str(status.INCOMPLETE), ))
+        return set(r[0] for r in rows)
+    finally:
+        conn.close()
+
+
+def load(file_path, compression_=None):
+    """Load a sqlite results database and return a TestrunResult.
+
+    This can be pointed at a results directory or directly at the database,
+    and works equally well on finished and partial runs.
+
+    compression is ignored, the database is never compressed.
+
+    """
+    return _load(file_path, True)
+
+
+def load_metadata(file_path):
+    """Load only the metadata of a results database as a TestrunResult.
+
+    The result has no tests, which makes this a single small query however
+    large the run is.
+
+    """
+    return _load(file_path, False)
+
+
+def _load(file_path, tests):
+    """Load a results database, with the tests only if tests is True."""
+    path = db_path(file_path)
+    if not os.path.isfile(path):
+        raise exceptions.PiglitFatalError(
+            'No sqlite results database found at: "{}"'.format(path))
+
+    conn = connect(path)
+    try:
+        data = {}
+        for key, value in conn.execute('SELECT key, value FROM metadata'):
+            data[key] = json.loads(value, object_hook=piglit_decoder)
+
+        data['tests'] = {}
+        if tests:
+            for name, value in conn.execute('SELECT name, data FROM tests'):
+                data['tests'][name] = json.loads(
+                    value, object_hook=piglit_decoder)
+    except sqlite3.DatabaseError as e:
+        raise exceptions.PiglitFatalError(
+            'While loading sqlite results database: "{}",\n'
+            'the following error occured:\n{}'.format(path, str(e)))
+    finally:
+        conn.close()
+
+    if data.get('results_version') != CURRENT_SQLITE_VERSION:
+        raise exceptions.PiglitFatalError(
+            'Unsupported sqlite results version: "{}"'.format(
+                data.get('results_version')))
+
+    return results.TestrunResult.from_dict(data)
+
+
+def set_meta(results_):
+    """Set sqlite specific metadata on a TestrunResult."""
+    results_.results_version = CURRENT_SQLITE_VERSION
+
+
+REGISTRY = Registry(
+    extensions=['.db'],
+    backend=SQLiteBackend,
+    load=load,
+    meta=set_meta,
+)
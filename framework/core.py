@@ -144,12 +144,37 @@ class Options(object):
     filter -- list of compiled regex which include exclusively tests that match
     exclude_filter -- list of compiled regex which exclude tests that match
     valgrind -- True if valgrind is to be used
-    dmesg -- True if dmesg checking is desired. This forces concurrency off
+    dmesg -- True if dmesg checking is desired. This forces concurrency off,
+             unless /dev/kmsg can be used
+    output_limit -- the number of bytes of each of stdout and stderr to keep
+                    for each test, 0 keeps everything
+    output_dir -- directory to write the output omitted by output_limit to,
+                  if None it is discarded
+    threads_per_test -- the number of threads CPU rasterizers may run in each
+                        test, None leaves it up to the driver
+    thread_budget -- the total number of threads to run at once, which
+                     together with threads_per_test sizes the pool of
+                     concurrent tests. None is the number of CPUs
+    pin_cpus -- if True each concurrent test is pinned to its own CPUs
+    memory_budget -- the total peak RSS in KiB of the tests running at once,
+                     tests wait to start until they fit. None is unlimited
+    timeout_factor -- tests with a duration in timeout_history are given a
+                      timeout of this multiple of their 95th percentile
+    timeout_floor -- the smallest timeout derived from timeout_history
+    timeout_cap -- the largest timeout derived from timeout_history, or None
+    hang_timeout -- kill a test once it has used no CPU time for this many
+                    seconds while asleep, 0 disables this
+    batch_size -- run up to this many tests that support it (such as glean
+                  tests) in a single process, 0 or 1 disables this
     env -- environment variables set for each test before run
 
     """
     def __init__(self, concurrent=True, execute=True, include_filter=None,
-                 exclude_filter=None, valgrind=False, dmesg=False, sync=False):
+                 exclude_filter=None, valgrind=False, dmesg=False, sync=False,
+                 output_limit=0, output_dir=None, threads_per_test=None,
+                 thread_budget=None, pin_cpus=False, memory_budget=None,
+                 timeout_factor=5, timeout_floor=10, timeout_cap=None,
+                 hang_timeout=0, batch_size=0):
         self.concurrent = concurrent
         self.execute = execute
         self.filter = \
@@ -160,6 +185,17 @@ class Options(object):
         self.valgrind = valgrind
         self.dmesg = dmesg
         self.sync = sync
+        self.output_limit = output_limit
+        self.output_dir = output_dir
+        self.threads_per_test = threads_per_test
+        self.thread_budget = thread_budget
+        self.pin_cpus = pin_cpus
+        self.memory_budget = memory_budget
+        self.timeout_factor = timeout_factor
+        self.timeout_floor = timeout_floor
+        self.timeout_cap = timeout_cap
+        self.hang_timeout = hang_timeout
+        self.batch_size = batch_size
 
         # env is used to set some base environment variables that are not going
         # to change across runs, without sending them to os.environ which is
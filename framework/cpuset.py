@@ -0,0 +1,178 @@
+# Copyright (c) 2015 Intel Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+"""Sizing the test pool for drivers that run their own threads.
+
+CPU rasterizers such as llvmpipe start a thread per CPU in every test by
+default, so running a test per CPU concurrently starts CPUs squared threads.
+This module sizes the pool from a total thread budget and the number of
+threads each test may use, and can pin each worker of the pool, and the
+tests it runs, to its own set of CPUs. Where possible each set is on a
+single NUMA node.
+
+"""
+
+from __future__ import print_function, absolute_import
+import ctypes
+import glob
+import multiprocessing
+import os
+import threading
+
+__all__ = [
+    'WorkerCPUs',
+    'current',
+    'numa_nodes',
+    'online_cpus',
+    'parse_cpulist',
+    'partition',
+    'pool_size',
+    'set_affinity',
+]
+
+# The CPUs that tests run by the current thread are pinned to
+_WORKER = threading.local()
+
+
+def parse_cpulist(text):
+    """Parse a cpulist as used by sysfs, such as '0-3,8', into a list."""
+    cpus = []
+    for part in text.strip().split(','):
+        if not part:
+            continue
+        first, _, last = part.partition('-')
+        cpus.extend(range(int(first), int(last or first) + 1))
+    return cpus
+
+
+def online_cpus():
+    """Return a list of the online CPUs."""
+    try:
+        with open('/sys/devices/system/cpu/online', 'r') as f:
+            return parse_cpulist(f.read())
+    except (IOError, ValueError):
+        return range(multiprocessing.cpu_count())
+
+
+def numa_nodes():
+    """Return a list of the online CPUs of each NUMA node.
+
+    If the system doesn't expose NUMA nodes it is treated as a single node.
+
+    """
+    online = set(online_cpus())
+    nodes = []
+    for node in sorted(glob.glob('/sys/devices/system/node/node[0-9]*'),
+                       key=lambda n: int(os.path.basename(n)[4:])):
+        try:
+            with open(os.path.join(node, 'cpulist'), 'r') as f:
+                cpus = [c for c in parse_cpulist(f.read()) if c in online]
+        except (IOError, ValueError):
+            continue
+        if cpus:
+            nodes.append(cpus)
+    return nodes or [sorted(online)]
+
+
+def pool_size(threads_per_test, budget=None):
+    """Return the number of tests to run at once.
+
+    Arguments:
+    threads_per_test -- the number of threads each test runs, 0 is treated
+                        as 1, since the test itself is a thread
+
+    Keyword Arguments:
+    budget -- the total number of threads to run at once. Default: the number
+              of online CPUs
+
+    """
+    budget = budget or len(online_cpus())
+    return max(1, budget // max(1, threads_per_test))
+
+
+def partition(workers, threads_per_test):
+    """Return a list of CPUs for each of workers.
+
+    Each worker gets threads_per_test CPUs from a single NUMA node. If there
+    are more workers than sets of CPUs the sets are shared round robin.
+
+    """
+    size = max(1, threads_per_test)
+    sets = []
+    for node in numa_nodes():
+        sets.extend(node[i:i + size]
+                    for i in xrange(0, len(node) - size + 1, size))
+    if not sets:
+        # No node has enough CPUs for a whole set
+        sets = [online_cpus()]
+    return [sets[i % len(sets)] for i in xrange(workers)]
+
+
+def set_affinity(cpus, libc=None):
+    """Pin the calling process to cpus.
+
+    This is safe to call between fork and exec, as long as libc was loaded
+    before the fork. Returns False if the affinity couldn't be set.
+
+    """
+    libc = libc or ctypes.CDLL(None, use_errno=True)
+    bits = ctypes.sizeof(ctypes.c_ulong) * 8
+    mask = (ctypes.c_ulong * (max(cpus) // bits + 1))()
+    for cpu in cpus:
+        mask[cpu // bits] |= 1 << (cpu % bits)
+    try:
+        return libc.sched_setaffinity(0, ctypes.sizeof(mask), mask) == 0
+    except AttributeError:
+        return False
+
+
+class WorkerCPUs(object):
+    """Assigns each worker thread of a pool its own set of CPUs.
+
+    The assign method is meant to be used as the initializer of a
+    multiprocessing.dummy.Pool.
+
+    """
+    def __init__(self, workers, threads_per_test):
+        self.__sets = partition(workers, threads_per_test)
+        self.__next = 0
+        self.__lock = threading.Lock()
+        self.__libc = ctypes.CDLL(None, use_errno=True)
+
+    def assign(self):
+        """Assign the next set of CPUs to the calling thread."""
+        with self.__lock:
+            _WORKER.cpus = self.__sets[self.__next % len(self.__sets)]
+            _WORKER.libc = self.__libc
+            self.__next += 1
+
+
+def current():
+    """Return a function that pins a process to the calling thread's CPUs.
+
+    Returns None if the calling thread wasn't assigned any CPUs.
+
+    """
+    cpus = getattr(_WORKER, 'cpus', None)
+    if not cpus:
+        return None
+    libc = _WORKER.libc
+    return lambda: set_affinity(cpus, libc)
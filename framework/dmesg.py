@@ -21,9 +21,11 @@
 
 """ Module implementing classes for reading posix dmesg
 
-Currently this module only has the default DummyDmesg, and a LinuxDmesg.
-The method used on Linux requires that timetamps are enabled, and no other
-posix system has timestamps.
+Currently this module only has the default DummyDmesg, a LinuxDmesg, and a
+KmsgDmesg. The LinuxDmesg method requires that timetamps are enabled, and no
+other posix system has timestamps. KmsgDmesg reads the structured records from
+/dev/kmsg in a background thread, and is the only implementation that can be
+used with concurrent tests.
 
 On OSX and *BSD one would likely want to implement a system that reads the
 sysloger, since timestamps can be added by the sysloger, and are not inserted
@@ -37,16 +39,22 @@ dmesg implementation for their OS.
 
 from __future__ import print_function, absolute_import
 import re
+import os
 import sys
+import errno
+import select
 import subprocess
+import threading
 import warnings
 import abc
 
 __all__ = [
     'BaseDmesg',
     'LinuxDmesg',
+    'KmsgDmesg',
     'DummyDmesg',
     'get_dmesg',
+    'supports_concurrency',
 ]
 
 
@@ -64,9 +72,12 @@ class BaseDmesg(object):
     This class is not thread safe, becasue it does not black between the start
     of the test and the reading of dmesg, which means that if two tests run at
     the same time, and test A creates an entri in dmesg, but test B finishes
-    first, test B will be marked as having the dmesg error.
+    first, test B will be marked as having the dmesg error. Subclasses that
+    are safe to use with concurrent tests set THREAD_SAFE to True.
 
     """
+    THREAD_SAFE = False
+
     @abc.abstractmethod
     def __init__(self):
         # A list containing all messages since the last time dmesg was read.
@@ -104,6 +115,32 @@ class BaseDmesg(object):
         Arguments:
         result -- A TestResult instance
 
+        """
+        # Get a new snapshot of dmesg
+        self.update_dmesg()
+
+        return self._apply_messages(result, self._new_messages)
+
+    def close(self):
+        """ Release anything held for reading dmesg
+
+        Called when the run that uses this object ends. The default has
+        nothing to release.
+
+        """
+        pass
+
+    def _apply_messages(self, result, messages):
+        """ Update result with the dmesg statuses for messages
+
+        If there are any messages (and they match self.regex, if it is set),
+        replace the status of the test and it's subtests, and add the messages
+        to the result.
+
+        Arguments:
+        result -- A TestResult instance
+        messages -- a list of dmesg lines attributed to the test
+
         """
         def replace(res):
             """ helper to replace statuses with the new dmesg status
@@ -118,15 +155,12 @@ class BaseDmesg(object):
                 "fail": "dmesg-fail"
             }.get(res, res)
 
-        # Get a new snapshot of dmesg
-        self.update_dmesg()
-
         # if update_dmesg() found new entries replace the results of the test
         # and subtests
-        if self._new_messages:
+        if messages:
 
             if self.regex:
-                for line in self._new_messages:
+                for line in messages:
                     if self.regex.search(line):
                         break
                 else:
@@ -139,7 +173,7 @@ class BaseDmesg(object):
                 result.subtests[key] = replace(value)
 
             # Add the dmesg values to the result
-            result.dmesg = "\n".join(self._new_messages)
+            result.dmesg = "\n".join(messages)
 
         return result
 
@@ -201,6 +235,179 @@ class LinuxDmesg(BaseDmesg):
         self._last_message = dmesg[-1] if dmesg else None
 
 
+class KmsgDmesg(BaseDmesg):
+    """ Read kernel messages from /dev/kmsg with per-test attribution
+
+    A single background thread reads the structured records from /dev/kmsg
+    as they are produced. Each record carries a sequence number, and every
+    test remembers the last sequence number seen when it started. When the
+    test finishes the device is drained once more, and every record with a
+    sequence number after the test's start is attributed to it. Records are
+    therefore attributed to every test that was running when the kernel
+    emitted them, which makes this safe to use with concurrent tests, and no
+    process is spawned per test.
+
+    update_dmesg() and update_result() must be called from the same thread for
+    a given test, which is what Test.execute() does.
+
+    """
+    THREAD_SAFE = True
+    KMSG_PATH = '/dev/kmsg'
+
+    # Levels above notice (info and debug) are ignored, this matches the
+    # --level argument LinuxDmesg passes to dmesg.
+    MAX_LEVEL = 5
+
+    # How long the reader thread waits for new records before checking if it
+    # has been stopped, in seconds.
+    POLL_INTERVAL = 0.5
+
+    def __init__(self, path=None):
+        """ Create a kmsg instance and start the reader thread """
+        self._new_messages = []
+        self.regex = None
+
+        # (sequence number, formatted line) tuples for every record that may
+        # still be needed by a running test
+        self._records = []
+        self._last_seq = -1
+        self._pending = ''
+        self._lock = threading.Lock()
+
+        # Maps the thread running a test to the last sequence number seen when
+        # that test started.
+        self._active = {}
+        self._local = threading.local()
+
+        self._fd = os.open(path or self.KMSG_PATH, os.O_RDONLY | os.O_NONBLOCK)
+        try:
+            # Skip everything in the ring buffer from before piglit started,
+            # otherwise the first tests would be full of false positives.
+            os.lseek(self._fd, 0, os.SEEK_END)
+        except OSError as e:
+            if e.errno != errno.ESPIPE:
+                raise
+
+        self._stop = threading.Event()
+        self._thread = threading.Thread(target=self._reader)
+        self._thread.daemon = True
+        self._thread.start()
+
+    def close(self):
+        """ Stop the reader thread and close the device """
+        stop = getattr(self, '_stop', None)
+        if stop is None or stop.is_set():
+            return
+        stop.set()
+        if self._thread is not threading.current_thread():
+            self._thread.join()
+        os.close(self._fd)
+
+    def _reader(self):
+        """ Body of the reader thread, drains the device as records arrive """
+        while not self._stop.is_set():
+            try:
+                ready = select.select([self._fd], [], [], self.POLL_INTERVAL)[0]
+            except (select.error, ValueError):
+                return
+            if ready:
+                with self._lock:
+                    self._drain()
+
+    def _drain(self):
+        """ Read every pending record from the device
+
+        Must be called with self._lock held.
+
+        """
+        while True:
+            try:
+                data = os.read(self._fd, 8192)
+            except OSError as e:
+                if e.errno == errno.EPIPE:
+                    # The ring buffer wrapped before the records were read,
+                    # the next read returns the oldest record still available
+                    continue
+                elif e.errno in (errno.EAGAIN, errno.EWOULDBLOCK):
+                    break
+                raise
+            if not data:
+                break
+            self._pending += data
+
+        # Each record is a header line followed by optional continuation
+        # lines starting with a space. A trailing partial line is kept for the
+        # next drain.
+        lines = self._pending.split('\n')
+        self._pending = lines.pop()
+        for line in lines:
+            if not line or line.startswith(' '):
+                continue
+            record = self._parse_record(line)
+            if record is None:
+                continue
+            seq, level, message = record
+            if seq <= self._last_seq:
+                continue
+            self._last_seq = seq
+            if level <= self.MAX_LEVEL and self._active:
+                self._records.append((seq, message))
+
+    @staticmethod
+    def _parse_record(line):
+        """ Parse a single /dev/kmsg record
+
+        Records look like this: 'prio,seq,usec,flags;message'. Returns a tuple
+        of (seq, level, line) where line is formatted the same way dmesg
+        formats it, or None if the record is malformed.
+
+        """
+        header, sep, message = line.partition(';')
+        if not sep:
+            return None
+        fields = header.split(',')
+        try:
+            prio = int(fields[0])
+            seq = int(fields[1])
+            usec = int(fields[2])
+        except (IndexError, ValueError):
+            return None
+
+        return (seq, prio & 7,
+                '[{0:5d}.{1:06d}] {2}'.format(usec // 1000000, usec % 1000000,
+                                              message))
+
+    def update_dmesg(self):
+        """ Mark the start of a test on the calling thread """
+        with self._lock:
+            self._drain()
+            self._local.start = self._last_seq
+            self._active[threading.current_thread()] = self._last_seq
+
+    def update_result(self, result):
+        """ Takes a TestResult object and updates it with dmesg statuses
+
+        Every record produced between the update_dmesg() and update_result()
+        calls on this thread is attributed to result.
+
+        """
+        with self._lock:
+            self._drain()
+            start = self._local.start
+            self._new_messages = [m for s, m in self._records if s > start]
+            self._active.pop(threading.current_thread(), None)
+
+            # Drop records no running test can claim anymore
+            if self._active:
+                oldest = min(self._active.itervalues())
+                self._records = [r for r in self._records if r[0] > oldest]
+            else:
+                self._records = []
+            messages = self._new_messages
+
+        return self._apply_messages(result, messages)
+
+
 class DummyDmesg(BaseDmesg):
     """ An dummy class for dmesg on non unix-like systems
 
@@ -227,6 +434,21 @@ class DmesgError(EnvironmentError):
     pass
 
 
+def _kmsg_available():
+    """ Returns True if /dev/kmsg can be opened for reading
+
+    This has to actually open the device, with kernel.dmesg_restrict set the
+    file mode allows reading but the open fails with EPERM.
+
+    """
+    try:
+        fd = os.open(KmsgDmesg.KMSG_PATH, os.O_RDONLY | os.O_NONBLOCK)
+    except (OSError, IOError):
+        return False
+    os.close(fd)
+    return True
+
+
 def get_dmesg(not_dummy=True):
     """ Return a Dmesg type instance
 
@@ -234,7 +456,20 @@ def get_dmesg(not_dummy=True):
     your system. However, if Dummy is True then it will always return a
     DummyDmesg instance.
 
+    On Linux KmsgDmesg is preferred, LinuxDmesg is used if /dev/kmsg cannot
+    be read.
+
     """
     if sys.platform.startswith('linux') and not_dummy:
+        if _kmsg_available():
+            try:
+                return KmsgDmesg()
+            except (OSError, IOError):
+                pass
         return LinuxDmesg()
     return DummyDmesg()
+
+
+def supports_concurrency():
+    """ Returns True if the dmesg returned by get_dmesg() is thread safe """
+    return sys.platform.startswith('linux') and _kmsg_available()
@@ -29,9 +29,11 @@ returning BaseLog derived instances to individual tests.
 from __future__ import print_function, absolute_import
 import sys
 import abc
+import time
 import itertools
 import threading
 import collections
+import multiprocessing
 from BaseHTTPServer import HTTPServer, BaseHTTPRequestHandler
 
 try:
@@ -67,11 +69,18 @@ class BaseLog(object):
         self._pad = len(str(state['total']))
 
     @abc.abstractmethod
-    def start(self, name):
+    def start(self, name, timeout=None):
         """ Called before test run starts
 
         This method is used to print things before the test starts
 
+        Arguments:
+        name -- the name of the test
+
+        Keyword Arguments:
+        timeout -- the number of seconds the test may run for, or None if there
+                   is no timeout
+
         """
 
     @abc.abstractmethod
@@ -121,7 +130,7 @@ class QuietLog(BaseLog):
         self.__counter = self._test_counter.next()
         self._state['running'].append(self.__counter)
 
-    def start(self, name):
+    def start(self, name, timeout=None):
         pass
 
     def _log(self, status):
@@ -218,7 +227,7 @@ class VerboseLog(QuietLog):
             sys.stdout.write('\n')
             sys.stdout.flush()
 
-    def start(self, name):
+    def start(self, name, timeout=None):
         """ Print the test that is being run next
 
         This printings a running: <testname> message before the test run
@@ -250,7 +259,7 @@ class DummyLog(BaseLog):
     def __init__(self, state, state_lock):
         pass
 
-    def start(self, name):
+    def start(self, name, timeout=None):
         pass
 
     def log(self, status):
@@ -260,6 +269,171 @@ class DummyLog(BaseLog):
         pass
 
 
+class Telemetry(object):
+    """ Live statistics about a run, served by the HTTPLogServer
+
+    The start() and finish() methods must be called with the state lock held.
+    snapshot() is meant to be called by the http server without taking the
+    lock, it only makes copies of containers (which are atomic operations for
+    the builtin types) and reads scalars, so the worst case is that a snapshot
+    is a test or so out of date, it never blocks the tests from running.
+
+    Arguments:
+    total -- the total number of tests to run
+    workers -- the number of tests that can run at the same time
+
+    """
+    # Upper bounds of the test duration histogram buckets, in seconds
+    BUCKETS = (0.1, 0.5, 1, 2, 5, 10, 30, 60, 120, 300)
+
+    # The number of seconds used to calculate the recent throughput
+    WINDOW = 60
+
+    # The number of entries returned in the nearest timeout list
+    NEAREST = 10
+
+    def __init__(self, total, workers):
+        self.total = total
+        self.workers = workers
+        self.started = time.time()
+        self.complete = 0
+        self.results = {}
+
+        # Maps an id for each running test to (name, start time, timeout)
+        self.running = {}
+
+        # Completion times of the most recent tests, used for throughput
+        self.completions = collections.deque(maxlen=4096)
+
+        # Non cumulative counts per bucket, the last one is +Inf
+        self.buckets = [0] * (len(self.BUCKETS) + 1)
+        self.duration_sum = 0.0
+
+    def start(self, key, name, timeout=None):
+        """ Mark the test identified by key as running """
+        self.running[key] = (name, time.time(), timeout)
+
+    def finish(self, key, status):
+        """ Mark the test identified by key as complete with status """
+        now = time.time()
+        _, start, _ = self.running.pop(key, (None, now, None))
+        duration = now - start
+
+        for i, bound in enumerate(self.BUCKETS):
+            if duration <= bound:
+                break
+        else:
+            i = len(self.BUCKETS)
+        self.buckets[i] += 1
+        self.duration_sum += duration
+
+        self.results[status] = self.results.get(status, 0) + 1
+        self.completions.append(now)
+        self.complete += 1
+
+    def snapshot(self):
+        """ Return a dictionary describing the current state of the run """
+        now = time.time()
+        running = self.running.copy()
+        completions = list(self.completions)
+        buckets = list(self.buckets)
+        complete = self.complete
+        elapsed = now - self.started
+
+        recent = [c for c in completions if now - c <= self.WINDOW]
+        window = min(self.WINDOW, elapsed)
+
+        tests = sorted(
+            ({'name': name, 'elapsed': now - start, 'timeout': timeout}
+             for name, start, timeout in running.itervalues()),
+            key=lambda x: x['elapsed'], reverse=True)
+
+        nearest = sorted(
+            ({'name': t['name'], 'remaining': t['timeout'] - t['elapsed']}
+             for t in tests if t['timeout']),
+            key=lambda x: x['remaining'])[:self.NEAREST]
+
+        cumulative = []
+        for count in buckets:
+            cumulative.append(count + (cumulative[-1] if cumulative else 0))
+
+        return {
+            'elapsed': elapsed,
+            'total': self.total,
+            'complete': complete,
+            'running_count': len(tests),
+            'queued': max(self.total - complete - len(tests), 0),
+            'workers': self.workers,
+            'utilization': float(len(tests)) / self.workers,
+            'throughput': {
+                'overall': complete / elapsed if elapsed > 0 else 0.0,
+                'recent': len(recent) / window if window > 0 else 0.0,
+            },
+            'running': tests,
+            'nearest_timeout': nearest,
+            'durations': {
+                'buckets': [[str(b), c] for b, c in
+                            zip(self.BUCKETS + ('+Inf',), cumulative)],
+                'sum': self.duration_sum,
+                'count': cumulative[-1],
+            },
+            'results': self.results.copy(),
+        }
+
+    @staticmethod
+    def to_prometheus(snapshot):
+        """ Format a snapshot in the prometheus text exposition format """
+        def escape(value):
+            return value.replace('\\', '\\\\').replace(
+                '"', '\\"').replace('\n', '\\n')
+
+        lines = []
+
+        def metric(name, type_, help_, samples):
+            lines.append('# HELP piglit_{0} {1}'.format(name, help_))
+            lines.append('# TYPE piglit_{0} {1}'.format(name, type_))
+            for suffix, labels, value in samples:
+                if labels:
+                    labels = '{' + ','.join(
+                        '{0}="{1}"'.format(k, escape(v))
+                        for k, v in labels) + '}'
+                lines.append('piglit_{0}{1}{2} {3!r}'.format(
+                    name, suffix, labels or '', value))
+
+        metric('tests', 'gauge', 'Number of tests in the run.',
+               [('', None, snapshot['total'])])
+        metric('tests_complete_total', 'counter', 'Number of tests completed.',
+               [('', None, snapshot['complete'])])
+        metric('tests_running', 'gauge', 'Number of tests running.',
+               [('', None, snapshot['running_count'])])
+        metric('tests_queued', 'gauge', 'Number of tests waiting to run.',
+               [('', None, snapshot['queued'])])
+        metric('workers', 'gauge', 'Number of tests that can run at once.',
+               [('', None, snapshot['workers'])])
+        metric('worker_utilization', 'gauge',
+               'Fraction of the workers running a test.',
+               [('', None, snapshot['utilization'])])
+        metric('throughput_tests_per_second', 'gauge',
+               'Tests completed per second.',
+               [('', [('window', k)], v)
+                for k, v in sorted(snapshot['throughput'].iteritems())])
+        metric('results_total', 'counter', 'Number of tests completed by status.',
+               [('', [('status', k)], v)
+                for k, v in sorted(snapshot['results'].iteritems())])
+        metric('running_test_elapsed_seconds', 'gauge',
+               'Seconds each running test has been running for.',
+               [('', [('name', t['name'])], t['elapsed'])
+                for t in snapshot['running']])
+        metric('test_duration_seconds', 'histogram',
+               'Duration of completed tests.',
+               [('_bucket', [('le', b)], c)
+                for b, c in snapshot['durations']['buckets']] +
+               [('_sum', None, snapshot['durations']['sum']),
+                ('_count', None, snapshot['durations']['count'])])
+
+        return '\n'.join(lines) + '\n'
+
+
 class HTTPLogServer(threading.Thread):
     class RequestHandler(BaseHTTPRequestHandler):
         INDENT = 4
@@ -276,6 +450,19 @@ class HTTPLogServer(threading.Thread):
                         "results" : self.server.state["summary"],
                     }
                 self.wfile.write(json.dumps(status, indent=self.INDENT))
+            elif self.path == "/telemetry":
+                snapshot = self.server.state["telemetry"].snapshot()
+                self.send_response(200)
+                self.send_header("Content-Type", "application/json")
+                self.end_headers()
+                self.wfile.write(json.dumps(snapshot, indent=self.INDENT))
+            elif self.path == "/metrics":
+                snapshot = self.server.state["telemetry"].snapshot()
+                self.send_response(200)
+                self.send_header("Content-Type",
+                                 "text/plain; version=0.0.4")
+                self.end_headers()
+                self.wfile.write(Telemetry.to_prometheus(snapshot))
             else:
                 self.send_response(404)
                 self.end_headers()
@@ -298,15 +485,18 @@ class HTTPLogServer(threading.Thread):
 
 class HTTPLog(BaseLog):
     """ A Logger that serves status information over http """
+    _test_counter = itertools.count()
 
     def __init__(self, state, state_lock):
         super(HTTPLog, self).__init__(state, state_lock)
         self._name = None
+        self.__counter = self._test_counter.next()
 
-    def start(self, name):
+    def start(self, name, timeout=None):
         with self._LOCK:
             self._name = name
             self._state['running'].append(self._name)
+            self._state['telemetry'].start(self.__counter, name, timeout)
 
     def log(self, status):
         with self._LOCK:
@@ -314,6 +504,7 @@ class HTTPLog(BaseLog):
             self._state['complete'] += 1
             assert status in self.SUMMARY_KEYS
             self._state['summary'][str(status)] += 1
+            self._state['telemetry'].finish(self.__counter, str(status))
 
     def summary(self):
         pass
@@ -336,6 +527,10 @@ class LogManager(object):
     logger -- a string name of a logger to use
     total -- the total number of test to run
 
+    Keyword Arguments:
+    workers -- the number of tests that may run at the same time. Default: the
+               number of cpus
+
     """
     LOG_MAP = {
         'quiet': QuietLog,
@@ -344,7 +539,7 @@ class LogManager(object):
         'http': HTTPLog,
     }
 
-    def __init__(self, logger, total):
+    def __init__(self, logger, total, workers=None):
         assert logger in self.LOG_MAP
         self._log = self.LOG_MAP[logger]
         self._state = {
@@ -358,6 +553,8 @@ class LogManager(object):
 
         # start the http server for http logger
         if logger == 'http':
+            self._state['telemetry'] = Telemetry(
+                total, workers or multiprocessing.cpu_count())
             self.log_server = HTTPLogServer(self._state, self._state_lock)
             self.log_server.start()
 
@@ -0,0 +1,254 @@
+# Copyright (c) 2015 Intel Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+"""Admitting concurrent tests within a memory budget.
+
+The concurrent pool admits a test whenever a worker is free, so a handful of
+memory hungry tests, like max size textures or large multisample FBOs, can
+run at the same time and push the machine into swap or the OOM killer. A
+MemoryBudget tracks the expected peak RSS of each running test and holds
+back new tests while the total would exceed the budget.
+
+The expected peak of a test is what it used in a previous run, if known.
+While a test runs its RSS is read from /proc, and if it grows past the
+expectation the reservation grows with it.
+
+All sizes are in KiB, which is what the kernel reports.
+
+"""
+
+from __future__ import print_function, absolute_import
+import contextlib
+import errno
+import os
+import re
+import sys
+import threading
+
+__all__ = [
+    'MemoryBudget',
+    'RSSMonitor',
+    'current',
+    'estimates',
+    'parse_size',
+    'peak_rss',
+    'wait',
+]
+
+# The function the tests run by the current thread report their RSS to
+_WORKER = threading.local()
+
+_SIZE = re.compile(r'^\s*(\d+)\s*([KMGT]?)i?B?\s*$', re.IGNORECASE)
+_UNITS = {'': 1, 'K': 1, 'M': 1024, 'G': 1024 ** 2, 'T': 1024 ** 3}
+
+
+def parse_size(text):
+    """Parse a size like '512M' or '8G' into KiB.
+
+    A number without a unit is KiB. Raises ValueError if text isn't a size.
+
+    """
+    match = _SIZE.match(text)
+    if not match:
+        raise ValueError('Invalid size: "{}"'.format(text))
+    return int(match.group(1)) * _UNITS[match.group(2).upper()]
+
+
+def peak_rss(pid):
+    """Return the peak RSS of a running process in KiB.
+
+    Returns None if it can't be read, because the process has exited or the
+    system has no /proc.
+
+    """
+    try:
+        with open('/proc/{}/status'.format(pid), 'r') as f:
+            for line in f:
+                if line.startswith('VmHWM:'):
+                    return int(line.split()[1])
+    except (IOError, ValueError, IndexError):
+        pass
+    return None
+
+
+def wait(proc):
+    """Wait for a subprocess.Popen to exit and return its peak RSS in KiB.
+
+    This replaces proc.wait() where the system provides wait4, which returns
+    the resource usage of the child along with its status. Returns None if
+    the peak isn't known.
+
+    """
+    if not hasattr(os, 'wait4'):
+        proc.wait()
+        return None
+
+    while True:
+        try:
+            _, status, usage = os.wait4(proc.pid, 0)
+            break
+        except OSError as e:
+            if e.errno == errno.EINTR:
+                continue
+            elif e.errno == errno.ECHILD:
+                # Already reaped by a poll(), such as from a ProcessTimeout
+                proc.wait()
+                return None
+            raise
+
+    proc._handle_exitstatus(status)  # pylint: disable=protected-access
+
+    # Linux reports ru_maxrss in KiB, OS X in bytes
+    if sys.platform == 'darwin':
+        return usage.ru_maxrss // 1024
+    return usage.ru_maxrss
+
+
+def estimates(results):
+    """Return a dictionary of test name: peak RSS from a TestrunResult."""
+    return {n: r.peak_rss for n, r in results.tests.iteritems()
+            if r.peak_rss}
+
+
+class RSSMonitor(threading.Thread):
+    """Reports the peak RSS of a process while it runs.
+
+    Every interval seconds the peak is read from /proc, and whenever it
+    grows it is passed to report. Call finish() once the process has
+    exited.
+
+    """
+    def __init__(self, pid, report, interval=0.5):
+        super(RSSMonitor, self).__init__()
+        self.daemon = True
+        self.pid = pid
+        self.peak = 0
+        self.__report = report
+        self.__interval = interval
+        self.__done = threading.Event()
+
+    def sample(self):
+        """Read the peak RSS of the process, and report it if it grew."""
+        rss = peak_rss(self.pid)
+        if rss is not None and rss > self.peak:
+            self.peak = rss
+            self.__report(rss)
+
+    def run(self):
+        while not self.__done.wait(self.__interval):
+            self.sample()
+
+    def finish(self):
+        """Stop monitoring and wait for the thread to exit."""
+        self.__done.set()
+        self.join()
+
+
+class MemoryBudget(object):
+    """Limits the expected total peak RSS of the running tests.
+
+    A test is always admitted if nothing else is running, so a test that is
+    larger than the whole budget still runs, on its own.
+
+    Arguments:
+    budget -- the total RSS in KiB the running tests may use, if None every
+              test is admitted immediately
+
+    Keyword Arguments:
+    estimates -- a dictionary of test name: expected peak RSS in KiB, from
+                 a previous run. Default: None
+    default -- the expected peak RSS of a test with no estimate. Default: 0
+
+    """
+    def __init__(self, budget, estimates=None, default=0):
+        self.budget = budget
+        self.default = default
+        self.__estimates = dict(estimates or {})
+        self.__running = {}
+        self.__cond = threading.Condition()
+
+    def estimate(self, name, like=None):
+        """Return the expected peak RSS of a test.
+
+        If there is no estimate for name, the estimate for like is used.
+
+        """
+        return self.__estimates.get(
+            name, self.__estimates.get(like, self.default))
+
+    @property
+    def reserved(self):
+        """The total RSS reserved by the running tests."""
+        with self.__cond:
+            return sum(self.__running.itervalues())
+
+    def update(self, name, rss):
+        """Grow the reservation of a running test to its measured RSS.
+
+        The measurement is also kept as the estimate for the test.
+
+        """
+        with self.__cond:
+            if rss > self.__estimates.get(name, 0):
+                self.__estimates[name] = rss
+            if name in self.__running and rss > self.__running[name]:
+                self.__running[name] = rss
+
+    @contextlib.contextmanager
+    def admit(self, name, like=None):
+        """Wait until there is room in the budget for name, then run it.
+
+        While in the context, tests run by the calling thread report their
+        RSS to update().
+
+        Keyword Arguments:
+        like -- the name of a test to take the estimate from if there is
+                none for name, such as the test a subtest was split from.
+                Default: None
+
+        """
+        need = self.estimate(name, like)
+        with self.__cond:
+            if self.budget is not None:
+                while self.__running and \
+                        sum(self.__running.itervalues()) + need > self.budget:
+                    self.__cond.wait()
+            self.__running[name] = need
+
+        if self.budget is not None:
+            _WORKER.report = lambda rss: self.update(name, rss)
+        try:
+            yield
+        finally:
+            _WORKER.report = None
+            with self.__cond:
+                del self.__running[name]
+                self.__cond.notify_all()
+
+
+def current():
+    """Return the function the calling thread reports the RSS of a test to.
+
+    Returns None if the calling thread isn't running an admitted test with a
+    budget.
+
+    """
+    return getattr(_WORKER, 'report', None)
@@ -27,17 +27,20 @@ are represented by a TestProfile or a TestProfile derived object.
 """
 
 from __future__ import print_function, absolute_import
+import collections
 import os
 import multiprocessing
 import multiprocessing.dummy
 import importlib
 import contextlib
 import itertools
+import threading
 
-from framework import grouptools, exceptions
+from framework import grouptools, exceptions, cpuset, memory, timeouts
 from framework.dmesg import get_dmesg
 from framework.log import LogManager
-from framework.test.base import Test
+from framework.results import TestResult
+from framework.test.base import Test, TestIsSkip
 
 __all__ = [
     'TestProfile',
@@ -133,6 +136,125 @@ class TestDict(dict):  # pylint: disable=too-few-public-methods
         self.__allow_reassignment -= 1
 
 
+class SplitTest(object):
+    """Merges the results of a test whose subtests are run separately.
+
+    Each subtest is run as its own unit, and the results are merged into a
+    single result for the test, which is written once the last unit is done.
+
+    Arguments:
+    name -- the name of the test
+    test -- the test, which must provide subtest()
+    subtests -- a list of (option, name) pairs, as from list_subtests()
+
+    """
+    def __init__(self, name, test, subtests):
+        self.name = name
+        self.result = TestResult()
+        self.result.command = ' '.join(test.command)
+        self.units = [(grouptools.join(name, option), test.subtest(option),
+                       subtest) for option, subtest in subtests]
+        self.__remaining = len(self.units)
+        self.__lock = threading.Lock()
+
+    def merge(self, subtest, result):
+        """Merge the result of the unit that ran subtest."""
+        merged = self.result
+        if result.subtests:
+            merged.subtests.update(result.subtests)
+        else:
+            # The unit didn't get far enough to report its subtest, it must
+            # have crashed or been skipped
+            merged.subtests[subtest] = result.result
+
+        for attr in ['out', 'err', 'dmesg']:
+            value = getattr(result, attr)
+            if value:
+                setattr(merged, attr, '\n'.join(
+                    x for x in [getattr(merged, attr), value] if x))
+
+        if merged.returncode in [None, 0]:
+            merged.returncode = result.returncode
+        if merged.exception is None:
+            merged.exception = result.exception
+            merged.traceback = result.traceback
+
+        if result.time.start:
+            merged.time.start = min(merged.time.start or result.time.start,
+                                    result.time.start)
+            merged.time.end = max(merged.time.end, result.time.end)
+
+        merged.perf.update(result.perf)
+        merged.shader_time.extend(result.shader_time)
+        # Each unit is a process of its own, so the phases and calls add up
+        for name, value in result.phases.iteritems():
+            merged.phases[name] = merged.phases.get(name, 0.0) + value
+        for name, value in result.gl_calls.iteritems():
+            calls = merged.gl_calls.setdefault(name, {})
+            for key, count in value.iteritems():
+                calls[key] = calls.get(key, 0) + count
+        if result.peak_rss:
+            merged.peak_rss = max(merged.peak_rss or 0, result.peak_rss)
+
+    def done(self, subtest, result, backend):
+        """Merge a unit's result, and write the test if it was the last."""
+        with self.__lock:
+            self.merge(subtest, result)
+            self.__remaining -= 1
+            if self.__remaining:
+                return
+
+        with backend.write_test(self.name) as w:
+            w(self.result)
+
+
+class BatchTest(object):
+    """Runs several tests in one process, and writes the result of each.
+
+    The tests must have the same batch_key, and batch() must return a test
+    that runs all of them, and whose results attribute maps the name
+    attribute of each test to its TestResult once it has run.
+
+    Arguments:
+    tests -- a list of (name, test) pairs
+
+    """
+    def __init__(self, tests):
+        self.tests = tests
+        self.name = '{} (+{})'.format(tests[0][0], len(tests) - 1)
+        self.test = tests[0][1].batch([t for _, t in tests])
+
+    def deadline(self, deadlines):
+        """Return the sum of the deadlines of the tests, or None."""
+        total = 0
+        for name, _ in self.tests:
+            deadline = deadlines.get(name)
+            if deadline is None:
+                return None
+            total += deadline
+        return total
+
+    def largest(self, budget):
+        """Return the name of the test with the largest memory estimate.
+
+        The tests run one after another in the same process, so the batch
+        needs as much as the largest of them.
+
+        """
+        return max((name for name, _ in self.tests), key=budget.estimate)
+
+    def done(self, backend):
+        """Write the result of each test.
+
+        A test without a result of its own, because the batch failed before
+        running it, gets the result of the batch.
+
+        """
+        for name, test in self.tests:
+            with backend.write_test(name) as w:
+                w(self.test.results.get(test.name, self.test.result))
+
+
 class TestProfile(object):
     """ Class that holds a list of tests for execution
 
@@ -158,6 +280,12 @@ class TestProfile(object):
         self._dmesg = None
         self.dmesg = False
         self.results_dir = None
+        # The peak RSS of tests in a previous run, used to admit tests within
+        # opts.memory_budget
+        self.memory_estimates = {}
+        # The durations of tests in previous runs, used to give each test a
+        # timeout
+        self.timeout_history = {}
 
     @property
     def dmesg(self):
@@ -173,6 +301,8 @@ class TestProfile(object):
                      will get a DummyDmesg
 
         """
+        if self._dmesg is not None:
+            self._dmesg.close()
         self._dmesg = get_dmesg(not_dummy)
 
     def _prepare_test_list(self, opts):
@@ -215,6 +345,105 @@ class TestProfile(object):
             raise exceptions.PiglitFatalError(
                 'There are no tests scheduled to run. Aborting run.')
 
+    def _split_subtests(self, opts):
+        """Split tests that run their subtests separately into units.
+
+        Returns a list of (name, test, split) tuples to run. split is None
+        for a test that is run whole, otherwise it is a pair of the SplitTest
+        that the unit belongs to and the name of the unit's subtest. Tests
+        that can't list their subtests are run whole.
+
+        """
+        def list_subtests(item):
+            """Return the subtests of a test, if it can be split."""
+            name, test = item
+            if not (opts.execute and getattr(test, 'split_subtests', False)):
+                return None
+            try:
+                test.is_skip()
+            except TestIsSkip:
+                return None
+            return test.list_subtests()
+
+        items = self.test_list.items()
+        pool = multiprocessing.dummy.Pool()
+        subtests = pool.map(list_subtests, items)
+        pool.close()
+        pool.join()
+
+        units = []
+        for (name, test), listed in itertools.izip(items, subtests):
+            if listed:
+                split = SplitTest(name, test, listed)
+                units.extend((n, t, (split, s)) for n, t, s in split.units)
+            else:
+                units.append((name, test, None))
+        return units
+
+    @staticmethod
+    def _batch_tests(units, opts):
+        """Group tests that can share a process into batches.
+
+        Tests that are run whole and have the same batch_key are put in
+        BatchTests of up to opts.batch_size tests each, which replace them in
+        units as (name, test, batch) tuples. Tests without a batch_key, or
+        that are alone, are left as they are.
+
+        """
+        if not (opts.execute and opts.batch_size > 1):
+            return units
+
+        groups = collections.OrderedDict()
+        for unit in units:
+            key = getattr(unit[1], 'batch_key', None)
+            if unit[2] is not None or key is None:
+                key = id(unit)
+            groups.setdefault(key, []).append(unit)
+
+        batched = []
+        for group in groups.itervalues():
+            for i in xrange(0, len(group), opts.batch_size):
+                chunk = group[i:i + opts.batch_size]
+                if len(chunk) == 1:
+                    batched.extend(chunk)
+                    continue
+                batch = BatchTest([(n, t) for n, t, _ in chunk])
+                batched.append((batch.name, batch.test, batch))
+        return batched
+
+    @staticmethod
+    def _concurrent_workers(opts):
+        """Return the number of workers in the pool concurrent tests run in.
+
+        By default the pool has a worker per CPU. If either
+        opts.threads_per_test or opts.thread_budget is set the number of
+        workers is the budget divided by the threads of each test instead.
+        Workers pinned with opts.pin_cpus can only use the online CPUs, so
+        then there is a worker per online CPU.
+
+        """
+        if opts.threads_per_test is not None or opts.thread_budget:
+            return cpuset.pool_size(opts.threads_per_test or 1,
+                                    opts.thread_budget)
+        if opts.pin_cpus:
+            return len(cpuset.online_cpus())
+        return multiprocessing.cpu_count()
+
+    @staticmethod
+    def _concurrent_pool(opts, workers):
+        """Create the pool that concurrent tests are run in.
+
+        If opts.pin_cpus is set each of the workers is pinned to its own
+        CPUs.
+
+        """
+        initializer = None
+        if opts.pin_cpus:
+            initializer = cpuset.WorkerCPUs(
+                workers, opts.threads_per_test or 1).assign
+
+        return multiprocessing.dummy.Pool(workers, initializer)
+
     def _pre_run_hook(self, opts):
         """ Hook executed at the start of TestProfile.run
 
@@ -259,21 +488,56 @@ class TestProfile(object):
         self._pre_run_hook(opts)
         Test.OPTS = opts
 
+        # llvmpipe starts a thread per CPU by default
+        if opts.threads_per_test is not None:
+            opts.env['LP_NUM_THREADS'] = str(opts.threads_per_test)
+
         chunksize = 1
 
         self._prepare_test_list(opts)
-        log = LogManager(logger, len(self.test_list))
-
-        def test(pair):
+        units = self._batch_tests(self._split_subtests(opts), opts)
+        workers = self._concurrent_workers(opts)
+        log = LogManager(logger, len(units),
+                         workers=1 if opts.concurrent == "none" else workers)
+        budget = memory.MemoryBudget(opts.memory_budget,
+                                     self.memory_estimates)
+        deadlines = timeouts.Deadlines(self.timeout_history,
+                                       opts.timeout_factor,
+                                       opts.timeout_floor,
+                                       opts.timeout_cap)
+
+        def test(unit):
             """ Function to call test.execute from .map
 
             Adds opts which are needed by Test.execute()
 
             """
-            name, test = pair
-            with backend.write_test(name) as w:
-                test.execute(name, log.get(), self.dmesg)
-                w(test.result)
+            name, test, split = unit
+            if isinstance(split, BatchTest):
+                deadline = split.deadline(deadlines)
+                if deadline is not None:
+                    test.timeout = min(test.timeout or deadline, deadline)
+                with budget.admit(name, like=split.largest(budget)):
+                    test.execute(name, log.get(), self.dmesg)
+                split.done(backend)
+                return
+
+            # A timeout set by the test itself is an upper bound
+            deadline = deadlines.get(
+                name, like=split[0].name if split is not None else None)
+            if deadline is not None:
+                test.timeout = min(test.timeout or deadline, deadline)
+
+            if split is not None:
+                with budget.admit(name, like=split[0].name):
+                    test.execute(name, log.get(), self.dmesg)
+                split[0].done(split[1], test.result, backend)
+                return
+
+            with budget.admit(name):
+                with backend.write_test(name) as w:
+                    test.execute(name, log.get(), self.dmesg)
+                    w(test.result)
 
         def run_threads(pool, testlist):
             """ Open a pool, close it, and join it """
@@ -286,24 +550,24 @@ class TestProfile(object):
         #
         # The default value of pool is the number of virtual processor cores
         single = multiprocessing.dummy.Pool(1)
-        multi = multiprocessing.dummy.Pool()
+        multi = self._concurrent_pool(opts, workers)
 
         if opts.concurrent == "all":
-            run_threads(multi, self.test_list.iteritems())
+            run_threads(multi, units)
         elif opts.concurrent == "none":
-            run_threads(single, self.test_list.iteritems())
+            run_threads(single, units)
         else:
             # Filter and return only thread safe tests to the threaded pool
-            run_threads(multi, (x for x in self.test_list.iteritems()
-                                if x[1].run_concurrent))
+            run_threads(multi, (x for x in units if x[1].run_concurrent))
             # Filter and return the non thread safe tests to the single pool
-            run_threads(single, (x for x in self.test_list.iteritems()
-                                 if not x[1].run_concurrent))
+            run_threads(single, (x for x in units if not x[1].run_concurrent))
 
         log.get().summary()
 
         self._post_run_hook(opts)
 
+        self.dmesg.close()
+
     def filter_tests(self, function):
         """Filter out tests that return false from the supplied function
 
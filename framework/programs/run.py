@@ -29,7 +29,8 @@ import time
 import ConfigParser
 import ctypes
 
-from framework import core, backends, exceptions
+from framework import core, backends, exceptions, memory, timeouts
+import framework.dmesg
 import framework.results
 import framework.profile
 from . import parsers
@@ -86,6 +87,64 @@ def _default_backend():
         return 'json'
 
 
+def _default_output_limit():
+    """ Logic to set the default output limit
+
+    Either the value set via the --output-limit option, or [core]:output_limit
+    from the config file. The default if that fails is 1MiB.
+
+    """
+    try:
+        return int(core.PIGLIT_CONFIG.get('core', 'output_limit'))
+    except (ConfigParser.NoOptionError, ConfigParser.NoSectionError):
+        return 1024 * 1024
+    except ValueError:
+        raise exceptions.PiglitFatalError(
+            '[core]:output_limit must be an integer number of bytes')
+
+
+def _default_int(option, default=None):
+    """Return the integer value of [core]:option from the config file."""
+    try:
+        return int(core.PIGLIT_CONFIG.get('core', option))
+    except (ConfigParser.NoOptionError, ConfigParser.NoSectionError):
+        return default
+    except ValueError:
+        raise exceptions.PiglitFatalError(
+            '[core]:{} must be an integer'.format(option))
+
+
+def _default_float(option, default=None):
+    """Return the float value of [core]:option from the config file."""
+    try:
+        return float(core.PIGLIT_CONFIG.get('core', option))
+    except (ConfigParser.NoOptionError, ConfigParser.NoSectionError):
+        return default
+    except ValueError:
+        raise exceptions.PiglitFatalError(
+            '[core]:{} must be a number'.format(option))
+
+
+def _default_pin_cpus():
+    """Return [core]:pin_cpus from the config file, or False."""
+    try:
+        return core.PIGLIT_CONFIG.getboolean('core', 'pin_cpus')
+    except (ConfigParser.NoOptionError, ConfigParser.NoSectionError):
+        return False
+
+
+def _default_memory_budget():
+    """Return [core]:memory_budget from the config file in KiB, or None."""
+    try:
+        return memory.parse_size(
+            core.PIGLIT_CONFIG.get('core', 'memory_budget'))
+    except (ConfigParser.NoOptionError, ConfigParser.NoSectionError):
+        return None
+    except ValueError:
+        raise exceptions.PiglitFatalError(
+            '[core]:memory_budget must be a size, such as 8G')
+
+
 def _run_parser(input_):
     """ Parser for piglit run command """
     unparsed = parsers.parse_config(input_)[1]
@@ -136,13 +195,103 @@ def _run_parser(input_):
     parser.add_argument("--valgrind",
                         action="store_true",
                         help="Run tests in valgrind's memcheck")
+    parser.add_argument("--shader-timing",
+                        action="store_true",
+                        help="Record how long the driver takes to compile "
+                             "and link each shader. See 'piglit summary "
+                             "shaders'")
     parser.add_argument("--dmesg",
                         action="store_true",
                         help="Capture a difference in dmesg before and "
-                             "after each test. Implies -1/--no-concurrency")
+                             "after each test. Implies -1/--no-concurrency "
+                             "unless /dev/kmsg is readable")
     parser.add_argument("-s", "--sync",
                         action="store_true",
                         help="Sync results to disk after every test")
+    parser.add_argument("--output-limit",
+                        type=int,
+                        default=_default_output_limit(),
+                        metavar="<bytes>",
+                        help="The number of bytes of each of stdout and "
+                             "stderr to store in the results for each test. "
+                             "The rest is written compressed to the output "
+                             "directory of the results. 0 stores everything")
+    parser.add_argument("--threads-per-test",
+                        type=int,
+                        default=_default_int('threads_per_test'),
+                        metavar="<threads>",
+                        help="The number of threads CPU rasterizers such as "
+                             "llvmpipe may use in each test. The number of "
+                             "concurrent tests is the thread budget divided "
+                             "by this")
+    parser.add_argument("--thread-budget",
+                        type=int,
+                        default=_default_int('thread_budget'),
+                        metavar="<threads>",
+                        help="The total number of threads to run at once. "
+                             "Default is the number of CPUs")
+    parser.add_argument("--pin-cpus",
+                        action="store_true",
+                        default=_default_pin_cpus(),
+                        help="Pin each concurrent test to its own set of "
+                             "CPUs, on a single NUMA node where possible")
+    parser.add_argument("--memory-budget",
+                        type=memory.parse_size,
+                        default=_default_memory_budget(),
+                        metavar="<size>",
+                        help="The total peak RSS of the tests running at "
+                             "once, such as 8G. Tests wait to start until "
+                             "their expected peak fits")
+    parser.add_argument("--memory-history",
+                        type=path.realpath,
+                        metavar="<results>",
+                        help="A previous result to take the expected peak RSS "
+                             "of each test from. Tests that are not in it are "
+                             "only accounted for once they are running")
+    parser.add_argument("--timeout-history",
+                        action="append",
+                        type=path.realpath,
+                        default=[],
+                        metavar="<results>",
+                        help="A previous result to take the durations of "
+                             "each test from. Each test that is in one is "
+                             "given a timeout of --timeout-factor times the "
+                             "95th percentile of its durations. May be given "
+                             "more than once")
+    parser.add_argument("--timeout-factor",
+                        type=float,
+                        default=_default_float('timeout_factor', 5),
+                        metavar="<factor>",
+                        help="The multiple of a test's usual duration it may "
+                             "run for. Default: 5")
+    parser.add_argument("--timeout-floor",
+                        type=int,
+                        default=_default_int('timeout_floor', 10),
+                        metavar="<seconds>",
+                        help="The smallest timeout derived from "
+                             "--timeout-history. Default: 10")
+    parser.add_argument("--timeout-cap",
+                        type=int,
+                        default=_default_int('timeout_cap'),
+                        metavar="<seconds>",
+                        help="The largest timeout derived from "
+                             "--timeout-history")
+    parser.add_argument("--hang-timeout",
+                        type=int,
+                        default=_default_int('hang_timeout', 0),
+                        metavar="<seconds>",
+                        help="Kill a test as a timeout once it has been "
+                             "asleep without using any CPU time for this "
+                             "many seconds, which is what a GPU hang looks "
+                             "like. Default: 0, disabled")
+    parser.add_argument("--batch-size",
+                        type=int,
+                        default=_default_int('batch_size', 0),
+                        metavar="<tests>",
+                        help="Run up to this many tests that support it, "
+                             "currently glean tests, in a single process "
+                             "that shares windows and contexts between them. "
+                             "Default: 0, disabled")
     parser.add_argument("--junit_suffix",
                         type=str,
                         default="",
@@ -185,6 +334,8 @@ def _create_metadata(args, name, opts):
         options[key] = value
     if args.platform:
         options['platform'] = args.platform
+    options['memory_history'] = args.memory_history
+    options['timeout_history'] = args.timeout_history
 
     metadata = {'options': options}
     metadata['name'] = name
@@ -193,6 +344,22 @@ def _create_metadata(args, name, opts):
     return metadata
 
 
+def _load_history(profile, options):
+    """Load the previous results named in a run's options into profile.
+
+    This is done the same way for a new run and a resumed one, since the
+    tests left to run on resume are exactly the ones the partial run has
+    nothing to say about.
+
+    """
+    if options.get('memory_history'):
+        profile.memory_estimates = memory.estimates(
+            backends.load(options['memory_history']))
+    if options.get('timeout_history'):
+        profile.timeout_history = timeouts.durations(
+            [backends.load(r) for r in options['timeout_history']])
+
+
 def _disable_windows_exception_messages():
     """Disable Windows error message boxes for this and all child processes."""
     if sys.platform == 'win32':
@@ -223,9 +390,9 @@ def run(input_):
     args = _run_parser(input_)
     _disable_windows_exception_messages()
 
-    # If dmesg is requested we must have serial run, this is becasue dmesg
-    # isn't reliable with threaded run
-    if args.dmesg:
+    # If dmesg is requested we must have serial run, unless /dev/kmsg can be
+    # used, this is becasue dmesg isn't reliable with threaded run
+    if args.dmesg and not framework.dmesg.supports_concurrency():
         args.concurrency = "none"
 
     # build up the include filter based on test_list
@@ -241,10 +408,23 @@ def run(input_):
                         execute=args.execute,
                         valgrind=args.valgrind,
                         dmesg=args.dmesg,
-                        sync=args.sync)
+                        sync=args.sync,
+                        output_limit=args.output_limit,
+                        output_dir=path.join(args.results_path, 'output'),
+                        threads_per_test=args.threads_per_test,
+                        thread_budget=args.thread_budget,
+                        pin_cpus=args.pin_cpus,
+                        memory_budget=args.memory_budget,
+                        timeout_factor=args.timeout_factor,
+                        timeout_floor=args.timeout_floor,
+                        timeout_cap=args.timeout_cap,
+                        hang_timeout=args.hang_timeout,
+                        batch_size=args.batch_size)
 
     # Set the platform to pass to waffle
     opts.env['PIGLIT_PLATFORM'] = args.platform
+    if args.shader_timing:
+        opts.env['PIGLIT_SHADER_TIMING'] = '1'
 
     # Change working directory to the root of the piglit directory
     piglit_dir = path.dirname(path.realpath(sys.argv[0]))
@@ -264,10 +444,12 @@ def run(input_):
         args.results_path,
         file_fsync=opts.sync,
         junit_suffix=args.junit_suffix)
-    backend.initialize(_create_metadata(args, results.name, opts))
+    metadata = _create_metadata(args, results.name, opts)
+    backend.initialize(metadata)
 
     profile = framework.profile.merge_test_profiles(args.test_profile)
     profile.results_dir = args.results_path
+    _load_history(profile, metadata['options'])
 
     results.time_elapsed.start = time.time()
     # Set the dmesg type
@@ -301,37 +483,69 @@ def resume(input_):
     args = parser.parse_args(input_)
     _disable_windows_exception_messages()
 
-    results = backends.load(args.results_path)
+    # Only the metadata of a sqlite run is needed, see below
+    is_sqlite = backends.sqlite.is_sqlite(args.results_path)
+    if is_sqlite:
+        results = backends.sqlite.load_metadata(args.results_path)
+    else:
+        results = backends.load(args.results_path)
     opts = core.Options(concurrent=results.options['concurrent'],
                         exclude_filter=results.options['exclude_filter'],
                         include_filter=results.options['filter'],
                         execute=results.options['execute'],
                         valgrind=results.options['valgrind'],
                         dmesg=results.options['dmesg'],
-                        sync=results.options['sync'])
+                        sync=results.options['sync'],
+                        output_limit=results.options.get('output_limit', 0),
+                        output_dir=results.options.get('output_dir'),
+                        threads_per_test=results.options.get(
+                            'threads_per_test'),
+                        thread_budget=results.options.get('thread_budget'),
+                        pin_cpus=results.options.get('pin_cpus', False),
+                        memory_budget=results.options.get('memory_budget'),
+                        timeout_factor=results.options.get('timeout_factor',
+                                                           5),
+                        timeout_floor=results.options.get('timeout_floor',
+                                                          10),
+                        timeout_cap=results.options.get('timeout_cap'),
+                        hang_timeout=results.options.get('hang_timeout', 0),
+                        batch_size=results.options.get('batch_size', 0))
 
     core.get_config(args.config_file)
 
     opts.env['PIGLIT_PLATFORM'] = results.options['platform']
+    env = results.options.get('env', {})
+    if 'PIGLIT_SHADER_TIMING' in env:
+        opts.env['PIGLIT_SHADER_TIMING'] = env['PIGLIT_SHADER_TIMING']
 
     results.options['env'] = core.collect_system_info()
     results.options['name'] = results.name
 
-    # Resume only works with the JSON backend
-    backend = backends.get_backend('json')(
-        args.results_path,
-        file_fsync=opts.sync,
-        file_start_count=len(results.tests) + 1)
+    # Resume works with the JSON and sqlite backends. A sqlite run can be
+    # resumed in place, and knows which tests are done without looking at
+    # the results themselves.
+    if is_sqlite:
+        backend = backends.get_backend('sqlite')(
+            args.results_path,
+            file_fsync=opts.sync)
+        opts.exclude_tests.update(backends.sqlite.completed(
+            args.results_path, include_incomplete=args.no_retry))
+    else:
+        backend = backends.get_backend('json')(
+            args.results_path,
+            file_fsync=opts.sync,
+            file_start_count=len(results.tests) + 1)
+
+        # Don't re-run tests that have already completed, incomplete status
+        # tests have obviously not completed.
+        for name, result in results.tests.iteritems():
+            if args.no_retry or result.result != 'incomplete':
+                opts.exclude_tests.add(name)
     # Specifically do not initialize again, everything initialize does is done.
 
-    # Don't re-run tests that have already completed, incomplete status tests
-    # have obviously not completed.
-    for name, result in results.tests.iteritems():
-        if args.no_retry or result.result != 'incomplete':
-            opts.exclude_tests.add(name)
-
     profile = framework.profile.merge_test_profiles(results.options['profile'])
     profile.results_dir = args.results_path
+    _load_history(profile, results.options)
     if opts.dmesg:
         profile.dmesg = opts.dmesg
 
@@ -35,6 +35,9 @@ __all__ = [
     'console',
     'csv',
     'html',
+    'perf',
+    'phases',
+    'shaders',
 ]
 
 
@@ -158,6 +161,79 @@ def console(input_):
     summary.console(args.results, args.mode or 'all')
 
 
+@exceptions.handler
+def perf(input_):
+    """Compare performance measurements between results."""
+    unparsed = parsers.parse_config(input_)[1]
+
+    # Adding the parent is necissary to get the help options
+    parser = argparse.ArgumentParser(parents=[parsers.CONFIG])
+    parser.add_argument("-d", "--diff",
+                        action="store_const",
+                        const="diff",
+                        default="all",
+                        dest="mode",
+                        help="Only display measurements that changed "
+                             "significantly")
+    parser.add_argument("-a", "--alpha",
+                        type=float,
+                        default=summary.perf_.ALPHA,
+                        help="The significance level used to compare each "
+                             "result to the first. Default: %(default)s")
+    parser.add_argument("results",
+                        metavar="<Results Path(s)>",
+                        nargs="+",
+                        help="Space seperated paths to at least one results "
+                             "file. The first is the baseline")
+    args = parser.parse_args(unparsed)
+
+    summary.perf(args.results, args.alpha, args.mode)
+
+
+@exceptions.handler
+def shaders(input_):
+    """Rank the slowest shaders in one or more results."""
+    unparsed = parsers.parse_config(input_)[1]
+
+    # Adding the parent is necissary to get the help options
+    parser = argparse.ArgumentParser(parents=[parsers.CONFIG])
+    parser.add_argument("-n", "--count",
+                        type=int,
+                        default=20,
+                        help="The number of shaders to list, 0 lists all. "
+                             "Default: %(default)s")
+    parser.add_argument("-k", "--key",
+                        choices=['max', 'mean'],
+                        default='max',
+                        help="Rank shaders by their slowest or their mean "
+                             "time. Default: %(default)s")
+    parser.add_argument("results",
+                        metavar="<Results Path(s)>",
+                        nargs="+",
+                        help="Space seperated paths to at least one results "
+                             "file, run with --shader-timing")
+    args = parser.parse_args(unparsed)
+
+    summary.shaders(args.results, args.count, args.key)
+
+
+@exceptions.handler
+def phases(input_):
+    """Show the time spent in each phase of the tests of one or more results."""
+    unparsed = parsers.parse_config(input_)[1]
+
+    # Adding the parent is necissary to get the help options
+    parser = argparse.ArgumentParser(parents=[parsers.CONFIG])
+    parser.add_argument("results",
+                        metavar="<Results Path(s)>",
+                        nargs="+",
+                        help="Space seperated paths to at least one results "
+                             "file")
+    args = parser.parse_args(unparsed)
+
+    summary.phases(args.results)
+
+
 @exceptions.handler
 def csv(input_):
     unparsed = parsers.parse_config(input_)[1]
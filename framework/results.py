@@ -26,10 +26,14 @@ from __future__ import print_function, absolute_import
 import collections
 import copy
 import datetime
+import hashlib
+import math
 
 from framework import status, exceptions, grouptools
 
 __all__ = [
+    'BlobTable',
+    'Measurement',
     'TestrunResult',
     'TestResult',
 ]
@@ -104,6 +108,98 @@ class StringDescriptor(object):  # pylint: disable=too-few-public-methods
         raise NotImplementedError
 
 
+class BlobRef(unicode):
+    """The id of a string stored in a BlobTable.
+
+    This is a unicode subclass so that it can be stored in a TestResult before
+    the BlobTable it refers to has been loaded, it must be expanded with
+    BlobTable.expand() before being used.
+
+    """
+    def to_json(self):
+        return {'__type__': 'Blob', 'id': unicode(self)}
+
+    @classmethod
+    def from_dict(cls, dict_):
+        return cls(dict_['id'])
+
+
+class BlobTable(object):
+    """A content addressed table of strings shared between TestResults.
+
+    Many of the strings stored in a TestResult (the environment, the command,
+    and often the output) are identical across a large number of tests.
+    Storing them once and referring to them by id makes the results files
+    smaller, and since every expanded reference is the same object, loaded
+    results use much less memory.
+
+    """
+    # Strings shorter than this are not worth storing, the reference would be
+    # about as large as the string.
+    MIN_SIZE = 64
+
+    def __init__(self, blobs=None):
+        self.__blobs = dict(blobs or {})
+
+    @staticmethod
+    def key(value):
+        """Return the id a string would be stored under.
+
+        Byte strings (like the output of a test) are hashed as they are,
+        encoding them would first decode them as ascii, which fails for
+        anything that isn't.
+
+        """
+        if isinstance(value, unicode):
+            value = value.encode('utf-8')
+        return hashlib.sha1(value).hexdigest()[:16]
+
+    def add(self, value):
+        """Add a string to the table.
+
+        Returns True if the value was added, or was already in the table. In
+        the very unlikely case of a collision the value is not added and False
+        is returned.
+
+        """
+        return self.__blobs.setdefault(self.key(value), value) == value
+
+    def ref(self, value):
+        """Return a BlobRef for value if it is in the table, else value.
+
+        Note that since BlobRef is a unicode subclass the json module will
+        encode it as a plain string, use BlobRef.to_json() to serialize it.
+
+        """
+        if isinstance(value, basestring) and len(value) >= self.MIN_SIZE:
+            key = self.key(value)
+            if self.__blobs.get(key) == value:
+                return BlobRef(key)
+        return value
+
+    def expand(self, value):
+        """Return the string value refers to if it is a BlobRef, else value."""
+        if isinstance(value, BlobRef):
+            return self.__blobs[value]
+        return value
+
+    def __len__(self):
+        return len(self.__blobs)
+
+    def to_json(self):
+        res = dict(self.__blobs)
+        res['__type__'] = 'BlobTable'
+        return res
+
+    @classmethod
+    def from_dict(cls, dict_):
+        dict_ = copy.copy(dict_)
+
+        if '__type__' in dict_:
+            del dict_['__type__']
+        return cls(dict_)
+
+
 class TimeAttribute(object):
     """Attribute of TestResult for time.
 
@@ -141,20 +237,84 @@ class TimeAttribute(object):
         return cls(**dict_)
 
 
+class Measurement(object):
+    """A performance measurement, made of repeated samples.
+
+    The samples are kept so that measurements from different runs can be
+    compared with a significance test, the mean, median and standard
+    deviation are derived from them.
+
+    """
+    __slots__ = ['unit', 'samples']
+
+    def __init__(self, unit='', samples=None):
+        self.unit = unit
+        self.samples = list(samples or [])
+
+    @property
+    def mean(self):
+        if not self.samples:
+            return 0.0
+        return math.fsum(self.samples) / len(self.samples)
+
+    @property
+    def median(self):
+        if not self.samples:
+            return 0.0
+        samples = sorted(self.samples)
+        mid = len(samples) // 2
+        if len(samples) % 2:
+            return samples[mid]
+        return (samples[mid - 1] + samples[mid]) / 2.0
+
+    @property
+    def stddev(self):
+        """The sample standard deviation."""
+        if len(self.samples) < 2:
+            return 0.0
+        mean = self.mean
+        return math.sqrt(math.fsum((x - mean) ** 2 for x in self.samples) /
+                         (len(self.samples) - 1))
+
+    def to_json(self):
+        return {
+            'unit': self.unit,
+            'samples': self.samples,
+            'mean': self.mean,
+            'median': self.median,
+            'stddev': self.stddev,
+            '__type__': 'Measurement',
+        }
+
+    @classmethod
+    def from_dict(cls, dict_):
+        """Load a measurement, the derived values are recalculated."""
+        return cls(dict_.get('unit', ''), dict_.get('samples'))
+
+
 class TestResult(object):
     """An object represting the result of a single test."""
     __slots__ = ['returncode', '_err', '_out', 'time', 'command', 'traceback',
                  'environment', 'subtests', 'dmesg', '__result', 'images',
-                 'exception']
+                 'exception', 'perf', 'shader_time', 'phases',
+                 'gl_calls', 'peak_rss']
     err = StringDescriptor('_err')
     out = StringDescriptor('_out')
 
+    # Fields that may be stored in a BlobTable
+    BLOB_FIELDS = ('command', 'environment', 'out', 'err', 'dmesg')
+
     def __init__(self, result=None):
         self.returncode = None
         self.time = TimeAttribute()
         self.command = str()
         self.environment = str()
         self.subtests = Subtests()
+        self.perf = {}
+        self.shader_time = []
+        self.phases = {}
+        self.gl_calls = {}
+        self.peak_rss = None
         self.dmesg = str()
         self.images = None
         self.traceback = None
@@ -183,8 +343,14 @@ class TestResult(object):
         except exceptions.PiglitInternalError as e:
             raise exceptions.PiglitFatalError(str(e))
 
-    def to_json(self):
-        """Return the TestResult as a json serializable object."""
+    def to_json(self, blobs=None):
+        """Return the TestResult as a json serializable object.
+
+        Keyword Arguments:
+        blobs -- a BlobTable. Any of the BLOB_FIELDS that are in the table are
+                 replaced by a reference to it. Default: None
+
+        """
         obj = {
             '__type__': 'TestResult',
             'command': self.command,
@@ -194,20 +360,35 @@ class TestResult(object):
             'result': self.result,
             'returncode': self.returncode,
             'subtests': self.subtests,
+            'perf': self.perf,
+            'shader_time': self.shader_time,
+            'phases': self.phases,
+            'gl_calls': self.gl_calls,
+            'peak_rss': self.peak_rss,
             'time': self.time,
             'exception': self.exception,
             'dmesg': self.dmesg,
         }
+        if blobs is not None:
+            for each in self.BLOB_FIELDS:
+                value = blobs.ref(obj[each])
+                if isinstance(value, BlobRef):
+                    obj[each] = value.to_json()
         return obj
 
     @classmethod
-    def from_dict(cls, dict_):
+    def from_dict(cls, dict_, blobs=None):
         """Load an already generated result in dictionary form.
 
         This is used as an alternate constructor which converts an existing
         dictionary into a TestResult object. It converts a key 'result' into a
         status.Status object
 
+        Keyword Arguments:
+        blobs -- a BlobTable to expand references with. If it is None any
+                 references are kept, and must be expanded with expand()
+                 later. Default: None
+
         """
         # pylint will say that assining to inst.out or inst.err is a non-slot
         # because self.err and self.out are descriptors, methods that act like
@@ -215,8 +396,16 @@ class TestResult(object):
         # pylint: disable=assigning-non-slot
         inst = cls()
 
+        # References that have not been through the json decoder are still
+        # dictionaries
+        refs = dict((k, BlobRef.from_dict(dict_[k])) for k in cls.BLOB_FIELDS
+                    if isinstance(dict_.get(k), dict))
+        if refs:
+            dict_ = copy.copy(dict_)
+            dict_.update(refs)
+
         for each in ['returncode', 'command', 'exception', 'environment',
-                     'time', 'result', 'dmesg']:
+                     'time', 'result', 'dmesg', 'peak_rss']:
             if each in dict_:
                 setattr(inst, each, dict_[each])
 
@@ -224,6 +413,17 @@ class TestResult(object):
             for name, value in dict_['subtests'].iteritems():
                 inst.subtests[name] = value
 
+        inst.shader_time = list(dict_.get('shader_time', []))
+        inst.phases = dict(dict_.get('phases', {}))
+        inst.gl_calls = dict(dict_.get('gl_calls', {}))
+
+        # Measurements are already decoded if they went through the json
+        # decoder
+        for name, value in dict_.get('perf', {}).iteritems():
+            if not isinstance(value, Measurement):
+                value = Measurement.from_dict(value)
+            inst.perf[name] = value
+
         # out and err must be set manually to avoid replacing the setter
         if 'out' in dict_:
             inst.out = dict_['out']
@@ -231,10 +431,21 @@ class TestResult(object):
         if 'err' in dict_:
             inst.err = dict_['err']
 
+        if blobs is not None:
+            inst.expand(blobs)
+
         return inst
 
+    def expand(self, blobs):
+        """Replace any references to a BlobTable with their strings."""
+        # pylint: disable=assigning-non-slot
+        for each in self.BLOB_FIELDS:
+            value = getattr(self, each)
+            if isinstance(value, BlobRef):
+                setattr(self, each, blobs.expand(value))
+
     def update(self, dict_):
-        """Update the results and subtests fields from a piglit test.
+        """Update the result and the other fields reported by a piglit test.
 
         Native piglit tests output their data as valid json, and piglit uses
         the json module to parse this data. This method consumes that raw
@@ -246,6 +457,23 @@ class TestResult(object):
         elif 'subtest' in dict_:
             self.subtests.update(dict_['subtest'])
 
+        if 'perf' in dict_:
+            for name, value in dict_['perf'].iteritems():
+                self.perf[name] = Measurement.from_dict(value)
+
+        # Each compile and link is reported on its own line
+        if 'shader_time' in dict_:
+            self.shader_time.extend(dict_['shader_time'])
+
+        # Phases that end after the result, like teardown, are reported on a
+        # line of their own
+        if 'phases' in dict_:
+            self.phases.update(dict_['phases'])
+
+        # Only reported by tests built with PIGLIT_DISPATCH_TRACE
+        if 'gl_calls' in dict_:
+            self.gl_calls.update(dict_['gl_calls'])
+
 
 class Totals(dict):
     def __init__(self, *args, **kwargs):
@@ -331,10 +559,30 @@ class TestrunResult(object):
                 self.totals['root'][res] += 1
 
     def to_json(self):
+        """Return the TestrunResult as a json serializable object.
+
+        Any of the TestResult.BLOB_FIELDS values that are shared by more than
+        one test are stored once in a BlobTable, and the tests refer to them.
+
+        """
         if not self.totals:
             self.calculate_group_totals()
         rep = copy.copy(self.__dict__)
         rep['__type__'] = 'TestrunResult'
+
+        counts = collections.Counter(
+            value for test in self.tests.itervalues()
+            for value in (getattr(test, f) for f in TestResult.BLOB_FIELDS)
+            if len(value) >= BlobTable.MIN_SIZE)
+        blobs = BlobTable()
+        for value, count in counts.iteritems():
+            if count > 1:
+                blobs.add(value)
+
+        rep['tests'] = {name: test.to_json(blobs)
+                        for name, test in self.tests.iteritems()}
+        if blobs:
+            rep['blobs'] = blobs
         return rep
 
     @classmethod
@@ -356,6 +604,21 @@ class TestrunResult(object):
             if value:
                 setattr(res, name, value)
 
+        # Tests may be TestResult instances if they were loaded with the json
+        # decoder, or dictionaries from to_json(). References to the blob
+        # table are expanded here, since the table is not available when the
+        # tests are decoded.
+        blobs = dict_.get('blobs')
+        if isinstance(blobs, dict):
+            blobs = BlobTable.from_dict(blobs)
+        res.tests = dict(res.tests)
+        for name, test in res.tests.items():
+            if isinstance(test, dict):
+                if test.get('__type__') == 'TestResult':
+                    res.tests[name] = TestResult.from_dict(test, blobs)
+            elif blobs is not None:
+                test.expand(blobs)
+
         if not res.totals and not _no_totals:
             res.calculate_group_totals()
 
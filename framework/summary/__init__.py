@@ -27,3 +27,6 @@
 from __future__ import absolute_import, division, print_function
 from .html_ import html
 from .console_ import console
+from .perf_ import perf
+from .shaders_ import shaders
+from .phases_ import phases
@@ -25,7 +25,6 @@
 from __future__ import absolute_import, division, print_function
 import itertools
 import re
-import operator
 
 # a local variable status exists, prevent accidental overloading by renaming
 # the module
@@ -101,6 +100,10 @@ class Names(object):
 
     @lazy_property
     def changes(self):
+        def changed(prev, cur):
+            """Any case of a != b except skip <-> notrun."""
+            return prev != cur and {prev, cur} != {so.SKIP, so.NOTRUN}
+
         def handler(names, name, prev, cur):
             """Handle missing tests.
 
@@ -114,13 +117,10 @@ class Names(object):
                 except KeyError:
                     return so.NOTRUN
 
-            # Add any case of a != b except skip <-> notrun
-            cur = _get(cur)
-            prev = _get(prev)
-            if cur != prev and {cur, prev} != {so.SKIP, so.NOTRUN}:
+            if changed(_get(prev), _get(cur)):
                 names.add(name)
 
-        return self.__diff(operator.ne, handler=handler)
+        return self.__diff(changed, handler=handler)
 
     @lazy_property
     def problems(self):
@@ -29,6 +29,7 @@ import textwrap
 # the module
 from framework import grouptools, backends
 from .common import Results
+from . import sqlite_
 
 __all__ = [
     'console',
@@ -98,7 +99,11 @@ def _print_result(results, list_):
 def console(results, mode):
     """ Write summary information to the console """
     assert mode in ['summary', 'diff', 'incomplete', 'all'], mode
-    results = Results([backends.load(r) for r in results])
+    # sqlite results can be compared in the database, without loading them
+    if sqlite_.supported(results):
+        results = sqlite_.SQLResults(results)
+    else:
+        results = Results([backends.load(r) for r in results])
 
     # Print the name of the test and the status from each test run
     if mode == 'all':
@@ -0,0 +1,177 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Compare performance measurements between runs.
+
+Every run is compared to the first one with Welch's t-test, which doesn't
+assume that the runs have the same variance. Measurements are rates, so a
+significant decrease is a regression.
+
+"""
+
+from __future__ import absolute_import, division, print_function
+import math
+
+from framework import grouptools, backends
+
+__all__ = [
+    'compare',
+    'perf',
+    'welch_ttest',
+]
+
+# The default significance level
+ALPHA = 0.05
+
+
+def _betacf(a, b, x):
+    """Continued fraction for the incomplete beta function."""
+    tiny = 1e-300
+    qab = a + b
+    qap = a + 1.0
+    qam = a - 1.0
+    c = 1.0
+    d = 1.0 - qab * x / qap
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    h = d
+    for m in xrange(1, 201):
+        m2 = 2 * m
+        for aa in (m * (b - m) * x / ((qam + m2) * (a + m2)),
+                   -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))):
+            d = 1.0 + aa * d
+            d = 1.0 / (d if abs(d) > tiny else tiny)
+            c = 1.0 + aa / c
+            c = c if abs(c) > tiny else tiny
+            h *= d * c
+        if abs(d * c - 1.0) < 1e-12:
+            break
+    return h
+
+
+def _betai(a, b, x):
+    """The regularized incomplete beta function I_x(a, b)."""
+    if x <= 0.0:
+        return 0.0
+    elif x >= 1.0:
+        return 1.0
+    bt = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) +
+                  a * math.log(x) + b * math.log(1.0 - x))
+    if x < (a + 1.0) / (a + b + 2.0):
+        return bt * _betacf(a, b, x) / a
+    return 1.0 - bt * _betacf(b, a, 1.0 - x) / b
+
+
+def welch_ttest(before, after):
+    """Return the two sided p-value that two Measurements have equal means.
+
+    Returns None if either measurement has fewer than two samples.
+
+    """
+    n1, n2 = len(before.samples), len(after.samples)
+    if n1 < 2 or n2 < 2:
+        return None
+
+    v1 = before.stddev ** 2 / n1
+    v2 = after.stddev ** 2 / n2
+    diff = after.mean - before.mean
+    if v1 + v2 == 0:
+        return 1.0 if diff == 0 else 0.0
+
+    t = diff / math.sqrt(v1 + v2)
+    df = (v1 + v2) ** 2 / (v1 ** 2 / (n1 - 1) + v2 ** 2 / (n2 - 1))
+    return _betai(df / 2.0, 0.5, df / (df + t * t))
+
+
+def compare(before, after, alpha=ALPHA):
+    """Compare two Measurements.
+
+    Returns a tuple of (relative change, p-value, verdict), where verdict is
+    one of 'regression', 'improvement', or '' if the change is not
+    significant at alpha.
+
+    """
+    change = (after.mean - before.mean) / before.mean if before.mean else 0.0
+    p = welch_ttest(before, after)
+    verdict = ''
+    if p is not None and p < alpha:
+        verdict = 'regression' if change < 0 else 'improvement'
+    return change, p, verdict
+
+
+def _measurements(results):
+    """Return a sorted list of every (test, measurement name) in results."""
+    names = set()
+    for res in results:
+        for test, result in res.tests.iteritems():
+            names.update((test, m) for m in result.perf)
+    return sorted(names)
+
+
+def perf(results, alpha=ALPHA, mode='all'):
+    """Print a comparison of the measurements in results to the console.
+
+    Arguments:
+    results -- a list of paths to results
+
+    Keyword Arguments:
+    alpha -- the significance level of the test. Default: 0.05
+    mode -- 'all' prints every measurement, 'diff' only those that changed
+            significantly in at least one run. Default: 'all'
+
+    """
+    assert mode in ['all', 'diff'], mode
+    results = [backends.load(r) for r in results]
+    width = max(len(r.name) for r in results)
+
+    for test, name in _measurements(results):
+        values = []
+        for res in results:
+            try:
+                values.append(res.tests[test].perf[name])
+            except KeyError:
+                values.append(None)
+
+        lines = []
+        significant = False
+        for res, value in zip(results, values):
+            if value is None:
+                lines.append('  {0: <{1}}  notrun'.format(res.name, width))
+                continue
+
+            line = '  {0: <{1}}  mean {2:.6g}  median {3:.6g}  ' \
+                   'stddev {4:.3g}  n {5}'.format(
+                       res.name, width, value.mean, value.median,
+                       value.stddev, len(value.samples))
+            if values[0] is not None and value is not values[0]:
+                change, p, verdict = compare(values[0], value, alpha)
+                line += '  {0:+.2%}  p {1}'.format(
+                    change, 'n/a' if p is None else '{:.3g}'.format(p))
+                if verdict:
+                    significant = True
+                    line += '  ' + verdict
+            lines.append(line)
+
+        if mode == 'all' or significant:
+            unit = next(v.unit for v in values if v is not None)
+            print('{} ({}):'.format(
+                '/'.join(grouptools.join(test, name).split(
+                    grouptools.SEPARATOR)), unit))
+            for line in lines:
+                print(line)
@@ -0,0 +1,118 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""Show where the time of a run went, phase by phase.
+
+GL tests report how long each phase of the run took: setting up the
+framework (which includes connecting to the display, choosing a config,
+creating the context and loading the dispatch table), the test's own init and
+display, and tearing down. Anything that isn't covered by a phase, such as
+exec and dynamic linking, is reported as other.
+
+"""
+
+from __future__ import absolute_import, division, print_function
+import collections
+
+from framework import backends
+
+__all__ = [
+    'PHASES',
+    'aggregate',
+    'phases',
+]
+
+# The phases in the order they run. framework includes the phases indented
+# below it.
+PHASES = ['framework', 'platform', 'config', 'context', 'dispatch', 'init',
+          'display', 'teardown']
+
+# The phases that make up the total, the rest are parts of framework
+_TOP_LEVEL = ['framework', 'init', 'display', 'teardown']
+
+
+class Phases(object):  # pylint: disable=too-few-public-methods
+    """The total time spent in each phase over the tests of a run."""
+    def __init__(self, name):
+        self.name = name
+        self.totals = collections.defaultdict(float)
+        self.tests = 0
+
+    @property
+    def overhead(self):
+        """The time spent setting up and tearing down the framework."""
+        return self.totals['framework'] + self.totals['teardown']
+
+    @property
+    def work(self):
+        """The time spent in the tests' init and display."""
+        return self.totals['init'] + self.totals['display']
+
+    @property
+    def total(self):
+        return sum(self.totals[p] for p in _TOP_LEVEL) + self.totals['other']
+
+
+def aggregate(result):
+    """Sum the phases of every test in a TestrunResult that reported them.
+
+    Returns a Phases instance.
+
+    """
+    agg = Phases(result.name)
+    for test in result.tests.itervalues():
+        if not test.phases:
+            continue
+        agg.tests += 1
+        for name, value in test.phases.iteritems():
+            agg.totals[name] += value
+        agg.totals['other'] += max(
+            test.time.total - sum(test.phases.get(p, 0.0)
+                                  for p in _TOP_LEVEL), 0.0)
+    return agg
+
+
+def _line(name, value, total, nested=False):
+    """Print one phase, and its share of the total."""
+    indent = '    ' if nested else '  '
+    print('{}{: <{}} {:>12.3f} s {:>6.1%}'.format(
+        indent, name, 14 - len(indent), value, value / total))
+
+
+def phases(results):
+    """Print the time spent in each phase for each run to the console.
+
+    Arguments:
+    results -- a list of paths to results
+
+    """
+    for res in results:
+        agg = aggregate(backends.load(res))
+        print('{} ({} tests with phases):'.format(agg.name, agg.tests))
+        if not agg.tests:
+            continue
+
+        total = agg.total or 1.0
+        for name in PHASES + ['other']:
+            _line(name, agg.totals[name], total,
+                  nested=name not in _TOP_LEVEL + ['other'])
+        _line('overhead', agg.overhead, total)
+        _line('work', agg.work, total)
@@ -0,0 +1,99 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Rank the slowest shaders across one or more runs.
+
+Tests report how long each compile and link took when they are run with
+PIGLIT_SHADER_TIMING set (piglit run --shader-timing). The same shader is
+often used by many tests, so the timings are grouped by the stage and the
+hash of the source.
+
+"""
+
+from __future__ import absolute_import, division, print_function
+import collections
+
+from framework import grouptools, backends
+
+__all__ = [
+    'collect',
+    'shaders',
+]
+
+
+class Shader(object):  # pylint: disable=too-few-public-methods
+    """The timings of one shader, or one set of linked shaders."""
+    def __init__(self, stage, hash_):
+        self.stage = stage
+        self.hash = hash_
+        self.times = []
+        self.tests = set()
+
+    @property
+    def max(self):
+        return max(self.times)
+
+    @property
+    def mean(self):
+        return sum(self.times) / len(self.times)
+
+
+def collect(results):
+    """Group the shader timings of a list of TestrunResults.
+
+    Returns a list of Shader instances.
+
+    """
+    shaders = collections.OrderedDict()
+    for res in results:
+        for name, test in res.tests.iteritems():
+            for each in test.shader_time:
+                key = (each['stage'], each['hash'])
+                if key not in shaders:
+                    shaders[key] = Shader(*key)
+                shaders[key].times.append(each['time'])
+                shaders[key].tests.add(name)
+    return shaders.values()
+
+
+def shaders(results, count=20, key='max'):
+    """Print the slowest shaders in results to the console.
+
+    Arguments:
+    results -- a list of paths to results
+
+    Keyword Arguments:
+    count -- the number of shaders to print, 0 prints all. Default: 20
+    key -- 'max' or 'mean', the time to rank the shaders by. Default: 'max'
+
+    """
+    assert key in ['max', 'mean'], key
+    ranked = sorted(collect([backends.load(r) for r in results]),
+                    key=lambda s: getattr(s, key), reverse=True)
+    if count:
+        ranked = ranked[:count]
+
+    for shader in ranked:
+        tests = sorted(shader.tests)
+        print('{:>10.3f} ms  max {:.3f} ms  n {}  {} {}  {}{}'.format(
+            getattr(shader, key) * 1000, shader.max * 1000,
+            len(shader.times), shader.stage, shader.hash,
+            '/'.join(tests[0].split(grouptools.SEPARATOR)),
+            ' (+{} more)'.format(len(tests) - 1) if len(tests) > 1 else ''))
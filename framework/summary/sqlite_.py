@@ -0,0 +1,292 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Summaries computed in sqlite across several attached run databases.
+
+This provides the same interface as common.Results, but rather than loading
+every run into memory the names and counts are computed by queries against
+the statuses table of each run, which is indexed by name and result.
+
+"""
+
+from __future__ import absolute_import, division, print_function
+import collections
+import json
+import sqlite3
+
+# a local variable status exists, prevent accidental overloading by renaming
+# the module
+import framework.status as so
+from framework.core import lazy_property
+from framework.backends import sqlite as backend
+from .common import Counts
+
+__all__ = [
+    'SQLResults',
+    'supported',
+]
+
+# sqlite's default SQLITE_MAX_ATTACHED
+MAX_RUNS = 10
+
+# Join the statuses of two runs on the names of all runs, like common.Names
+# does, treating missing as notrun. A name with no status may still be a test
+# that has subtests in another run, whose own result is used, as
+# TestrunResult.get_result does. Each side is joined to the status table to
+# get the sorting value, and to know whether it is a NoChangeStatus.
+_PAIR = """
+    SELECT p.name AS name,
+           p.a_result IS NOT NULL AS a_present,
+           p.b_result IS NOT NULL AS b_present,
+           coalesce(p.a_result, 'notrun') AS a_result,
+           coalesce(p.b_result, 'notrun') AS b_result,
+           sa.value AS a_value, sa.total AS a_total,
+           sb.value AS b_value, sb.total AS b_total
+    FROM (SELECT n.name AS name,
+                 coalesce(a.result, ta.result) AS a_result,
+                 coalesce(b.result, tb.result) AS b_result
+          FROM names AS n
+          LEFT JOIN {a}.statuses AS a ON a.name = n.name
+          LEFT JOIN {b}.statuses AS b ON b.name = n.name
+          LEFT JOIN {a}.tests AS ta ON a.name IS NULL AND ta.name = n.name
+          LEFT JOIN {b}.tests AS tb ON b.name IS NULL AND tb.name = n.name
+         ) AS p
+    JOIN status AS sa ON sa.name = coalesce(p.a_result, 'notrun')
+    JOIN status AS sb ON sb.name = coalesce(p.b_result, 'notrun')
+"""
+
+# Every status has a distinct value except skip, notrun and pass, and skip and
+# notrun compare by name, so a change is simply a different name, except for
+# skip <-> notrun, see common.Names.changes
+_CHANGES = """
+    SELECT name FROM ({pair}) WHERE a_result != b_result AND
+        NOT (a_result IN ('skip', 'notrun') AND
+             b_result IN ('skip', 'notrun'))
+"""
+
+# Enabled and disabled tests are either added or removed, or go from notrun to
+# something else or back.
+_ENABLED = """
+    SELECT name FROM ({pair}) WHERE b_present AND
+        (NOT a_present OR (a_result = 'notrun' AND b_result != 'notrun'))
+"""
+_DISABLED = """
+    SELECT name FROM ({pair}) WHERE a_present AND
+        (NOT b_present OR (a_result != 'notrun' AND b_result = 'notrun'))
+"""
+
+# Regressions and fixes ignore tests that are not in both runs, and skip and
+# notrun on either side.
+_REGRESSIONS = """
+    SELECT name FROM ({pair}) WHERE a_total = 1 AND b_total = 1 AND
+        a_value {op} b_value
+"""
+
+
+def supported(results):
+    """Return True if the SQL summary can be used for all of results."""
+    return len(results) <= MAX_RUNS and all(
+        backend.is_sqlite(r) for r in results)
+
+
+class _Run(object):  # pylint: disable=too-few-public-methods
+    """A lightweight stand in for a TestrunResult.
+
+    Provides the name and the root totals, which is all that the console
+    summary needs.
+
+    """
+    def __init__(self, name, totals):
+        self.name = name
+        self.totals = {'root': totals}
+
+
+class SQLResults(object):
+    """A drop in replacement for common.Results using sqlite.
+
+    Each run is attached to an in memory database as run<N>.
+
+    Arguments:
+    paths -- a list of result databases or directories containing them
+
+    """
+    def __init__(self, paths):
+        assert len(paths) <= MAX_RUNS, \
+            'Only {} runs can be attached at once'.format(MAX_RUNS)
+        self._conn = sqlite3.connect(':memory:')
+        self._conn.text_factory = unicode
+        self._schemas = []
+        for i, path in enumerate(paths):
+            schema = 'run{}'.format(i)
+            self._conn.execute('ATTACH DATABASE ? AS {}'.format(schema),
+                               (backend.db_path(path), ))
+            self._schemas.append(schema)
+
+        self._conn.execute('CREATE TEMP TABLE names (name TEXT PRIMARY KEY)')
+        for schema in self._schemas:
+            self._conn.execute('INSERT OR IGNORE INTO names '
+                               'SELECT name FROM {}.statuses'.format(schema))
+
+        self._conn.execute('CREATE TEMP TABLE status ('
+                           'name TEXT PRIMARY KEY, value INTEGER, '
+                           'total INTEGER)')
+        self._conn.executemany(
+            'INSERT INTO status VALUES (?, ?, ?)',
+            ((str(s), int(s), s.fraction[1]) for s in so.ALL))
+
+        self.results = [self.__run(s, p) for s, p in zip(self._schemas, paths)]
+        self.names = SQLNames(self)
+        self.counts = Counts(self)
+
+    def __run(self, schema, path):
+        """Build a _Run for an attached database."""
+        row = self._conn.execute(
+            "SELECT value FROM {}.metadata WHERE key = 'name'".format(
+                schema)).fetchone()
+        name = json.loads(row[0]) if row else path
+
+        totals = collections.defaultdict(int)
+        for result, count in self._conn.execute(
+                'SELECT result, count(*) FROM {}.statuses '
+                'GROUP BY result'.format(schema)):
+            totals[result] = count
+        return _Run(name, totals)
+
+    def query(self, sql, *args):
+        """Run a query and return the first column of each row as a set.
+
+        sql may use {a} and {b}, which are replaced with the schemas of each
+        consecutive pair of runs, returning a list of sets, or {a} alone which
+        is replaced with the schema of each run.
+
+        """
+        if '{b}' in sql:
+            pairs = zip(self._schemas[:-1], self._schemas[1:])
+        else:
+            pairs = ((s, None) for s in self._schemas)
+        return [set(r[0] for r in self._conn.execute(
+                    sql.format(a=a, b=b), args)) for a, b in pairs]
+
+    def get_result(self, name):
+        """Get all results for a single test, NOTRUN if it is missing."""
+        results = []
+        for schema in self._schemas:
+            row = self._conn.execute(
+                'SELECT coalesce('
+                '(SELECT result FROM {0}.statuses WHERE name = ?), '
+                '(SELECT result FROM {0}.tests WHERE name = ?))'.format(
+                    schema),
+                (name, name)).fetchone()
+            results.append(so.status_lookup(row[0]) if row[0] else so.NOTRUN)
+        return results
+
+
+class SQLNames(object):
+    """Class containing names of tests for various statuses.
+
+    This has the same members and results as common.Names.
+
+    """
+    def __init__(self, tests):
+        self.__results = tests
+
+    def __diff(self, sql, **kwargs):
+        pair = _PAIR.format(a='{a}', b='{b}')
+        return [set()] + self.__results.query(
+            sql.format(pair=pair, **kwargs))
+
+    def __single(self, where, *args):
+        return self.__results.query(
+            'SELECT name FROM {{a}}.statuses WHERE {}'.format(where), *args)
+
+    @staticmethod
+    def __union(sets):
+        return set.union(*sets) if sets else set()
+
+    @lazy_property
+    def all(self):
+        """A set of all tests in all runs."""
+        return self.__union(self.__single('1'))
+
+    @lazy_property
+    def changes(self):
+        return self.__diff(_CHANGES)
+
+    @lazy_property
+    def problems(self):
+        return self.__single(
+            'result NOT IN (?, ?, ?)', str(so.PASS), str(so.SKIP),
+            str(so.NOTRUN))
+
+    @lazy_property
+    def skips(self):
+        return self.__single('result = ?', str(so.SKIP))
+
+    @lazy_property
+    def regressions(self):
+        return self.__diff(_REGRESSIONS, op='<')
+
+    @lazy_property
+    def fixes(self):
+        return self.__diff(_REGRESSIONS, op='>')
+
+    @lazy_property
+    def enabled(self):
+        return self.__diff(_ENABLED)
+
+    @lazy_property
+    def disabled(self):
+        return self.__diff(_DISABLED)
+
+    @lazy_property
+    def incomplete(self):
+        return self.__single('result = ?', str(so.INCOMPLETE))
+
+    @lazy_property
+    def all_changes(self):
+        return self.__union(self.changes[1:])
+
+    @lazy_property
+    def all_disabled(self):
+        return self.__union(self.disabled[1:])
+
+    @lazy_property
+    def all_enabled(self):
+        return self.__union(self.enabled[1:])
+
+    @lazy_property
+    def all_fixes(self):
+        return self.__union(self.fixes[1:])
+
+    @lazy_property
+    def all_regressions(self):
+        return self.__union(self.regressions[1:])
+
+    @lazy_property
+    def all_incomplete(self):
+        return self.__union(self.incomplete)
+
+    @lazy_property
+    def all_problems(self):
+        return self.__union(self.problems)
+
+    @lazy_property
+    def all_skips(self):
+        return self.__union(self.skips)
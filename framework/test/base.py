@@ -24,8 +24,11 @@
 
 from __future__ import print_function, absolute_import
 import errno
+import collections
+import gzip
 import os
 import subprocess
+import tempfile
 import time
 import sys
 import traceback
@@ -36,12 +39,13 @@ import itertools
 import abc
 import copy
 
-from framework import exceptions
+from framework import exceptions, cpuset, memory, timeouts
 from framework.core import Options
 from framework.results import TestResult
 
 
 __all__ = [
+    'OutputBuffer',
     'Test',
     'TestIsSkip',
     'TestRunError',
@@ -72,26 +76,50 @@ class ProcessTimeout(threading.Thread):
     killed if the timeout is reached and it has not completed. Wait for the
     outcome by calling the join() method from the parent.
 
+    If hang_timeout is set the process is also killed once it has been asleep
+    without using any CPU time for that many seconds, and hung is set. A
+    timeout of 0 means that only hangs are detected.
+
     """
 
-    def __init__(self, timeout, proc):
+    def __init__(self, timeout, proc, hang_timeout=0):
         threading.Thread.__init__(self)
         self.proc = proc
         self.timeout = timeout
+        self.hang_timeout = hang_timeout
+        self.hung = False
         self.status = 0
 
     def run(self):
         start_time = datetime.now()
         delta = 0
+        idle_start = None
+        last = None
 
         # poll() returns the returncode attribute, which is either the return
         # code of the child process (which could be zero), or None if the
         # process has not yet terminated.
 
-        while delta < self.timeout and self.proc.poll() is None:
+        while (not self.timeout or delta < self.timeout) and \
+                self.proc.poll() is None:
             time.sleep(1)
             delta = (datetime.now() - start_time).total_seconds()
 
+            if self.hang_timeout:
+                # A process that is sleeping (S) or waiting on the kernel (D)
+                # and hasn't used the CPU since the last sample is idle
+                sample = timeouts.cpu_time(self.proc.pid)
+                if sample is not None and last is not None and \
+                        sample[0] in 'SD' and sample[1] == last[1]:
+                    if idle_start is None:
+                        idle_start = delta
+                    elif delta - idle_start >= self.hang_timeout:
+                        self.hung = True
+                        break
+                else:
+                    idle_start = None
+                last = sample
+
         # if the test is not finished after timeout, first try to terminate it
         # and if that fails, send SIGKILL to all processes in the test's
         # process group
@@ -112,6 +140,134 @@ class ProcessTimeout(threading.Thread):
         return self.status
 
 
+class OutputBuffer(object):
+    """ Bounded capture of one output stream of a test
+
+    Lines are fed in as the test produces them. The first half of the limit
+    is kept as the head of the output, and the most recent half is kept in a
+    ring buffer as the tail. Lines that fall out of the ring buffer are
+    written to a gzip compressed spill file (if a directory for it is given),
+    so only a bounded amount of each test's output is ever held in memory or
+    embedded in the results.
+
+    Lines starting with prefix are collected in the records attribute as
+    they arrive, and the time each one arrived is put in record_times. This
+    is used for the PIGLIT: lines of native piglit tests. Unless
+    keep_records is set the records are not stored in the buffer at all.
+
+    Arguments:
+    limit -- the maximum number of bytes to keep, 0 for no limit
+
+    Keyword Arguments:
+    spill_dir -- a directory to write the omitted output to. If None the
+                 omitted output is discarded. Default: None
+    spill_name -- a prefix for the spill file name. Default: 'output'
+    prefix -- lines starting with this are put in records. Default: None
+    keep_records -- if True records are also kept in the buffer, where they
+                    show which output came before which record.
+                    Default: False
+
+    """
+    def __init__(self, limit, spill_dir=None, spill_name='output',
+                 prefix=None, keep_records=False):
+        self.records = []
+        self.record_times = []
+        self.spill = None
+        self._limit = limit
+        self._spill_dir = spill_dir
+        self._spill_name = spill_name
+        self._spill_file = None
+        self._prefix = prefix
+        self._keep_records = keep_records
+        self._head = []
+        self._head_size = 0
+        self._tail = collections.deque()
+        self._tail_size = 0
+        self._omitted = 0
+
+    def write(self, line):
+        """ Add a single line of output """
+        if self._prefix and line.startswith(self._prefix):
+            self.records.append(line.rstrip('\n'))
+            self.record_times.append(time.time())
+            if not self._keep_records:
+                return
+
+        if not self._limit:
+            self._head.append(line)
+            self._head_size += len(line)
+            return
+
+        room = self._limit // 2 - self._head_size
+        if room > 0:
+            if len(line) <= room:
+                self._head.append(line)
+                self._head_size += len(line)
+                return
+
+            # Cut a line that doesn't fit, otherwise one long line without
+            # a newline would be kept whole whatever the limit. The rest
+            # goes on to the tail like any other output.
+            self._head.append(line[:room])
+            self._head_size += room
+            line = line[room:]
+
+        self._tail.append(line)
+        self._tail_size += len(line)
+        while self._tail_size > self._limit - self._limit // 2:
+            old = self._tail.popleft()
+            self._tail_size -= len(old)
+            self._omitted += len(old)
+            self._write_spill(old)
+
+    def _write_spill(self, line):
+        """ Write a line that has been dropped from the buffer to disk """
+        if self._spill_dir is None:
+            return
+
+        if self._spill_file is None:
+            try:
+                os.makedirs(self._spill_dir)
+            except OSError as e:
+                if e.errno != errno.EEXIST:
+                    raise
+            fd, self.spill = tempfile.mkstemp(
+                prefix=self._spill_name + '.', suffix='.gz',
+                dir=self._spill_dir)
+            self._spill_file = gzip.GzipFile(fileobj=os.fdopen(fd, 'wb'),
+                                             mode='wb')
+        self._spill_file.write(line)
+
+    def close(self):
+        """ Finish the output, closing the spill file if one was opened """
+        if self._spill_file is not None:
+            fileobj = self._spill_file.fileobj
+            self._spill_file.close()
+            fileobj.close()
+            self._spill_file = None
+
+    def getvalue(self):
+        """ Return the captured output
+
+        If any output was omitted a marker line is inserted between the head
+        and the tail saying how much, and where it was written.
+
+        """
+        if not self._omitted:
+            return ''.join(itertools.chain(self._head, self._tail))
+
+        marker = '\n[piglit: {} bytes of output omitted{}]\n'.format(
+            self._omitted,
+            ', written to {}'.format(self.spill) if self.spill else '')
+        return ''.join(itertools.chain(self._head, [marker], self._tail))
+
+    def read_from(self, pipe):
+        """ Read lines from pipe until EOF """
+        for line in iter(pipe.readline, ''):
+            self.write(line)
+        pipe.close()
+
+
 def _is_crash_returncode(returncode):
     """Determine whether the given process return code correspond to a
     crash.
@@ -148,9 +304,15 @@ class Test(object):
     OPTS = Options()
     __metaclass__ = abc.ABCMeta
     __slots__ = ['run_concurrent', 'env', 'result', 'cwd', '_command',
-                 '__proc_timeout']
+                 '_records', '_record_times', '__proc_timeout']
     timeout = 0
 
+    # If set, stdout lines starting with this are collected into
+    # self._records as the test runs rather than being kept in the output
+    OUTPUT_PREFIX = None
+    # If set, the OUTPUT_PREFIX lines are also kept in the output
+    KEEP_RECORDS = False
+
     def __init__(self, command, run_concurrent=False):
         assert isinstance(command, list), command
 
@@ -159,6 +321,8 @@ class Test(object):
         self.env = {}
         self.result = TestResult()
         self.cwd = None
+        self._records = []
+        self._record_times = []
         self.__proc_timeout = None
 
     def execute(self, path, log, dmesg):
@@ -173,7 +337,7 @@ class Test(object):
         dmesg -- a dmesg.BaseDmesg derived class
 
         """
-        log.start(path)
+        log.start(path, timeout=self.timeout or None)
         # Run the test
         if self.OPTS.execute:
             try:
@@ -206,8 +370,13 @@ class Test(object):
         """
         if _is_crash_returncode(self.result.returncode):
             # check if the process was terminated by the timeout
-            if self.timeout > 0 and self.__proc_timeout.join() > 0:
+            if self.__proc_timeout is not None and \
+                    self.__proc_timeout.join() > 0:
                 self.result.result = 'timeout'
+                if self.__proc_timeout.hung:
+                    self.result.err += (
+                        '\n[piglit: killed after using no CPU time for {} '
+                        'seconds]\n'.format(self.OPTS.hang_timeout))
             else:
                 self.result.result = 'crash'
         elif self.result.returncode != 0 and self.result.result == 'pass':
@@ -259,13 +428,8 @@ class Test(object):
         if hasattr(os, 'setpgrp'):
             os.setpgrp()
 
-    def _run_command(self):
-        """ Run the test command and get the result
-
-        This method sets environment options, then runs the executable. If the
-        executable isn't found it sets the result to skip.
-
-        """
+    def _environment(self):
+        """Return the environment to run the test command in."""
         # Setup the environment for the test. Environment variables are taken
         # from the following sources, listed in order of increasing precedence:
         #
@@ -284,12 +448,29 @@ class Test(object):
                                           self.OPTS.env.iteritems(),
                                           self.env.iteritems()):
             fullenv[key] = str(value)
+        return fullenv
+
+    def _run_command(self):
+        """ Run the test command and get the result
+
+        This method sets environment options, then runs the executable. If the
+        executable isn't found it sets the result to skip.
+
+        """
+        fullenv = self._environment()
+        self.__proc_timeout = None
 
         # preexec_fn is not supported on Windows platforms
         if sys.platform == 'win32':
             preexec_fn = None
         else:
-            preexec_fn = self.__set_process_group
+            pin = cpuset.current()
+            if pin is None:
+                preexec_fn = self.__set_process_group
+            else:
+                def preexec_fn():
+                    self.__set_process_group()
+                    pin()
 
         try:
             proc = subprocess.Popen(self.command,
@@ -303,11 +484,12 @@ class Test(object):
             # process is still going after the timeout, then it will be killed
             # forcing the communicate function (which is a blocking call) to
             # return
-            if self.timeout > 0:
-                self.__proc_timeout = ProcessTimeout(self.timeout, proc)
+            if self.timeout > 0 or self.OPTS.hang_timeout:
+                self.__proc_timeout = ProcessTimeout(
+                    self.timeout, proc, self.OPTS.hang_timeout)
                 self.__proc_timeout.start()
 
-            out, err = proc.communicate()
+            out, err = self.__communicate(proc)
             returncode = proc.returncode
         except OSError as e:
             # Different sets of tests get built under different build
@@ -323,6 +505,48 @@ class Test(object):
         self.result.err = err
         self.result.returncode = returncode
 
+    def __communicate(self, proc):
+        """ Read the output of proc into bounded buffers until it exits
+
+        This replaces Popen.communicate(), which holds the whole output of
+        the test in memory. Each stream is read by its own thread as it is
+        produced, so the records are extracted incrementally and only
+        OPTS.output_limit bytes of each stream are kept. The peak RSS of the
+        process is stored in the result.
+
+        """
+        name = os.path.basename(self.command[0])
+        out = OutputBuffer(self.OPTS.output_limit, self.OPTS.output_dir,
+                           name + '.out', self.OUTPUT_PREFIX,
+                           self.KEEP_RECORDS)
+        err = OutputBuffer(self.OPTS.output_limit, self.OPTS.output_dir,
+                           name + '.err')
+
+        readers = [threading.Thread(target=b.read_from, args=(p,))
+                   for b, p in [(out, proc.stdout), (err, proc.stderr)]]
+        for reader in readers:
+            reader.daemon = True
+            reader.start()
+
+        # Only watch the process as it runs if something is waiting on it
+        report = memory.current()
+        if report is not None:
+            monitor = memory.RSSMonitor(proc.pid, report)
+            monitor.start()
+
+        for reader in readers:
+            reader.join()
+        if report is not None:
+            monitor.finish()
+        self.result.peak_rss = memory.wait(proc)
+
+        out.close()
+        err.close()
+        self._records = out.records
+        self._record_times = out.record_times
+
+        return out.getvalue(), err.getvalue()
+
     def __eq__(self, other):
         return self.command == other.command
 
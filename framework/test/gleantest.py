@@ -24,10 +24,18 @@
 
 from __future__ import print_function, absolute_import
 import os
+import time
+try:
+    import simplejson as json
+except ImportError:
+    import json
+
+from framework.results import TestResult
 from .base import Test, TestIsSkip
 from .piglit_test import TEST_BIN_DIR
 
 __all__ = [
+    'GleanBatch',
     'GleanTest',
 ]
 
@@ -47,11 +55,27 @@ class GleanTest(Test):
         super(GleanTest, self).__init__(
             [self._EXECUTABLE, "-o", "-v", "-v", "-v", "-t", "+" + name],
             **kwargs)
+        self.name = name
 
     @Test.command.getter
     def command(self):
         return super(GleanTest, self).command + self.GLOBAL_PARAMS
 
+    @property
+    def batch_key(self):
+        """Tests with the same key can be run in one process by batch()."""
+        return (type(self), tuple(sorted(self.env.iteritems())), self.cwd,
+                self.run_concurrent)
+
+    @staticmethod
+    def batch(tests):
+        """Return a GleanBatch that runs all of tests in one process."""
+        batch = GleanBatch([t.name for t in tests],
+                           run_concurrent=tests[0].run_concurrent)
+        batch.env = dict(tests[0].env)
+        batch.cwd = tests[0].cwd
+        return batch
+
     def interpret_result(self):
         if self.result.returncode != 0 or 'FAIL' in self.result.out:
             self.result.result = 'fail'
@@ -67,3 +91,132 @@ class GleanTest(Test):
                 'but the platform is "{}"'.format(
                     self.OPTS.env['PIGLIT_PLATFORM']))
         super(GleanTest, self).is_skip()
+
+
+class GleanBatch(GleanTest):
+    """ Execute several glean subtests in one process
+
+    glean is run with --batch, which shares windows and rendering contexts
+    between the tests rather than creating them for every test, and prints a
+    PIGLIT: line with the result of each test. After running, results is a
+    dictionary of test name: TestResult.
+
+    glean runs the tests in sorted order. If it dies part way through, the
+    test that was running is given the status of the process, and the tests
+    after it are run again in a new process.
+
+    """
+    OUTPUT_PREFIX = 'PIGLIT:'
+    KEEP_RECORDS = True
+
+    def __init__(self, names, **kwargs):
+        self.names = sorted(names)
+        super(GleanBatch, self).__init__(' +'.join(self.names), **kwargs)
+        self._command.insert(-2, '--batch')
+        self.results = {}
+
+    @property
+    def batch_key(self):
+        return None
+
+    def run(self):
+        merged = self.result
+        self.results = {}
+        pending = self.names
+        while pending:
+            self._command[-1] = '+' + ' +'.join(pending)
+            self.result = TestResult()
+            self._records = []
+            self._record_times = []
+            self.result.time.start = time.time()
+            super(GleanBatch, self).run()
+            self.result.time.end = time.time()
+            pending = self.__collect(pending)
+
+            for attr in ['out', 'err']:
+                value = getattr(self.result, attr)
+                if value:
+                    setattr(merged, attr, '\n'.join(
+                        x for x in [getattr(merged, attr), value] if x))
+            if merged.returncode in [None, 0]:
+                merged.returncode = self.result.returncode
+            if self.result.peak_rss:
+                merged.peak_rss = max(merged.peak_rss or 0,
+                                      self.result.peak_rss)
+            merged.result = self.result.result
+            merged.command = self.result.command
+            merged.environment = self.result.environment
+        self.result = merged
+
+    def __result(self, status, out, start=0.0, end=0.0):
+        """Return the result of one test run by the last process."""
+        result = TestResult(status)
+        result.command = self.result.command
+        result.environment = self.result.environment
+        result.returncode = self.result.returncode
+        result.peak_rss = self.result.peak_rss
+        result.out = out
+        result.err = self.result.err
+        result.time.start = start
+        result.time.end = end
+        return result
+
+    def __collect(self, pending):
+        """Store the results of the last process in results.
+
+        Each test reported by a PIGLIT: line is given the output and time
+        since the previous one. The output is split at the PIGLIT: lines
+        that are still in it, so that it stays right when the middle of the
+        output has been omitted. A test whose line was omitted has lost its
+        output and status, and is incomplete. Returns the tests that have to
+        be run again.
+
+        """
+        reported = {}
+        for record, when in zip(self._records, self._record_times):
+            line = json.loads(record[len(self.OUTPUT_PREFIX):])
+            for name in line.get('subtest', {}):
+                reported[name] = when
+
+        kept = {}
+        text = []
+        lines = []
+        for line in self.result.out.splitlines(True):
+            if line.startswith(self.OUTPUT_PREFIX):
+                try:
+                    record = json.loads(line[len(self.OUTPUT_PREFIX):])
+                except ValueError:
+                    # Cut short by the limit on the output
+                    record = None
+                if record is not None:
+                    for name, status in record.get('subtest', {}).iteritems():
+                        kept[name] = (status, ''.join(text))
+                    text = []
+                    continue
+            text.append(line)
+            lines.append(line)
+        rest = ''.join(text)
+        self.result.out = ''.join(lines)
+
+        start = self.result.time.start
+        for i, name in enumerate(pending):
+            if name in reported:
+                status, out = kept.get(name, ('incomplete', ''))
+                self.results[name] = self.__result(
+                    status, out, start, reported[name])
+                start = reported[name]
+                continue
+
+            if self.result.result == 'skip' or self.result.returncode == 0:
+                # Either nothing was run, or glean exited normally without
+                # running the rest of the tests
+                for other in pending[i:]:
+                    self.results[other] = self.__result(
+                        self.result.result, rest)
+                return []
+
+            # The process died while running this test
+            self.results[name] = self.__result(
+                self.result.result, rest, start, self.result.time.end)
+            return pending[i + 1:]
+        return []
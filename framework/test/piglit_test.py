@@ -23,7 +23,9 @@
 """ Module provides a base class for Tests """
 
 from __future__ import print_function, absolute_import
+import copy
 import os
+import subprocess
 import sys
 import glob
 try:
@@ -32,6 +34,7 @@ except ImportError:
     import json
 
 from .base import Test, WindowResizeMixin, ValgrindMixin, TestIsSkip
+from framework.results import TestResult
 import framework.core as core
 
 
@@ -59,21 +62,74 @@ class PiglitBaseTest(ValgrindMixin, Test):
     Expect one line prefixed PIGLIT: in the output, which contains a result
     dictionary. The plain output is appended to this dictionary
     """
-    def __init__(self, command, run_concurrent=True, **kwargs):
+    OUTPUT_PREFIX = 'PIGLIT:'
+
+    def __init__(self, command, run_concurrent=True, split_subtests=False,
+                 **kwargs):
         super(PiglitBaseTest, self).__init__(command, run_concurrent, **kwargs)
 
         # Prepend TEST_BIN_DIR to the path.
         self._command[0] = os.path.join(TEST_BIN_DIR, self._command[0])
 
+        # If True each subtest is run as a separate process, see
+        # list_subtests()
+        self.split_subtests = split_subtests
+
+    def list_subtests(self):
+        """Return a list of (option, name) pairs of the test's subtests.
+
+        The test is run with -list-subtests, which is handled by
+        piglit_parse_subtest_args() before a context is created. Each option
+        can be passed to the test with -subtest to run only that subtest,
+        which reports its result as name.
+
+        An empty list is returned if the test can't list its subtests.
+
+        """
+        try:
+            with open(os.devnull, 'w') as devnull:
+                out = subprocess.check_output(
+                    self._command + ['-list-subtests'],
+                    stderr=devnull,
+                    cwd=self.cwd,
+                    env=self._environment(),
+                    universal_newlines=True)
+        except (OSError, subprocess.CalledProcessError):
+            return []
+
+        subtests = []
+        for line in out.splitlines():
+            option, sep, name = line.partition(': ')
+            if not sep or not option:
+                return []
+            subtests.append((option, name))
+        return subtests
+
+    def subtest(self, option):
+        """Return a copy of the test that only runs one subtest."""
+        test = copy.copy(self)
+        test._command = self._command + ['-subtest', option]
+        test.env = dict(self.env)
+        test.result = TestResult()
+        test._records = []
+        test._record_times = []
+        test.split_subtests = False
+        return test
+
     def interpret_result(self):
-        outlines = self.result.out.split('\n')
-        outpiglit = (s[7:] for s in outlines if s.startswith('PIGLIT:'))
+        # The PIGLIT: lines are normally extracted as the output is read, but
+        # the output may also have been set directly.
+        records = self._records
+        if 'PIGLIT:' in self.result.out:
+            outlines = self.result.out.split('\n')
+            records = records + [s for s in outlines
+                                 if s.startswith('PIGLIT:')]
+            self.result.out = '\n'.join(
+                s for s in outlines if not s.startswith('PIGLIT:'))
 
         # FIXME: handle this properly. It needs a method in TestResult probably
-        for piglit in outpiglit:
-            self.result.update(json.loads(piglit))
-        self.result.out = '\n'.join(
-            s for s in outlines if not s.startswith('PIGLIT:'))
+        for piglit in records:
+            self.result.update(json.loads(piglit[7:]))
 
         super(PiglitBaseTest, self).interpret_result()
 
@@ -21,13 +21,16 @@
 """ Tests for the exectest module """
 
 from __future__ import print_function, absolute_import
+import os
+import gzip
 
 import nose.tools as nt
 from nose.plugins.attrib import attr
 
 import framework.tests.utils as utils
+from framework.core import Options
 from framework.test.base import (
-    Test, WindowResizeMixin, ValgrindMixin, TestRunError
+    Test, WindowResizeMixin, ValgrindMixin, TestRunError, OutputBuffer
 )
 from framework.tests.status_tests import PROBLEMS, STATUSES
 
@@ -75,6 +78,24 @@ def test_timeout():
     nt.eq_(test.result.result, 'timeout')
 
 
+@attr('slow')
+def test_hang_timeout():
+    """test.base.Test.run(): kills tests that stop using the CPU"""
+    utils.platform_check('linux')
+    utils.binary_check('sleep', 1)
+
+    class _Test(Test):
+        OPTS = Options(hang_timeout=2)
+
+        def interpret_result(self):
+            super(_Test, self).interpret_result()
+
+    test = _Test(['sleep', '60'])
+    test.run()
+    nt.eq_(test.result.result, 'timeout')
+    nt.ok_('no CPU time' in test.result.err)
+
+
 @attr('slow')
 def test_timeout_pass():
     """test.base.Test.run(): Result is returned when timeout is set but not exceeded
@@ -245,3 +266,76 @@ class TestValgrindMixinRun(object):
         test.result.returncode = 1
         test.run()
         nt.eq_(test.result.result, 'fail')
+
+
+def test_outputbuffer_unlimited():
+    """test.base.OutputBuffer: keeps everything when there is no limit"""
+    buf = OutputBuffer(0)
+    for i in xrange(100):
+        buf.write('line {}\n'.format(i))
+    nt.eq_(buf.getvalue(),
+           ''.join('line {}\n'.format(i) for i in xrange(100)))
+
+
+def test_outputbuffer_prefix():
+    """test.base.OutputBuffer: lines with the prefix are put in records"""
+    buf = OutputBuffer(0, prefix='PIGLIT:')
+    buf.write('foo\n')
+    buf.write('PIGLIT: {"result": "pass"}\n')
+    buf.write('bar\n')
+    nt.eq_(buf.records, ['PIGLIT: {"result": "pass"}'])
+    nt.eq_(buf.getvalue(), 'foo\nbar\n')
+
+
+def test_outputbuffer_limit():
+    """test.base.OutputBuffer: keeps the head and the tail within the limit"""
+    buf = OutputBuffer(20)
+    for i in xrange(100):
+        buf.write('{:04}\n'.format(i))
+    value = buf.getvalue()
+
+    nt.ok_(value.startswith('0000\n0001\n'))
+    nt.ok_(value.endswith('0098\n0099\n'))
+    nt.assert_in('bytes of output omitted', value)
+    nt.assert_not_in('0050\n', value)
+
+
+def test_outputbuffer_long_line():
+    """test.base.OutputBuffer: a single long line is cut to the limit"""
+    buf = OutputBuffer(20)
+    buf.write('x' * 10000)
+    value = buf.getvalue()
+
+    nt.ok_(value.startswith('x' * 10 + '\n['))
+    nt.assert_in('9990 bytes of output omitted', value)
+    nt.ok_(len(value) < 100)
+
+
+def test_outputbuffer_spill():
+    """test.base.OutputBuffer: omitted output is written to the spill file"""
+    with utils.tempdir() as tdir:
+        buf = OutputBuffer(20, spill_dir=os.path.join(tdir, 'output'))
+        for i in xrange(100):
+            buf.write('{:04}\n'.format(i))
+        buf.close()
+
+        nt.ok_(buf.spill.startswith(os.path.join(tdir, 'output')))
+        nt.assert_in(buf.spill, buf.getvalue())
+        with gzip.open(buf.spill, 'rb') as f:
+            spilled = f.read()
+
+    nt.ok_(spilled.startswith('0002\n'))
+    nt.assert_in('0050\n', spilled)
+
+
+def test_run_command_records():
+    """test.base.Test._run_command(): collects OUTPUT_PREFIX lines"""
+    utils.binary_check('printf')
+
+    class Test_(TestTest):
+        OUTPUT_PREFIX = 'PIGLIT:'
+
+    test = Test_(['printf', 'foo\\nPIGLIT: {}\\nbar\\n'])
+    test.run()
+    nt.eq_(test._records, ['PIGLIT: {}'])
+    nt.eq_(test.result.out, 'foo\nbar\n')
@@ -0,0 +1,116 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.cpuset"""
+
+# pylint: disable=protected-access,invalid-name,missing-docstring
+
+from __future__ import absolute_import, division, print_function
+import threading
+
+import mock
+import nose.tools as nt
+
+from framework import cpuset
+
+
+def test_parse_cpulist():
+    """cpuset.parse_cpulist(): parses ranges and single CPUs"""
+    nt.eq_(cpuset.parse_cpulist('0-3,8,10-11\n'), [0, 1, 2, 3, 8, 10, 11])
+
+
+def test_pool_size():
+    """cpuset.pool_size(): divides the budget by the threads per test"""
+    nt.eq_(cpuset.pool_size(4, 32), 8)
+
+
+def test_pool_size_zero_threads():
+    """cpuset.pool_size(): a test with no extra threads still costs one"""
+    nt.eq_(cpuset.pool_size(0, 8), 8)
+
+
+def test_pool_size_minimum():
+    """cpuset.pool_size(): runs at least one test"""
+    nt.eq_(cpuset.pool_size(16, 4), 1)
+
+
+class TestPartition(object):
+    @classmethod
+    def setup_class(cls):
+        with mock.patch('framework.cpuset.numa_nodes',
+                        mock.Mock(return_value=[[0, 1, 2, 3, 4],
+                                                [5, 6, 7, 8, 9]])):
+            cls.sets = cpuset.partition(5, 2)
+
+    def test_size(self):
+        """cpuset.partition(): each set has threads_per_test CPUs"""
+        nt.ok_(all(len(s) == 2 for s in self.sets))
+
+    def test_nodes(self):
+        """cpuset.partition(): sets don't cross NUMA nodes"""
+        nt.eq_(self.sets[:4], [[0, 1], [2, 3], [5, 6], [7, 8]])
+
+    def test_wrap(self):
+        """cpuset.partition(): sets are shared when there are too few"""
+        nt.eq_(self.sets[4], [0, 1])
+
+
+def test_partition_too_small():
+    """cpuset.partition(): falls back to all CPUs if no node is big enough"""
+    with mock.patch('framework.cpuset.numa_nodes',
+                    mock.Mock(return_value=[[0, 1], [2, 3]])):
+        with mock.patch('framework.cpuset.online_cpus',
+                        mock.Mock(return_value=[0, 1, 2, 3])):
+            nt.eq_(cpuset.partition(2, 3), [[0, 1, 2, 3], [0, 1, 2, 3]])
+
+
+def test_set_affinity_mask():
+    """cpuset.set_affinity(): builds a mask of the CPUs"""
+    libc = mock.Mock()
+    libc.sched_setaffinity = mock.Mock(return_value=0)
+    nt.ok_(cpuset.set_affinity([0, 3], libc))
+    mask = libc.sched_setaffinity.call_args_list[0][0][2]
+    nt.eq_(mask[0], 0b1001)
+
+
+def test_worker_cpus():
+    """cpuset.WorkerCPUs.assign(): gives each thread its own CPUs"""
+    with mock.patch('framework.cpuset.numa_nodes',
+                    mock.Mock(return_value=[[0, 1, 2, 3]])):
+        workers = cpuset.WorkerCPUs(2, 2)
+
+    got = []
+
+    def worker():
+        workers.assign()
+        got.append(cpuset._WORKER.cpus)
+
+    threads = [threading.Thread(target=worker) for _ in range(2)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    nt.eq_(sorted(got), [[0, 1], [2, 3]])
+
+
+def test_current_unassigned():
+    """cpuset.current(): is None for a thread without CPUs"""
+    nt.eq_(cpuset.current(), None)
@@ -29,7 +29,11 @@ from __future__ import print_function, absolute_import
 import os
 import subprocess
 import re
+import threading
+import errno
+import contextlib
 
+import mock
 import nose.tools as nt
 from nose.plugins.skip import SkipTest
 from nose.plugins.attrib import attr
@@ -73,7 +77,7 @@ class DummyLog(object):
     def __init__(self):
         pass
 
-    def start(self, *args):
+    def start(self, *args, **kwargs):
         return None
 
     def log(self, *args):
@@ -89,6 +93,30 @@ class TestDmesg(dmesg.BaseDmesg):
         pass
 
 
+@contextlib.contextmanager
+def _kmsg_fifo():
+    """ Yield a KmsgDmesg reading from a fifo, and a function to write to it
+
+    The writer end is kept open until the context manager exits so that the
+    reader thread never sees EOF.
+
+    """
+    with utils.tempdir() as tdir:
+        fifo = os.path.join(tdir, 'kmsg')
+        os.mkfifo(fifo)
+        kmsg = dmesg.KmsgDmesg(fifo)
+        fd = os.open(fifo, os.O_WRONLY)
+
+        def write(record):
+            os.write(fd, record + '\n')
+
+        try:
+            yield kmsg, write
+        finally:
+            kmsg.close()
+            os.close(fd)
+
+
 # Tests
 @utils.no_error
 def test_linux_initialization():
@@ -115,9 +143,10 @@ def test_get_dmesg_linux():
     """
     utils.platform_check('linux')
     posix = _get_dmesg()
-    nt.assert_is(type(posix), dmesg.LinuxDmesg,
-                 msg=("Error: get_dmesg should have returned LinuxDmesg, "
-                      "but it actually returned {}".format(type(posix))))
+    nt.assert_in(type(posix), (dmesg.LinuxDmesg, dmesg.KmsgDmesg),
+                 msg=("Error: get_dmesg should have returned LinuxDmesg or "
+                      "KmsgDmesg, but it actually returned {}".format(
+                          type(posix))))
 
 
 @attr('privileged')
@@ -337,6 +366,111 @@ def test_update_result_add_dmesg():
            msg="result does not have dmesg member but should")
 
 
+def test_kmsg_parse_record():
+    """dmesg.KmsgDmesg._parse_record: parses a record"""
+    nt.eq_(dmesg.KmsgDmesg._parse_record('6,12,5000001,-;a message'),
+           (12, 6, '[    5.000001] a message'))
+
+
+def test_kmsg_parse_record_facility():
+    """dmesg.KmsgDmesg._parse_record: level ignores the facility"""
+    nt.eq_(dmesg.KmsgDmesg._parse_record('30,1,0,-;a message')[1], 6)
+
+
+def test_kmsg_parse_record_malformed():
+    """dmesg.KmsgDmesg._parse_record: returns None for malformed records"""
+    nt.eq_(dmesg.KmsgDmesg._parse_record('not a record'), None)
+
+
+def test_kmsg_available_restricted():
+    """dmesg._kmsg_available: False if the device can't be opened
+
+    With kernel.dmesg_restrict set /dev/kmsg is world readable, but opening it
+    fails with EPERM.
+
+    """
+    def deny(*args):
+        raise OSError(errno.EPERM, 'Operation not permitted')
+
+    with mock.patch('framework.dmesg.os.access', mock.Mock(return_value=True)):
+        with mock.patch('framework.dmesg.os.open', deny):
+            nt.eq_(dmesg._kmsg_available(), False)
+
+
+def test_kmsg_close():
+    """dmesg.KmsgDmesg.close: stops the reader thread"""
+    with _kmsg_fifo() as (kmsg, _):
+        thread = kmsg._thread
+        kmsg.close()
+        nt.ok_(not thread.is_alive())
+
+
+def test_kmsg_update_result():
+    """dmesg.KmsgDmesg.update_result: messages during a test are attributed"""
+    with _kmsg_fifo() as (kmsg, write):
+        result = framework.results.TestResult('pass')
+        kmsg.update_dmesg()
+        write('3,1,100,-;something broke')
+        result = kmsg.update_result(result)
+
+    nt.eq_(result.result, 'dmesg-warn')
+    nt.eq_(result.dmesg, '[    0.000100] something broke')
+
+
+def test_kmsg_update_result_before():
+    """dmesg.KmsgDmesg.update_result: messages before a test are ignored"""
+    with _kmsg_fifo() as (kmsg, write):
+        result = framework.results.TestResult('pass')
+        write('3,1,100,-;something broke')
+        kmsg.update_dmesg()
+        result = kmsg.update_result(result)
+
+    nt.eq_(result.result, 'pass')
+
+
+def test_kmsg_update_result_level():
+    """dmesg.KmsgDmesg.update_result: info and debug messages are ignored"""
+    with _kmsg_fifo() as (kmsg, write):
+        result = framework.results.TestResult('pass')
+        kmsg.update_dmesg()
+        write('6,1,100,-;just some info')
+        write(' SUBSYSTEM=foo')
+        write('7,2,101,-;debugging')
+        result = kmsg.update_result(result)
+
+    nt.eq_(result.result, 'pass')
+
+
+def test_kmsg_concurrent():
+    """dmesg.KmsgDmesg.update_result: messages go to all running tests"""
+    first = framework.results.TestResult('pass')
+    second = framework.results.TestResult('pass')
+    started = threading.Event()
+    written = threading.Event()
+
+    def run_second(kmsg):
+        kmsg.update_dmesg()
+        started.set()
+        written.wait()
+        kmsg.update_result(second)
+
+    with _kmsg_fifo() as (kmsg, write):
+        kmsg.update_dmesg()
+        write('3,1,100,-;first')
+
+        thread = threading.Thread(target=run_second, args=(kmsg,))
+        thread.start()
+        started.wait()
+
+        write('3,2,200,-;second')
+        kmsg.update_result(first)
+        written.set()
+        thread.join()
+
+    nt.eq_(first.dmesg, '[    0.000100] first\n[    0.000200] second')
+    nt.eq_(second.dmesg, '[    0.000200] second')
+
+
 @attr('privileged')
 def test_execute_dmesg():
     """test.base.Test.execute: dmesg statuses are applied
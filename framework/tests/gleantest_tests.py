@@ -21,10 +21,13 @@
 """ Tests for the glean class. Requires Nose """
 
 from __future__ import print_function, absolute_import
+import os
+import stat
 
+import mock
 import nose.tools as nt
 
-from framework.test import GleanTest
+from framework.test import GleanTest, GleanBatch
 from framework.tests import utils
 from framework.test.base import TestIsSkip
 
@@ -101,3 +104,103 @@ def test_crash():
     test.interpret_result()
 
     nt.eq_(test.result.result, 'crash')
+
+
+def test_batch_command():
+    """test.gleantest.GleanTest.batch(): runs all of the tests with --batch"""
+    test = GleanTest.batch([GleanTest('foo'), GleanTest('bar')])
+    nt.ok_('--batch' in test.command)
+    nt.ok_('+bar +foo' in test.command)
+
+
+# Reports each test, but dies while running the test named b
+_FAKE_GLEAN = """#!/bin/sh
+while [ "$1" != "-t" ]; do shift; done
+for t in $2; do
+    t=${t#+}
+    echo "running $t"
+    if [ "$t" = "b" ]; then kill -SEGV $$; fi
+    echo "PIGLIT: {\\"subtest\\": {\\"$t\\": \\"pass\\"}}"
+done
+"""
+
+
+class TestGleanBatchRun(object):
+    """Tests for GleanBatch.run() with a fake glean."""
+    @classmethod
+    def setup_class(cls):
+        utils.platform_check('linux')
+        GleanTest.OPTS.env['PIGLIT_PLATFORM'] = 'glx'
+        with utils.tempdir() as tdir:
+            glean = os.path.join(tdir, 'glean')
+            with open(glean, 'w') as f:
+                f.write(_FAKE_GLEAN)
+            os.chmod(glean, stat.S_IRWXU)
+
+            with mock.patch.object(GleanTest, '_EXECUTABLE', glean):
+                cls.test = GleanBatch(['c', 'a', 'b'])
+            cls.test.run()
+
+    def test_pass(self):
+        """test.gleantest.GleanBatch.run(): reports each test's result"""
+        nt.eq_(self.test.results['a'].result, 'pass')
+
+    def test_out(self):
+        """test.gleantest.GleanBatch.run(): splits the output between tests"""
+        nt.eq_(self.test.results['a'].out, 'running a\n')
+
+    def test_crash(self):
+        """test.gleantest.GleanBatch.run(): the running test gets the crash"""
+        nt.eq_(self.test.results['b'].result, 'crash')
+
+    def test_rerun(self):
+        """test.gleantest.GleanBatch.run(): reruns tests after a crash"""
+        nt.eq_(self.test.results['c'].result, 'pass')
+
+
+# Reports each test, with enough output after all but the last that the
+# PIGLIT: line of b falls in the part of the output that is omitted
+_NOISY_GLEAN = """#!/bin/sh
+while [ "$1" != "-t" ]; do shift; done
+for t in $2; do
+    t=${t#+}
+    echo "running $t"
+    echo "PIGLIT: {\\"subtest\\": {\\"$t\\": \\"pass\\"}}"
+    if [ "$t" != "c" ]; then
+        i=0
+        while [ $i -lt 200 ]; do echo noise; i=$((i + 1)); done
+    fi
+done
+"""
+
+
+class TestGleanBatchOutputLimit(object):
+    """Tests for GleanBatch.run() when output is omitted."""
+    @classmethod
+    def setup_class(cls):
+        utils.platform_check('linux')
+        GleanTest.OPTS.env['PIGLIT_PLATFORM'] = 'glx'
+        with utils.tempdir() as tdir:
+            glean = os.path.join(tdir, 'glean')
+            with open(glean, 'w') as f:
+                f.write(_NOISY_GLEAN)
+            os.chmod(glean, stat.S_IRWXU)
+
+            with mock.patch.object(GleanTest, '_EXECUTABLE', glean):
+                cls.test = GleanBatch(['a', 'b', 'c'])
+            with mock.patch.object(GleanTest.OPTS, 'output_limit', 200):
+                cls.test.run()
+
+    def test_out(self):
+        """test.gleantest.GleanBatch.run(): splits truncated output"""
+        nt.eq_(self.test.results['a'].out, 'running a\n')
+
+    def test_omitted(self):
+        """test.gleantest.GleanBatch.run(): omitted tests are incomplete"""
+        nt.eq_(self.test.results['b'].result, 'incomplete')
+
+    def test_after(self):
+        """test.gleantest.GleanBatch.run(): tests after omitted output are kept
+        """
+        nt.eq_(self.test.results['c'].result, 'pass')
+        nt.ok_(self.test.results['c'].out.endswith('noise\nrunning c\n'))
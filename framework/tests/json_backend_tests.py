@@ -320,3 +320,22 @@ def test_load_bad_json():
     with utils.tempfile('{"bad json": }') as f:
         with open(f, 'r') as tfile:
             backends.json._load(tfile)
+
+
+def test_load_blobs():
+    """backends.json._load: expands references to the blob table"""
+    env = u'PIGLIT_PLATFORM="gbm" ' * 10
+    run = results.TestrunResult()
+    for name in ['a', 'b']:
+        test = results.TestResult('pass')
+        test.environment = env
+        run.tests[name] = test
+    run.results_version = backends.json.CURRENT_JSON_VERSION
+
+    with utils.tempfile(
+            json.dumps(run, default=backends.json.piglit_encoder)) as t:
+        with open(t, 'r') as f:
+            test = backends.json._load(f)
+
+    nt.eq_(test.tests['a'].environment, env)
+    nt.eq_(test.tests['b'].environment, env)
@@ -817,3 +817,53 @@ class TestV7toV8(object):
         """backends.json.update_results (7 -> 8): total time is stored as start and end"""
         nt.eq_(self.result.time_elapsed.start, 0.0)
         nt.eq_(self.result.time_elapsed.end, 1.2)
+
+
+class TestV8toV9(object):
+    DATA = {
+        "results_version": 8,
+        "name": "test",
+        "options": {
+            "profile": ['quick'],
+            "dmesg": False,
+            "verbose": False,
+            "platform": "gbm",
+            "sync": False,
+            "valgrind": False,
+            "filter": [],
+            "concurrent": "all",
+            "test_count": 0,
+            "exclude_tests": [],
+            "exclude_filter": [],
+            "env": {
+                "lspci": "stuff",
+                "uname": "more stuff",
+                "glxinfo": "and stuff",
+                "wglinfo": "stuff"
+            }
+        },
+        "tests": {
+            'a@test': results.TestResult('pass'),
+        },
+        "time_elapsed": results.TimeAttribute(end=1.2),
+    }
+
+    @classmethod
+    def setup_class(cls):
+        """Class setup. Create a TestrunResult with v8 data."""
+        cls.DATA['tests']['a@test'] = cls.DATA['tests']['a@test'].to_json()
+        cls.DATA['tests']['a@test']['environment'] = 'x' * 100
+
+        with utils.tempfile(
+                json.dumps(cls.DATA, default=backends.json.piglit_encoder)) as t:
+            with open(t, 'r') as f:
+                cls.result = backends.json._update_eight_to_nine(
+                    backends.json._load(f))
+
+    def test_version(self):
+        """backends.json.update_results (8 -> 9): results_version is 9"""
+        nt.eq_(self.result.results_version, 9)
+
+    def test_inline_strings(self):
+        """backends.json.update_results (8 -> 9): inline strings are kept"""
+        nt.eq_(self.result.tests['a@test'].environment, 'x' * 100)
@@ -29,6 +29,7 @@ try:
     from lxml import etree
 except ImportError:
     import xml.etree.cElementTree as etree
+import mock
 import nose.tools as nt
 from nose.plugins.skip import SkipTest
 
@@ -150,6 +151,16 @@ class TestJUnitMultiTest(TestJUnitSingleTest):
         """backends.junit.JUnitBackend.write_test(): (twice) produces valid xml"""
         super(TestJUnitMultiTest, self).test_xml_valid()
 
+    def test_tests_count(self):
+        """backends.junit.JUnitBackend.finalize(): sets the tests attribute"""
+        suite = etree.parse(self.test_file).getroot().find('testsuite')
+        nt.eq_(suite.attrib['tests'], '2')
+
+    def test_testcase_count(self):
+        """backends.junit.JUnitBackend.finalize(): writes every testcase"""
+        suite = etree.parse(self.test_file).getroot().find('testsuite')
+        nt.eq_(len(suite.findall('testcase')), 2)
+
 
 @doc_formatter
 def test_junit_replace():
@@ -195,6 +206,32 @@ def test_junit_skips_bad_tests():
         test.finalize()
 
 
+def test_junit_skips_bad_tests_count():
+    """backends.junit.JUnitBackend: illformed tests are not counted"""
+    with utils.tempdir() as tdir:
+        result = results.TestResult()
+        result.time.end = 1.2345
+        result.result = 'pass'
+        result.out = 'this is stdout'
+        result.err = 'this is stderr'
+        result.command = 'foo'
+
+        test = backends.junit.JUnitBackend(tdir)
+        test.initialize(BACKEND_INITIAL_META)
+        with test.write_test(grouptools.join('a', 'test', 'group', 'test1')) as t:
+            t(result)
+        with open(os.path.join(tdir, 'tests', '1.xml'), 'w') as f:
+            f.write('<testcase name="bad"')
+
+        test.finalize()
+
+        suite = etree.parse(os.path.join(tdir, 'results.xml')).getroot()
+        suite = suite.find('testsuite')
+
+    nt.eq_(suite.attrib['tests'], '1')
+    nt.eq_(len(suite.findall('testcase')), 1)
+
+
 class TestJUnitLoad(utils.StaticDirectory):
     """Methods that test loading JUnit results."""
     __instance = None
@@ -282,6 +319,49 @@ class TestJUnitLoad(utils.StaticDirectory):
         backends.junit.REGISTRY.load(self.tdir, 'none')
 
 
+def test_load_only_piglit_suite():
+    """backends.junit._load: only loads tests from the piglit testsuite"""
+    with utils.tempdir() as tdir:
+        filename = os.path.join(tdir, 'results.xml')
+        with open(filename, 'w') as f:
+            f.write(_XML.replace(
+                '  </testsuites>',
+                '    <testsuite name="other" tests="1">\n'
+                '      <testcase classname="other.foo" name="b-test" '
+                'status="pass" time="1.0">\n'
+                '        <system-out>cmd\nout</system-out>\n'
+                '        <system-err>err</system-err>\n'
+                '      </testcase>\n'
+                '    </testsuite>\n'
+                '  </testsuites>'))
+
+        test = backends.junit.REGISTRY.load(filename, 'none')
+
+    nt.eq_(test.tests.keys(), [grouptools.join('foo', 'bar', 'a-test')])
+
+
+def test_load_discards_tests():
+    """backends.junit._load: tests are removed from the tree once loaded"""
+    parsed = []
+    iterparse = etree.iterparse
+
+    def capture(*args, **kwargs):
+        for event, elem in iterparse(*args, **kwargs):
+            if not parsed:
+                parsed.append(elem)
+            yield event, elem
+
+    with utils.tempdir() as tdir:
+        filename = os.path.join(tdir, 'results.xml')
+        with open(filename, 'w') as f:
+            f.write(_XML)
+
+        with mock.patch('framework.backends.junit.etree.iterparse', capture):
+            backends.junit.REGISTRY.load(filename, 'none')
+
+    nt.eq_(len(parsed[0]), 0)
+
+
 def test_load_file_name():
     """backends.junit._load: uses the filename for name if filename != 'results'
     """
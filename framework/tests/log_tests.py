@@ -167,3 +167,80 @@ def test_noprint_when_expected():
     for name, func, args in printing:
         check_no_output.description = "log.{}: produces no output".format(name)
         yield check_no_output, func, args
+
+
+def test_telemetry_finish():
+    """log.Telemetry.finish(): updates counts and results"""
+    telemetry = log.Telemetry(10, 2)
+    telemetry.start(0, 'a test')
+    telemetry.finish(0, 'pass')
+    snapshot = telemetry.snapshot()
+
+    nt.eq_(snapshot['complete'], 1)
+    nt.eq_(snapshot['results'], {'pass': 1})
+    nt.eq_(snapshot['durations']['count'], 1)
+
+
+def test_telemetry_running():
+    """log.Telemetry.snapshot(): reports running tests and queue depth"""
+    telemetry = log.Telemetry(10, 4)
+    telemetry.start(0, 'a test')
+    telemetry.start(1, 'another test')
+    snapshot = telemetry.snapshot()
+
+    nt.eq_(set(t['name'] for t in snapshot['running']),
+           set(['a test', 'another test']))
+    nt.eq_(snapshot['queued'], 8)
+    nt.eq_(snapshot['utilization'], 0.5)
+
+
+def test_telemetry_nearest_timeout():
+    """log.Telemetry.snapshot(): only tests with a timeout are listed"""
+    telemetry = log.Telemetry(10, 4)
+    telemetry.start(0, 'a test', 60)
+    telemetry.start(1, 'another test', 10)
+    telemetry.start(2, 'no timeout')
+    snapshot = telemetry.snapshot()
+
+    nt.eq_([t['name'] for t in snapshot['nearest_timeout']],
+           ['another test', 'a test'])
+
+
+def test_telemetry_histogram_cumulative():
+    """log.Telemetry.snapshot(): histogram buckets are cumulative"""
+    telemetry = log.Telemetry(10, 4)
+    for i in range(3):
+        telemetry.start(i, 'test')
+        telemetry.finish(i, 'pass')
+    buckets = telemetry.snapshot()['durations']['buckets']
+
+    nt.eq_(buckets[-1], ['+Inf', 3])
+    nt.eq_([c for _, c in buckets], sorted(c for _, c in buckets))
+
+
+def test_telemetry_prometheus():
+    """log.Telemetry.to_prometheus(): produces valid exposition lines"""
+    telemetry = log.Telemetry(10, 4)
+    telemetry.start(0, 'a "quoted" test')
+    telemetry.start(1, 'test')
+    telemetry.finish(1, 'pass')
+    text = log.Telemetry.to_prometheus(telemetry.snapshot())
+
+    nt.assert_in('piglit_tests 10\n', text)
+    nt.assert_in('piglit_tests_complete_total 1\n', text)
+    nt.assert_in('piglit_results_total{status="pass"} 1\n', text)
+    nt.assert_in('{name="a \\"quoted\\" test"}', text)
+    nt.assert_in('piglit_test_duration_seconds_bucket{le="+Inf"} 1\n', text)
+
+
+def test_httplog_updates_telemetry():
+    """log.HTTPLog: start() and log() update the telemetry"""
+    state = {'total': 1, 'complete': 0, 'running': [],
+             'summary': collections.defaultdict(lambda: 0),
+             'telemetry': log.Telemetry(1, 1)}
+    log_inst = log.HTTPLog(state, threading.Lock())
+    log_inst.start('a test')
+    nt.eq_(state['telemetry'].snapshot()['running_count'], 1)
+
+    log_inst.log('pass')
+    nt.eq_(state['telemetry'].snapshot()['complete'], 1)
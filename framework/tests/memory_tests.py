@@ -0,0 +1,142 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.memory"""
+
+# pylint: disable=protected-access,invalid-name,missing-docstring
+
+from __future__ import absolute_import, division, print_function
+import subprocess
+import sys
+import threading
+import time
+
+import nose.tools as nt
+
+from framework import memory, results
+from . import utils
+
+
+def test_parse_size():
+    """memory.parse_size(): converts units to KiB"""
+    nt.eq_(memory.parse_size('512M'), 512 * 1024)
+
+
+def test_parse_size_plain():
+    """memory.parse_size(): a plain number is KiB"""
+    nt.eq_(memory.parse_size('2048'), 2048)
+
+
+def test_parse_size_suffix():
+    """memory.parse_size(): accepts GiB style suffixes"""
+    nt.eq_(memory.parse_size('2GiB'), 2 * 1024 ** 2)
+
+
+@nt.raises(ValueError)
+def test_parse_size_invalid():
+    """memory.parse_size(): raises ValueError for junk"""
+    memory.parse_size('lots')
+
+
+def test_wait():
+    """memory.wait(): sets the returncode"""
+    proc = subprocess.Popen([sys.executable, '-c', 'exit(3)'])
+    memory.wait(proc)
+    nt.eq_(proc.returncode, 3)
+
+
+def test_wait_peak():
+    """memory.wait(): returns the peak RSS of the process"""
+    utils.platform_check('linux')
+    proc = subprocess.Popen(
+        [sys.executable, '-c', 'x = bytearray(64 * 1024 * 1024)'])
+    nt.ok_(memory.wait(proc) >= 64 * 1024)
+
+
+def test_estimates():
+    """memory.estimates(): only includes tests with a peak"""
+    run = results.TestrunResult()
+    run.tests['a'] = results.TestResult('pass')
+    run.tests['a'].peak_rss = 100
+    run.tests['b'] = results.TestResult('pass')
+    nt.eq_(memory.estimates(run), {'a': 100})
+
+
+def test_estimate_like():
+    """memory.MemoryBudget.estimate(): falls back to like"""
+    budget = memory.MemoryBudget(100, {'a': 10})
+    nt.eq_(budget.estimate('a/sub', like='a'), 10)
+
+
+def test_update():
+    """memory.MemoryBudget.update(): grows the reservation of a test"""
+    budget = memory.MemoryBudget(100, {'a': 10})
+    with budget.admit('a'):
+        memory.current()(30)
+        nt.eq_(budget.reserved, 30)
+
+
+def test_current_unlimited():
+    """memory.current(): is None without a budget"""
+    budget = memory.MemoryBudget(None)
+    with budget.admit('a'):
+        nt.eq_(memory.current(), None)
+
+
+def test_admit_alone():
+    """memory.MemoryBudget.admit(): runs a test over the budget alone"""
+    budget = memory.MemoryBudget(100, {'a': 1000})
+    with budget.admit('a'):
+        nt.eq_(budget.reserved, 1000)
+
+
+class TestAdmitWaits(object):
+    """A test that doesn't fit waits for the running tests to finish."""
+    @classmethod
+    def setup_class(cls):
+        budget = memory.MemoryBudget(100, {'a': 60, 'b': 60, 'c': 30})
+        cls.order = []
+        release = threading.Event()
+
+        def run(name):
+            with budget.admit(name):
+                cls.order.append(name)
+                if name == 'a':
+                    release.wait()
+
+        threads = {n: threading.Thread(target=run, args=(n, ))
+                   for n in 'abc'}
+        threads['a'].start()
+        while budget.reserved < 60:
+            time.sleep(0.01)
+        threads['b'].start()
+        threads['c'].start()
+        threads['c'].join()
+        release.set()
+        for thread in threads.itervalues():
+            thread.join()
+
+    def test_fits(self):
+        """memory.MemoryBudget.admit(): runs a test that fits"""
+        nt.eq_(self.order[:2], ['a', 'c'])
+
+    def test_waits(self):
+        """memory.MemoryBudget.admit(): waits for room for a test"""
+        nt.eq_(self.order[2], 'b')
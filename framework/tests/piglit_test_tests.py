@@ -22,6 +22,7 @@
 
 from __future__ import print_function, absolute_import
 
+import mock
 import nose.tools as nt
 
 from framework.tests import utils
@@ -126,3 +127,36 @@ def test_PiglitGLTest_platform_not_in_exclude():
     PiglitGLTest.OPTS.env['PIGLIT_PLATFORM'] = 'gbm'
     test = PiglitGLTest(['foo'], exclude_platforms=['glx'])
     test.is_skip()
+
+
+def test_PiglitBaseTest_list_subtests():
+    """test.piglit_test.PiglitBaseTest.list_subtests(): parses the list"""
+    test = PiglitBaseTest(['foo'])
+    with mock.patch('framework.test.piglit_test.subprocess.check_output',
+                    mock.Mock(return_value='ldr: LDR Profile\nhdr: HDR\n')):
+        nt.eq_(test.list_subtests(), [('ldr', 'LDR Profile'), ('hdr', 'HDR')])
+
+
+def test_PiglitBaseTest_list_subtests_fails():
+    """test.piglit_test.PiglitBaseTest.list_subtests(): empty if the test fails"""
+    test = PiglitBaseTest(['foo'])
+    with mock.patch('framework.test.piglit_test.subprocess.check_output',
+                    mock.Mock(side_effect=OSError)):
+        nt.eq_(test.list_subtests(), [])
+
+
+def test_PiglitBaseTest_list_subtests_garbage():
+    """test.piglit_test.PiglitBaseTest.list_subtests(): empty if the output isn't a list"""
+    test = PiglitBaseTest(['foo'])
+    with mock.patch('framework.test.piglit_test.subprocess.check_output',
+                    mock.Mock(return_value='Running the test\n')):
+        nt.eq_(test.list_subtests(), [])
+
+
+def test_PiglitBaseTest_subtest():
+    """test.piglit_test.PiglitBaseTest.subtest(): runs only that subtest"""
+    test = PiglitBaseTest(['foo'], split_subtests=True)
+    sub = test.subtest('ldr')
+    nt.eq_(sub.command[-2:], ['-subtest', 'ldr'])
+    nt.assert_not_in('-subtest', test.command)
+    nt.assert_is_not(sub.result, test.result)
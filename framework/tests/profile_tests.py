@@ -24,11 +24,13 @@ from __future__ import print_function, absolute_import
 import sys
 import copy
 
+import mock
 import nose.tools as nt
 
 from framework.tests import utils
-from framework import grouptools, core, dmesg, profile, exceptions
-from framework.test import GleanTest
+from framework import (grouptools, core, dmesg, profile, exceptions, results,
+                       memory)
+from framework.test import GleanTest, PiglitGLTest
 
 # Don't print sys.stderr to the console
 sys.stderr = sys.stdout
@@ -75,7 +77,7 @@ def test_testprofile_set_dmesg_true():
     utils.platform_check('linux')
     profile_ = profile.TestProfile()
     profile_.dmesg = True
-    nt.ok_(isinstance(profile_.dmesg, dmesg.LinuxDmesg))
+    nt.ok_(isinstance(profile_.dmesg, (dmesg.LinuxDmesg, dmesg.KmsgDmesg)))
 
 
 def test_testprofile_set_dmesg_false():
@@ -87,6 +89,14 @@ def test_testprofile_set_dmesg_false():
     nt.ok_(isinstance(profile_.dmesg, dmesg.DummyDmesg))
 
 
+def test_testprofile_set_dmesg_closes():
+    """profile.TestProfile: setting Dmesg closes the previous one"""
+    profile_ = profile.TestProfile()
+    old = profile_._dmesg = mock.Mock()
+    profile_.dmesg = False
+    old.close.assert_called_once_with()
+
+
 def test_testprofile_update_test_list():
     """profile.TestProfile.update(): updates TestProfile.test_list"""
     profile1 = profile.TestProfile()
@@ -346,3 +356,137 @@ def test_testprofile_allow_reassignemnt_stacked():
         test['a'] = utils.Test(['bar'])
 
     nt.ok_(test['a'].command == ['bar'])
+
+
+class TestSplitTest(object):
+    """Tests for the SplitTest class."""
+    def setup(self):
+        self.test = PiglitGLTest(['foo'], split_subtests=True)
+        self.split = profile.SplitTest(
+            'group/foo', self.test, [('ldr', 'LDR Profile'), ('hdr', 'HDR')])
+
+    def test_units(self):
+        """profile.SplitTest: has a unit per subtest"""
+        nt.eq_([(n, s) for n, _, s in self.split.units],
+               [(grouptools.join('group/foo', 'ldr'), 'LDR Profile'),
+                (grouptools.join('group/foo', 'hdr'), 'HDR')])
+
+    def test_merge_subtests(self):
+        """profile.SplitTest.merge(): merges the reported subtests"""
+        result = results.TestResult('pass')
+        result.subtests['LDR Profile'] = 'pass'
+        self.split.merge('LDR Profile', result)
+        nt.eq_(self.split.result.subtests['LDR Profile'], 'pass')
+
+    def test_merge_crash(self):
+        """profile.SplitTest.merge(): uses the result if no subtest is reported"""
+        self.split.merge('HDR', results.TestResult('crash'))
+        nt.eq_(self.split.result.subtests['HDR'], 'crash')
+
+    def test_merge_out(self):
+        """profile.SplitTest.merge(): joins the output"""
+        for out in ['a', 'b']:
+            result = results.TestResult('pass')
+            result.out = out
+            self.split.merge('HDR', result)
+        nt.eq_(self.split.result.out, 'a\nb')
+
+    def test_merge_phases(self):
+        """profile.SplitTest.merge(): adds up the phases"""
+        for init in [0.5, 0.25]:
+            result = results.TestResult('pass')
+            result.phases = {'init': init}
+            self.split.merge('HDR', result)
+        nt.eq_(self.split.result.phases, {'init': 0.75})
+
+    def test_merge_gl_calls(self):
+        """profile.SplitTest.merge(): adds up the GL calls"""
+        for count in [3, 4]:
+            result = results.TestResult('pass')
+            result.gl_calls = {'glClear': {'count': count}}
+            self.split.merge('HDR', result)
+        nt.eq_(self.split.result.gl_calls, {'glClear': {'count': 7}})
+
+    def test_done(self):
+        """profile.SplitTest.done(): writes the result after the last unit"""
+        backend = mock.MagicMock()
+        self.split.done('LDR Profile', results.TestResult('pass'), backend)
+        nt.eq_(backend.write_test.call_count, 0)
+        self.split.done('HDR', results.TestResult('fail'), backend)
+        backend.write_test.assert_called_once_with('group/foo')
+
+
+def test_split_subtests():
+    """profile.TestProfile._split_subtests(): splits tests that list subtests"""
+    profile_ = profile.TestProfile()
+    profile_.test_list['split'] = PiglitGLTest(['foo'], split_subtests=True)
+    profile_.test_list['whole'] = PiglitGLTest(['bar'])
+    opts = core.Options()
+    PiglitGLTest.OPTS.env['PIGLIT_PLATFORM'] = 'glx'
+
+    with mock.patch.object(PiglitGLTest, 'list_subtests',
+                           mock.Mock(return_value=[('a', 'A'), ('b', 'B')])):
+        units = profile_._split_subtests(opts)
+
+    nt.eq_(sorted(n for n, _, _ in units),
+           sorted([grouptools.join('split', 'a'),
+                   grouptools.join('split', 'b'), 'whole']))
+
+
+def test_concurrent_workers_pinned():
+    """profile.TestProfile._concurrent_workers(): a pinned worker per online CPU
+    """
+    with mock.patch('framework.profile.cpuset.online_cpus',
+                    mock.Mock(return_value=[0, 2, 3])):
+        nt.eq_(profile.TestProfile._concurrent_workers(
+            core.Options(pin_cpus=True)), 3)
+
+
+def test_batch_tests():
+    """profile.TestProfile._batch_tests(): batches tests with the same key"""
+    units = [('glean/a', GleanTest('a'), None),
+             ('glean/b', GleanTest('b'), None),
+             ('whole', PiglitGLTest(['foo']), None)]
+    batched = profile.TestProfile._batch_tests(
+        units, core.Options(batch_size=32))
+
+    nt.eq_(len(batched), 2)
+    batch = next(b for _, _, b in batched if b is not None)
+    nt.eq_(batch.test.names, ['a', 'b'])
+    nt.eq_([n for n, _ in batch.tests], ['glean/a', 'glean/b'])
+
+
+def test_batch_largest():
+    """profile.BatchTest.largest(): returns the test with the largest estimate
+    """
+    batch = profile.BatchTest([('glean/' + n, GleanTest(n)) for n in 'abc'])
+    budget = memory.MemoryBudget(1024, {'glean/a': 10, 'glean/b': 300,
+                                        'glean/c': 20})
+    nt.eq_(batch.largest(budget), 'glean/b')
+
+
+def test_batch_tests_key():
+    """profile.TestProfile._batch_tests(): tests with different env run alone
+    """
+    other = GleanTest('b')
+    other.env['PIGLIT_TEST'] = 'foo'
+    units = [('glean/a', GleanTest('a'), None), ('glean/b', other, None)]
+
+    nt.eq_(profile.TestProfile._batch_tests(
+        units, core.Options(batch_size=32)), units)
+
+
+def test_batch_tests_size():
+    """profile.TestProfile._batch_tests(): batches hold at most batch_size"""
+    units = [('glean/' + n, GleanTest(n), None) for n in 'abcde']
+    batched = profile.TestProfile._batch_tests(
+        units, core.Options(batch_size=2))
+
+    nt.eq_([len(b.tests) if b else 1 for _, _, b in batched], [2, 2, 1])
+
+
+def test_batch_tests_disabled():
+    """profile.TestProfile._batch_tests(): does nothing by default"""
+    units = [('glean/a', GleanTest('a'), None),
+             ('glean/b', GleanTest('b'), None)]
+    nt.eq_(profile.TestProfile._batch_tests(units, core.Options()), units)
@@ -23,9 +23,12 @@
 
 from __future__ import print_function, absolute_import
 
+import hashlib
+import json
+
 import nose.tools as nt
 
-from framework import results, status, exceptions, grouptools
+from framework import results, status, exceptions, grouptools, backends
 import framework.tests.utils as utils
 
 
@@ -321,6 +324,84 @@ def test_TestResult_update_subtests():
     nt.eq_(test.subtests['result'], 'incomplete')
 
 
+def test_TestResult_update_perf():
+    """results.TestResult.update: perf measurements are added"""
+    test = results.TestResult('pass')
+    test.update({'perf': {'draw': {'unit': 'draws/s', 'samples': [1, 2]}}})
+    nt.eq_(test.perf['draw'].samples, [1, 2])
+
+
+def test_TestResult_perf_round_trip():
+    """results.TestResult: perf survives to_json and from_dict"""
+    test = results.TestResult('pass')
+    test.perf['draw'] = results.Measurement('draws/s', [1.0, 2.0, 3.0])
+    test = json.loads(json.dumps(test, default=backends.json.piglit_encoder),
+                      object_hook=backends.json.piglit_decoder)
+    nt.eq_(test.perf['draw'].samples, [1.0, 2.0, 3.0])
+
+
+def test_TestResult_update_shader_time():
+    """results.TestResult.update: shader timings are appended"""
+    test = results.TestResult('pass')
+    for stage in ['vertex', 'link']:
+        test.update({'shader_time': [
+            {'stage': stage, 'hash': '0123456789abcdef', 'time': 0.5}]})
+    nt.eq_([x['stage'] for x in test.shader_time], ['vertex', 'link'])
+
+
+def test_TestResult_update_phases():
+    """results.TestResult.update: phases are merged"""
+    test = results.TestResult('pass')
+    test.update({'result': 'pass', 'phases': {'init': 0.5}})
+    test.update({'phases': {'teardown': 0.25}})
+    nt.eq_(test.phases, {'init': 0.5, 'teardown': 0.25})
+
+
+def test_TestResult_update_gl_calls():
+    """results.TestResult.update: gl call counts are added"""
+    test = results.TestResult('pass')
+    test.update({'gl_calls': {'glReadPixels': {'count': 4096}}})
+    nt.eq_(test.gl_calls['glReadPixels']['count'], 4096)
+
+
+class TestMeasurement(object):
+    """Tests for the Measurement class."""
+    @classmethod
+    def setup_class(cls):
+        cls.test = results.Measurement('draws/s', [4.0, 1.0, 3.0, 2.0])
+
+    def test_mean(self):
+        """results.Measurement.mean: is the mean of the samples"""
+        nt.eq_(self.test.mean, 2.5)
+
+    def test_median(self):
+        """results.Measurement.median: averages the middle samples"""
+        nt.eq_(self.test.median, 2.5)
+
+    def test_median_odd(self):
+        """results.Measurement.median: is the middle sample"""
+        nt.eq_(results.Measurement('', [5.0, 1.0, 2.0]).median, 2.0)
+
+    def test_stddev(self):
+        """results.Measurement.stddev: is the sample standard deviation"""
+        nt.assert_almost_equal(self.test.stddev, 1.2909944487358056)
+
+    def test_stddev_single(self):
+        """results.Measurement.stddev: is 0 with one sample"""
+        nt.eq_(results.Measurement('', [5.0]).stddev, 0.0)
+
+    def test_to_json(self):
+        """results.Measurement.to_json: includes the derived values"""
+        json_ = self.test.to_json()
+        nt.eq_((json_['mean'], json_['median'], json_['unit']),
+               (2.5, 2.5, 'draws/s'))
+
+    def test_from_dict(self):
+        """results.Measurement.from_dict: restores the samples"""
+        test = results.Measurement.from_dict(self.test.to_json())
+        nt.eq_(test.samples, self.test.samples)
+
+
 class TestStringDescriptor(object):
     """Test class for StringDescriptor."""
     @classmethod
@@ -527,7 +608,7 @@ class TestTestrunResultToJson(object):
 
     def test_tests(self):
         """results.TestrunResult.to_json: tests is properly encoded"""
-        nt.eq_(self.test['tests']['a test'].result, 'pass')
+        nt.eq_(self.test['tests']['a test']['result'], 'pass')
 
     def test_type(self):
         """results.TestrunResult.to_json: __type__ is added"""
@@ -669,3 +750,90 @@ class TestTestrunResult_get_result(object):
     def test_get_nonexist(self):
         """results.TestrunResult.get_result: raises KeyError if test doesn't exist"""
         self.inst.get_result('fooobar')
+
+
+def test_BlobTable_ref():
+    """results.BlobTable.ref: returns a BlobRef for strings in the table"""
+    value = u'a' * results.BlobTable.MIN_SIZE
+    table = results.BlobTable()
+    table.add(value)
+    nt.ok_(isinstance(table.ref(value), results.BlobRef))
+
+
+def test_BlobTable_ref_short():
+    """results.BlobTable.ref: returns short strings unchanged"""
+    table = results.BlobTable()
+    table.add(u'short')
+    nt.eq_(table.ref(u'short'), u'short')
+    nt.ok_(not isinstance(table.ref(u'short'), results.BlobRef))
+
+
+def test_BlobTable_expand():
+    """results.BlobTable.expand: returns the stored string for a BlobRef"""
+    value = u'a' * results.BlobTable.MIN_SIZE
+    table = results.BlobTable()
+    table.add(value)
+    nt.eq_(table.expand(table.ref(value)), value)
+
+
+def test_BlobTable_key_bytes():
+    """results.BlobTable.key: hashes byte strings that aren't ascii"""
+    value = b'\xff' * results.BlobTable.MIN_SIZE
+    table = results.BlobTable()
+    nt.eq_(results.BlobTable.key(value),
+           hashlib.sha1(value).hexdigest()[:16])
+    nt.ok_(table.add(value))
+    nt.eq_(table.expand(table.ref(value)), value)
+
+
+class TestTestrunResultBlobs(object):
+    """Tests for the blob table created by TestrunResult.to_json."""
+    @classmethod
+    def setup_class(cls):
+        cls.env = u'PIGLIT_PLATFORM="gbm" ' * 10
+        cls.unique = u'unique output ' * 10
+
+        run = results.TestrunResult()
+        for name in ['a', 'b', 'c']:
+            test = results.TestResult('pass')
+            test.environment = cls.env
+            test.out = u'short'
+            run.tests[name] = test
+        run.tests['a'].err = cls.unique
+
+        cls.json = run.to_json()
+        cls.result = results.TestrunResult.from_dict(cls.json)
+
+    def test_shared_is_ref(self):
+        """results.TestrunResult.to_json: shared strings are references"""
+        nt.eq_(self.json['tests']['a']['environment']['__type__'], 'Blob')
+
+    def test_one_blob(self):
+        """results.TestrunResult.to_json: shared strings are stored once"""
+        nt.eq_(len(self.json['blobs']), 1)
+
+    def test_unique_inline(self):
+        """results.TestrunResult.to_json: unique strings are not stored"""
+        nt.eq_(self.json['tests']['a']['err'], self.unique)
+
+    def test_short_inline(self):
+        """results.TestrunResult.to_json: short strings are not stored"""
+        nt.eq_(self.json['tests']['a']['out'], u'short')
+
+    def test_expanded(self):
+        """results.TestrunResult.from_dict: references are expanded"""
+        nt.eq_(self.result.tests['b'].environment, self.env)
+        nt.ok_(not isinstance(self.result.tests['b'].environment,
+                              results.BlobRef))
+
+    def test_expanded_shared(self):
+        """results.TestrunResult.from_dict: expanded strings are shared"""
+        nt.assert_is(self.result.tests['a'].environment,
+                     self.result.tests['b'].environment)
+
+
+def test_TestResult_peak_rss_round_trip():
+    """results.TestResult: peak_rss survives to_json and from_dict"""
+    test = results.TestResult('pass')
+    test.peak_rss = 4096
+    nt.eq_(results.TestResult.from_dict(test.to_json()).peak_rss, 4096)
@@ -24,12 +24,15 @@ from __future__ import print_function, absolute_import
 import sys
 import os
 import shutil
+import copy
 
+import mock
 import nose.tools as nt
 
-from framework import core, exceptions
+from framework import core, exceptions, backends, results, timeouts
 import framework.tests.utils as utils
 import framework.programs.run as run
+from .backends_tests import BACKEND_INITIAL_META
 
 
 class TestWithEnvClean(object):
@@ -260,3 +263,80 @@ class TestPlatform(_Helpers):
 
             run._run_parser(['-f', os.path.join(tdir, 'piglit.conf'),
                              'quick.py', 'foo'])
+
+
+def _json_partial(dest, meta):
+    """Write a json run that stopped after the test 'second'."""
+    backend = backends.json.JSONBackend(dest)
+    backend.initialize(meta)
+    with backend.write_test('second') as t:
+        t(results.TestResult('pass'))
+
+
+def _sqlite_partial(dest, meta):
+    """Write a sqlite run of the test 'second'.
+
+    The database is closed, as it would be had the run been killed, a
+    finished run resumes the same way.
+
+    """
+    backend = backends.sqlite.SQLiteBackend(dest)
+    backend.initialize(meta)
+    with backend.write_test('second') as t:
+        t(results.TestResult('pass'))
+    backend.finalize()
+
+
+def _resume(history, partial=_json_partial):
+    """Resume a run of two tests that stopped after the second one.
+
+    Returns the profile resume ran, with history saved in the options of
+    the partial run, which is written by partial.
+
+    """
+    with utils.tempdir() as hdir, utils.tempdir() as rdir:
+        result = results.TestResult('pass')
+        result.time.end = 30
+        result.peak_rss = 1024
+        backend = backends.json.JSONBackend(hdir)
+        backend.initialize(BACKEND_INITIAL_META)
+        for name in ['first', 'second']:
+            with backend.write_test(name) as t:
+                t(result)
+        backend.finalize()
+
+        meta = copy.deepcopy(BACKEND_INITIAL_META)
+        meta['options'].update({'profile': ['fake.py'],
+                                'log_level': 'quiet',
+                                'platform': 'mixed_glx_egl'})
+        meta['options'].update(history(hdir))
+        partial(rdir, meta)
+
+        profile = mock.MagicMock()
+        with mock.patch('framework.profile.merge_test_profiles',
+                        return_value=profile), \
+                mock.patch('framework.programs.run.core.collect_system_info',
+                           return_value={}):
+            run.resume([rdir])
+
+    nt.eq_(profile.run.call_args[0][0].exclude_tests, set(['second']))
+    return profile
+
+
+def test_resume_memory_history():
+    """run.resume(): remaining tests get estimates from --memory-history"""
+    profile = _resume(lambda h: {'memory_history': h})
+    nt.eq_(profile.memory_estimates, {'first': 1024, 'second': 1024})
+
+
+def test_resume_timeout_history():
+    """run.resume(): remaining tests get deadlines from --timeout-history"""
+    profile = _resume(lambda h: {'timeout_history': [h]})
+    deadlines = timeouts.Deadlines(profile.timeout_history)
+    nt.eq_(deadlines.get('first'), 150)
+
+
+def test_resume_sqlite():
+    """run.resume(): a sqlite run is resumed from its metadata"""
+    profile = _resume(lambda h: {'memory_history': h}, _sqlite_partial)
+    nt.eq_(profile.memory_estimates, {'first': 1024, 'second': 1024})
@@ -0,0 +1,286 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# pylint: disable=missing-docstring
+
+"""Tests for the sqlite backend and the sqlite summary."""
+
+from __future__ import print_function, absolute_import
+import copy
+import os
+import shutil
+import sqlite3
+import tempfile
+
+import nose.tools as nt
+
+from framework import results, backends, grouptools, status
+from framework.backends import sqlite
+from framework.summary import common, sqlite_
+import framework.tests.utils as utils
+from .backends_tests import BACKEND_INITIAL_META
+
+
+def _write(dest, tests, **options):
+    """Write a run into dest, from a dict of name: TestResult."""
+    backend = sqlite.SQLiteBackend(dest, **options)
+    backend.initialize(dict(BACKEND_INITIAL_META, name=os.path.basename(dest)))
+    for name, result in tests.iteritems():
+        with backend.write_test(name) as t:
+            t(result)
+    backend.finalize()
+
+
+def _result(result, **subtests):
+    test = results.TestResult(result)
+    for name, value in subtests.iteritems():
+        test.subtests[name] = value
+    return test
+
+
+def test_initialize():
+    """backends.sqlite.SQLiteBackend.initialize(): creates a database"""
+    with utils.tempdir() as tdir:
+        backend = sqlite.SQLiteBackend(tdir)
+        backend.initialize(copy.copy(BACKEND_INITIAL_META))
+
+        nt.ok_(sqlite.is_sqlite(tdir))
+
+
+def test_load_registered():
+    """backends.load(): finds a sqlite result in a directory"""
+    with utils.tempdir() as tdir:
+        _write(tdir, {'foo': _result('pass')})
+        # Make sure that journals don't confuse the loader
+        with open(os.path.join(tdir, 'results.db-wal'), 'w') as f:
+            f.write('')
+
+        nt.ok_(isinstance(backends.load(tdir), results.TestrunResult))
+
+
+class TestRoundTrip(object):
+    """Tests for writing and loading a sqlite result."""
+    @classmethod
+    def setup_class(cls):
+        cls.tdir = tempfile.mkdtemp()
+        test = _result('fail')
+        test.out = 'this is stdout'
+        test.time = results.TimeAttribute(1.0, 2.5)
+        _write(cls.tdir, {
+            'group1/test1': test,
+            'group1/test2': _result('pass', sub1='pass', sub2='crash'),
+        })
+        cls.result = sqlite.load(cls.tdir)
+
+    @classmethod
+    def teardown_class(cls):
+        shutil.rmtree(cls.tdir)
+
+    def test_name(self):
+        """backends.sqlite.load(): restores the name"""
+        nt.eq_(self.result.name, os.path.basename(self.tdir))
+
+    def test_result(self):
+        """backends.sqlite.load(): restores the result"""
+        nt.eq_(self.result.tests['group1/test1'].result, status.FAIL)
+
+    def test_out(self):
+        """backends.sqlite.load(): restores out"""
+        nt.eq_(self.result.tests['group1/test1'].out, 'this is stdout')
+
+    def test_time(self):
+        """backends.sqlite.load(): restores time"""
+        nt.eq_(self.result.tests['group1/test1'].time.total, 1.5)
+
+    def test_subtests(self):
+        """backends.sqlite.load(): restores subtests"""
+        nt.eq_(self.result.tests['group1/test2'].subtests['sub2'],
+               status.CRASH)
+
+    def test_statuses(self):
+        """backends.sqlite.SQLiteBackend: writes a status per subtest"""
+        conn = sqlite.connect(self.tdir)
+        try:
+            names = set(r[0] for r in conn.execute(
+                'SELECT name FROM statuses'))
+        finally:
+            conn.close()
+        nt.eq_(names, {'group1/test1',
+                       grouptools.join('group1/test2', 'sub1'),
+                       grouptools.join('group1/test2', 'sub2')})
+
+    def test_journal(self):
+        """backends.sqlite.SQLiteBackend.finalize(): leaves a single file"""
+        nt.eq_(os.listdir(self.tdir), ['results.db'])
+
+
+def test_write_test_incomplete():
+    """backends.sqlite.SQLiteBackend.write_test(): writes incomplete first"""
+    with utils.tempdir() as tdir:
+        backend = sqlite.SQLiteBackend(tdir, sqlite_batch=1)
+        backend.initialize(copy.copy(BACKEND_INITIAL_META))
+        with backend.write_test('foo'):
+            # The incomplete status is committed along with the metadata
+            backend._commit(force=True)
+            nt.eq_(sqlite.load(tdir).tests['foo'].result, status.INCOMPLETE)
+
+
+def test_write_test_batch():
+    """backends.sqlite.SQLiteBackend.write_test(): commits in batches"""
+    with utils.tempdir() as tdir:
+        backend = sqlite.SQLiteBackend(tdir, sqlite_batch=2,
+                                       sqlite_interval=1000)
+        backend.initialize(copy.copy(BACKEND_INITIAL_META))
+
+        def count():
+            conn = sqlite3.connect(os.path.join(tdir, 'results.db'))
+            try:
+                return conn.execute("SELECT count(*) FROM tests WHERE "
+                                    "result = 'pass'").fetchone()[0]
+            finally:
+                conn.close()
+
+        for name in ['a', 'b', 'c']:
+            with backend.write_test(name) as t:
+                t(_result('pass'))
+
+        nt.eq_(count(), 2)
+        backend.finalize()
+        nt.eq_(count(), 3)
+
+
+def test_completed():
+    """backends.sqlite.completed(): doesn't include incomplete tests"""
+    with utils.tempdir() as tdir:
+        _write(tdir, {'a': _result('pass'), 'b': _result('incomplete')})
+        nt.eq_(sqlite.completed(tdir), {'a'})
+
+
+def test_completed_incomplete():
+    """backends.sqlite.completed(): includes incomplete tests if asked"""
+    with utils.tempdir() as tdir:
+        _write(tdir, {'a': _result('pass'), 'b': _result('incomplete')})
+        nt.eq_(sqlite.completed(tdir, include_incomplete=True), {'a', 'b'})
+
+
+def test_load_metadata():
+    """backends.sqlite.load_metadata(): loads the options but no tests"""
+    with utils.tempdir() as tdir:
+        _write(tdir, {'a': _result('pass')})
+        result = sqlite.load_metadata(tdir)
+        nt.eq_(result.name, os.path.basename(tdir))
+        nt.eq_(result.options['concurrent'],
+               BACKEND_INITIAL_META['options']['concurrent'])
+        nt.eq_(result.tests, {})
+
+
+class TestSQLResults(object):
+    """The sqlite summary must agree with the in memory summary."""
+    RUNS = [
+        {'pass': _result('pass'),
+         'regress': _result('pass'),
+         'fix': _result('fail'),
+         'skip-notrun': _result('skip'),
+         'pass-skip': _result('pass'),
+         'skip-pass': _result('skip'),
+         'disabled': _result('fail'),
+         'change': _result('warn'),
+         'sub': _result('pass', a='pass', b='fail'),
+         'sub-notrun': _result('pass', a='notrun', b='skip', c='pass'),
+         'split': _result('crash'),
+         'incomplete': _result('incomplete')},
+        {'pass': _result('pass'),
+         'regress': _result('crash'),
+         'fix': _result('pass'),
+         'pass-skip': _result('skip'),
+         'skip-pass': _result('pass'),
+         'enabled': _result('pass'),
+         'enabled-fail': _result('fail'),
+         'change': _result('dmesg-warn'),
+         'sub': _result('pass', a='fail', b='pass', c='skip'),
+         'sub-notrun': _result('pass', a='skip', b='notrun', c='notrun'),
+         'split': _result('pass', a='pass'),
+         'incomplete': _result('pass')},
+        {'pass': _result('timeout'),
+         'regress': _result('pass')},
+    ]
+
+    @classmethod
+    def setup_class(cls):
+        cls.tdir = tempfile.mkdtemp()
+        paths = []
+        for i, run in enumerate(cls.RUNS):
+            path = os.path.join(cls.tdir, str(i))
+            os.mkdir(path)
+            _write(path, run)
+            paths.append(path)
+
+        cls.sql = sqlite_.SQLResults(paths)
+        cls.mem = common.Results([backends.load(p) for p in paths])
+
+    @classmethod
+    def teardown_class(cls):
+        cls.sql._conn.close()
+        shutil.rmtree(cls.tdir)
+
+    @utils.nose_generator
+    def test_names(self):
+        def test(attr):
+            nt.eq_([set(x) for x in getattr(self.sql.names, attr)],
+                   [set(x) for x in getattr(self.mem.names, attr)])
+
+        for attr in ['changes', 'problems', 'skips', 'regressions', 'fixes',
+                     'enabled', 'disabled', 'incomplete']:
+            test.description = \
+                'summary.sqlite_.SQLNames: {} agrees with Names'.format(attr)
+            yield test, attr
+
+    @utils.nose_generator
+    def test_all(self):
+        def test(attr):
+            nt.eq_(getattr(self.sql.names, attr),
+                   getattr(self.mem.names, attr))
+
+        for attr in ['all', 'all_changes', 'all_disabled', 'all_enabled',
+                     'all_fixes', 'all_regressions', 'all_incomplete',
+                     'all_problems', 'all_skips']:
+            test.description = \
+                'summary.sqlite_.SQLNames: {} agrees with Names'.format(attr)
+            yield test, attr
+
+    def test_get_result(self):
+        """summary.sqlite_.SQLResults.get_result(): agrees with Results"""
+        for name in self.mem.names.all:
+            nt.eq_([str(x) for x in self.sql.get_result(name)],
+                   [str(x) for x in self.mem.get_result(name)])
+
+    def test_totals(self):
+        """summary.sqlite_.SQLResults: root totals agree with Results"""
+        for sql, mem in zip(self.sql.results, self.mem.results):
+            nt.eq_({k: v for k, v in sql.totals['root'].iteritems() if v},
+                   {k: v for k, v in mem.totals['root'].iteritems() if v})
+
+
+def test_supported():
+    """summary.sqlite_.supported(): false if any result isn't sqlite"""
+    with utils.tempdir() as tdir:
+        _write(tdir, {'a': _result('pass')})
+        nt.eq_(sqlite_.supported([tdir, os.path.join(tdir, 'foo.json')]),
+               False)
@@ -0,0 +1,121 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.summary.perf_"""
+
+# pylint: disable=protected-access,invalid-name,missing-docstring
+
+from __future__ import absolute_import, division, print_function
+import os
+import shutil
+import tempfile
+
+import nose.tools as nt
+
+from framework import results, backends
+from framework.summary import perf_
+from .backends_tests import BACKEND_INITIAL_META
+from .summary_console_tests import get_stdout
+
+
+def test_betai():
+    """summary.perf_._betai: matches known values"""
+    # I_0.5(a, a) is 0.5 by symmetry, I_x(1, 1) is x
+    nt.assert_almost_equal(perf_._betai(3.5, 3.5, 0.5), 0.5)
+    nt.assert_almost_equal(perf_._betai(1.0, 1.0, 0.3), 0.3)
+
+
+def test_welch_ttest():
+    """summary.perf_.welch_ttest: matches a known p-value"""
+    # Computed with scipy.stats.ttest_ind(a, b, equal_var=False)
+    a = results.Measurement('', [27.5, 21.0, 19.0, 23.6, 17.0, 17.9, 16.9,
+                                 20.1, 21.9, 22.6, 23.1, 19.6, 19.0, 21.7,
+                                 21.4])
+    b = results.Measurement('', [27.1, 22.0, 20.8, 23.4, 23.4, 23.5, 25.8,
+                                 22.0, 24.8, 20.2, 21.9, 22.1, 22.9, 20.5,
+                                 24.4])
+    nt.assert_almost_equal(perf_.welch_ttest(a, b), 0.0210, places=3)
+
+
+def test_welch_ttest_one_sample():
+    """summary.perf_.welch_ttest: returns None with too few samples"""
+    nt.eq_(perf_.welch_ttest(results.Measurement('', [1.0]),
+                             results.Measurement('', [1.0, 2.0])), None)
+
+
+def test_welch_ttest_no_variance():
+    """summary.perf_.welch_ttest: handles samples with no variance"""
+    nt.eq_(perf_.welch_ttest(results.Measurement('', [1.0, 1.0]),
+                             results.Measurement('', [2.0, 2.0])), 0.0)
+
+
+def test_compare_regression():
+    """summary.perf_.compare: a significant decrease is a regression"""
+    _, _, verdict = perf_.compare(
+        results.Measurement('', [100.0, 101.0, 99.0, 100.0]),
+        results.Measurement('', [80.0, 81.0, 79.0, 80.0]))
+    nt.eq_(verdict, 'regression')
+
+
+def test_compare_noise():
+    """summary.perf_.compare: noise is not significant"""
+    change, _, verdict = perf_.compare(
+        results.Measurement('', [100.0, 120.0, 80.0, 100.0]),
+        results.Measurement('', [101.0, 81.0, 121.0, 99.0]))
+    nt.eq_(verdict, '')
+    nt.assert_almost_equal(change, 0.005)
+
+
+class TestPerf(object):
+    """Tests for the perf console output."""
+    @classmethod
+    def setup_class(cls):
+        cls.tdir = tempfile.mkdtemp()
+        cls.paths = []
+        for name, samples in [('before', [100.0, 101.0, 99.0]),
+                              ('after', [50.0, 51.0, 49.0])]:
+            path = os.path.join(cls.tdir, name)
+            os.mkdir(path)
+            backend = backends.json.JSONBackend(path)
+            backend.initialize(dict(BACKEND_INITIAL_META, name=name))
+            test = results.TestResult('pass')
+            test.perf['draw'] = results.Measurement('draws/s', samples)
+            with backend.write_test('perf/draw-calls') as t:
+                t(test)
+            backend.finalize()
+            cls.paths.append(path)
+
+        cls.output = get_stdout(lambda: perf_.perf(cls.paths)).splitlines()
+
+    @classmethod
+    def teardown_class(cls):
+        shutil.rmtree(cls.tdir)
+
+    def test_header(self):
+        """summary.perf_.perf: prints the name and unit"""
+        nt.eq_(self.output[0], 'perf/draw-calls/draw (draws/s):')
+
+    def test_regression(self):
+        """summary.perf_.perf: marks a significant regression"""
+        nt.ok_(self.output[2].endswith('regression'), msg=self.output[2])
+
+    def test_baseline(self):
+        """summary.perf_.perf: doesn't compare the baseline to itself"""
+        nt.ok_('p ' not in self.output[1], msg=self.output[1])
@@ -0,0 +1,75 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.summary.phases_"""
+
+# pylint: disable=protected-access,invalid-name,missing-docstring
+
+from __future__ import absolute_import, division, print_function
+
+import nose.tools as nt
+
+from framework import results
+from framework.summary import phases_
+
+
+def _make(total, **phases):
+    test = results.TestResult('pass')
+    test.time = results.TimeAttribute(0.0, total)
+    test.update({'phases': phases})
+    return test
+
+
+class TestAggregate(object):
+    @classmethod
+    def setup_class(cls):
+        res = results.TestrunResult()
+        res.name = 'run'
+        res.tests['a'] = _make(1.0, framework=0.3, context=0.2, init=0.1,
+                               display=0.2, teardown=0.1)
+        res.tests['b'] = _make(2.0, framework=0.5, context=0.4, init=0.5,
+                               display=0.5, teardown=0.2)
+        # A test that doesn't report phases isn't counted
+        res.tests['c'] = results.TestResult('pass')
+        cls.agg = phases_.aggregate(res)
+
+    def test_tests(self):
+        """summary.phases_.aggregate: counts tests reporting phases"""
+        nt.eq_(self.agg.tests, 2)
+
+    def test_totals(self):
+        """summary.phases_.aggregate: sums each phase"""
+        nt.assert_almost_equal(self.agg.totals['context'], 0.6)
+
+    def test_other(self):
+        """summary.phases_.aggregate: other is the time outside of phases"""
+        nt.assert_almost_equal(self.agg.totals['other'], 0.6)
+
+    def test_overhead(self):
+        """summary.phases_.Phases.overhead: is framework and teardown"""
+        nt.assert_almost_equal(self.agg.overhead, 1.1)
+
+    def test_work(self):
+        """summary.phases_.Phases.work: is init and display"""
+        nt.assert_almost_equal(self.agg.work, 1.3)
+
+    def test_total(self):
+        """summary.phases_.Phases.total: doesn't count nested phases"""
+        nt.assert_almost_equal(self.agg.total, 3.0)
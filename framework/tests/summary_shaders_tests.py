@@ -0,0 +1,71 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.summary.shaders_"""
+
+# pylint: disable=protected-access,invalid-name,missing-docstring
+
+from __future__ import absolute_import, division, print_function
+
+import nose.tools as nt
+
+from framework import results
+from framework.summary import shaders_
+
+
+def _run(tests):
+    res = results.TestrunResult()
+    for name, timings in tests.iteritems():
+        res.tests[name] = results.TestResult('pass')
+        for stage, hash_, time in timings:
+            res.tests[name].update({'shader_time': [
+                {'stage': stage, 'hash': hash_, 'time': time}]})
+    return res
+
+
+class TestCollect(object):
+    @classmethod
+    def setup_class(cls):
+        shaders = shaders_.collect([
+            _run({'a': [('vertex', '1', 0.1), ('link', '2', 0.3)],
+                  'b': [('vertex', '1', 0.3)]}),
+            _run({'a': [('vertex', '1', 0.2)]}),
+        ])
+        cls.shaders = {(s.stage, s.hash): s for s in shaders}
+
+    def test_grouped(self):
+        """summary.shaders_.collect: groups by stage and hash"""
+        nt.eq_(set(self.shaders), {('vertex', '1'), ('link', '2')})
+
+    def test_times(self):
+        """summary.shaders_.collect: collects the times from every run"""
+        nt.eq_(sorted(self.shaders[('vertex', '1')].times), [0.1, 0.2, 0.3])
+
+    def test_tests(self):
+        """summary.shaders_.collect: records the tests using a shader"""
+        nt.eq_(self.shaders[('vertex', '1')].tests, {'a', 'b'})
+
+    def test_max(self):
+        """summary.shaders_.Shader.max: is the slowest time"""
+        nt.eq_(self.shaders[('vertex', '1')].max, 0.3)
+
+    def test_mean(self):
+        """summary.shaders_.Shader.mean: is the mean time"""
+        nt.assert_almost_equal(self.shaders[('vertex', '1')].mean, 0.2)
@@ -0,0 +1,99 @@
+# Copyright (c) 2015 Intel Corporation
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests for framework.timeouts"""
+
+# pylint: disable=invalid-name,missing-docstring
+
+from __future__ import absolute_import, division, print_function
+import os
+
+import nose.tools as nt
+
+from framework import timeouts, results
+from . import utils
+
+
+def _run(**tests):
+    run = results.TestrunResult()
+    for name, (status, total) in tests.iteritems():
+        run.tests[name] = results.TestResult(status)
+        run.tests[name].time = results.TimeAttribute(0.0, total)
+    return run
+
+
+def test_percentile():
+    """timeouts.percentile(): interpolates between samples"""
+    nt.eq_(timeouts.percentile([1, 2, 3, 4, 5], 50), 3)
+    nt.eq_(timeouts.percentile([0, 10], 95), 9.5)
+
+
+def test_percentile_single():
+    """timeouts.percentile(): is the sample when there is only one"""
+    nt.eq_(timeouts.percentile([7], 95), 7)
+
+
+def test_durations():
+    """timeouts.durations(): collects durations from each run"""
+    nt.eq_(timeouts.durations([_run(a=('pass', 1.0)), _run(a=('fail', 2.0))]),
+           {'a': [1.0, 2.0]})
+
+
+def test_durations_ignored():
+    """timeouts.durations(): ignores skips and timeouts"""
+    nt.eq_(timeouts.durations([_run(a=('skip', 1.0), b=('timeout', 60.0))]),
+           {})
+
+
+def test_deadline_factor():
+    """timeouts.Deadlines.get(): is a multiple of the 95th percentile"""
+    deadlines = timeouts.Deadlines({'a': [10, 20]}, factor=2, floor=0)
+    nt.eq_(deadlines.get('a'), 39)
+
+
+def test_deadline_floor():
+    """timeouts.Deadlines.get(): is at least the floor"""
+    deadlines = timeouts.Deadlines({'a': [0.1]}, floor=10)
+    nt.eq_(deadlines.get('a'), 10)
+
+
+def test_deadline_cap():
+    """timeouts.Deadlines.get(): is at most the cap"""
+    deadlines = timeouts.Deadlines({'a': [100]}, cap=60)
+    nt.eq_(deadlines.get('a'), 60)
+
+
+def test_deadline_like():
+    """timeouts.Deadlines.get(): falls back to like"""
+    deadlines = timeouts.Deadlines({'a': [100]}, factor=1)
+    nt.eq_(deadlines.get('a/sub', like='a'), 100)
+
+
+def test_deadline_unknown():
+    """timeouts.Deadlines.get(): is None without history"""
+    nt.eq_(timeouts.Deadlines({}).get('a'), None)
+
+
+def test_cpu_time():
+    """timeouts.cpu_time(): reads the state of a running process"""
+    utils.platform_check('linux')
+    state, ticks = timeouts.cpu_time(os.getpid())
+    nt.eq_(state, 'R')
+    nt.ok_(ticks >= 0)
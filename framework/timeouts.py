@@ -0,0 +1,133 @@
+# Copyright (c) 2015 Intel Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+"""Per-test timeouts derived from previous runs, and hang detection.
+
+Most tests have no timeout, so a hung test stalls a worker for the rest of
+the run, and a timeout generous enough for the slowest test wastes minutes
+on every hang. Instead the deadline of each test can be derived from how
+long it took in previous runs: a multiple of the 95th percentile of its
+durations, clamped between a floor and a cap.
+
+A test can also be killed early if it is asleep and hasn't used any CPU
+time for a while, which is what a driver hang looks like from outside.
+
+"""
+
+from __future__ import print_function, absolute_import
+import collections
+import math
+
+from framework import status
+
+__all__ = [
+    'Deadlines',
+    'cpu_time',
+    'durations',
+    'percentile',
+]
+
+# Results that don't say how long a test takes to run
+_IGNORED = frozenset([status.NOTRUN, status.SKIP, status.INCOMPLETE,
+                      status.TIMEOUT])
+
+
+def percentile(values, p):
+    """Return the p-th percentile of values by linear interpolation."""
+    assert values, 'percentile of nothing'
+    values = sorted(values)
+    rank = (len(values) - 1) * p / 100.0
+    low = int(math.floor(rank))
+    high = min(low + 1, len(values) - 1)
+    return values[low] + (values[high] - values[low]) * (rank - low)
+
+
+def durations(results):
+    """Return a dictionary of test name: list of durations.
+
+    Arguments:
+    results -- a list of TestrunResults
+
+    """
+    history = collections.defaultdict(list)
+    for run in results:
+        for name, result in run.tests.iteritems():
+            if result.result not in _IGNORED and result.time.total > 0:
+                history[name].append(result.time.total)
+    return dict(history)
+
+
+def cpu_time(pid):
+    """Return the state and CPU time in clock ticks of a running process.
+
+    The CPU time is the user and system time of all of its threads. Returns
+    None if it can't be read, because the process has exited or the system
+    has no /proc.
+
+    """
+    try:
+        with open('/proc/{}/stat'.format(pid), 'r') as f:
+            stat = f.read()
+    except IOError:
+        return None
+
+    # The name of the command is in parentheses and may contain spaces
+    fields = stat[stat.rfind(')') + 2:].split()
+    try:
+        return fields[0], int(fields[11]) + int(fields[12])
+    except (IndexError, ValueError):
+        return None
+
+
+class Deadlines(object):
+    """Timeouts for tests from their durations in previous runs.
+
+    Arguments:
+    history -- a dictionary of test name: list of durations, as returned by
+               durations()
+
+    Keyword Arguments:
+    factor -- the multiple of the 95th percentile of a test's durations it
+              may run for. Default: 5
+    floor -- the smallest timeout in seconds. Default: 10
+    cap -- the largest timeout in seconds, or None. Default: None
+
+    """
+    def __init__(self, history, factor=5, floor=10, cap=None):
+        self.factor = factor
+        self.floor = floor
+        self.cap = cap
+        self.__history = history
+
+    def get(self, name, like=None):
+        """Return the timeout for a test in seconds, or None if unknown.
+
+        If there is no history for name, the history of like is used.
+
+        """
+        samples = self.__history.get(name) or self.__history.get(like)
+        if not samples:
+            return None
+
+        timeout = max(self.floor, self.factor * percentile(samples, 95))
+        if self.cap:
+            timeout = min(self.cap, timeout)
+        return int(math.ceil(timeout))
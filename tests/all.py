@@ -10,6 +10,7 @@ from framework import grouptools
 from framework.profile import TestProfile
 from framework.test import (PiglitGLTest, GleanTest, ShaderTest,
                             GLSLParserTest, GLSLParserNoConfigError)
+from framework.test.piglit_test import PiglitBaseTest
 from .py_modules.constants import TESTS_DIR, GENERATED_TESTS_DIR
 
 __all__ = ['profile']
@@ -1039,6 +1040,8 @@ with profile.group_manager(
     g(['triangle-rasterization'], run_concurrent=False)
     g(['triangle-rasterization', '-use_fbo'], 'triangle-rasterization-fbo',
       run_concurrent=False)
+    g(['triangle-rasterization', '-batch', '-count', '10000'],
+      'triangle-rasterization-batch', run_concurrent=False)
     g(['triangle-rasterization-overdraw'], run_concurrent=False)
     g(['tex-miplevel-selection', '-nobias', '-nolod'],
       'tex-miplevel-selection')
@@ -2593,6 +2596,7 @@ with profile.group_manager(
     g(['arb_texture_compression-invalid-formats', 'bptc'], 'invalid formats')
     g(['bptc-modes'])
     g(['bptc-float-modes'])
+    g(['compressed-random', 'bptc'])
     g(['compressedteximage', 'GL_COMPRESSED_RGBA_BPTC_UNORM'])
     g(['compressedteximage', 'GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM'])
     g(['compressedteximage', 'GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT'])
@@ -3058,6 +3062,7 @@ with profile.group_manager(
         PiglitGLTest,
         grouptools.join('spec', 'ext_texture_compression_latc')) as g:
     g(['arb_texture_compression-invalid-formats', 'latc'], 'invalid formats')
+    g(['compressed-random', 'latc'])
     g(['fbo-generatemipmap-formats', 'GL_EXT_texture_compression_latc'],
       'fbo-generatemipmap-formats')
     g(['fbo-generatemipmap-formats', 'GL_EXT_texture_compression_latc-signed'],
@@ -3072,6 +3077,7 @@ with profile.group_manager(
     g(['compressedteximage', 'GL_COMPRESSED_SIGNED_RED_RGTC1_EXT'])
     g(['compressedteximage', 'GL_COMPRESSED_SIGNED_RED_GREEN_RGTC2_EXT'])
     g(['arb_texture_compression-invalid-formats', 'rgtc'], 'invalid formats')
+    g(['compressed-random', 'rgtc'])
     g(['rgtc-teximage-01'], run_concurrent=False)
     g(['rgtc-teximage-02'], run_concurrent=False)
     g(['fbo-generatemipmap-formats', 'GL_EXT_texture_compression_rgtc'],
@@ -3088,6 +3094,7 @@ with profile.group_manager(
     g(['compressedteximage', 'GL_COMPRESSED_RGBA_S3TC_DXT3_EXT'])
     g(['compressedteximage', 'GL_COMPRESSED_RGBA_S3TC_DXT5_EXT'])
     g(['arb_texture_compression-invalid-formats', 's3tc'], 'invalid formats')
+    g(['compressed-random', 's3tc'])
     g(['gen-compressed-teximage'], run_concurrent=False)
     g(['s3tc-errors'])
     g(['s3tc-teximage'], run_concurrent=False)
@@ -4191,12 +4198,14 @@ with profile.group_manager(
          PiglitGLTest,
          grouptools.join('spec', 'khr_texture_compression_astc')) as g:
     g(['arb_texture_compression-invalid-formats', 'astc'], 'invalid formats')
-    g(['khr_compressed_astc-array_gl'], 'array-gl')
-    g(['khr_compressed_astc-array_gles3'], 'array-gles')
+    g(['khr_compressed_astc-array_gl'], 'array-gl', split_subtests=True)
+    g(['khr_compressed_astc-array_gles3'], 'array-gles',
+      split_subtests=True)
     g(['khr_compressed_astc-basic_gl'], 'basic-gl')
     g(['khr_compressed_astc-basic_gles2'], 'basic-gles')
-    g(['khr_compressed_astc-miptree_gl'], 'miptree-gl')
-    g(['khr_compressed_astc-miptree_gles2'], 'miptree-gles')
+    g(['khr_compressed_astc-miptree_gl'], 'miptree-gl', split_subtests=True)
+    g(['khr_compressed_astc-miptree_gles2'], 'miptree-gles',
+      split_subtests=True)
 
 with profile.group_manager(
          PiglitGLTest,
@@ -4365,6 +4374,7 @@ with profile.group_manager(
         PiglitGLTest, grouptools.join('spec', 'arb_es3_compatibility')) as g:
     g(['es3-primrestart-fixedindex'])
     g(['es3-drawarrays-primrestart-fixedindex'])
+    g(['compressed-random', 'etc2'])
 
     for tex_format in ['rgb8', 'srgb8', 'rgba8', 'srgb8-alpha8', 'r11', 'rg11',
                        'rgb8-punchthrough-alpha1',
@@ -4496,5 +4506,10 @@ with profile.group_manager(
     g(['oes_draw_elements_base_vertex-multidrawelements'],
       run_concurrent=False)
 
+# Tests which don't create a context
+with profile.group_manager(PiglitBaseTest, 'no_api') as g:
+    g(['format-convert'])
+    g(['texture-fixture-cache'])
+
 if platform.system() is 'Windows':
     profile.filter_tests(lambda p, _: not p.startswith('glx'))
@@ -0,0 +1,372 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file format-convert.c
+ *
+ * Checks the conversions in piglit-format-convert.h, which the format tests
+ * use to build their expected results.  Every code of the small formats is
+ * round tripped, the half float encoder is compared to a copy of the scalar
+ * code it replaced, and the interpolated sRGB conversions are compared to
+ * the spec formulas.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "piglit-util.h"
+#include "piglit-format-convert.h"
+
+#define CHUNK 4096
+
+static float
+bits_float(uint32_t u)
+{
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+static uint32_t
+float_bits(float f)
+{
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+/**
+ * The scalar half float encoder that piglit_half_from_float() used, with
+ * its denorm cases folded together.  The array conversion must match it
+ * bit for bit.
+ */
+static uint16_t
+reference_half(float val)
+{
+	const uint32_t i = float_bits(val);
+	const int flt_m = i & 0x7fffff;
+	const int flt_e = (i >> 23) & 0xff;
+	const int s = (i >> 31) & 0x1;
+	int e, m = 0;
+
+	if (flt_e == 0) {
+		/* zero and float denorms */
+		e = 0;
+	} else if (flt_e == 0xff) {
+		e = 31;
+		if (flt_m != 0)
+			m = 1;
+	} else {
+		const int new_exp = flt_e - 127;
+		if (new_exp < -24) {
+			e = 0;
+		} else if (new_exp < -14) {
+			/* a denorm: 2^new_exp * (1 + flt_m / 2^23) / 2^-24 */
+			e = 0;
+			m = (1 << (new_exp + 24)) +
+				(flt_m >> (-1 - new_exp));
+		} else if (new_exp > 15) {
+			e = 31;
+		} else {
+			e = new_exp + 15;
+			m = flt_m >> 13;
+		}
+	}
+
+	return (s << 15) | (e << 10) | m;
+}
+
+static enum piglit_result
+test_half(void)
+{
+	static float f[CHUNK];
+	static uint16_t h[CHUNK];
+	uint64_t u;
+	unsigned i;
+
+	/* Every half except NaNs, whose payloads aren't kept. */
+	for (u = 0; u < 0x10000; u += CHUNK) {
+		for (i = 0; i < CHUNK; i++)
+			h[i] = u + i;
+		piglit_convert_half_to_float(f, h, CHUNK);
+		piglit_convert_float_to_half(h, f, CHUNK);
+		for (i = 0; i < CHUNK; i++) {
+			const uint16_t code = u + i;
+			if ((code & 0x7fff) > 0x7c00)
+				continue;
+			if (h[i] != code) {
+				printf("half 0x%04x -> %g -> 0x%04x\n",
+				       code, f[i], h[i]);
+				return PIGLIT_FAIL;
+			}
+		}
+	}
+
+	/* A dense sample of every float, in runs which aren't a multiple
+	 * of the vector width so that the scalar tails are covered too.
+	 */
+	for (u = 0; u < 0x100000000ull; u += 97 * (CHUNK - 1)) {
+		for (i = 0; i < CHUNK - 1; i++)
+			f[i] = bits_float(u + 97 * i);
+		piglit_convert_float_to_half(h, f, CHUNK - 1);
+		for (i = 0; i < CHUNK - 1; i++) {
+			if (h[i] != reference_half(f[i])) {
+				printf("float 0x%08x -> half 0x%04x, "
+				       "expected 0x%04x\n",
+				       float_bits(f[i]), h[i],
+				       reference_half(f[i]));
+				return PIGLIT_FAIL;
+			}
+		}
+	}
+
+	return PIGLIT_PASS;
+}
+
+static enum piglit_result
+test_rgb9e5(void)
+{
+	uint32_t code, again;
+	float rgb[3], rgb2[3];
+	unsigned e, m;
+
+	/* Values that are exactly representable must survive encoding, even
+	 * if the code they came from wasn't the canonical one.
+	 */
+	for (e = 0; e < 32; e++) {
+		for (m = 0; m < 512; m++) {
+			code = m | ((m * 7) & 0x1ff) << 9 |
+				((m * 13 + e) & 0x1ff) << 18 | e << 27;
+			piglit_convert_rgb9e5_to_float3(rgb, &code, 1);
+			piglit_convert_float3_to_rgb9e5(&again, rgb, 1);
+			piglit_convert_rgb9e5_to_float3(rgb2, &again, 1);
+			if (memcmp(rgb, rgb2, sizeof(rgb)) != 0) {
+				printf("rgb9e5 0x%08x -> (%g, %g, %g) -> "
+				       "0x%08x\n", code, rgb[0], rgb[1],
+				       rgb[2], again);
+				return PIGLIT_FAIL;
+			}
+		}
+	}
+
+	return PIGLIT_PASS;
+}
+
+/* Denorms are flushed to zero when encoding. */
+static unsigned
+flush_uf(unsigned v, int mantissa_bits)
+{
+	return v >> mantissa_bits ? v : 0;
+}
+
+static enum piglit_result
+test_r11g11b10f(void)
+{
+	uint32_t code, expected, again;
+	float rgb[3];
+	unsigned c;
+
+	/* Every 11 bit code and every 10 bit code, skipping NaNs. */
+	for (c = 0; c <= 0x7c0; c++) {
+		const unsigned r = c, g = 0x7c0 - c, b = MIN2(c, 0x3e0);
+
+		code = r | g << 11 | b << 22;
+		expected = flush_uf(r, 6) | flush_uf(g, 6) << 11 |
+			flush_uf(b, 5) << 22;
+		piglit_convert_r11g11b10f_to_float3(rgb, &code, 1);
+		piglit_convert_float3_to_r11g11b10f(&again, rgb, 1);
+		if (again != expected) {
+			printf("r11g11b10f 0x%08x -> (%g, %g, %g) -> 0x%08x\n",
+			       code, rgb[0], rgb[1], rgb[2], again);
+			return PIGLIT_FAIL;
+		}
+	}
+
+	return PIGLIT_PASS;
+}
+
+static double
+srgb_to_linear(double s)
+{
+	if (s <= 0.04045)
+		return s / 12.92;
+	return pow((s + 0.055) / 1.055, 2.4);
+}
+
+static double
+linear_to_srgb(double l)
+{
+	if (l < 0.0031308)
+		return l * 12.92;
+	return 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+}
+
+static enum piglit_result
+test_srgb(void)
+{
+	static float in[CHUNK], out[CHUNK];
+	uint8_t codes[256], again[256];
+	float linear[256];
+	uint32_t u;
+	unsigned i;
+
+	for (i = 0; i < 256; i++)
+		codes[i] = i;
+	piglit_convert_srgb8_to_linear(linear, codes, 256);
+	piglit_convert_linear_to_srgb8(again, linear, 256);
+	for (i = 0; i < 256; i++) {
+		if (again[i] != i) {
+			printf("srgb8 %u -> %g -> %u\n", i, linear[i],
+			       again[i]);
+			return PIGLIT_FAIL;
+		}
+	}
+
+	/* Every 64th float in [0, 1]. */
+	for (u = 0; u <= 0x3f800000; u += 64 * CHUNK) {
+		for (i = 0; i < CHUNK; i++)
+			in[i] = bits_float(MIN2(u + 64 * i, 0x3f800000));
+
+		piglit_convert_srgb_to_linear(out, in, CHUNK);
+		for (i = 0; i < CHUNK; i++) {
+			if (fabs(out[i] - srgb_to_linear(in[i])) > 1e-6) {
+				printf("srgb %.9g -> linear %.9g, expected "
+				       "%.9g\n", in[i], out[i],
+				       srgb_to_linear(in[i]));
+				return PIGLIT_FAIL;
+			}
+		}
+
+		piglit_convert_linear_to_srgb(out, in, CHUNK);
+		for (i = 0; i < CHUNK; i++) {
+			if (fabs(out[i] - linear_to_srgb(in[i])) > 1e-6) {
+				printf("linear %.9g -> srgb %.9g, expected "
+				       "%.9g\n", in[i], out[i],
+				       linear_to_srgb(in[i]));
+				return PIGLIT_FAIL;
+			}
+		}
+
+		piglit_convert_linear_to_srgb8(codes, in, 256);
+		for (i = 0; i < 256; i++) {
+			const double s = linear_to_srgb(in[i]) * 255.0;
+			if (fabs(codes[i] - s) > 0.5 + 1e-9) {
+				printf("linear %.9g -> srgb8 %u, expected "
+				       "%.9g\n", in[i], codes[i], s);
+				return PIGLIT_FAIL;
+			}
+		}
+	}
+
+	return PIGLIT_PASS;
+}
+
+static enum piglit_result
+test_norm(void)
+{
+	static uint16_t u16[65536];
+	static int16_t s16[65536];
+	static float f[65536];
+	uint8_t u8[256];
+	int8_t s8[256];
+	unsigned i;
+
+	for (i = 0; i < 256; i++)
+		u8[i] = i;
+	piglit_convert_unorm8_to_float(f, u8, 256);
+	piglit_convert_float_to_unorm8(u8, f, 256);
+	for (i = 0; i < 256; i++) {
+		if (u8[i] != i || f[i] != piglit_unorm_to_float(8, i)) {
+			printf("unorm8 %u -> %g -> %u\n", i, f[i], u8[i]);
+			return PIGLIT_FAIL;
+		}
+	}
+
+	for (i = 0; i < 256; i++)
+		s8[i] = i - 128;
+	piglit_convert_snorm8_to_float(f, s8, 256);
+	piglit_convert_float_to_snorm8(s8, f, 256);
+	for (i = 0; i < 256; i++) {
+		/* -128 and -127 are both -1. */
+		const int expected = MAX2((int) i - 128, -127);
+		if (s8[i] != expected ||
+		    f[i] != piglit_snorm_to_float(8, (int) i - 128)) {
+			printf("snorm8 %d -> %g -> %d\n", (int) i - 128, f[i],
+			       s8[i]);
+			return PIGLIT_FAIL;
+		}
+	}
+
+	for (i = 0; i < 65536; i++)
+		u16[i] = i;
+	piglit_convert_unorm16_to_float(f, u16, 65536);
+	piglit_convert_float_to_unorm16(u16, f, 65536);
+	for (i = 0; i < 65536; i++) {
+		if (u16[i] != i || f[i] != piglit_unorm_to_float(16, i)) {
+			printf("unorm16 %u -> %g -> %u\n", i, f[i], u16[i]);
+			return PIGLIT_FAIL;
+		}
+	}
+
+	for (i = 0; i < 65536; i++)
+		s16[i] = (int) i - 32768;
+	piglit_convert_snorm16_to_float(f, s16, 65536);
+	piglit_convert_float_to_snorm16(s16, f, 65536);
+	for (i = 0; i < 65536; i++) {
+		const int expected = MAX2((int) i - 32768, -32767);
+		if (s16[i] != expected ||
+		    f[i] != piglit_snorm_to_float(16, (int) i - 32768)) {
+			printf("snorm16 %d -> %g -> %d\n", (int) i - 32768,
+			       f[i], s16[i]);
+			return PIGLIT_FAIL;
+		}
+	}
+
+	return PIGLIT_PASS;
+}
+
+static const struct {
+	const char *name;
+	enum piglit_result (*func)(void);
+} tests[] = {
+	{ "half", test_half },
+	{ "rgb9e5", test_rgb9e5 },
+	{ "r11g11b10f", test_r11g11b10f },
+	{ "srgb", test_srgb },
+	{ "normalized", test_norm },
+};
+
+int
+main(int argc, char **argv)
+{
+	enum piglit_result result = PIGLIT_PASS;
+	unsigned i;
+
+	for (i = 0; i < ARRAY_SIZE(tests); i++) {
+		const enum piglit_result r = tests[i].func();
+		piglit_report_subtest_result(r, "%s", tests[i].name);
+		piglit_merge_result(&result, r);
+	}
+
+	piglit_report_result(result);
+}
@@ -33,9 +33,15 @@
  * There are 2 components to the test;
  *   1. Predefined sanity tests ensuring bounding box calculations are correct
  *   2. Randomised triangle drawing to attempt to test all possible triangles
+ *
+ * With -batch, the random triangles that fit in a cell are packed into a grid
+ * of cells, one triangle per cell, so that each readback checks a whole grid
+ * of them. Larger ones are drawn over each other in layers of different
+ * colours and checked a layer batch at a time.
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-rasterizer.h"
 #include "mersenne.hpp"
 
 #include <time.h>
@@ -88,19 +94,12 @@ struct Triangle {
 bool use_fbo = false;
 bool break_on_fail = false;
 bool print_triangle = false;
+bool batch = false;
+int batch_cell_size = 32;
 int random_test_count = 100;
 
 /* filling convention */
-static enum filling_convention_t {
-	bottom_left = 0,
-	left_bottom,
-	right_bottom,
-	bottom_right,
-	top_right,
-	right_top,
-	left_top,
-	top_left,
-} filling_convention;
+static piglit_fill_convention filling_convention;
 
 /* Fixed point format */
 static int FIXED_SHIFT;
@@ -128,31 +127,6 @@ Mersenne mersenne;
 std::vector<Triangle> fixed_tests;
 
 
-/* std::algorithm min/max with 3 arguments! :D */
-namespace std {
-	template<typename T>
-	T min(T& a, T& b, T& c)
-	{
-		return (a < b) ? std::min(a, c) : std::min(b, c);
-	}
-
-	template<typename T>
-	T max(T& a, T& b, T& c)
-	{
-		return (a > b) ? std::max(a, c) : std::max(b, c);
-	}
-}
-
-/* Proper rounding of float to integer */
-int64_t iround(float v)
-{
-	if (v > 0.0f)
-		v += 0.5f;
-	if (v < 0.0f)
-		v -= 0.5f;
-	return (int64_t)v;
-}
-
 /* Calculate log2 for integers */
 int log2i(int x)
 {
@@ -163,146 +137,42 @@ int log2i(int x)
 }
 
 
-/* Based on http://devmaster.net/forums/topic/1145-advanced-rasterization */
-void rast_triangle(uint8_t* buffer, uint32_t stride, const Triangle& tri)
-{
-	float center_offset = -0.5f;
-
-	/* fixed point coordinates */
-	int64_t x1 = iround(FIXED_ONE * (tri[0].x + center_offset));
-	int64_t x2 = iround(FIXED_ONE * (tri[1].x + center_offset));
-	int64_t x3 = iround(FIXED_ONE * (tri[2].x + center_offset));
-
-	int64_t y1 = iround(FIXED_ONE * (tri[0].y + center_offset));
-	int64_t y2 = iround(FIXED_ONE * (tri[1].y + center_offset));
-	int64_t y3 = iround(FIXED_ONE * (tri[2].y + center_offset));
-
-	/* Force correct vertex order */
-	const int64_t cross = (x2 - x1) * (y3 - y2) - (y2 - y1) * (x3 - x2);
-	if (cross > 0) {
-		std::swap(x1, x3);
-		std::swap(y1, y3);
-	}
-
-	/* Deltas */
-	const int64_t dx12 = x1 - x2;
-	const int64_t dx23 = x2 - x3;
-	const int64_t dx31 = x3 - x1;
-
-	const int64_t dy12 = y1 - y2;
-	const int64_t dy23 = y2 - y3;
-	const int64_t dy31 = y3 - y1;
-
-	/* Fixed-point deltas */
-	const int64_t fdx12 = dx12 << FIXED_SHIFT;
-	const int64_t fdx23 = dx23 << FIXED_SHIFT;
-	const int64_t fdx31 = dx31 << FIXED_SHIFT;
-
-	const int64_t fdy12 = dy12 << FIXED_SHIFT;
-	const int64_t fdy23 = dy23 << FIXED_SHIFT;
-	const int64_t fdy31 = dy31 << FIXED_SHIFT;
-
-	/* Bounding rectangle */
-	int64_t minx = std::min(x1, x2, x3) >> FIXED_SHIFT;
-	int64_t maxx = (std::max(x1, x2, x3)) >> FIXED_SHIFT;
-
-	int64_t miny = (std::min(y1, y2, y3)) >> FIXED_SHIFT;
-	int64_t maxy = std::max(y1, y2, y3) >> FIXED_SHIFT;
-
-	minx = std::max(minx, (int64_t)0);
-	maxx = std::min(maxx, (int64_t)fbo_width - 1);
-
-	miny = std::max(miny, (int64_t)0);
-	maxy = std::min(maxy, (int64_t)fbo_height - 1);
-
-	/* Half-edge constants */
-	int64_t c1 = dy12 * x1 - dx12 * y1;
-	int64_t c2 = dy23 * x2 - dx23 * y2;
-	int64_t c3 = dy31 * x3 - dx31 * y3;
-
-	/* Correct for filling convention */
-	switch (filling_convention) {
-		case bottom_right:
-			if (dy12 > 0 || (dy12 == 0 && dx12 > 0)) c1++;
-			if (dy23 > 0 || (dy23 == 0 && dx23 > 0)) c2++;
-			if (dy31 > 0 || (dy31 == 0 && dx31 > 0)) c3++;
-			break;
-		case right_bottom:
-			if (dx12 < 0 || (dx12 == 0 && dy12 < 0)) c1++;
-			if (dx23 < 0 || (dx23 == 0 && dy23 < 0)) c2++;
-			if (dx31 < 0 || (dx31 == 0 && dy31 < 0)) c3++;
-			break;
-		case left_bottom:
-			if (dx12 < 0 || (dx12 == 0 && dy12 > 0)) c1++;
-			if (dx23 < 0 || (dx23 == 0 && dy23 > 0)) c2++;
-			if (dx31 < 0 || (dx31 == 0 && dy31 > 0)) c3++;
-			break;
-		case bottom_left:
-			if (dy12 < 0 || (dy12 == 0 && dx12 > 0)) c1++;
-			if (dy23 < 0 || (dy23 == 0 && dx23 > 0)) c2++;
-			if (dy31 < 0 || (dy31 == 0 && dx31 > 0)) c3++;
-			break;
-		case top_left:
-			if (dy12 < 0 || (dy12 == 0 && dx12 < 0)) c1++;
-			if (dy23 < 0 || (dy23 == 0 && dx23 < 0)) c2++;
-			if (dy31 < 0 || (dy31 == 0 && dx31 < 0)) c3++;
-			break;
-		case left_top:
-			if (dx12 > 0 || (dx12 == 0 && dy12 > 0)) c1++;
-			if (dx23 > 0 || (dx23 == 0 && dy23 > 0)) c2++;
-			if (dx31 > 0 || (dx31 == 0 && dy31 > 0)) c3++;
-			break;
-		case right_top:
-			if (dx12 > 0 || (dx12 == 0 && dy12 < 0)) c1++;
-			if (dx23 > 0 || (dx23 == 0 && dy23 < 0)) c2++;
-			if (dx31 > 0 || (dx31 == 0 && dy31 < 0)) c3++;
-			break;
-		case top_right:
-			if (dy12 > 0 || (dy12 == 0 && dx12 < 0)) c1++;
-			if (dy23 > 0 || (dy23 == 0 && dx23 < 0)) c2++;
-			if (dy31 > 0 || (dy31 == 0 && dx31 < 0)) c3++;
-			break;
-	}
-
-	int64_t cy1 = c1 + dx12 * (miny << FIXED_SHIFT) - dy12 * (minx << FIXED_SHIFT);
-	int64_t cy2 = c2 + dx23 * (miny << FIXED_SHIFT) - dy23 * (minx << FIXED_SHIFT);
-	int64_t cy3 = c3 + dx31 * (miny << FIXED_SHIFT) - dy31 * (minx << FIXED_SHIFT);
-
-	/* Perform rasterization */
-	buffer += miny * stride;
-	for (int64_t y = miny; y <= maxy; y++) {
-		int64_t cx1 = cy1;
-		int64_t cx2 = cy2;
-		int64_t cx3 = cy3;
+/* Colours of the triangles in a layer batch, as read back with
+ * GL_UNSIGNED_INT_8_8_8_8. Channels are either off or at full intensity so
+ * that they read back exactly at any colour depth.
+ */
+static const uint32_t layer_colors[] = {
+	0xFF0000FF, 0x00FF00FF, 0x0000FFFF, 0xFFFF00FF,
+	0xFF00FFFF, 0x00FFFFFF, 0xFFFFFFFF,
+};
 
-		for (int64_t x = minx; x <= maxx; x++) {
-			if (cx1 > 0 && cx2 > 0 && cx3 > 0) {
-				((uint32_t*)buffer)[x] = 0x00FF00FF;
-			}
 
-			cx1 -= fdy12;
-			cx2 -= fdy23;
-			cx3 -= fdy31;
-		}
+/* Software rasterise triangles into buffer, tris[i] with values[i] */
+void rast_triangles(uint32_t* buffer, const Triangle* tris, unsigned count,
+		    const uint32_t* values)
+{
+	piglit_rasterizer rast;
 
-		cy1 += fdx12;
-		cy2 += fdx23;
-		cy3 += fdx31;
+	rast.subpixel_bits = FIXED_SHIFT;
+	rast.convention = filling_convention;
+	rast.buffer = buffer;
+	rast.width = fbo_width;
+	rast.height = fbo_height;
+	rast.stride = fbo_width;
 
-		buffer += stride;
-	}
+	piglit_rasterize_triangles(&rast, &tris[0][0].x, count, values);
 }
 
 
-/* Prints an ascii representation of the triangle */
-void triangle_art(uint32_t* buffer)
+/* Prints an ascii representation of the triangle in a region of buffer */
+void triangle_art(uint32_t* buffer, int x0, int y0, int width, int height)
 {
-	int minx = fbo_width - 1, miny = fbo_height - 1;
-	int maxx = 0, maxy = 0;
+	int minx = x0 + width - 1, miny = y0 + height - 1;
+	int maxx = x0, maxy = y0;
 
 	/* Find bounds so we dont have to print whole screen */
-	for (int y = 0; y < fbo_height; ++y) {
-		for (int x = 0; x < fbo_width; ++x) {
+	for (int y = y0; y < y0 + height; ++y) {
+		for (int x = x0; x < x0 + width; ++x) {
 			if (buffer[y*fbo_width + x] & 0xFFFFFF00) {
 				if (x < minx) minx = x;
 				if (y < miny) miny = y;
@@ -316,8 +186,10 @@ void triangle_art(uint32_t* buffer)
 	if (minx > maxx || miny > maxy)
 		return;
 
-	--minx; --miny;
-	++maxx; ++maxy;
+	minx = std::max(minx - 1, 0);
+	miny = std::max(miny - 1, 0);
+	maxx = std::min(maxx + 1, fbo_width - 1);
+	maxy = std::min(maxy + 1, fbo_height - 1);
 
 	/* Print an ascii representation of triangle */
 	for (int y = maxy; y >= miny; --y) {
@@ -344,6 +216,23 @@ void triangle_art(uint32_t* buffer)
 }
 
 
+/* Checks a region of buffer for any colour other than black or yellow */
+bool check_region(const uint32_t* buffer, int x0, int y0, int width, int height)
+{
+	for (int y = y0; y < y0 + height; ++y) {
+		for (int x = x0; x < x0 + width; ++x) {
+			uint32_t val = buffer[y*fbo_width + x] & 0xFFFFFF00;
+
+			if (val != 0 && val != 0xFFFF0000) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
 /* Reads buffer from OpenGL and checks for any colour other than black or yellow
  * (black = background, yellow = both opengl AND software rast drew to that pixel)
  */
@@ -354,47 +243,54 @@ uint32_t* check_triangle()
 
 	glReadPixels(0, 0, fbo_width, fbo_height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, buffer);
 
-	for (int y = 0; y < fbo_height; ++y) {
-		for (int x = 0; x < fbo_width; ++x) {
-			uint32_t val = buffer[y*fbo_width + x] & 0xFFFFFF00;
-
-			if (val != 0 && val != 0xFFFF0000) {
-				return buffer;
-			}
-		}
-	}
+	if (!check_region(buffer, 0, 0, fbo_width, fbo_height))
+		return buffer;
 
 	return NULL;
 }
 
 
-/* Performs test using tri */
-GLboolean test_triangle(const Triangle& tri)
+/* Draws tris with both the software rasteriser and OpenGL */
+void draw_triangles(const Triangle* tris, unsigned count)
 {
 	static uint32_t* buffer = 0;
 	if (!buffer) buffer = new uint32_t[fbo_width * fbo_height];
+	const std::vector<uint32_t> green(count, 0x00FF00FF);
 
 	/* Clear OpenGL and software buffer */
 	glClear(GL_COLOR_BUFFER_BIT);
 	memset(buffer, 0, sizeof(uint32_t) * fbo_width * fbo_height);
 
-	/* Software rasterise triangle and blit it to OpenGL */
-	rast_triangle((uint8_t*)buffer, fbo_width * 4, tri);
+	/* Software rasterise triangles and blit them to OpenGL */
+	rast_triangles(buffer, tris, count, &green[0]);
 	glDrawPixels(fbo_width, fbo_height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, buffer);
 
-	/* Draw OpenGL triangle */
+	/* Draw OpenGL triangles */
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, 0, tri.v);
-	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glVertexPointer(2, GL_FLOAT, 0, tris);
+	glDrawArrays(GL_TRIANGLES, 0, 3 * count);
 	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+void print_fail(int id, const Triangle& tri)
+{
+	printf("FAIL: %d. (%f, %f), (%f, %f), (%f, %f)\n", id,
+	       tri[0].x, tri[0].y, tri[1].x, tri[1].y, tri[2].x, tri[2].y);
+}
+
+
+/* Performs test using tri */
+GLboolean test_triangle(const Triangle& tri)
+{
+	draw_triangles(&tri, 1);
 
 	/* Check the result and print relevant error messages */
 	if (uint32_t* result = check_triangle()) {
-		printf("FAIL: %d. (%f, %f), (%f, %f), (%f, %f)\n", test_id,
-		       tri[0].x, tri[0].y, tri[1].x, tri[1].y, tri[2].x, tri[2].y);
+		print_fail(test_id, tri);
 
 		if (print_triangle) {
-			triangle_art(result);
+			triangle_art(result, 0, 0, fbo_width, fbo_height);
 		}
 
 		fflush(stdout);
@@ -405,10 +301,148 @@ GLboolean test_triangle(const Triangle& tri)
 }
 
 
-/* Generate a random triangle */
-void random_triangle(Triangle& tri)
+/* Performs the tests in tris with a single readback. Each triangle must lie
+ * in its own cell of the batch grid, tris[i] in cell i, and have test id
+ * ids[i]. Returns the number of failed tests.
+ */
+int test_triangle_batch(const std::vector<Triangle>& tris,
+			const std::vector<int>& ids)
+{
+	const int cols = fbo_width / batch_cell_size;
+	int fail_count = 0;
+
+	draw_triangles(&tris[0], tris.size());
+
+	uint32_t* result = check_triangle();
+	if (!result)
+		return 0;
+
+	/* Find the cells that failed */
+	for (unsigned i = 0; i < tris.size(); ++i) {
+		const int x = (i % cols) * batch_cell_size;
+		const int y = (i / cols) * batch_cell_size;
+
+		if (check_region(result, x, y, batch_cell_size, batch_cell_size))
+			continue;
+
+		print_fail(ids[i], tris[i]);
+
+		if (print_triangle) {
+			triangle_art(result, x, y, batch_cell_size, batch_cell_size);
+		}
+
+		++fail_count;
+	}
+
+	/* The bad pixels must be outside of all cells */
+	if (!fail_count) {
+		printf("FAIL: %d-%d. Fragments outside of the triangle cells\n",
+		       ids.front(), ids.back());
+		fail_count = 1;
+	}
+
+	fflush(stdout);
+	return fail_count;
+}
+
+
+/* Performs the tests in tris, which may overlap, with a single readback.
+ * tris[i] has test id ids[i] and is drawn in layer_colors[i] without
+ * blending, so every pixel must show the last triangle covering it in both
+ * OpenGL and the software rasteriser; parts hidden by later triangles go
+ * unchecked. Returns the number of failed tests.
+ */
+int test_triangle_layers(const std::vector<Triangle>& tris,
+			 const std::vector<int>& ids)
 {
-	int size = 1 << (mersenne.value() % (log2i(fbo_width) + 1));
+	static uint32_t* expected = 0;
+	static uint32_t* result = 0;
+	if (!expected) expected = new uint32_t[fbo_width * fbo_height];
+	if (!result) result = new uint32_t[fbo_width * fbo_height];
+	std::vector<bool> failed(tris.size(), false);
+	bool mismatch = false;
+	int fail_count = 0;
+
+	assert(tris.size() <= ARRAY_SIZE(layer_colors));
+
+	/* Software rasterise the layers */
+	memset(expected, 0, sizeof(uint32_t) * fbo_width * fbo_height);
+	rast_triangles(expected, &tris[0], tris.size(), layer_colors);
+
+	/* Draw OpenGL triangles, each in its own colour */
+	glDisable(GL_BLEND);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, &tris[0]);
+	for (unsigned i = 0; i < tris.size(); ++i) {
+		const uint32_t c = layer_colors[i];
+
+		glColor4ub(c >> 24, (c >> 16) & 0xFF, (c >> 8) & 0xFF, 0xFF);
+		glDrawArrays(GL_TRIANGLES, 3 * i, 3);
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	glColor4f(1.0f, 0.0f, 0.0f, 1.0f);
+	glEnable(GL_BLEND);
+
+	glReadPixels(0, 0, fbo_width, fbo_height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, result);
+
+	/* Find the triangles that failed */
+	for (int k = 0; k < fbo_width * fbo_height; ++k) {
+		const uint32_t want = expected[k] & 0xFFFFFF00;
+		const uint32_t got = result[k] & 0xFFFFFF00;
+
+		if (want == got)
+			continue;
+
+		mismatch = true;
+		for (unsigned i = 0; i < tris.size(); ++i) {
+			const uint32_t c = layer_colors[i] & 0xFFFFFF00;
+
+			if (c == want || c == got)
+				failed[i] = true;
+		}
+	}
+
+	if (!mismatch)
+		return 0;
+
+	/* A pixel shows two triangles, so retest them alone to find the
+	 * one that is wrong
+	 */
+	for (unsigned i = 0; i < tris.size(); ++i) {
+		if (!failed[i])
+			continue;
+
+		draw_triangles(&tris[i], 1);
+
+		if (uint32_t* art = check_triangle()) {
+			print_fail(ids[i], tris[i]);
+
+			if (print_triangle) {
+				triangle_art(art, 0, 0, fbo_width, fbo_height);
+			}
+
+			++fail_count;
+		}
+	}
+
+	/* Every triangle is right on its own */
+	if (!fail_count) {
+		printf("FAIL: %d-%d. Triangles differ when drawn together\n",
+		       ids.front(), ids.back());
+		fail_count = 1;
+	}
+
+	fflush(stdout);
+	return fail_count;
+}
+
+
+/* Generate a random triangle inside [0, max_size) x [0, max_size) */
+void random_triangle(Triangle& tri, int max_size)
+{
+	int size = 1 << (mersenne.value() % (log2i(max_size) + 1));
 
 	for (int i = 0; i < 3; ++i) {
 		tri[i].x = (mersenne.value() % (size * FIXED_ONE)) * (1.0f / FIXED_ONE);
@@ -419,6 +453,70 @@ void random_triangle(Triangle& tri)
 }
 
 
+/* Whether tri lies inside [0, batch_cell_size) x [0, batch_cell_size) */
+bool fits_cell(const Triangle& tri)
+{
+	for (int i = 0; i < 3; ++i) {
+		if (tri[i].x >= batch_cell_size || tri[i].y >= batch_cell_size)
+			return false;
+	}
+
+	return true;
+}
+
+
+/* Performs count random tests. Triangles that fit in a cell are packed into
+ * the grid, as many as there are batch cells, and larger ones are drawn in
+ * layer batches. Returns the number of failed tests.
+ */
+int test_random_batches(int count)
+{
+	const int cols = fbo_width / batch_cell_size;
+	const unsigned per_batch = cols * (fbo_height / batch_cell_size);
+	std::vector<Triangle> cells, layers;
+	std::vector<int> cell_ids, layer_ids;
+	int fail_count = 0;
+
+	for (int i = 0; i < count && !(fail_count && break_on_fail); ++i) {
+		const bool last = i == count - 1;
+		Triangle tri;
+
+		random_triangle(tri, fbo_width);
+
+		if (fits_cell(tri)) {
+			const unsigned cell = cells.size();
+
+			/* Whole pixel offsets don't change rasterization */
+			for (int j = 0; j < 3; ++j) {
+				tri[j].x += (cell % cols) * batch_cell_size;
+				tri[j].y += (cell / cols) * batch_cell_size;
+			}
+
+			cells.push_back(tri);
+			cell_ids.push_back(test_id);
+		} else {
+			layers.push_back(tri);
+			layer_ids.push_back(test_id);
+		}
+
+		if (cells.size() == per_batch || (last && !cells.empty())) {
+			fail_count += test_triangle_batch(cells, cell_ids);
+			cells.clear();
+			cell_ids.clear();
+		}
+
+		if (layers.size() == ARRAY_SIZE(layer_colors) ||
+		    (last && !layers.empty())) {
+			fail_count += test_triangle_layers(layers, layer_ids);
+			layers.clear();
+			layer_ids.clear();
+		}
+	}
+
+	return fail_count;
+}
+
+
 /* From the OpenGL 1.4 spec page 78 (page 91 of PDF):
  * "Special treatment is given to a fragment whose center lies on a polygon
  * boundary edge. In such a case we require that if two polygons lie on either
@@ -503,7 +601,7 @@ void get_filling_convention(void)
 	int produced_fragment_count = 0;
 	for (int i = 0; i < 8; ++i) {
 		if ((buffer[i] & 0xFFFFFF00) == 0xFFFFFF00) {
-			filling_convention = (filling_convention_t)i;
+			filling_convention = (piglit_fill_convention)i;
 			produced_fragment_count++;
 		}
 	}
@@ -573,12 +671,17 @@ piglit_display(void)
 		}
 
 		printf("Running %d random tests\n", random_test_count);
-		for (int i = 0; i < random_test_count && !(fail_count && break_on_fail); ++i) {
-			Triangle tri;
-			random_triangle(tri);
-
-			if (!test_triangle(tri))
-				++fail_count;
+		if (batch) {
+			if (!(fail_count && break_on_fail))
+				fail_count += test_random_batches(random_test_count);
+		} else {
+			for (int i = 0; i < random_test_count && !(fail_count && break_on_fail); ++i) {
+				Triangle tri;
+				random_triangle(tri, fbo_width);
+
+				if (!test_triangle(tri))
+					++fail_count;
+			}
 		}
 
 		printf("Failed %d tests\n", fail_count);
@@ -587,9 +690,14 @@ piglit_display(void)
 		if (fail_count)
 			pass = GL_FALSE;
 	} else {
-		Triangle tri;
-		random_triangle(tri);
-		pass &= test_triangle(tri);
+		if (batch) {
+			pass &= test_random_batches((fbo_width / batch_cell_size) *
+						    (fbo_height / batch_cell_size)) == 0;
+		} else {
+			Triangle tri;
+			random_triangle(tri, fbo_width);
+			pass &= test_triangle(tri);
+		}
 
 		glDisable(GL_BLEND);
 
@@ -705,6 +813,8 @@ piglit_init(int argc, char **argv)
 		} else if (strcmp(argv[i], "-use_fbo") == 0){
 			use_fbo = true;
 			printf("FBOs are in use\n");
+		} else if (strcmp(argv[i], "-batch") == 0){
+			batch = true;
 		} else if (i + 1 < argc) {
 			if (strcmp(argv[i], "-count") == 0) {
 				random_test_count = strtoul(argv[++i], NULL, 0);
@@ -712,10 +822,26 @@ piglit_init(int argc, char **argv)
 				seed = strtoul(argv[++i], NULL, 0);
 			} else if (strcmp(argv[i], "-subpixel_bits") == 0) {
 				in_subpixel_bits = strtoul(argv[++i], NULL, 0);
+			} else if (strcmp(argv[i], "-cell_size") == 0) {
+				batch_cell_size = strtoul(argv[++i], NULL, 0);
 			}
 		}
 	}
 
+	if (batch) {
+		if (batch_cell_size < 1 ||
+		    batch_cell_size > std::min(fbo_width, fbo_height)) {
+			printf("Invalid cell size %d\n", batch_cell_size);
+			piglit_report_result(PIGLIT_FAIL);
+		}
+
+		printf("Testing batches of %d triangles in %dx%d cells, "
+		       "and of %d larger ones in layers\n",
+		       (fbo_width / batch_cell_size) * (fbo_height / batch_cell_size),
+		       batch_cell_size, batch_cell_size,
+		       (int)ARRAY_SIZE(layer_colors));
+	}
+
 	FIXED_SHIFT = in_subpixel_bits;
 	FIXED_ONE = 1 << FIXED_SHIFT;
 
@@ -32,6 +32,8 @@
 // environ.cpp:  implementation of test environment class
 
 #include "environ.h"
+#include "dsurf.h"
+#include "rc.h"
 
 #if defined(__UNIX__)
 #include <sys/stat.h>
@@ -61,4 +63,53 @@ Environment::Environment(Options& opt):
 {
 } // Environment::Environment()
 
+Environment::~Environment() {
+	releaseSurfaces();
+} // Environment::~Environment()
+
+///////////////////////////////////////////////////////////////////////////////
+// Shared windows and rendering contexts
+///////////////////////////////////////////////////////////////////////////////
+Window&
+Environment::window(DrawingSurfaceConfig& c, int width, int height) {
+	WindowKey key(&c, make_pair(width, height));
+	map<WindowKey, Window*>::iterator p = windows.find(key);
+	if (p != windows.end())
+		return *p->second;
+
+	Window* w = new Window(winSys, c, width, height);
+	windows[key] = w;
+	return *w;
+} // Environment::window
+
+RenderingContext&
+Environment::context(DrawingSurfaceConfig& c) {
+	// A context can be bound to any window with the same
+	// configuration, so one is enough for all window sizes.
+	map<DrawingSurfaceConfig*, RenderingContext*>::iterator p =
+		contexts.find(&c);
+	if (p != contexts.end())
+		return *p->second;
+
+	RenderingContext* rc = new RenderingContext(winSys, c);
+	contexts[&c] = rc;
+	return *rc;
+} // Environment::context
+
+void
+Environment::releaseSurfaces() {
+	if (windows.empty() && contexts.empty())
+		return;
+
+	winSys.makeCurrent();
+	for (map<DrawingSurfaceConfig*, RenderingContext*>::iterator p =
+	     contexts.begin(); p != contexts.end(); ++p)
+		delete p->second;
+	contexts.clear();
+	for (map<WindowKey, Window*>::iterator p = windows.begin();
+	     p != windows.end(); ++p)
+		delete p->second;
+	windows.clear();
+} // Environment::releaseSurfaces
+
 } // namespace GLEAN
@@ -41,17 +41,23 @@
 #define __environ_h__
 
 #include <iostream>
+#include <map>
+#include <utility>
 #include "options.h"
 #include "winsys.h"
 
 namespace GLEAN {
 
 class Image;			// Forward and mutually-recursive references.
+class Window;
+class RenderingContext;
+class DrawingSurfaceConfig;
 
 class Environment {
     public:
     	// Constructors:
 	Environment(Options& opt);
+	~Environment();
 
 	// Exceptions:
 	struct Error { };	// Base class for all errors.
@@ -69,6 +75,19 @@ class Environment {
 
 	WindowSystem winSys;	// The window system providing the OpenGL
 				// implementation under test.
+
+	// Windows and rendering contexts for drawing surface
+	// configurations.  They are created on first use and kept until
+	// releaseSurfaces() is called, so in batch mode every test
+	// that uses a configuration shares them.
+	Window& window(DrawingSurfaceConfig& c, int width, int height);
+	RenderingContext& context(DrawingSurfaceConfig& c);
+	void releaseSurfaces();
+
+    private:
+	typedef pair<DrawingSurfaceConfig*, pair<int, int> > WindowKey;
+	map<WindowKey, Window*> windows;
+	map<DrawingSurfaceConfig*, RenderingContext*> contexts;
 }; // class Environment
 
 } // namespace GLEAN
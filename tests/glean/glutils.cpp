@@ -120,6 +120,35 @@ logGLErrors(Environment& env) {
 		env.log << "\tOpenGL error: " << piglit_get_gl_error_name(err) << '\n';
 } // logGLErrors
 
+///////////////////////////////////////////////////////////////////////////////
+// pushState, popState: Save and restore the state of the current context.
+//	The attribute stacks cover the fixed-function state; program and
+//	framebuffer bindings aren't part of any attribute group, so they
+//	are reset to the defaults instead.
+///////////////////////////////////////////////////////////////////////////////
+void
+pushState() {
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_ALL_ATTRIB_BITS);
+} // pushState
+
+void
+popState() {
+	// Unbind any framebuffer object first, so that the draw and read
+	// buffers are restored to the window.
+	if (getVersion() >= 2.0)
+		glUseProgram(0);
+	if (haveExtension("GL_EXT_framebuffer_object"))
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+	glPopClientAttrib();
+	glPopAttrib();
+
+	// Don't leave errors behind for the next test to report.
+	while (glGetError())
+		;
+} // popState
+
 } // namespace GLUtils
 
 } // namespace GLEAN
@@ -60,6 +60,12 @@ float getVersion();
 // Check for OpenGL errors and log any that have occurred:
 void logGLErrors(Environment& env);
 
+// Save the state of the current context, and return to it after a
+// test has run, so that tests sharing a context don't see each
+// other's state:
+void pushState();
+void popState();
+
 } // namespace GLUtils
 
 } // namespace GLEAN
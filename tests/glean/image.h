@@ -63,6 +63,8 @@ class Image {
 		vbPixelSizeInBytes = 2,
 		vbPacker = 4,
 		vbUnpacker = 8,
+		vbFloatPacker = 16,
+		vbFloatUnpacker = 32,
 		vbAll = ~0
 	};
 	int _invalid;
@@ -80,6 +82,12 @@ class Image {
 	typedef void Packer(GLsizei n, char* nextPixel, double* rgba);
 	Packer* _packer;
 	Packer* validatePacker();
+	typedef void FloatUnpacker(GLsizei n, float* rgba, char* nextPixel);
+	FloatUnpacker* _floatUnpacker;
+	FloatUnpacker* validateFloatUnpacker();
+	typedef void FloatPacker(GLsizei n, char* nextPixel, float* rgba);
+	FloatPacker* _floatPacker;
+	FloatPacker* validateFloatPacker();
 
 	// For now, we will require that:
 	// 1.  All images are in native byte order (so that byte swapping
@@ -160,7 +168,9 @@ class Image {
 			  vbRowSizeInBytes
 			| vbPixelSizeInBytes
 			| vbPacker
-			| vbUnpacker);
+			| vbUnpacker
+			| vbFloatPacker
+			| vbFloatUnpacker);
 	}
 
 	inline GLenum type() const	// Pixel data type.  Currently
@@ -174,7 +184,9 @@ class Image {
 			  vbRowSizeInBytes
 			| vbPixelSizeInBytes
 			| vbPacker
-			| vbUnpacker);
+			| vbUnpacker
+			| vbFloatPacker
+			| vbFloatUnpacker);
 	}
 
 	inline char* pixels() 		// The pixels.
@@ -205,6 +217,11 @@ class Image {
 
 	void unpack(GLsizei n, double* rgba, char* nextPixel);
 	void pack(GLsizei n, char* nextPixel, double* rgba);
+
+	// The same in single precision.  These are the faster choice for
+	// bulk comparisons of whole images.
+	void unpack(GLsizei n, float* rgba, char* nextPixel);
+	void pack(GLsizei n, char* nextPixel, float* rgba);
 	// XXX get(x, y, double* rgba);
 	// XXX put(x, y, double* rgba);
 
@@ -82,6 +82,8 @@ main(int argc, char* argv[]) {
 			o.overwrite = true;
 		} else if (!strcmp(argv[i], "--quick")) {
 			o.quick = true;
+		} else if (!strcmp(argv[i], "--batch")) {
+			o.batch = true;
 		} else if (!strcmp(argv[i], "--visuals")) {
 			visFilter = true;
 			++i;
@@ -119,10 +121,21 @@ main(int argc, char* argv[]) {
 	// results.
 	try {
 		Environment e(o);
-		for (Test* t = Test::testList; t; t = t->nextTest)
-			if (binary_search(o.selectedTests.begin(),
-			    o.selectedTests.end(), t->name))
-				t->run(e);
+		if (o.batch) {
+			// Run the tests in sorted order, so that piglit can
+			// tell which test was running if we die part way.
+			for (vector<string>::const_iterator n =
+			     o.selectedTests.begin();
+			     n != o.selectedTests.end(); ++n)
+				for (Test* t = Test::testList; t; t = t->nextTest)
+					if (t->name == *n)
+						t->run(e);
+		} else {
+			for (Test* t = Test::testList; t; t = t->nextTest)
+				if (binary_search(o.selectedTests.begin(),
+				    o.selectedTests.end(), t->name))
+					t->run(e);
+		}
 	}
 #if defined(__X11__)
 	catch (WindowSystem::CantOpenDisplay) {
@@ -271,6 +284,8 @@ usage(char* command) {
 "                                  # pixel formats) to test\n"
 "       (-t|--tests) {(+|-)test}   # choose tests to include (+) or exclude (-)\n"
 "       --quick                    # run fewer tests to reduce test time\n"
+"       --batch                    # reuse windows and contexts between\n"
+"                                  # tests, print a PIGLIT: line per test\n"
 "       --listtests                # list test names and exit\n"
 "       --help                     # display usage information\n"
 #if defined(__X11__)
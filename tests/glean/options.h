@@ -74,6 +74,8 @@ class Options {
 	bool overwrite;		// overwrite old results database if exists
 
 	bool quick;		// run fewer/quicker tests when possible
+	bool batch;		// share windows and contexts between tests,
+				// and report a PIGLIT: result for each test
 
 #if defined(__X11__)
 	string dpyName;		// Name of the X11 display providing the
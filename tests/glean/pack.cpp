@@ -36,22 +36,35 @@
 
 namespace {
 
-#define SCALE (static_cast<double>(num) / static_cast<double>(denom))
-#define BIAS (static_cast<double>(bias) / static_cast<double>(denom))
+#define SCALE (static_cast<C>(num) / static_cast<C>(denom))
+#define BIAS (static_cast<C>(bias) / static_cast<C>(denom))
 
 // The original implementation of packing functions (using function
 // templates) wouldn't compile under VC6, but this slight variant
 // using static member functions in a class template will compile.
+//
+// T is the type of the components being packed, double or float.  The
+// arithmetic is done in T too, except for 32 bit integer components, which
+// float can't represent exactly.
 
-template<class component, int num, unsigned int denom, int bias>
+template<class T, class component>
+struct Calc {
+	typedef T type;
+};
+template<> struct Calc<float, GLint> { typedef double type; };
+template<> struct Calc<float, GLuint> { typedef double type; };
+
+template<class T, class component, unsigned int num, unsigned int denom,
+	int bias>
 class Pack
 {
+	typedef typename Calc<T, component>::type C;
 public :
 	// pack_l
-	static void pack_l(GLsizei n, char* dst, double* rgba) 
+	static void pack_l(GLsizei n, char* dst, T* rgba) 
 	{
 		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
+		T* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias)
 				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
@@ -62,10 +75,10 @@ public :
 	}
 
 	// pack_la
-	static void pack_la(GLsizei n, char* dst, double* rgba) 
+	static void pack_la(GLsizei n, char* dst, T* rgba) 
 	{
 		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
+		T* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
@@ -79,10 +92,10 @@ public :
 	}
 
 	// pack_rga
-	static void pack_rgb(GLsizei n, char* dst, double* rgba) 
+	static void pack_rgb(GLsizei n, char* dst, T* rgba) 
 	{
 		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
+		T* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
@@ -97,25 +110,42 @@ public :
 		}
 	}
 
-	// pack_rgba
-	static void pack_rgba(GLsizei n, char* dst, double* rgba) 
+	// pack_rgba:  the layouts match, so 8 and 16 bit components are
+	// converted in blocks of a fixed size, as in unpack.cpp.
+	static void pack_rgba(GLsizei n, char* dst, T* rgba) 
 	{
 		component* out = reinterpret_cast<component*>(dst);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				out[0] = static_cast<component>(SCALE * rgba[0] - BIAS);
-				out[1] = static_cast<component>(SCALE * rgba[1] - BIAS);
-				out[2] = static_cast<component>(SCALE * rgba[2] - BIAS);
-				out[3] = static_cast<component>(SCALE * rgba[3] - BIAS);
-			} else {
-				out[0] = static_cast<component>(SCALE * rgba[0]);
-				out[1] = static_cast<component>(SCALE * rgba[1]);
-				out[2] = static_cast<component>(SCALE * rgba[2]);
-				out[3] = static_cast<component>(SCALE * rgba[3]);
+		GLsizei i = 0;
+		if (sizeof(component) > 2) {
+			for (; i < 4 * n; i += 4) {
+				out[i + 0] = convert(rgba[i + 0]);
+				out[i + 1] = convert(rgba[i + 1]);
+				out[i + 2] = convert(rgba[i + 2]);
+				out[i + 3] = convert(rgba[i + 3]);
 			}
-			out += 4;
+			return;
 		}
+
+		for (; i + BLOCK <= 4 * n; i += BLOCK) {
+			component tmp[BLOCK];
+			for (int j = 0; j < BLOCK; ++j)
+				tmp[j] = convert(rgba[i + j]);
+			for (int j = 0; j < BLOCK; ++j)
+				out[i + j] = tmp[j];
+		}
+		for (; i < 4 * n; ++i)
+			out[i] = convert(rgba[i]);
+	}
+
+private :
+	enum { BLOCK = 16 };
+
+	static inline component convert(T c)
+	{
+		if (bias)
+			return static_cast<component>(SCALE * c - BIAS);
+		else
+			return static_cast<component>(SCALE * c);
 	}
 
 };	// class Pack
@@ -123,140 +153,135 @@ public :
 #undef SCALE
 #undef BIAS
 
-}; // anonymous namespace
-
-
-namespace GLEAN {
-
-///////////////////////////////////////////////////////////////////////////////
-// Public interface
-///////////////////////////////////////////////////////////////////////////////
-void
-Image::pack(GLsizei n, char* nextPixel, double* rgba) {
-	(*(valid(vbPacker)? _packer: validatePacker())) (n, nextPixel, rgba);
-}
+template<class T>
+struct PackFn {
+	typedef void Fn(GLsizei n, char* dst, T* rgba);
+};
 
 ///////////////////////////////////////////////////////////////////////////////
-// validatePacker - select appropriate pixel-packing utility
+// selectPacker - select the packing utility for a format and type, and
+// components of type T
 ///////////////////////////////////////////////////////////////////////////////
-
-Image::Packer*
-Image::validatePacker() {
-	switch (format()) {
+template<class T>
+typename PackFn<T>::Fn*
+selectPacker(GLenum format, GLenum type) {
+	switch (format) {
 	case GL_LUMINANCE:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_l;
-			break;
+			return Pack<T, GLbyte, 255, 2, 1>::pack_l;
 		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_l;
-			break;
+			return Pack<T, GLubyte, 255, 1, 0>::pack_l;
 		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_l;
-			break;
+			return Pack<T, GLshort, 65535, 2, 1>::pack_l;
 		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_l;
-			break;
+			return Pack<T, GLushort, 65535, 1, 0>::pack_l;
 		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_l;
-			break;
+			return Pack<T, GLint, 4294967295U, 2, 1>::pack_l;
 		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_l;
-			break;
+			return Pack<T, GLuint, 4294967295U, 1, 0>::pack_l;
 		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_l;
-			break;
+			return Pack<T, GLfloat, 1, 1, 0>::pack_l;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	case GL_LUMINANCE_ALPHA:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_la;
-			break;
+			return Pack<T, GLbyte, 255, 2, 1>::pack_la;
 		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_la;
-			break;
+			return Pack<T, GLubyte, 255, 1, 0>::pack_la;
 		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_la;
-			break;
+			return Pack<T, GLshort, 65535, 2, 1>::pack_la;
 		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_la;
-			break;
+			return Pack<T, GLushort, 65535, 1, 0>::pack_la;
 		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_la;
-			break;
+			return Pack<T, GLint, 4294967295U, 2, 1>::pack_la;
 		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_la;
-			break;
+			return Pack<T, GLuint, 4294967295U, 1, 0>::pack_la;
 		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_la;
-			break;
+			return Pack<T, GLfloat, 1, 1, 0>::pack_la;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	case GL_RGB:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_rgb;
-			break;
+			return Pack<T, GLbyte, 255, 2, 1>::pack_rgb;
 		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_rgb;
-			break;
+			return Pack<T, GLubyte, 255, 1, 0>::pack_rgb;
 		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_rgb;
-			break;
+			return Pack<T, GLshort, 65535, 2, 1>::pack_rgb;
 		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_rgb;
-			break;
+			return Pack<T, GLushort, 65535, 1, 0>::pack_rgb;
 		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_rgb;
-			break;
+			return Pack<T, GLint, 4294967295U, 2, 1>::pack_rgb;
 		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_rgb;
-			break;
+			return Pack<T, GLuint, 4294967295U, 1, 0>::pack_rgb;
 		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_rgb;
-			break;
+			return Pack<T, GLfloat, 1, 1, 0>::pack_rgb;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	case GL_RGBA:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_packer = Pack<GLbyte, 255, 2, 1>::pack_rgba;
-			break;
+			return Pack<T, GLbyte, 255, 2, 1>::pack_rgba;
 		case GL_UNSIGNED_BYTE:
-			_packer = Pack<GLubyte, 255, 1, 0>::pack_rgba;
-			break;
+			return Pack<T, GLubyte, 255, 1, 0>::pack_rgba;
 		case GL_SHORT:
-			_packer = Pack<GLshort, 65535, 2, 1>::pack_rgba;
-			break;
+			return Pack<T, GLshort, 65535, 2, 1>::pack_rgba;
 		case GL_UNSIGNED_SHORT:
-			_packer = Pack<GLushort, 65535, 1, 0>::pack_rgba;
-			break;
+			return Pack<T, GLushort, 65535, 1, 0>::pack_rgba;
 		case GL_INT:
-			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_rgba;
-			break;
+			return Pack<T, GLint, 4294967295U, 2, 1>::pack_rgba;
 		case GL_UNSIGNED_INT:
-			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_rgba;
-			break;
+			return Pack<T, GLuint, 4294967295U, 1, 0>::pack_rgba;
 		case GL_FLOAT:
-			_packer = Pack<GLfloat, 1, 1, 0>::pack_rgba;
-			break;
+			return Pack<T, GLfloat, 1, 1, 0>::pack_rgba;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	default:
-		throw BadFormat(format());
+		throw GLEAN::Image::BadFormat(format);
 	}
+} // selectPacker
+
+}; // anonymous namespace
+
+
+namespace GLEAN {
+
+///////////////////////////////////////////////////////////////////////////////
+// Public interface
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::pack(GLsizei n, char* nextPixel, double* rgba) {
+	(*(valid(vbPacker)? _packer: validatePacker())) (n, nextPixel, rgba);
+}
+
+void
+Image::pack(GLsizei n, char* nextPixel, float* rgba) {
+	(*(valid(vbFloatPacker)? _floatPacker: validateFloatPacker()))
+		(n, nextPixel, rgba);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// validatePacker - select appropriate pixel-packing utility
+///////////////////////////////////////////////////////////////////////////////
 
+Image::Packer*
+Image::validatePacker() {
+	_packer = selectPacker<double>(format(), type());
 	validate(vbPacker);
 	return _packer;
 }
 
+Image::FloatPacker*
+Image::validateFloatPacker() {
+	_floatPacker = selectPacker<float>(format(), type());
+	validate(vbFloatPacker);
+	return _floatPacker;
+}
+
 }; // namespace GLEAN
@@ -0,0 +1,129 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// packbench:  measure the throughput of Image::pack and Image::unpack for
+// every supported format and type, in double and single precision.
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include "image.h"
+
+using namespace GLEAN;
+
+namespace {
+
+const struct {
+	GLenum value;
+	const char* name;
+} formats[] = {
+	{ GL_LUMINANCE, "LUMINANCE" },
+	{ GL_LUMINANCE_ALPHA, "LUMINANCE_ALPHA" },
+	{ GL_RGB, "RGB" },
+	{ GL_RGBA, "RGBA" },
+};
+
+const struct {
+	GLenum value;
+	const char* name;
+} types[] = {
+	{ GL_BYTE, "BYTE" },
+	{ GL_UNSIGNED_BYTE, "UNSIGNED_BYTE" },
+	{ GL_SHORT, "SHORT" },
+	{ GL_UNSIGNED_SHORT, "UNSIGNED_SHORT" },
+	{ GL_INT, "INT" },
+	{ GL_UNSIGNED_INT, "UNSIGNED_INT" },
+	{ GL_FLOAT, "FLOAT" },
+};
+
+// The width and height of the image converted, a large window
+const int size = 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+// measure:  return the throughput of unpacking (or packing) every row of img,
+//	in millions of pixels per second.
+///////////////////////////////////////////////////////////////////////////////
+template<class T>
+double
+measure(Image& img, bool unpack, int repeat) {
+	std::vector<T> rgba(4 * img.width());
+	for (int i = 0; i < 4 * img.width(); ++i)
+		rgba[i] = static_cast<T>(i % 256) / 255;
+
+	// Report the best of the runs, which is the least disturbed by
+	// anything else running on the machine
+	double best = 0.0;
+	for (int n = 0; n < repeat; ++n) {
+		clock_t start = clock();
+		char* row = img.pixels();
+		for (int i = 0; i < img.height(); ++i) {
+			if (unpack)
+				img.unpack(img.width(), &rgba[0], row);
+			else
+				img.pack(img.width(), row, &rgba[0]);
+			row += img.rowSizeInBytes();
+		}
+		double seconds = static_cast<double>(clock() - start)
+			/ CLOCKS_PER_SEC;
+		if (seconds > 0.0) {
+			double rate = static_cast<double>(img.width())
+				* img.height() / seconds / 1.0e6;
+			if (rate > best)
+				best = rate;
+		}
+	}
+	return best;
+} // measure
+
+} // anonymous namespace
+
+int
+main(int argc, char** argv) {
+	int repeat = argc > 1 ? atoi(argv[1]) : 10;
+
+	printf("%-16s %-15s %14s %14s %14s %14s\n", "format", "type",
+		"unpack double", "unpack float", "pack double", "pack float");
+	printf("%-16s %-15s %14s %14s %14s %14s\n", "", "", "(Mpix/s)",
+		"(Mpix/s)", "(Mpix/s)", "(Mpix/s)");
+	for (unsigned f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+		for (unsigned t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+			Image img(size, size, formats[f].value, types[t].value);
+			printf("%-16s %-15s %14.1f %14.1f %14.1f %14.1f\n",
+				formats[f].name, types[t].name,
+				measure<double>(img, true, repeat),
+				measure<float>(img, true, repeat),
+				measure<double>(img, false, repeat),
+				measure<float>(img, false, repeat));
+		}
+
+	return 0;
+}
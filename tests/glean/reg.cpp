@@ -32,6 +32,7 @@
 // Image registration.
 
 #include <cfloat>
+#include <vector>
 #include "image.h"
 
 #include <cmath>	// for fabs
@@ -39,6 +40,43 @@
 
 namespace GLEAN {
 
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// unpackPlane:  unpack a whole image into one RGBA float per sample, with the
+//	rows stored consecutively.
+///////////////////////////////////////////////////////////////////////////////
+void
+unpackPlane(Image& img, std::vector<float>& plane) {
+	int w4 = 4 * img.width();
+
+	plane.resize(w4 * img.height());
+	char* p = img.pixels();
+	for (int i = 0; i < img.height(); ++i) {
+		img.unpack(img.width(), &plane[i * w4], p);
+		p += img.rowSizeInBytes();
+	}
+} // unpackPlane
+
+///////////////////////////////////////////////////////////////////////////////
+// rowError:  sum of absolute differences between n RGBA samples.  Each
+//	channel has its own accumulator, so that the compiler can vectorize
+//	the loop without reordering the floating point additions.
+///////////////////////////////////////////////////////////////////////////////
+inline float
+rowError(const float* ref, const float* test, int n) {
+	float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+	for (int m = 0; m < n; m += 4) {
+		r += std::fabs(ref[m + 0] - test[m + 0]);
+		g += std::fabs(ref[m + 1] - test[m + 1]);
+		b += std::fabs(ref[m + 2] - test[m + 2]);
+		a += std::fabs(ref[m + 3] - test[m + 3]);
+	}
+	return r + g + b + a;
+} // rowError
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // register:  compare a reference image to the current (``test'') image.
 //
@@ -53,6 +91,13 @@ namespace GLEAN {
 //	Returns an Image::Registration struct that specifies the position at
 //	which the sum of mean absolute errors was minimal, plus the statistics
 //	at that position.
+//
+//	Every position has the same number of samples, so the position with
+//	the minimal sum of means is the one with the minimal total absolute
+//	error.  That is computed over float copies of both images, a row at
+//	a time, and a position is abandoned as soon as its partial total
+//	reaches the best total so far.  Only the winning position is then
+//	sampled into the BasicStats.
 ///////////////////////////////////////////////////////////////////////////////
 Image::Registration
 Image::reg(Image& ref) {
@@ -62,113 +107,62 @@ Image::reg(Image& ref) {
 	int hr = ref.height();		// Height of test image, in pixels.
 	int dh = ht - hr;		// Difference in heights, in pixels.
 	int dw = wt - wr;		// Difference in widths, in pixels.
-	int i;
 
 	if (dh < 0 || dw < 0)
 		throw RefImageTooLarge();
 
 	int wt4 = 4 * wt;		// Width of test image, in RGBA samples.
 	int wr4 = 4 * wr;		// Width of ref image, in RGBA samples.
-	int dw4 = 4 * dw;		// Difference in widths, in samples.
-
-	double** testPix;		// Buffers containing all the rows of
-					// the test image that need to be
-					// accessed concurrently.
-	// XXX sure would be nice to use auto_ptr to allocate this stuff,
-	// but it isn't supported in the STL that came with egcs 1.1.2.
-	
-	// XXX testPix = new (double*) [dh + 1];
-	// VC 6 seems to misinterpret this as a c-style cast
-	testPix = new double* [dh + 1];
-
-	
-	for (/*int */i = 0; i <= dh; ++i)
-		testPix[i] = new double [wt4];
-
-	double* refPix = new double [wr4];
-					// Buffer containing the one row of
-					// the reference image that's accessed
-					// at any given time.
-
-	BasicStats** stats;		// Buffers containing a statistics-
-					// gathering structure for each of
-					// the possible reference image
-					// positions.
-	// XXX stats = new (BasicStats*) [dh + 1];
-	// VC 6 seems to misinterpret this as a c-style cast
-	stats = new BasicStats * [dh + 1];
-
-	for (/*int*/ i = 0; i <= dh; ++i)
-		stats[i] = new BasicStats [dw4 + 4];
-
-	// Prime the pump by unpacking the first few rows of the test image:
-	char* testRow = pixels();
-	for (/*int*/ i = 0; i < dh; ++i) {
-		unpack(wt, testPix[i], testRow);
-		testRow += rowSizeInBytes();
-	}
-
-	// Now accumulate statistics for one row of the reference image
-	// at a time, in all possible positions:
-	char* refRow = ref.pixels();
-	for (/*int*/ i = 0; i < hr; ++i) {
-		// Get the next row of the reference image:
-		ref.unpack(wr, refPix, refRow);
-		refRow += ref.rowSizeInBytes();
-
-		// Get the next row of the test image:
-		unpack(wt, testPix[dh], testRow);
-		testRow += rowSizeInBytes();
 
-		// Accumulate absolute error for R,G,B,A in all positions:
-		for (int j = 0; j <= dh; ++j)
-			for (int k = 0; k <= dw4; k += 4)
-				for (int m = 0; m < wr4; m += 4) {
-					stats[j][k+0].sample( fabs(
-						refPix[m+0]-testPix[j][m+k+0]));
-					stats[j][k+1].sample( fabs(
-						refPix[m+1]-testPix[j][m+k+1]));
-					stats[j][k+2].sample( fabs(
-						refPix[m+2]-testPix[j][m+k+2]));
-					stats[j][k+3].sample( fabs(
-						refPix[m+3]-testPix[j][m+k+3]));
-				}
-	}
-
-	// Now find the position for which the sum of the mean absolute errors
-	// is minimal:
-	double minErrorSum = DBL_MAX;
+	Registration r;
+	r.wOffset = 0;
+	r.hOffset = 0;
+	if (wr4 == 0 || hr == 0)
+		return r;		// Every position matches perfectly.
+
+	std::vector<float> testPlane;
+	std::vector<float> refPlane;
+	unpackPlane(*this, testPlane);
+	unpackPlane(ref, refPlane);
+
+	// Find the position with the minimal total absolute error, in the
+	// same order as the positions were always searched, so that ties
+	// are broken the same way:
+	double minError = DBL_MAX;
 	int minI = 0;
 	int minJ = 0;
-	for (/*int*/ i = 0; i <= dh; ++i)
-		for (int j = 0; j <= dw4; j += 4) {
-			double errorSum = stats[i][j+0].mean()
-				+ stats[i][j+1].mean()
-				+ stats[i][j+2].mean()
-				+ stats[i][j+3].mean();
-			if (errorSum < minErrorSum) {
-				minErrorSum = errorSum;
+	for (int i = 0; i <= dh; ++i)
+		for (int j = 0; j <= dw; ++j) {
+			double error = 0.0;
+			for (int row = 0; row < hr && error < minError; ++row)
+				error += rowError(&refPlane[row * wr4],
+					&testPlane[(i + row) * wt4 + 4 * j], wr4);
+			if (error < minError) {
+				minError = error;
 				minI = i;
 				minJ = j;
 			}
 		}
 
-	Registration r;
-	r.wOffset = minJ / 4;
+	// Gather the statistics for the winning position at full precision:
+	r.wOffset = minJ;
 	r.hOffset = minI;
-	r.stats[0] = stats[minI][minJ+0];
-	r.stats[1] = stats[minI][minJ+1];
-	r.stats[2] = stats[minI][minJ+2];
-	r.stats[3] = stats[minI][minJ+3];
-
-	// Clean up:
-	for (/*int*/ i = 0; i <= dh; ++i)
-		delete[] testPix[i];
-	delete[] testPix;
-	delete[] refPix;
-	for (/*int*/ i = 0; i <= dh; ++i)
-		delete[] stats[i];
-	delete[] stats;
+
+	std::vector<double> testPix(wt4);
+	std::vector<double> refPix(wr4);
+	char* testRow = pixels() + minI * rowSizeInBytes();
+	char* refRow = ref.pixels();
+	for (int i = 0; i < hr; ++i) {
+		unpack(wt, &testPix[0], testRow);
+		testRow += rowSizeInBytes();
+		ref.unpack(wr, &refPix[0], refRow);
+		refRow += ref.rowSizeInBytes();
+
+		for (int m = 0; m < wr4; m += 4)
+			for (int c = 0; c < 4; ++c)
+				r.stats[c].sample(fabs(refPix[m + c]
+					- testPix[4 * minJ + m + c]));
+	}
 
 	return r;
 } // Image::register
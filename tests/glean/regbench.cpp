@@ -0,0 +1,212 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// regbench:  compare the speed of Image::reg with the brute force search it
+// replaced, on window sized images.
+//
+// Each reference image is cut out of a random test image at a known offset,
+// with some noise added, and both implementations must find that offset.
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include "image.h"
+#include "rand.h"
+
+using namespace GLEAN;
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// bruteForceReg:  the original implementation of Image::reg, which samples
+//	the absolute error of every position into its own BasicStats.
+///////////////////////////////////////////////////////////////////////////////
+Image::Registration
+bruteForceReg(Image& test, Image& ref) {
+	int wt = test.width();
+	int ht = test.height();
+	int wr = ref.width();
+	int hr = ref.height();
+	int dh = ht - hr;
+	int dw = wt - wr;
+	int wt4 = 4 * wt;
+	int wr4 = 4 * wr;
+	int dw4 = 4 * dw;
+
+	std::vector<std::vector<double> > testPix(dh + 1,
+		std::vector<double>(wt4));
+	std::vector<double> refPix(wr4);
+	std::vector<std::vector<BasicStats> > stats(dh + 1,
+		std::vector<BasicStats>(dw4 + 4));
+
+	char* testRow = test.pixels();
+	for (int i = 0; i < dh; ++i) {
+		test.unpack(wt, &testPix[i][0], testRow);
+		testRow += test.rowSizeInBytes();
+	}
+
+	char* refRow = ref.pixels();
+	for (int i = 0; i < hr; ++i) {
+		ref.unpack(wr, &refPix[0], refRow);
+		refRow += ref.rowSizeInBytes();
+		// Rotate the rows, as the original did by reading into the
+		// last buffer of a sliding window:
+		if (i > 0)
+			for (int j = 0; j < dh; ++j)
+				testPix[j].swap(testPix[j + 1]);
+		test.unpack(wt, &testPix[dh][0], testRow);
+		testRow += test.rowSizeInBytes();
+
+		for (int j = 0; j <= dh; ++j)
+			for (int k = 0; k <= dw4; k += 4)
+				for (int m = 0; m < wr4; m += 4)
+					for (int c = 0; c < 4; ++c)
+						stats[j][k + c].sample(fabs(
+							refPix[m + c]
+							- testPix[j][m + k + c]));
+	}
+
+	double minErrorSum = DBL_MAX;
+	int minI = 0;
+	int minJ = 0;
+	for (int i = 0; i <= dh; ++i)
+		for (int j = 0; j <= dw4; j += 4) {
+			double errorSum = stats[i][j + 0].mean()
+				+ stats[i][j + 1].mean()
+				+ stats[i][j + 2].mean()
+				+ stats[i][j + 3].mean();
+			if (errorSum < minErrorSum) {
+				minErrorSum = errorSum;
+				minI = i;
+				minJ = j;
+			}
+		}
+
+	Image::Registration r;
+	r.wOffset = minJ / 4;
+	r.hOffset = minI;
+	for (int c = 0; c < 4; ++c)
+		r.stats[c] = stats[minI][minJ + c];
+	return r;
+} // bruteForceReg
+
+///////////////////////////////////////////////////////////////////////////////
+// makeImages:  fill test with random pixels, and ref with the part of it at
+//	(x, y) plus a little noise.
+///////////////////////////////////////////////////////////////////////////////
+void
+makeImages(Image& test, Image& ref, int x, int y) {
+	RandomBits rand(8, 1);
+	for (int i = 0; i < test.height(); ++i) {
+		unsigned char* p = reinterpret_cast<unsigned char*>(
+			test.pixels() + i * test.rowSizeInBytes());
+		for (int m = 0; m < 4 * test.width(); ++m)
+			p[m] = rand.next();
+	}
+
+	RandomBits noise(2, 2);
+	for (int i = 0; i < ref.height(); ++i) {
+		unsigned char* p = reinterpret_cast<unsigned char*>(
+			ref.pixels() + i * ref.rowSizeInBytes());
+		unsigned char* q = reinterpret_cast<unsigned char*>(
+			test.pixels() + (y + i) * test.rowSizeInBytes()) + 4 * x;
+		for (int m = 0; m < 4 * ref.width(); ++m)
+			p[m] = q[m] ^ noise.next();
+	}
+} // makeImages
+
+double
+seconds(clock_t start) {
+	return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char** argv) {
+	static const struct {
+		int testSize;
+		int refSize;
+	} sizes[] = {
+		{ 64, 56 },
+		{ 100, 90 },
+		{ 160, 144 },
+		{ 258, 250 },
+	};
+	int repeat = argc > 1 ? atoi(argv[1]) : 3;
+	bool ok = true;
+
+	printf("%-9s %-9s %12s %12s %9s\n", "test", "ref", "brute (ms)",
+		"reg (ms)", "speedup");
+	for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		int wt = sizes[i].testSize;
+		int wr = sizes[i].refSize;
+		int x = (wt - wr) / 3;
+		int y = (wt - wr) / 2;
+		Image test(wt, wt, GL_RGBA, GL_UNSIGNED_BYTE);
+		Image ref(wr, wr, GL_RGBA, GL_UNSIGNED_BYTE);
+		makeImages(test, ref, x, y);
+
+		Image::Registration a, b;
+		clock_t start = clock();
+		for (int n = 0; n < repeat; ++n)
+			a = bruteForceReg(test, ref);
+		double brute = seconds(start) / repeat;
+
+		start = clock();
+		for (int n = 0; n < repeat; ++n)
+			b = test.reg(ref);
+		double fast = seconds(start) / repeat;
+
+		printf("%4dx%-4d %4dx%-4d %12.2f %12.2f %8.1fx\n", wt, wt,
+			wr, wr, brute * 1000.0, fast * 1000.0,
+			fast > 0.0 ? brute / fast : 0.0);
+
+		if (a.wOffset != x || a.hOffset != y
+		 || b.wOffset != x || b.hOffset != y) {
+			printf("  wrong offset: expected %d,%d, brute %d,%d, "
+				"reg %d,%d\n", x, y, a.wOffset, a.hOffset,
+				b.wOffset, b.hOffset);
+			ok = false;
+		}
+		for (int c = 0; c < 4; ++c)
+			if (a.stats[c].n() != b.stats[c].n()
+			 || fabs(a.stats[c].mean() - b.stats[c].mean()) > 1e-9) {
+				printf("  channel %d: stats differ\n", c);
+				ok = false;
+			}
+	}
+
+	return ok ? 0 : 1;
+}
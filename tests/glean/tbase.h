@@ -284,6 +284,7 @@ public:
 		env = &environment; // make environment available
 		logDescription();   // log invocation
 		WindowSystem& ws = env->winSys;
+		bool passed = true;
 
 		try {
 			// Select the drawing configurations for testing
@@ -305,8 +306,11 @@ public:
 				if ((*p)->samples > 0)
 					continue;
 
-				Window w(ws, **p, fWidth, fHeight);
-				RenderingContext rc(ws, **p);
+				// In batch mode the window and context are
+				// shared with later tests, otherwise they
+				// are released after this configuration.
+				Window& w = env->window(**p, fWidth, fHeight);
+				RenderingContext& rc = env->context(**p);
 				if (!ws.makeCurrent(rc, w)) {
 					// XXX need to throw exception here
 				}
@@ -316,23 +320,35 @@ public:
 				piglit_dispatch_default_init(PIGLIT_DISPATCH_GL);
 
 				// Check if test is applicable to this context
-				if (!isApplicable())
+				if (!isApplicable()) {
+					releaseSurfaces();
 					continue;
+				}
 
 				// Check for all prerequisite extensions.  Note
 				// that this must be done after the rendering
 				// context has been created and made current!
-				if (!GLUtils::haveExtensions(extensions))
+				if (!GLUtils::haveExtensions(extensions)) {
+					releaseSurfaces();
 					continue;
+				}
 
 				// Create a result object and run the test:
 				ResultType* r = new ResultType();
 				r->config = *p;
+				if (env->options.batch)
+					GLUtils::pushState();
 				runOne(*r, w);
+				if (env->options.batch) {
+					ws.makeCurrent(rc, w);
+					GLUtils::popState();
+				}
 				logOne(*r);
+				releaseSurfaces();
 
 				// Save the result
 				results.push_back(r);
+				passed &= r->pass;
 
 				// if testOne, skip remaining surface configs
 				if (testOne)
@@ -347,15 +363,32 @@ public:
 			for (int i = 0; i < e.position; ++i)
 				env->log << ' ';
 			env->log << "^ " << e.err << '\n';
+			passed = false;
 		}
 		catch (RenderingContext::Error) {
 			env->log << "Could not create a rendering context\n";
+			passed = false;
 		}
+		releaseSurfaces();
 		env->log << '\n';
 
+		// In batch mode several tests share the process, so each
+		// reports its own result for piglit.
+		if (env->options.batch)
+			env->log << "PIGLIT: {\"subtest\": {\"" << name
+				 << "\": \"" << (passed ? "pass" : "fail")
+				 << "\"}}" << endl;
+
 		hasRun = true;	// Note that we've completed the run
 	}
 
+	// Release the window and context of a configuration, unless
+	// they are being kept for the following tests.
+	void releaseSurfaces() {
+		if (!env->options.batch)
+			env->releaseSurfaces();
+	}
+
 	virtual void logPassFail(ResultType& r) {
 		env->log << name << (r.pass ? ":  PASS ": ":  FAIL ");
 	}
@@ -41,23 +41,37 @@
 
 namespace {
 
-#define SCALE (static_cast<double>(num) / static_cast<double>(denom))
-#define BIAS (static_cast<double>(bias) / static_cast<double>(denom))
+#define SCALE (static_cast<C>(num) / static_cast<C>(denom))
+#define BIAS (static_cast<C>(bias) / static_cast<C>(denom))
 
 // See comments in pack.cpp concerning this workaround for a VC6 problem.
+//
+// T is the type of the unpacked components, double or float.  The scale
+// and bias are computed in T, so that the float kernels don't go through
+// double and the compiler can vectorize the widening conversions.  32 bit
+// integer components are the exception, since float can't represent them
+// exactly.
 
-template<class component, int num, unsigned int denom, int bias>
+template<class T, class component>
+struct Calc {
+	typedef T type;
+};
+template<> struct Calc<float, GLint> { typedef double type; };
+template<> struct Calc<float, GLuint> { typedef double type; };
+
+template<class T, class component, int num, unsigned int denom, int bias>
 class Unpack
 {
+	typedef typename Calc<T, component>::type C;
 public :
 	// unpack_l
-	static void unpack_l(GLsizei n, double* rgba, char* src) 
+	static void unpack_l(GLsizei n, T* rgba, char* src) 
 	{
 		component* in = reinterpret_cast<component*>(src);
 			// XXX It seems to me that static_cast should be sufficient,
 			// but egcs 1.1.2 thinks otherwise.
 
-		double* end = rgba + 4 * n;
+		T* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias)
 				rgba[0] = SCALE * in[0] + BIAS;
@@ -69,10 +83,10 @@ public :
 	}
 
 	// unpack_la
-	static void unpack_la(GLsizei n, double* rgba, char* src) 
+	static void unpack_la(GLsizei n, T* rgba, char* src) 
 	{
 		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
+		T* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				rgba[0] = SCALE * in[0] + BIAS;
@@ -87,10 +101,10 @@ public :
 	}
 
 	// unpack_rgb
-	static void unpack_rgb(GLsizei n, double* rgba, char* src) 
+	static void unpack_rgb(GLsizei n, T* rgba, char* src) 
 	{
 		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
+		T* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				rgba[0] = SCALE * in[0] + BIAS;
@@ -106,25 +120,45 @@ public :
 		}
 	}
 
-	// unpack_rgba
-	static void unpack_rgba(GLsizei n, double* rgba, char* src) 
+	// unpack_rgba:  the layouts match, so 8 and 16 bit components are
+	// converted in blocks of a fixed size through a temporary, which the
+	// compiler vectorizes even when it won't vectorize a loop of unknown
+	// length between pointers that may alias.  Wider components gain
+	// nothing from it, and are converted a pixel at a time.
+	static void unpack_rgba(GLsizei n, T* rgba, char* src) 
 	{
 		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
-		for (; rgba != end; rgba += 4) {
-			if (bias) {
-				rgba[0] = SCALE * in[0] + BIAS;
-				rgba[1] = SCALE * in[1] + BIAS;
-				rgba[2] = SCALE * in[2] + BIAS;
-				rgba[3] = SCALE * in[3] + BIAS;
-			} else {
-				rgba[0] = SCALE * in[0];
-				rgba[1] = SCALE * in[1];
-				rgba[2] = SCALE * in[2];
-				rgba[3] = SCALE * in[3];
+		GLsizei i = 0;
+		if (sizeof(component) > 2) {
+			for (; i < 4 * n; i += 4) {
+				rgba[i + 0] = convert(in[i + 0]);
+				rgba[i + 1] = convert(in[i + 1]);
+				rgba[i + 2] = convert(in[i + 2]);
+				rgba[i + 3] = convert(in[i + 3]);
 			}
-			in += 4;
+			return;
+		}
+
+		for (; i + BLOCK <= 4 * n; i += BLOCK) {
+			T tmp[BLOCK];
+			for (int j = 0; j < BLOCK; ++j)
+				tmp[j] = convert(in[i + j]);
+			for (int j = 0; j < BLOCK; ++j)
+				rgba[i + j] = tmp[j];
 		}
+		for (; i < 4 * n; ++i)
+			rgba[i] = convert(in[i]);
+	}
+
+private :
+	enum { BLOCK = 16 };
+
+	static inline T convert(component c)
+	{
+		if (bias)
+			return SCALE * c + BIAS;
+		else
+			return SCALE * c;
 	}
 
 };	// class Unpack
@@ -132,140 +166,135 @@ public :
 #undef SCALE
 #undef BIAS
 
-}; // anonymous namespace
-
+template<class T>
+struct UnpackFn {
+	typedef void Fn(GLsizei n, T* rgba, char* src);
+};
 
-namespace GLEAN {
-
-///////////////////////////////////////////////////////////////////////////////
-// Public interface
 ///////////////////////////////////////////////////////////////////////////////
-void
-Image::unpack(GLsizei n, double* rgba, char* nextPixel) {
-	(*(valid(vbUnpacker)? _unpacker: validateUnpacker()))
-		(n, rgba, nextPixel);
-}
-
+// selectUnpacker - select the unpacking utility for a format and type, and
+// components of type T
 ///////////////////////////////////////////////////////////////////////////////
-// validateUnpacker - select appropriate pixel-unpacking utility
-///////////////////////////////////////////////////////////////////////////////
-Image::Unpacker*
-Image::validateUnpacker() {
-	switch (format()) {
+template<class T>
+typename UnpackFn<T>::Fn*
+selectUnpacker(GLenum format, GLenum type) {
+	switch (format) {
 	case GL_LUMINANCE:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_l;
-			break;
+			return Unpack<T, GLbyte, 2, 255, 1>::unpack_l;
 		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_l;
-			break;
+			return Unpack<T, GLubyte, 1, 255, 0>::unpack_l;
 		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_l;
-			break;
+			return Unpack<T, GLshort, 2, 65535, 1>::unpack_l;
 		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_l;
-			break;
+			return Unpack<T, GLushort, 1, 65535, 0>::unpack_l;
 		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_l;
-			break;
+			return Unpack<T, GLint, 2, 4294967295U, 1>::unpack_l;
 		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_l;
-			break;
+			return Unpack<T, GLuint, 1, 4294967295U, 0>::unpack_l;
 		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_l;
-			break;
+			return Unpack<T, GLfloat, 1, 1, 0>::unpack_l;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	case GL_LUMINANCE_ALPHA:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_la;
-			break;
+			return Unpack<T, GLbyte, 2, 255, 1>::unpack_la;
 		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_la;
-			break;
+			return Unpack<T, GLubyte, 1, 255, 0>::unpack_la;
 		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_la;
-			break;
+			return Unpack<T, GLshort, 2, 65535, 1>::unpack_la;
 		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_la;
-			break;
+			return Unpack<T, GLushort, 1, 65535, 0>::unpack_la;
 		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_la;
-			break;
+			return Unpack<T, GLint, 2, 4294967295U, 1>::unpack_la;
 		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 2, 4294967295U, 0>::unpack_la;
-			break;
+			return Unpack<T, GLuint, 2, 4294967295U, 0>::unpack_la;
 		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_la;
-			break;
+			return Unpack<T, GLfloat, 1, 1, 0>::unpack_la;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	case GL_RGB:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_rgb;
-			break;
+			return Unpack<T, GLbyte, 2, 255, 1>::unpack_rgb;
 		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_rgb;
-			break;
+			return Unpack<T, GLubyte, 1, 255, 0>::unpack_rgb;
 		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_rgb;
-			break;
+			return Unpack<T, GLshort, 2, 65535, 1>::unpack_rgb;
 		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_rgb;
-			break;
+			return Unpack<T, GLushort, 1, 65535, 0>::unpack_rgb;
 		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_rgb;
-			break;
+			return Unpack<T, GLint, 2, 4294967295U, 1>::unpack_rgb;
 		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_rgb;
-			break;
+			return Unpack<T, GLuint, 1, 4294967295U, 0>::unpack_rgb;
 		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_rgb;
-			break;
+			return Unpack<T, GLfloat, 1, 1, 0>::unpack_rgb;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	case GL_RGBA:
-		switch (type()) {
+		switch (type) {
 		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_rgba;
-			break;
+			return Unpack<T, GLbyte, 2, 255, 1>::unpack_rgba;
 		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_rgba;
-			break;
+			return Unpack<T, GLubyte, 1, 255, 0>::unpack_rgba;
 		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_rgba;
-			break;
+			return Unpack<T, GLshort, 2, 65535, 1>::unpack_rgba;
 		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_rgba;
-			break;
+			return Unpack<T, GLushort, 1, 65535, 0>::unpack_rgba;
 		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_rgba;
-			break;
+			return Unpack<T, GLint, 2, 4294967295U, 1>::unpack_rgba;
 		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_rgba;
-			break;
+			return Unpack<T, GLuint, 1, 4294967295U, 0>::unpack_rgba;
 		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_rgba;
-			break;
+			return Unpack<T, GLfloat, 1, 1, 0>::unpack_rgba;
 		default:
-			throw BadType(type());
+			throw GLEAN::Image::BadType(type);
 		}
-		break;
 	default:
-		throw BadFormat(format());
+		throw GLEAN::Image::BadFormat(format);
 	}
+} // selectUnpacker
+
+}; // anonymous namespace
+
+
+namespace GLEAN {
+
+///////////////////////////////////////////////////////////////////////////////
+// Public interface
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::unpack(GLsizei n, double* rgba, char* nextPixel) {
+	(*(valid(vbUnpacker)? _unpacker: validateUnpacker()))
+		(n, rgba, nextPixel);
+}
+
+void
+Image::unpack(GLsizei n, float* rgba, char* nextPixel) {
+	(*(valid(vbFloatUnpacker)? _floatUnpacker: validateFloatUnpacker()))
+		(n, rgba, nextPixel);
+}
 
+///////////////////////////////////////////////////////////////////////////////
+// validateUnpacker - select appropriate pixel-unpacking utility
+///////////////////////////////////////////////////////////////////////////////
+Image::Unpacker*
+Image::validateUnpacker() {
+	_unpacker = selectUnpacker<double>(format(), type());
 	validate(vbUnpacker);
 	return _unpacker;
 }
 
+Image::FloatUnpacker*
+Image::validateFloatUnpacker() {
+	_floatUnpacker = selectUnpacker<float>(format(), type());
+	validate(vbFloatUnpacker);
+	return _floatUnpacker;
+}
+
 }; // namespace GLEAN
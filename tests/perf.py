@@ -0,0 +1,36 @@
+# -*- coding: utf-8 -*-
+
+"""Driver microbenchmarks.
+
+These tests don't check rendering, they measure how fast the driver does a
+few common things. Each test reports its measurements as samples, which can
+be compared between runs with 'piglit summary perf'.
+
+The number of warmup and timed repetitions can be set in the [perf] section
+of piglit.conf.
+
+"""
+
+from __future__ import print_function, absolute_import
+
+from framework import grouptools
+from framework.core import PIGLIT_CONFIG
+from framework.profile import TestProfile
+from framework.test import PiglitGLTest
+
+__all__ = ['profile']
+
+profile = TestProfile()
+
+_ARGS = [
+    '-warmup', PIGLIT_CONFIG.safe_get('perf', 'warmup', fallback='3'),
+    '-repetitions', PIGLIT_CONFIG.safe_get('perf', 'repetitions',
+                                           fallback='10'),
+]
+
+# Measurements are disturbed by other tests running at the same time, so none
+# of these are run concurrently.
+with profile.group_manager(PiglitGLTest, 'perf') as g:
+    for name in ['compile-link', 'draw-calls', 'readback', 'state-change',
+                 'texture-fixture', 'texture-upload', 'uniform-upload']:
+        g(['perf-' + name] + _ARGS, name, run_concurrent=False)
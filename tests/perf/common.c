@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file common.c
+ *
+ * Helpers shared by the performance tests.
+ */
+
+#include "piglit-util-gl.h"
+#include "common.h"
+
+static unsigned warmup = 3;
+static unsigned repetitions = 10;
+
+static unsigned
+parse_count(int *argc, char *argv[], const char *arg, unsigned value)
+{
+	int i;
+
+	for (i = 1; i < *argc; i++) {
+		char *end;
+		long n;
+
+		if (strcmp(argv[i], arg) != 0)
+			continue;
+
+		if (i + 1 >= *argc) {
+			fprintf(stderr, "%s requires a value\n", arg);
+			piglit_report_result(PIGLIT_FAIL);
+		}
+
+		n = strtol(argv[i + 1], &end, 10);
+		if (*end != '\0' || n < 0) {
+			fprintf(stderr, "invalid value for %s: %s\n",
+				arg, argv[i + 1]);
+			piglit_report_result(PIGLIT_FAIL);
+		}
+
+		for (i += 2; i < *argc; i++)
+			argv[i - 2] = argv[i];
+		*argc -= 2;
+
+		return n;
+	}
+
+	return value;
+}
+
+void
+perf_parse_args(int *argc, char *argv[])
+{
+	warmup = parse_count(argc, argv, "-warmup", warmup);
+	repetitions = parse_count(argc, argv, "-repetitions", repetitions);
+
+	if (repetitions == 0) {
+		fprintf(stderr, "-repetitions must be at least 1\n");
+		piglit_report_result(PIGLIT_FAIL);
+	}
+}
+
+void
+perf_measure(const char *name, const char *unit, perf_func func,
+	     unsigned iterations, double scale)
+{
+	double *samples = malloc(repetitions * sizeof(*samples));
+	unsigned i;
+
+	for (i = 0; i < warmup; i++)
+		func(iterations);
+	glFinish();
+
+	for (i = 0; i < repetitions; i++) {
+		int64_t start, end;
+
+		start = piglit_time_get_nano();
+		func(iterations);
+		glFinish();
+		end = piglit_time_get_nano();
+
+		/* Guard against a clock that didn't advance. */
+		if (end <= start)
+			end = start + 1;
+
+		samples[i] = iterations * scale * 1e9 / (double) (end - start);
+	}
+
+	/* Print the whole line at once, so that nothing func prints can end
+	 * up inside of it.
+	 */
+	printf("PIGLIT: {\"perf\": {\"%s\": {\"unit\": \"%s\", "
+	       "\"samples\": [", name, unit);
+	for (i = 0; i < repetitions; i++)
+		printf("%s%.9g", i ? ", " : "", samples[i]);
+	printf("]}}}\n");
+	fflush(stdout);
+
+	free(samples);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file common.h
+ *
+ * Helpers shared by the performance tests.
+ *
+ * Each test measures one or more operations as a rate. An operation is run
+ * a number of times to warm up the driver, and is then timed for a number
+ * of repetitions. Every repetition is one sample, and the samples are
+ * reported to the framework on a PIGLIT: line so that runs can be compared.
+ */
+
+#pragma once
+
+/**
+ * An operation to measure. It must perform \c iterations operations; the
+ * caller takes care of waiting for the GPU to finish.
+ */
+typedef void (*perf_func)(unsigned iterations);
+
+/**
+ * Parse and remove the -warmup <n> and -repetitions <n> arguments.
+ *
+ * Must be called before any other perf_* function, normally from
+ * piglit_init().
+ */
+void
+perf_parse_args(int *argc, char *argv[]);
+
+/**
+ * Measure the rate of \p func and report the samples as \p name.
+ *
+ * Each sample is \p iterations * \p scale / seconds. \p scale can be used
+ * to report bandwidth rather than operations per second, for example.
+ */
+void
+perf_measure(const char *name, const char *unit, perf_func func,
+	     unsigned iterations, double scale);
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file compile-link.c
+ *
+ * Measure the latency of compiling and linking a small program, as a rate
+ * of programs per second. Every program has a unique constant so that a
+ * shader cache can't satisfy the compile.
+ */
+
+#include "piglit-util-gl.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+	config.supports_gl_compat_version = 20;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+PIGLIT_GL_TEST_CONFIG_END
+
+static const char *vs_template =
+	"attribute vec4 piglit_vertex;\n"
+	"uniform mat4 mvp;\n"
+	"varying vec4 color;\n"
+	"void main() {\n"
+	"	gl_Position = mvp * piglit_vertex;\n"
+	"	color = piglit_vertex * %u.0;\n"
+	"}\n";
+
+static const char *fs_template =
+	"varying vec4 color;\n"
+	"void main() {\n"
+	"	vec4 c = color;\n"
+	"	for (int i = 0; i < 4; i++)\n"
+	"		c = fract(c * %u.0 + 0.5);\n"
+	"	gl_FragColor = c;\n"
+	"}\n";
+
+static unsigned serial;
+
+static void
+compile_link(unsigned iterations)
+{
+	char vs[512], fs[512];
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		GLuint prog;
+
+		serial++;
+		snprintf(vs, sizeof(vs), vs_template, serial);
+		snprintf(fs, sizeof(fs), fs_template, serial);
+
+		prog = piglit_build_simple_program(vs, fs);
+		glDeleteProgram(prog);
+	}
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	perf_measure("compile-link", "programs/s", compile_link, 20, 1.0);
+
+	return PIGLIT_PASS;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	perf_parse_args(&argc, argv);
+}
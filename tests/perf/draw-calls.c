@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file draw-calls.c
+ *
+ * Measure the throughput of small draw calls with no state changes in
+ * between, which is dominated by the per-draw overhead of the driver.
+ */
+
+#include "piglit-util-gl.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+	config.supports_gl_compat_version = 20;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+PIGLIT_GL_TEST_CONFIG_END
+
+static const char *vs_text =
+	"attribute vec4 piglit_vertex;\n"
+	"void main() { gl_Position = piglit_vertex; }\n";
+
+static const char *fs_text =
+	"void main() { gl_FragColor = vec4(0.0, 1.0, 0.0, 1.0); }\n";
+
+static void
+draw_arrays(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++)
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+static void
+draw_elements(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++)
+		glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, NULL);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	perf_measure("draw-arrays", "draws/s", draw_arrays, 10000, 1.0);
+	perf_measure("draw-elements", "draws/s", draw_elements, 10000, 1.0);
+
+	return PIGLIT_PASS;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	static const float verts[] = {
+		-0.01, -0.01,
+		 0.01, -0.01,
+		 0.00,  0.01,
+	};
+	static const GLushort indices[] = { 0, 1, 2 };
+	GLuint prog, vbo, ibo;
+	GLint loc;
+
+	perf_parse_args(&argc, argv);
+
+	prog = piglit_build_simple_program(vs_text, fs_text);
+	loc = glGetAttribLocation(prog, "piglit_vertex");
+	glUseProgram(prog);
+
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+	glEnableVertexAttribArray(loc);
+
+	glGenBuffers(1, &ibo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
+		     GL_STATIC_DRAW);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		piglit_report_result(PIGLIT_FAIL);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file state-change.c
+ *
+ * Measure the cost of common state changes. Every draw is preceded by a
+ * change of a single piece of state, so the rate includes the validation
+ * the driver does at draw time.
+ */
+
+#include "piglit-util-gl.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+	config.supports_gl_compat_version = 20;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+PIGLIT_GL_TEST_CONFIG_END
+
+static const char *vs_text =
+	"attribute vec4 piglit_vertex;\n"
+	"varying vec2 tc;\n"
+	"void main() {\n"
+	"	gl_Position = piglit_vertex;\n"
+	"	tc = piglit_vertex.xy;\n"
+	"}\n";
+
+static const char *fs_text[2] = {
+	"uniform sampler2D tex;\n"
+	"varying vec2 tc;\n"
+	"void main() { gl_FragColor = texture2D(tex, tc); }\n",
+
+	"uniform sampler2D tex;\n"
+	"varying vec2 tc;\n"
+	"void main() { gl_FragColor = texture2D(tex, tc).bgra; }\n",
+};
+
+static GLuint progs[2];
+static GLuint texs[2];
+
+static void
+program_switch(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		glUseProgram(progs[i & 1]);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	glUseProgram(progs[0]);
+}
+
+static void
+texture_switch(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		glBindTexture(GL_TEXTURE_2D, texs[i & 1]);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	glBindTexture(GL_TEXTURE_2D, texs[0]);
+}
+
+static void
+blend_toggle(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		if (i & 1)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+	glDisable(GL_BLEND);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	perf_measure("program-switch", "draws/s", program_switch, 5000, 1.0);
+	perf_measure("texture-switch", "draws/s", texture_switch, 5000, 1.0);
+	perf_measure("blend-toggle", "draws/s", blend_toggle, 5000, 1.0);
+
+	return PIGLIT_PASS;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	static const float verts[] = {
+		-0.01, -0.01,
+		 0.01, -0.01,
+		 0.00,  0.01,
+	};
+	GLuint vbo;
+	int i;
+
+	perf_parse_args(&argc, argv);
+
+	for (i = 0; i < 2; i++) {
+		GLuint vs = piglit_compile_shader_text(GL_VERTEX_SHADER,
+						       vs_text);
+		GLuint fs = piglit_compile_shader_text(GL_FRAGMENT_SHADER,
+						       fs_text[i]);
+
+		progs[i] = glCreateProgram();
+		glAttachShader(progs[i], vs);
+		glAttachShader(progs[i], fs);
+		glBindAttribLocation(progs[i], 0, "piglit_vertex");
+		glLinkProgram(progs[i]);
+		if (!piglit_link_check_status(progs[i]))
+			piglit_report_result(PIGLIT_FAIL);
+		glDeleteShader(vs);
+		glDeleteShader(fs);
+
+		texs[i] = piglit_rgbw_texture(GL_RGBA8, 16, 16, GL_FALSE,
+					      GL_FALSE,
+					      GL_UNSIGNED_NORMALIZED);
+	}
+	glUseProgram(progs[0]);
+	glBindTexture(GL_TEXTURE_2D, texs[0]);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+	glEnableVertexAttribArray(0);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		piglit_report_result(PIGLIT_FAIL);
+}
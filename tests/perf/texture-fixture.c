@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file texture-fixture.c
+ *
+ * Measure how fast the texture fixtures are generated at the largest
+ * supported size, how fast a cached one is found again, and how fast a
+ * mip chain is uploaded with and without a pixel buffer object.
+ */
+
+#include "piglit-util-gl.h"
+#include "piglit-texture-fixture.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+	config.supports_gl_compat_version = 10;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+PIGLIT_GL_TEST_CONFIG_END
+
+/* A float RGBA mip chain of this size already takes 90 MB. */
+#define MAX_SIZE 2048
+
+static int size;
+static struct piglit_fixture_desc rgbw, checkerboard, depth;
+
+static void
+generate(unsigned iterations, const struct piglit_fixture_desc *desc)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		piglit_fixture_clear_cache();
+		piglit_fixture_get(desc);
+	}
+}
+
+static void
+generate_rgbw(unsigned iterations)
+{
+	generate(iterations, &rgbw);
+}
+
+static void
+generate_checkerboard(unsigned iterations)
+{
+	generate(iterations, &checkerboard);
+}
+
+static void
+generate_depth(unsigned iterations)
+{
+	generate(iterations, &depth);
+}
+
+static void
+lookup(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		piglit_fixture_get(&rgbw);
+		piglit_fixture_get(&checkerboard);
+		piglit_fixture_get(&depth);
+	}
+}
+
+static void
+upload(unsigned iterations, bool use_pbo)
+{
+	const struct piglit_fixture_chain *chain = piglit_fixture_get(&rgbw);
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		GLuint tex;
+
+		glGenTextures(1, &tex);
+		glBindTexture(GL_TEXTURE_2D, tex);
+		piglit_fixture_upload(&rgbw, chain, GL_RGBA8, use_pbo);
+		glDeleteTextures(1, &tex);
+	}
+}
+
+static void
+upload_client(unsigned iterations)
+{
+	upload(iterations, false);
+}
+
+static void
+upload_pbo(unsigned iterations)
+{
+	upload(iterations, true);
+}
+
+static double
+chain_mb(const struct piglit_fixture_desc *desc)
+{
+	return piglit_fixture_get(desc)->size / 1e6;
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	perf_measure("generate-rgbw", "MB/s", generate_rgbw, 1,
+		     chain_mb(&rgbw));
+	perf_measure("generate-checkerboard", "MB/s", generate_checkerboard,
+		     1, chain_mb(&checkerboard));
+	perf_measure("generate-depth", "MB/s", generate_depth, 1,
+		     chain_mb(&depth));
+
+	/* Three chains per iteration. */
+	perf_measure("cached-lookup", "lookups/s", lookup, 1000, 3);
+
+	perf_measure("upload-rgbw", "MB/s", upload_client, 1,
+		     chain_mb(&rgbw));
+	if (piglit_get_gl_version() >= 21 ||
+	    piglit_is_extension_supported("GL_ARB_pixel_buffer_object")) {
+		perf_measure("upload-rgbw-pbo", "MB/s", upload_pbo, 1,
+			     chain_mb(&rgbw));
+	}
+
+	piglit_fixture_clear_cache();
+	return PIGLIT_PASS;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	static const float black[4] = {0, 0, 0, 1};
+	static const float white[4] = {1, 1, 1, 1};
+
+	perf_parse_args(&argc, argv);
+
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+	size = MIN2(size, MAX_SIZE);
+
+	piglit_fixture_init_desc(&rgbw, PIGLIT_FIXTURE_RGBW, GL_TEXTURE_2D,
+				 size, size, 1, true, GL_RGBA, GL_FLOAT);
+	rgbw.internalformat = GL_RGBA8;
+	rgbw.basetype = GL_UNSIGNED_NORMALIZED;
+
+	piglit_fixture_init_desc(&checkerboard, PIGLIT_FIXTURE_CHECKERBOARD,
+				 GL_TEXTURE_2D, size, size, 1, false,
+				 GL_RGBA, GL_FLOAT);
+	checkerboard.square_width = 8;
+	checkerboard.square_height = 8;
+	memcpy(checkerboard.colors[0], black, sizeof(black));
+	memcpy(checkerboard.colors[1], white, sizeof(white));
+
+	piglit_fixture_init_desc(&depth, PIGLIT_FIXTURE_DEPTH_GRADIENT,
+				 GL_TEXTURE_2D, size, size, 1, true,
+				 GL_DEPTH_COMPONENT, GL_FLOAT);
+}
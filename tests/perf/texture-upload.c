@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file texture-upload.c
+ *
+ * Measure the bandwidth of creating textures with piglit_rgbw_texture(),
+ * with and without mipmaps.  The fixture cache is disabled, so that each
+ * iteration generates the image as well as uploading it.
+ */
+
+#include "piglit-util-gl.h"
+#include "piglit-texture-fixture.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+	config.supports_gl_compat_version = 10;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+PIGLIT_GL_TEST_CONFIG_END
+
+#define TEX_SIZE 512
+
+static void
+upload(unsigned iterations, GLboolean mip)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		GLuint tex = piglit_rgbw_texture(GL_RGBA8, TEX_SIZE, TEX_SIZE,
+						 mip, GL_FALSE,
+						 GL_UNSIGNED_NORMALIZED);
+		glDeleteTextures(1, &tex);
+	}
+}
+
+static void
+upload_base(unsigned iterations)
+{
+	upload(iterations, GL_FALSE);
+}
+
+static void
+upload_mipmap(unsigned iterations)
+{
+	upload(iterations, GL_TRUE);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	const double size = TEX_SIZE * TEX_SIZE * 4 / 1e6;
+
+	perf_measure("rgbw-texture", "MB/s", upload_base, 10, size);
+	/* A full mip chain is 4/3 of the base level. */
+	perf_measure("rgbw-texture-mipmap", "MB/s", upload_mipmap, 10,
+		     size * 4 / 3);
+
+	return PIGLIT_PASS;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	perf_parse_args(&argc, argv);
+	piglit_fixture_set_cache_limit(0);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file uniform-upload.c
+ *
+ * Measure the cost of updating shader constants before each draw, both with
+ * plain uniforms and, if supported, by updating a uniform buffer object.
+ */
+
+#include "piglit-util-gl.h"
+#include "common.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+	config.supports_gl_compat_version = 20;
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+PIGLIT_GL_TEST_CONFIG_END
+
+#define NUM_VEC4 16
+
+static const char *vs_text =
+	"attribute vec4 piglit_vertex;\n"
+	"void main() { gl_Position = piglit_vertex; }\n";
+
+static const char *fs_uniform_text =
+	"uniform vec4 values[16];\n"
+	"void main() {\n"
+	"	vec4 sum = vec4(0.0);\n"
+	"	for (int i = 0; i < 16; i++)\n"
+	"		sum += values[i];\n"
+	"	gl_FragColor = sum;\n"
+	"}\n";
+
+static const char *fs_ubo_text =
+	"#extension GL_ARB_uniform_buffer_object : require\n"
+	"layout(std140) uniform block { vec4 values[16]; };\n"
+	"void main() {\n"
+	"	vec4 sum = vec4(0.0);\n"
+	"	for (int i = 0; i < 16; i++)\n"
+	"		sum += values[i];\n"
+	"	gl_FragColor = sum;\n"
+	"}\n";
+
+static GLuint uniform_prog, ubo_prog, ubo;
+static GLint values_loc;
+static float values[NUM_VEC4 * 4];
+
+static void
+uniform_upload(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		values[0] = i;
+		glUniform4fv(values_loc, NUM_VEC4, values);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+}
+
+static void
+ubo_upload(unsigned iterations)
+{
+	unsigned i;
+
+	for (i = 0; i < iterations; i++) {
+		values[0] = i;
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(values), values);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	glUseProgram(uniform_prog);
+	perf_measure("uniform", "draws/s", uniform_upload, 5000, 1.0);
+
+	if (ubo_prog) {
+		glUseProgram(ubo_prog);
+		perf_measure("ubo", "draws/s", ubo_upload, 5000, 1.0);
+	}
+
+	return PIGLIT_PASS;
+}
+
+static GLuint
+build_program(const char *fs_text)
+{
+	GLuint vs = piglit_compile_shader_text(GL_VERTEX_SHADER, vs_text);
+	GLuint fs = piglit_compile_shader_text(GL_FRAGMENT_SHADER, fs_text);
+	GLuint prog = glCreateProgram();
+
+	glAttachShader(prog, vs);
+	glAttachShader(prog, fs);
+	glBindAttribLocation(prog, 0, "piglit_vertex");
+	glLinkProgram(prog);
+	if (!piglit_link_check_status(prog))
+		piglit_report_result(PIGLIT_FAIL);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	return prog;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	static const float verts[] = {
+		-0.01, -0.01,
+		 0.01, -0.01,
+		 0.00,  0.01,
+	};
+	GLuint vbo;
+
+	perf_parse_args(&argc, argv);
+
+	uniform_prog = build_program(fs_uniform_text);
+	values_loc = glGetUniformLocation(uniform_prog, "values");
+
+	if (piglit_is_extension_supported("GL_ARB_uniform_buffer_object")) {
+		ubo_prog = build_program(fs_ubo_text);
+		glUniformBlockBinding(ubo_prog,
+				      glGetUniformBlockIndex(ubo_prog, "block"),
+				      0);
+
+		glGenBuffers(1, &ubo);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, ubo);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(values), values,
+			     GL_DYNAMIC_DRAW);
+	}
+
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+	glEnableVertexAttribArray(0);
+
+	if (!piglit_check_gl_error(GL_NO_ERROR))
+		piglit_report_result(PIGLIT_FAIL);
+}
@@ -405,7 +405,7 @@ compile_glsl(GLenum target)
 				    &shader_string_size);
 	}
 
-	glCompileShader(shader);
+	piglit_compile_shader_object(shader);
 
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
 
@@ -962,7 +962,7 @@ link_and_use_shaders(void)
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_POS, "piglit_vertex");
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_TEX, "piglit_texcoord");
 
-	glLinkProgram(prog);
+	piglit_link_program(prog);
 
 	for (i = 0; i < num_vertex_shaders; i++) {
 		glDeleteShader(vertex_shaders[i]);
@@ -3149,8 +3149,10 @@ piglit_init(int argc, char **argv)
 		program_must_be_in_use();
 		bind_vao_if_supported();
 
-		num_vbo_rows = setup_vbo_from_text(prog, vertex_data_start,
-						   vertex_data_end);
+		num_vbo_rows = setup_vbo_from_text_with_base(prog,
+							     vertex_data_start,
+							     vertex_data_end,
+							     argv[1]);
 		vbo_present = true;
 	}
 	setup_ubos();
@@ -132,7 +132,8 @@ load_texture(const char *dir1, const char *dir2,
 	                  dir2,
 	                  cur_file);
 
-	ktx = piglit_ktx_read_file(filepath);
+	/* The subtests draw overlapping sets of files. */
+	ktx = piglit_ktx_read_file_cached(filepath);
 	if (ktx == NULL)
 		piglit_report_result(PIGLIT_FAIL);
 
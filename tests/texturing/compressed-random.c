@@ -0,0 +1,255 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file compressed-random.c
+ *
+ * Upload random blocks to every level of a compressed texture, read the
+ * levels back with glGetTexImage and compare them with the reference
+ * decoders in piglit-compressed-decode.c.
+ *
+ * Random data reaches block modes that hand-written test images rarely
+ * cover.  The few encodings whose results are undefined are patched out
+ * before upload.  The sRGB variants share the decoders of the linear
+ * formats, and glGetTexImage doesn't decode them, so they are not tested
+ * separately.
+ */
+
+#include "piglit-util-gl.h"
+#include "piglit-compressed-decode.h"
+
+PIGLIT_GL_TEST_CONFIG_BEGIN
+
+	config.supports_gl_compat_version = 10;
+
+	config.window_visual = PIGLIT_GL_VISUAL_RGBA | PIGLIT_GL_VISUAL_DOUBLE;
+
+PIGLIT_GL_TEST_CONFIG_END
+
+#define WIDTH 64
+#define HEIGHT 32
+
+struct format_group {
+	const char *name;
+	const char *extension;
+	GLenum formats[8];
+};
+
+static const struct format_group groups[] = {
+	{ "s3tc", "GL_EXT_texture_compression_s3tc",
+	  { GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+	    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+	    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
+	    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT } },
+	{ "rgtc", "GL_ARB_texture_compression_rgtc",
+	  { GL_COMPRESSED_RED_RGTC1,
+	    GL_COMPRESSED_SIGNED_RED_RGTC1,
+	    GL_COMPRESSED_RG_RGTC2,
+	    GL_COMPRESSED_SIGNED_RG_RGTC2 } },
+	{ "latc", "GL_EXT_texture_compression_latc",
+	  { GL_COMPRESSED_LUMINANCE_LATC1_EXT,
+	    GL_COMPRESSED_SIGNED_LUMINANCE_LATC1_EXT,
+	    GL_COMPRESSED_LUMINANCE_ALPHA_LATC2_EXT,
+	    GL_COMPRESSED_SIGNED_LUMINANCE_ALPHA_LATC2_EXT } },
+	{ "bptc", "GL_ARB_texture_compression_bptc",
+	  { GL_COMPRESSED_RGBA_BPTC_UNORM,
+	    GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT,
+	    GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT } },
+	{ "etc2", "GL_ARB_ES3_compatibility",
+	  { GL_COMPRESSED_RGB8_ETC2,
+	    GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+	    GL_COMPRESSED_RGBA8_ETC2_EAC,
+	    GL_COMPRESSED_R11_EAC,
+	    GL_COMPRESSED_SIGNED_R11_EAC,
+	    GL_COMPRESSED_RG11_EAC,
+	    GL_COMPRESSED_SIGNED_RG11_EAC } },
+};
+
+static const struct format_group *group;
+
+static void
+print_usage_and_exit(const char *prog_name)
+{
+	unsigned i;
+
+	printf("Usage: %s <group>\n"
+	       "  where <group> is one of:\n", prog_name);
+	for (i = 0; i < ARRAY_SIZE(groups); i++)
+		printf("    %s\n", groups[i].name);
+	piglit_report_result(PIGLIT_FAIL);
+}
+
+/**
+ * Replace the encodings that the specs leave undefined.
+ */
+static void
+fix_block(GLenum format, uint8_t *block)
+{
+	switch (format) {
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		/* Mode 8 is reserved. */
+		if (block[0] == 0)
+			block[0] = 1 << (rand() % 8);
+		break;
+	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		/* Modes 10011, 10111, 11011 and 11111 are reserved. */
+		if ((block[0] & 0x13) == 0x13)
+			block[0] &= ~0x10;
+		break;
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+		/* An alpha multiplier of zero is not allowed. */
+		if ((block[1] & 0xf0) == 0)
+			block[1] |= 0x10;
+		break;
+	default:
+		break;
+	}
+}
+
+static bool
+compare_level(GLenum format, unsigned level, unsigned w, unsigned h,
+	      const float *expected, const float *observed)
+{
+	/* The float BPTC formats decode to exact halves. Everything else
+	 * is normalized, and implementations may interpolate at a lower
+	 * precision.
+	 */
+	const float tolerance =
+		(format == GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT ||
+		 format == GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT) ?
+		0.0f : 2.0f / 255.0f;
+	unsigned i, c;
+
+	for (i = 0; i < w * h; i++) {
+		for (c = 0; c < 4; c++) {
+			if (fabsf(expected[4 * i + c] -
+				  observed[4 * i + c]) > tolerance) {
+				printf("%s level %u: mismatch at %u, %u\n"
+				       "  Expected: %f %f %f %f\n"
+				       "  Observed: %f %f %f %f\n",
+				       piglit_get_gl_enum_name(format), level,
+				       i % w, i / w,
+				       expected[4 * i], expected[4 * i + 1],
+				       expected[4 * i + 2], expected[4 * i + 3],
+				       observed[4 * i], observed[4 * i + 1],
+				       observed[4 * i + 2], observed[4 * i + 3]);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool
+test_format(GLenum format)
+{
+	unsigned bw, bh, bytes, level, w, h, i;
+	float *expected, *observed;
+	uint8_t *data;
+	bool pass = true;
+	GLuint tex;
+
+	piglit_get_compressed_block_size(format, &bw, &bh, &bytes);
+
+	data = malloc(piglit_compressed_image_size(format, WIDTH, HEIGHT));
+	expected = malloc(WIDTH * HEIGHT * 4 * sizeof(float));
+	observed = malloc(WIDTH * HEIGHT * 4 * sizeof(float));
+
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+
+	for (level = 0, w = WIDTH, h = HEIGHT; pass; level++) {
+		const unsigned size =
+			piglit_compressed_image_size(format, w, h);
+
+		for (i = 0; i < size; i++)
+			data[i] = rand();
+		for (i = 0; i < size; i += bytes)
+			fix_block(format, data + i);
+
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, format, w, h, 0,
+				       size, data);
+		glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_FLOAT,
+			      observed);
+		if (!piglit_check_gl_error(GL_NO_ERROR)) {
+			pass = false;
+			break;
+		}
+
+		piglit_decompress_image(format, w, h, data, expected);
+		pass = compare_level(format, level, w, h, expected, observed);
+
+		if (w == 1 && h == 1)
+			break;
+		w = MAX2(w / 2, 1);
+		h = MAX2(h / 2, 1);
+	}
+
+	glDeleteTextures(1, &tex);
+	free(observed);
+	free(expected);
+	free(data);
+
+	return pass;
+}
+
+void
+piglit_init(int argc, char **argv)
+{
+	bool pass = true;
+	unsigned i;
+
+	if (argc != 2)
+		print_usage_and_exit(argv[0]);
+
+	for (i = 0; i < ARRAY_SIZE(groups); i++) {
+		if (strcmp(argv[1], groups[i].name) == 0)
+			group = &groups[i];
+	}
+	if (group == NULL)
+		print_usage_and_exit(argv[0]);
+
+	piglit_require_gl_version(13);
+	piglit_require_extension(group->extension);
+
+	for (i = 0; i < ARRAY_SIZE(group->formats) && group->formats[i]; i++) {
+		const GLenum format = group->formats[i];
+		const bool format_pass = test_format(format);
+
+		piglit_report_subtest_result(format_pass ? PIGLIT_PASS :
+					     PIGLIT_FAIL, "%s",
+					     piglit_get_gl_enum_name(format));
+		pass = pass && format_pass;
+	}
+
+	piglit_report_result(pass ? PIGLIT_PASS : PIGLIT_FAIL);
+}
+
+enum piglit_result
+piglit_display(void)
+{
+	/* unreached */
+	return PIGLIT_FAIL;
+}
@@ -186,31 +186,6 @@ valid_combination(GLenum format, GLenum type)
 	}
 }
 
-static float
-un_to_float(unsigned char bits, unsigned int color)
-{
-	unsigned int max = ~0u >> (sizeof(max) * 8 - bits);
-	return (float)color / (float)max;
-}
-
-static float
-sn_to_float(unsigned char bits, int color)
-{
-	int max = ~(~0 << (bits-1));
-	if (color < -max)
-		color = -max;
-	return (float)color / (float)max;
-}
-
-static float
-srgb_to_linear(float s)
-{
-	if (s > 0.0405)
-		return pow((s + 0.055) / 1.055, 2.4);
-	else
-		return s / 12.92;
-}
-
 #define UNPACK(val, len, off) ((val) >> off) & ~(~0ul << len)
 
 static void
@@ -221,99 +196,95 @@ to_float(void *data, int num_chan, GLenum type, float *out)
 	switch (type) {
 	case GL_UNSIGNED_BYTE_3_3_2:
 		assert(num_chan == 3);
-		out[0] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 5));
-		out[1] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 2));
-		out[2] = un_to_float(2, UNPACK(*(GLubyte *)data, 2, 0));
+		out[0] = piglit_unorm_to_float(3, UNPACK(*(GLubyte *)data, 3, 5));
+		out[1] = piglit_unorm_to_float(3, UNPACK(*(GLubyte *)data, 3, 2));
+		out[2] = piglit_unorm_to_float(2, UNPACK(*(GLubyte *)data, 2, 0));
 		break;
 	case GL_UNSIGNED_BYTE_2_3_3_REV:
 		assert(num_chan == 3);
-		out[0] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 0));
-		out[1] = un_to_float(3, UNPACK(*(GLubyte *)data, 3, 3));
-		out[2] = un_to_float(2, UNPACK(*(GLubyte *)data, 2, 6));
+		out[0] = piglit_unorm_to_float(3, UNPACK(*(GLubyte *)data, 3, 0));
+		out[1] = piglit_unorm_to_float(3, UNPACK(*(GLubyte *)data, 3, 3));
+		out[2] = piglit_unorm_to_float(2, UNPACK(*(GLubyte *)data, 2, 6));
 		break;
 	case GL_UNSIGNED_SHORT_5_6_5:
 		assert(num_chan == 3);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
-		out[1] = un_to_float(6, UNPACK(*(GLushort *)data, 6, 5));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
+		out[0] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
+		out[1] = piglit_unorm_to_float(6, UNPACK(*(GLushort *)data, 6, 5));
+		out[2] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
 		break;
 	case GL_UNSIGNED_SHORT_5_6_5_REV:
 		assert(num_chan == 3);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
-		out[1] = un_to_float(6, UNPACK(*(GLushort *)data, 6, 5));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
+		out[0] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
+		out[1] = piglit_unorm_to_float(6, UNPACK(*(GLushort *)data, 6, 5));
+		out[2] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
 		break;
 	case GL_UNSIGNED_SHORT_4_4_4_4:
 		assert(num_chan == 4);
-		out[0] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 12));
-		out[1] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 8));
-		out[2] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 4));
-		out[3] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 0));
+		out[0] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 12));
+		out[1] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 8));
+		out[2] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 4));
+		out[3] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 0));
 		break;
 	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
 		assert(num_chan == 4);
-		out[0] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 0));
-		out[1] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 4));
-		out[2] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 8));
-		out[3] = un_to_float(4, UNPACK(*(GLushort *)data, 4, 12));
+		out[0] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 0));
+		out[1] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 4));
+		out[2] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 8));
+		out[3] = piglit_unorm_to_float(4, UNPACK(*(GLushort *)data, 4, 12));
 		break;
 	case GL_UNSIGNED_SHORT_5_5_5_1:
 		assert(num_chan == 4);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
-		out[1] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 6));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 1));
-		out[3] = un_to_float(1, UNPACK(*(GLushort *)data, 1, 0));
+		out[0] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 11));
+		out[1] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 6));
+		out[2] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 1));
+		out[3] = piglit_unorm_to_float(1, UNPACK(*(GLushort *)data, 1, 0));
 		break;
 	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
 		assert(num_chan == 4);
-		out[0] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
-		out[1] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 5));
-		out[2] = un_to_float(5, UNPACK(*(GLushort *)data, 5, 10));
-		out[3] = un_to_float(1, UNPACK(*(GLushort *)data, 1, 15));
+		out[0] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 0));
+		out[1] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 5));
+		out[2] = piglit_unorm_to_float(5, UNPACK(*(GLushort *)data, 5, 10));
+		out[3] = piglit_unorm_to_float(1, UNPACK(*(GLushort *)data, 1, 15));
 		break;
 	case GL_UNSIGNED_INT_10_10_10_2:
 		assert(num_chan == 4);
-		out[0] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 22));
-		out[1] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 12));
-		out[2] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 2));
-		out[3] = un_to_float(2, UNPACK(*(GLuint *)data, 2, 0));
+		out[0] = piglit_unorm_to_float(10, UNPACK(*(GLuint *)data, 10, 22));
+		out[1] = piglit_unorm_to_float(10, UNPACK(*(GLuint *)data, 10, 12));
+		out[2] = piglit_unorm_to_float(10, UNPACK(*(GLuint *)data, 10, 2));
+		out[3] = piglit_unorm_to_float(2, UNPACK(*(GLuint *)data, 2, 0));
 		break;
 	case GL_UNSIGNED_INT_2_10_10_10_REV:
 		assert(num_chan == 4);
-		out[0] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 0));
-		out[1] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 10));
-		out[2] = un_to_float(10, UNPACK(*(GLuint *)data, 10, 20));
-		out[3] = un_to_float(2, UNPACK(*(GLuint *)data, 2, 30));
+		out[0] = piglit_unorm_to_float(10, UNPACK(*(GLuint *)data, 10, 0));
+		out[1] = piglit_unorm_to_float(10, UNPACK(*(GLuint *)data, 10, 10));
+		out[2] = piglit_unorm_to_float(10, UNPACK(*(GLuint *)data, 10, 20));
+		out[3] = piglit_unorm_to_float(2, UNPACK(*(GLuint *)data, 2, 30));
 		break;
 	case GL_UNSIGNED_INT_8_8_8_8:
 		assert(num_chan == 4);
-		out[0] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 24));
-		out[1] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 16));
-		out[2] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 8));
-		out[3] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 0));
+		out[0] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 24));
+		out[1] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 16));
+		out[2] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 8));
+		out[3] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 0));
 		break;
 	case GL_UNSIGNED_INT_8_8_8_8_REV:
 		assert(num_chan == 4);
-		out[0] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 0));
-		out[1] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 8));
-		out[2] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 16));
-		out[3] = un_to_float(8, UNPACK(*(GLuint *)data, 8, 24));
+		out[0] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 0));
+		out[1] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 8));
+		out[2] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 16));
+		out[3] = piglit_unorm_to_float(8, UNPACK(*(GLuint *)data, 8, 24));
 		break;
 	case GL_BYTE:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = sn_to_float(8, ((GLbyte *)data)[i]);
+		piglit_convert_snorm8_to_float(out, data, num_chan);
 		break;
 	case GL_UNSIGNED_BYTE:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = un_to_float(8, ((GLubyte *)data)[i]);
+		piglit_convert_unorm8_to_float(out, data, num_chan);
 		break;
 	case GL_SHORT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = sn_to_float(16, ((GLshort *)data)[i]);
+		piglit_convert_snorm16_to_float(out, data, num_chan);
 		break;
 	case GL_UNSIGNED_SHORT:
-		for (i = 0; i < num_chan; ++i)
-			out[i] = un_to_float(16, ((GLushort *)data)[i]);
+		piglit_convert_unorm16_to_float(out, data, num_chan);
 		break;
 	case GL_FLOAT:
 		for (i = 0; i < num_chan; ++i)
@@ -321,11 +292,11 @@ to_float(void *data, int num_chan, GLenum type, float *out)
 		break;
 	case GL_INT:
 		for (i = 0; i < num_chan; ++i)
-			out[i] = sn_to_float(32, ((GLint *)data)[i]);
+			out[i] = piglit_snorm_to_float(32, ((GLint *)data)[i]);
 		break;
 	case GL_UNSIGNED_INT:
 		for (i = 0; i < num_chan; ++i)
-			out[i] = un_to_float(32, ((GLuint *)data)[i]);
+			out[i] = piglit_unorm_to_float(32, ((GLuint *)data)[i]);
 		break;
 	default:
 		assert(!"Invalid type");
@@ -695,10 +666,9 @@ to_expected(GLenum test_format, GLenum test_type, void *up_raw, float *expected)
 			expected[3] = 0.0f;
 	}
 
+	/* Switches from the linear segment at 0.04045, as in the spec. */
 	if (is_format_srgb(format->internal_format)) {
-		expected[0] = srgb_to_linear(expected[0]);
-		expected[1] = srgb_to_linear(expected[1]);
-		expected[2] = srgb_to_linear(expected[2]);
+		piglit_convert_srgb_to_linear(expected, expected, 3);
 	}
 }
 
@@ -726,7 +696,7 @@ run_test(GLenum test_format, GLenum test_type, float *time_out)
 		/* Sanitize so we don't get invalid floating point values */
 		tmp = malloc(texture_size * texture_size * channels * sizeof(float));
 		for (i = 0; i < texture_size * texture_size * channels; ++i)
-			tmp[i] = sn_to_float(32, ((GLint *)rand_data)[i]);
+			tmp[i] = piglit_snorm_to_float(32, ((GLint *)rand_data)[i]);
 		data = tmp;
 	} else {
 		tmp = NULL;
@@ -811,7 +781,7 @@ test_exact()
 		tmp_float = malloc(texture_size * texture_size *
 				   channels * sizeof(float));
 		for (i = 0; i < texture_size * texture_size * channels; ++i)
-			tmp_float[i] = sn_to_float(32, ((GLint *)rand_data)[i]);
+			tmp_float[i] = piglit_snorm_to_float(32, ((GLint *)rand_data)[i]);
 		data = (GLubyte *)tmp_float;
 	} else {
 		tmp_float = NULL;
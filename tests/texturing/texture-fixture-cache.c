@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file texture-fixture-cache.c
+ *
+ * Checks that the cache of piglit-texture-fixture.h stays within its limit
+ * by freeing the least recently used chains, that a chain that is used
+ * again is not regenerated, and that a limit of 0 disables it.
+ *
+ * The chains have different sizes, so the size of the cache tells which
+ * of them it holds, and piglit_fixture_cache_misses() tells whether one was
+ * generated again.  This only generates images, so it doesn't create a
+ * context.
+ */
+
+#include "piglit-util-gl.h"
+#include "piglit-texture-fixture.h"
+
+static bool
+check_size(const char *when, size_t expected)
+{
+	const size_t size = piglit_fixture_cache_size();
+
+	if (size == expected)
+		return true;
+
+	printf("%s: the cache holds %u bytes, expected %u\n", when,
+	       (unsigned) size, (unsigned) expected);
+	return false;
+}
+
+/**
+ * Get \p desc, and check whether it had to be generated.
+ */
+static bool
+get(const char *when, const struct piglit_fixture_desc *desc, bool miss)
+{
+	const unsigned misses = piglit_fixture_cache_misses();
+
+	piglit_fixture_get(desc);
+	if ((piglit_fixture_cache_misses() != misses) == miss)
+		return true;
+
+	printf("%s: the chain was %s\n", when,
+	       miss ? "not generated" : "generated again");
+	return false;
+}
+
+/**
+ * A \p size x \p size checkerboard of single texel squares.
+ */
+static size_t
+init_desc(struct piglit_fixture_desc *desc, int size)
+{
+	static const float black[4] = {0, 0, 0, 1};
+	static const float white[4] = {1, 1, 1, 1};
+
+	piglit_fixture_init_desc(desc, PIGLIT_FIXTURE_CHECKERBOARD,
+				 GL_TEXTURE_2D, size, size, 1, false,
+				 GL_RGBA, GL_FLOAT);
+	desc->square_width = 1;
+	desc->square_height = 1;
+	memcpy(desc->colors[0], black, sizeof(black));
+	memcpy(desc->colors[1], white, sizeof(white));
+
+	return size * size * 4 * sizeof(float);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct piglit_fixture_desc a, b, c;
+	const size_t size_a = init_desc(&a, 16);
+	const size_t size_b = init_desc(&b, 8);
+	const size_t size_c = init_desc(&c, 4);
+	bool pass = true;
+
+	piglit_fixture_clear_cache();
+	pass = get("a", &a, true) && pass;
+	pass = get("a used again", &a, false) && pass;
+	pass = get("b", &b, true) && pass;
+	piglit_fixture_set_cache_limit(size_a + size_b);
+	pass = check_size("a and b", size_a + size_b) && pass;
+
+	/* a is used again, so b is the least recently used. */
+	pass = get("a after b", &a, false) && pass;
+	pass = get("c", &c, true) && pass;
+	pass = check_size("c added", size_a + size_c) && pass;
+	pass = get("a after c", &a, false) && pass;
+
+	/* The chain that was just returned is kept over the limit. */
+	piglit_fixture_set_cache_limit(1);
+	pass = check_size("limit below one chain", size_a) && pass;
+	pass = get("b over the limit", &b, true) && pass;
+	pass = check_size("b added over the limit", size_b) && pass;
+
+	/* Without a cache, even the last chain is generated again. */
+	piglit_fixture_set_cache_limit(0);
+	pass = get("b without a cache", &b, true) && pass;
+	pass = check_size("b without a cache", size_b) && pass;
+
+	piglit_fixture_clear_cache();
+	pass = check_size("cleared", 0) && pass;
+	piglit_fixture_set_cache_limit(PIGLIT_FIXTURE_CACHE_LIMIT);
+
+	piglit_report_result(pass ? PIGLIT_PASS : PIGLIT_FAIL);
+}
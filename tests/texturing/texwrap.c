@@ -63,6 +63,7 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-texture-sampler.h"
 #include <limits.h>
 
 /* Only *_ARB versions of these exist. I am lazy to add the suffix. */
@@ -561,7 +562,8 @@ struct wrap_mode {
 #define TEXTURE_SIZE(npot)  ((npot) ? SIZE_NPOT : SIZE_POT)
 #define BIAS_INT(npot)      (TEXTURE_SIZE(npot)+2)
 #define BIAS(npot)          (BIAS_INT(npot) / (double)TEXTURE_SIZE(npot))
-#define TILE_SIZE(npot)     ((BIAS_INT(npot)*2 + TEXTURE_SIZE(npot)) * TEXEL_SIZE)
+#define GRID_SIZE(npot)     (BIAS_INT(npot)*2 + TEXTURE_SIZE(npot))
+#define TILE_SIZE(npot)     (GRID_SIZE(npot) * TEXEL_SIZE)
 
 /* Test parameters and state. */
 static GLuint texture_id;
@@ -611,172 +613,46 @@ static int get_int_format_bits(const struct format_desc *format)
 	       maxbits >= 10 ? 10 : 8;
 }
 
-static void sample_nearest(int x, int y, int z,
-			   GLenum wrap_mode, GLenum filter,
-			   unsigned char pixel[4],
-			   const struct format_desc *format,
-			   GLboolean npot, GLboolean texswizzle,
-			   int bits)
+static void init_sampler(const struct format_desc *format,
+			 struct piglit_sampler_texture *tex)
 {
-	unsigned sample_border = 0;
-	float border_factor = 0;
-	int coords[3] = {x, y, z};
-	unsigned i;
-	float result[4];
-	int *iresult = (int*)result;
-	unsigned *uiresult = (unsigned*)result;
-
-	/* Zero coords according to the texture target. */
-	switch (texture_target) {
-	case GL_TEXTURE_1D:
-		coords[1] = 0;
-		/* Fall through. */
-
-	case GL_TEXTURE_2D:
-	case GL_TEXTURE_RECTANGLE:
-		coords[2] = 0;
-	}
-
-	if (texture_offset) {
-		coords[0] -= 3;
-		if (texture_target != GL_TEXTURE_1D)
-			coords[1] += 3;
-	}
-	/* Handle clamp mirroring. */
-	switch (wrap_mode) {
-	case GL_MIRROR_CLAMP_EXT:
-	case GL_MIRROR_CLAMP_TO_EDGE_EXT:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-		for (i = 0; i < 3; i++) {
-			if (coords[i] < 0) {
-				coords[i] = -coords[i] - 1;
-			}
-		}
-	}
-
-	/* Handle border sampling. */
-	switch (wrap_mode) {
-	case GL_CLAMP:
-	case GL_MIRROR_CLAMP_EXT:
-		if (filter != GL_LINEAR) {
-			break;
-		}
-
-	case GL_CLAMP_TO_BORDER:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-		sample_border = 0;
-		for (i = 0; i < 3; i++) {
-			if (coords[i] >= TEXTURE_SIZE(npot) || coords[i] < 0) {
-				sample_border++;
-			}
-		}
-	}
-
-	/* Figure out what the border factor is. */
-	switch (wrap_mode) {
-	case GL_CLAMP:
-	case GL_MIRROR_CLAMP_EXT:
-		if (filter == GL_LINEAR) {
-			const double factor[] = {0, 0.5, 0.75, 0.875};
-			border_factor = factor[sample_border];
-		}
-		break;
-	case GL_CLAMP_TO_BORDER:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-		if (sample_border) {
-			border_factor = 1;
-		}
-		break;
-	}
-
-	/* Handle wrapping. */
-	switch (wrap_mode) {
-	case GL_REPEAT:
-		for (i = 0; i < 3; i++) {
-			coords[i] = (coords[i] + TEXTURE_SIZE(npot)*10) % TEXTURE_SIZE(npot);
-		}
-		break;
-
-	case GL_CLAMP:
-	case GL_MIRROR_CLAMP_EXT:
-	case GL_CLAMP_TO_BORDER:
-	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
-	case GL_CLAMP_TO_EDGE:
-	case GL_MIRROR_CLAMP_TO_EDGE_EXT:
-		for (i = 0; i < 3; i++) {
-			coords[i] = coords[i] >= TEXTURE_SIZE(npot) ? TEXTURE_SIZE(npot)-1 :
-								coords[i] < 0 ? 0 : coords[i];
-		}
-		break;
-
-	case GL_MIRRORED_REPEAT:
-		for (i = 0; i < 3; i++) {
-			coords[i] = (coords[i] + TEXTURE_SIZE(npot)*10) % (TEXTURE_SIZE(npot) * 2);
-			if (coords[i] >= TEXTURE_SIZE(npot))
-				coords[i] = 2*TEXTURE_SIZE(npot) - coords[i] - 1;
-		}
-		break;
-	}
-
-	/* Sample the pixel. */
-	if (format->depth) {
-		result[0] = result[1] = result[2] =
-				image[(coords[2]*size_y*size_x +
-				       coords[1]*size_x + coords[0])];
-		result[3] = 1;
-	} else {
-		memcpy(result,
-		       &image[(coords[2]*size_y*size_x +
-			       coords[1]*size_x + coords[0])*4],
-		       sizeof(result));
-	}
-
-	if (format->srgb) {
-		for (i = 0; i < 3; i++) {
-			result[i] = piglit_srgb_to_linear(result[i]);
-		}
-	}
-
-	/* Sample the border.
-	 * This is actually the only place we care about linear filtering,
-	 * for CLAMP. Pixels are expected to be sampled at their center,
-	 * so we don't have to take 4 samples. */
-	if (border_factor == 1) {
-		memcpy(result, border_real, 16);
-	} else if (border_factor) {
-		for (i = 0; i < 4; i++)
-			result[i] = border_real[i] * border_factor +
-				    result[i] * (1 - border_factor);
-	}
-
-	/* Texture swizzle. */
-	if (texswizzle) {
-		float orig[4];
-		memcpy(orig, result, 16);
+	tex->data = image;
+	tex->type = format->type == INT_TYPE ? PIGLIT_SAMPLER_INT :
+		    format->type == UINT_TYPE ? PIGLIT_SAMPLER_UINT :
+		    PIGLIT_SAMPLER_FLOAT;
+	tex->components = format->depth || format->stencil ? 1 : 4;
+	tex->dimensions = texture_target == GL_TEXTURE_1D ? 1 :
+			  texture_target == GL_TEXTURE_3D ? 3 : 2;
+	tex->width = size_x;
+	tex->height = size_y;
+	tex->depth = size_z;
+	tex->srgb = format->srgb;
+}
 
-		for (i = 0; i < 4; i++) {
-			result[i] = orig[swizzle[i]];
-		}
-	}
+/* Convert a sample to what the shader writes to the framebuffer. */
+static void texel_to_ubyte(const union piglit_sampler_texel *texel,
+			   const struct format_desc *format, int bits,
+			   unsigned char pixel[4])
+{
+	unsigned i;
 
-	/* Final conversion. */
 	switch (format->type) {
 	case FLOAT_TYPE:
 		for (i = 0; i < 4; i++) {
-			pixel[i] = result[i] * 255.1;
+			pixel[i] = texel->f[i] * 255.1;
 		}
 		break;
 	case INT_TYPE:
 		for (i = 0; i < 4; i++) {
-			pixel[i] = iresult[i] * (255.1 / ((1ull << (bits-1))-1));
+			pixel[i] = texel->i[i] * (255.1 / ((1ull << (bits-1))-1));
 		}
 		break;
 	case UINT_TYPE:
 		for (i = 0; i < 4; i++) {
-			pixel[i] = uiresult[i] * (255.1 / ((1ull << bits)-1));
+			pixel[i] = texel->u[i] * (255.1 / ((1ull << bits)-1));
 		}
 		if (bits == 10) {
-			pixel[3] = uiresult[3] * (255.1 / 3);
+			pixel[3] = texel->u[3] * (255.1 / 3);
 		}
 		break;
 	}
@@ -1001,11 +877,32 @@ static GLboolean probe_pixels(const struct format_desc *format, GLboolean npot,
 	GLboolean pass = GL_TRUE;
 	int num_filters = format->type == FLOAT_TYPE ? 2 : 1;
 	int bits = get_int_format_bits(format);
+	struct piglit_sampler_texture tex;
+	struct piglit_sampler_state state;
+	union piglit_sampler_texel *samples;
+	/* Sample the texel centers, the slices are the same. */
+	float origin[3] = {0.5 - BIAS_INT(npot), 0.5 - BIAS_INT(npot), 0.5};
+	const float dx[3] = {1, 0, 0};
+	const float dy[3] = {0, 1, 0};
 
 	pixels = malloc(piglit_width * piglit_height * 4);
 	glReadPixels(0, 0, piglit_width, piglit_height,
 		     GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 
+	samples = malloc(GRID_SIZE(npot) * GRID_SIZE(npot) * sizeof(*samples));
+
+	init_sampler(format, &tex);
+	memcpy(state.border.f, border_real, sizeof(border_real));
+	for (j = 0; j < 4; j++) {
+		state.swizzle[j] = texswizzle ? GL_RED + swizzle[j] : 0;
+	}
+
+	if (texture_offset) {
+		origin[0] -= 3;
+		if (texture_target != GL_TEXTURE_1D)
+			origin[1] += 3;
+	}
+
 	/* make slices different for 3D textures */
 
 	/* Loop over min/mag filters. */
@@ -1049,6 +946,7 @@ static GLboolean probe_pixels(const struct format_desc *format, GLboolean npot,
 		for (j = 0; wrap_modes[j].mode != 0; j++) {
 			unsigned char expected[4];
 			int x0, y0;
+			int k;
 			int a, b;
 
 			test_to_xy(j, i, npot, &x0, &y0);
@@ -1059,15 +957,21 @@ static GLboolean probe_pixels(const struct format_desc *format, GLboolean npot,
 			if (skip_test(wrap_modes[j].mode, filter))
 				continue;
 
-			for (b = 0; b < (TEXTURE_SIZE(npot) + BIAS_INT(npot)*2); b++) {
-				for (a = 0; a < (TEXTURE_SIZE(npot) + BIAS_INT(npot)*2); a++) {
+			for (k = 0; k < 3; k++) {
+				state.wrap[k] = wrap_modes[j].mode;
+			}
+			state.filter = filter;
+			piglit_sample_texture_grid(&tex, &state, origin, dx, dy,
+						   GRID_SIZE(npot), GRID_SIZE(npot),
+						   samples);
+
+			for (b = 0; b < GRID_SIZE(npot); b++) {
+				for (a = 0; a < GRID_SIZE(npot); a++) {
 					double x = x0 + TEXEL_SIZE*(a+0.5);
 					double y = y0 + TEXEL_SIZE*(b+0.5);
 
-					sample_nearest(a - BIAS_INT(npot), b - BIAS_INT(npot),
-						       0, /* the slices are the same */
-						       wrap_modes[j].mode, filter, expected,
-						       format, npot, texswizzle, bits);
+					texel_to_ubyte(&samples[b*GRID_SIZE(npot) + a],
+						       format, bits, expected);
 
 					if (!probe_pixel_rgba(pixels, piglit_width, deltamax_swizzled,
 							      x, y, expected, a, b,
@@ -1083,6 +987,7 @@ tile_done:
 		}
 	}
 
+	free(samples);
 	free(pixels);
 	return pass;
 }
@@ -0,0 +1,1302 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-compressed-decode.c
+ *
+ * Each decoder works on one 4x4 block and only depends on the bytes of
+ * that block.  The S3TC, RGTC and LATC decoders interpolate in float, as
+ * the specs describe; the others follow the integer arithmetic of their
+ * specs exactly.
+ */
+
+#include "piglit-compressed-decode.h"
+
+#define BLOCK_TEXELS 16
+
+/* Don't start a thread for fewer blocks than this. */
+#define MIN_BLOCKS_PER_THREAD 1024
+
+static inline unsigned
+read_le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static inline uint32_t
+read_le32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static inline uint64_t
+read_le64(const uint8_t *p)
+{
+	return read_le32(p) | (uint64_t) read_le32(p + 4) << 32;
+}
+
+static inline uint32_t
+read_be32(const uint8_t *p)
+{
+	return (uint32_t) p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static inline uint64_t
+read_be64(const uint8_t *p)
+{
+	return (uint64_t) read_be32(p) << 32 | read_be32(p + 4);
+}
+
+static inline int
+clamp_int(int v, int min, int max)
+{
+	return v < min ? min : (v > max ? max : v);
+}
+
+static void
+set_texel(float *rgba, float r, float g, float b, float a)
+{
+	rgba[0] = r;
+	rgba[1] = g;
+	rgba[2] = b;
+	rgba[3] = a;
+}
+
+/* S3TC */
+
+static void
+rgb565_to_float(unsigned c, float *rgb)
+{
+	rgb[0] = (c >> 11) / 31.0f;
+	rgb[1] = ((c >> 5) & 0x3f) / 63.0f;
+	rgb[2] = (c & 0x1f) / 31.0f;
+}
+
+/**
+ * Decode the color half of an S3TC block.  DXT3 and DXT5 always use the
+ * four color mode, and only DXT1 with alpha has transparent texels.
+ */
+static void
+decode_dxt_color(const uint8_t *src, bool dxt1, bool has_alpha, float *rgba)
+{
+	const unsigned c0 = read_le16(src), c1 = read_le16(src + 2);
+	const uint32_t bits = read_le32(src + 4);
+	float palette[4][4];
+	unsigned i, c;
+
+	rgb565_to_float(c0, palette[0]);
+	rgb565_to_float(c1, palette[1]);
+	for (i = 0; i < 4; i++)
+		palette[i][3] = 1.0f;
+
+	if (c0 > c1 || !dxt1) {
+		for (c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+	} else {
+		for (c = 0; c < 3; c++) {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0.0f;
+		}
+		if (has_alpha)
+			palette[3][3] = 0.0f;
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		memcpy(rgba + 4 * i, palette[(bits >> (2 * i)) & 3],
+		       sizeof(palette[0]));
+}
+
+/* RGTC and LATC channels, which are also the DXT5 alpha channel */
+
+static void
+decode_rgtc_channel(const uint8_t *src, bool is_signed, float *dst)
+{
+	const uint64_t bits = read_le64(src) >> 16;
+	float palette[8];
+	bool eight_values;
+	unsigned i;
+
+	if (is_signed) {
+		const int r0 = (int8_t) src[0], r1 = (int8_t) src[1];
+
+		/* -128 is the same as -127. */
+		palette[0] = MAX2(r0, -127) / 127.0f;
+		palette[1] = MAX2(r1, -127) / 127.0f;
+		eight_values = r0 > r1;
+	} else {
+		palette[0] = src[0] / 255.0f;
+		palette[1] = src[1] / 255.0f;
+		eight_values = src[0] > src[1];
+	}
+
+	if (eight_values) {
+		for (i = 1; i < 7; i++)
+			palette[i + 1] = ((7 - i) * palette[0] +
+					  i * palette[1]) / 7;
+	} else {
+		for (i = 1; i < 5; i++)
+			palette[i + 1] = ((5 - i) * palette[0] +
+					  i * palette[1]) / 5;
+		palette[6] = is_signed ? -1.0f : 0.0f;
+		palette[7] = 1.0f;
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		dst[4 * i] = palette[(bits >> (3 * i)) & 7];
+}
+
+/* ETC1, ETC2 and EAC */
+
+static const int etc1_modifiers[8][4] = {
+	{ 2, 8, -2, -8 },
+	{ 5, 17, -5, -17 },
+	{ 9, 29, -9, -29 },
+	{ 13, 42, -13, -42 },
+	{ 18, 60, -18, -60 },
+	{ 24, 80, -24, -80 },
+	{ 33, 106, -33, -106 },
+	{ 47, 183, -47, -183 },
+};
+
+static const int etc2_distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int eac_modifiers[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 },
+};
+
+static inline int
+etc_extend4(int v)
+{
+	return v << 4 | v;
+}
+
+static inline int
+etc_extend5(int v)
+{
+	return v << 3 | v >> 2;
+}
+
+static inline int
+etc_extend6(int v)
+{
+	return v << 2 | v >> 4;
+}
+
+static inline int
+etc_extend7(int v)
+{
+	return v << 1 | v >> 6;
+}
+
+static inline int
+sign_extend3(int v)
+{
+	return v & 4 ? v - 8 : v;
+}
+
+static void
+etc_paint(int paint[4][3], const int *color, int distance, int first)
+{
+	unsigned c;
+
+	for (c = 0; c < 3; c++) {
+		paint[first][c] = clamp_int(color[c] + distance, 0, 255);
+		paint[first + 1][c] = clamp_int(color[c] - distance, 0, 255);
+	}
+}
+
+/**
+ * Write the texels of a T or H mode block, which pick one of four paint
+ * colors.
+ */
+static void
+etc_write_paint(const int paint[4][3], uint32_t lo, bool opaque,
+		float *rgba)
+{
+	unsigned x, y;
+
+	for (y = 0; y < 4; y++) {
+		for (x = 0; x < 4; x++) {
+			const unsigned k = x * 4 + y;
+			const unsigned index = ((lo >> (16 + k)) & 1) << 1 |
+				((lo >> k) & 1);
+			float *texel = rgba + 4 * (y * 4 + x);
+
+			if (!opaque && index == 2)
+				set_texel(texel, 0, 0, 0, 0);
+			else
+				set_texel(texel, paint[index][0] / 255.0f,
+					  paint[index][1] / 255.0f,
+					  paint[index][2] / 255.0f, 1.0f);
+		}
+	}
+}
+
+/**
+ * Decode an ETC2 RGB block, which is also an ETC1 block as long as the
+ * differential mode doesn't overflow.  With punchthrough alpha the
+ * differential bit is the opaque bit instead.
+ */
+static void
+decode_etc2_rgb(const uint8_t *src, bool punchthrough, float *rgba)
+{
+	const uint32_t hi = read_be32(src), lo = read_be32(src + 4);
+	const bool diff = hi & 2;
+	const bool opaque = !punchthrough || diff;
+	int base[2][3], paint[4][3];
+	unsigned x, y, c;
+
+	if (!punchthrough && !diff) {
+		for (c = 0; c < 3; c++) {
+			base[0][c] = etc_extend4((hi >> (28 - 8 * c)) & 0xf);
+			base[1][c] = etc_extend4((hi >> (24 - 8 * c)) & 0xf);
+		}
+	} else {
+		int color[3], delta[3];
+
+		for (c = 0; c < 3; c++) {
+			color[c] = (hi >> (27 - 8 * c)) & 0x1f;
+			delta[c] = sign_extend3((hi >> (24 - 8 * c)) & 7);
+		}
+
+		if (color[0] + delta[0] < 0 || color[0] + delta[0] > 31) {
+			/* T mode */
+			const int d = etc2_distances[((hi >> 1) & 6) |
+						     (hi & 1)];
+			const int c1[3] = {
+				etc_extend4(((hi >> 25) & 0xc) |
+					    ((hi >> 24) & 3)),
+				etc_extend4((hi >> 20) & 0xf),
+				etc_extend4((hi >> 16) & 0xf),
+			};
+			const int c2[3] = {
+				etc_extend4((hi >> 12) & 0xf),
+				etc_extend4((hi >> 8) & 0xf),
+				etc_extend4((hi >> 4) & 0xf),
+			};
+
+			memcpy(paint[0], c1, sizeof(c1));
+			memcpy(paint[2], c2, sizeof(c2));
+			for (c = 0; c < 3; c++) {
+				paint[1][c] = clamp_int(c2[c] + d, 0, 255);
+				paint[3][c] = clamp_int(c2[c] - d, 0, 255);
+			}
+			etc_write_paint(paint, lo, opaque, rgba);
+			return;
+		} else if (color[1] + delta[1] < 0 ||
+			   color[1] + delta[1] > 31) {
+			/* H mode */
+			const int c1[3] = {
+				etc_extend4((hi >> 27) & 0xf),
+				etc_extend4(((hi >> 23) & 0xe) |
+					    ((hi >> 20) & 1)),
+				etc_extend4(((hi >> 16) & 0x8) |
+					    ((hi >> 15) & 7)),
+			};
+			const int c2[3] = {
+				etc_extend4((hi >> 11) & 0xf),
+				etc_extend4((hi >> 7) & 0xf),
+				etc_extend4((hi >> 3) & 0xf),
+			};
+			const int order =
+				(c1[0] << 16 | c1[1] << 8 | c1[2]) >=
+				(c2[0] << 16 | c2[1] << 8 | c2[2]);
+			const int d = etc2_distances[(hi & 4) |
+						     (hi & 1) << 1 | order];
+
+			etc_paint(paint, c1, d, 0);
+			etc_paint(paint, c2, d, 2);
+			etc_write_paint(paint, lo, opaque, rgba);
+			return;
+		} else if (color[2] + delta[2] < 0 ||
+			   color[2] + delta[2] > 31) {
+			/* Planar mode, which ignores the opaque bit */
+			const int o[3] = {
+				etc_extend6((hi >> 25) & 0x3f),
+				etc_extend7(((hi >> 18) & 0x40) |
+					    ((hi >> 17) & 0x3f)),
+				etc_extend6(((hi >> 11) & 0x20) |
+					    ((hi >> 8) & 0x18) |
+					    ((hi >> 7) & 7)),
+			};
+			const int h[3] = {
+				etc_extend6(((hi >> 1) & 0x3e) | (hi & 1)),
+				etc_extend7((lo >> 25) & 0x7f),
+				etc_extend6((lo >> 19) & 0x3f),
+			};
+			const int v[3] = {
+				etc_extend6((lo >> 13) & 0x3f),
+				etc_extend7((lo >> 6) & 0x7f),
+				etc_extend6(lo & 0x3f),
+			};
+
+			for (y = 0; y < 4; y++) {
+				for (x = 0; x < 4; x++) {
+					float *texel = rgba + 4 * (y * 4 + x);
+
+					for (c = 0; c < 3; c++) {
+						const int value =
+							(x * (h[c] - o[c]) +
+							 y * (v[c] - o[c]) +
+							 4 * o[c] + 2) >> 2;
+						texel[c] = clamp_int(value, 0,
+								     255) /
+							255.0f;
+					}
+					texel[3] = 1.0f;
+				}
+			}
+			return;
+		}
+
+		for (c = 0; c < 3; c++) {
+			base[0][c] = etc_extend5(color[c]);
+			base[1][c] = etc_extend5(color[c] + delta[c]);
+		}
+	}
+
+	/* Individual and differential modes */
+	for (y = 0; y < 4; y++) {
+		for (x = 0; x < 4; x++) {
+			const unsigned k = x * 4 + y;
+			const unsigned index = ((lo >> (16 + k)) & 1) << 1 |
+				((lo >> k) & 1);
+			const unsigned sub = (hi & 1) ? y >= 2 : x >= 2;
+			const unsigned table = (hi >> (sub ? 2 : 5)) & 7;
+			float *texel = rgba + 4 * (y * 4 + x);
+
+			if (!opaque && index == 2) {
+				set_texel(texel, 0, 0, 0, 0);
+				continue;
+			}
+
+			/* Without the opaque bit the modifiers of the
+			 * first and third index are 0.
+			 */
+			for (c = 0; c < 3; c++) {
+				const int m = opaque || (index & 1) ?
+					etc1_modifiers[table][index] : 0;
+				texel[c] = clamp_int(base[sub][c] + m, 0, 255) /
+					255.0f;
+			}
+			texel[3] = 1.0f;
+		}
+	}
+}
+
+enum eac_kind {
+	EAC_ALPHA8,
+	EAC_R11,
+	EAC_SIGNED_R11,
+};
+
+static void
+decode_eac_channel(const uint8_t *src, enum eac_kind kind, float *dst)
+{
+	const uint64_t bits = read_be64(src);
+	const int mult = (bits >> 52) & 0xf;
+	const int *modifiers = eac_modifiers[(bits >> 48) & 0xf];
+	int base = bits >> 56;
+	unsigned x, y;
+
+	if (kind == EAC_SIGNED_R11)
+		base = MAX2((int8_t) base, -127);
+
+	for (y = 0; y < 4; y++) {
+		for (x = 0; x < 4; x++) {
+			const unsigned k = x * 4 + y;
+			const int m = modifiers[(bits >> (45 - 3 * k)) & 7];
+			float *value = dst + 4 * (y * 4 + x);
+
+			switch (kind) {
+			case EAC_ALPHA8:
+				*value = clamp_int(base + m * mult, 0, 255) /
+					255.0f;
+				break;
+			case EAC_R11:
+				*value = clamp_int(base * 8 + 4 +
+						   (mult ? m * mult * 8 : m),
+						   0, 2047) / 2047.0f;
+				break;
+			case EAC_SIGNED_R11:
+				*value = clamp_int(base * 8 +
+						   (mult ? m * mult * 8 : m),
+						   -1023, 1023) / 1023.0f;
+				break;
+			}
+		}
+	}
+}
+
+/* BPTC */
+
+struct bptc_bits {
+	uint64_t lo, hi;
+};
+
+static inline unsigned
+bptc_extract(const struct bptc_bits *bits, unsigned *offset, unsigned n)
+{
+	const unsigned o = *offset;
+	uint64_t value;
+
+	if (o >= 64) {
+		value = bits->hi >> (o - 64);
+	} else {
+		value = bits->lo >> o;
+		if (o + n > 64)
+			value |= bits->hi << (64 - o);
+	}
+
+	*offset += n;
+	return value & ((1u << n) - 1);
+}
+
+/* The partitions of the two and three subset modes, with two bits per
+ * texel and texel 0 in the low bits.
+ */
+static const uint32_t bptc_partitions2[64] = {
+	0x50505050, 0x40404040, 0x54545454, 0x54505040,
+	0x50404000, 0x55545450, 0x55545040, 0x54504000,
+	0x50400000, 0x55555450, 0x55544000, 0x54400000,
+	0x55555440, 0x55550000, 0x55555500, 0x55000000,
+	0x55150100, 0x00004054, 0x15010000, 0x00405054,
+	0x00004050, 0x15050100, 0x05010000, 0x40505054,
+	0x00404050, 0x05010100, 0x14141414, 0x05141450,
+	0x01155440, 0x00555500, 0x15014054, 0x05414150,
+	0x44444444, 0x55005500, 0x11441144, 0x05055050,
+	0x05500550, 0x11114444, 0x41144114, 0x44111144,
+	0x15055054, 0x01055040, 0x05041050, 0x05455150,
+	0x14414114, 0x50050550, 0x41411414, 0x00141400,
+	0x00041504, 0x00105410, 0x10541000, 0x04150400,
+	0x50410514, 0x41051450, 0x05415014, 0x14054150,
+	0x41050514, 0x41505014, 0x40011554, 0x54150140,
+	0x50505500, 0x00555050, 0x15151010, 0x54540404,
+};
+
+static const uint32_t bptc_partitions3[64] = {
+	0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8,
+	0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+	0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090,
+	0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+	0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0,
+	0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+	0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400,
+	0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+	0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424,
+	0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+	0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0,
+	0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+	0xaa444444, 0x54a854a8, 0x95809580, 0x96969600,
+	0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+	0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000,
+	0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+};
+
+/* The texel whose index has an implicit leading zero, for the second
+ * subset of two subset partitions, and for the second and third subsets
+ * of three subset partitions.
+ */
+static const uint8_t bptc_anchors[3][64] = {
+	{
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+		15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+		 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+	},
+	{
+		 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+		 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+		 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+		 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+	},
+	{
+		15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+		15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+		15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+		15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+	},
+};
+
+static const uint8_t bptc_weights2[4] = { 0, 21, 43, 64 };
+static const uint8_t bptc_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t bptc_weights4[16] = {
+	0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+static inline int
+bptc_interpolate(int e0, int e1, unsigned index, unsigned n_bits)
+{
+	const uint8_t *weights = n_bits == 2 ? bptc_weights2 :
+		n_bits == 3 ? bptc_weights3 : bptc_weights4;
+	const int w = weights[index];
+
+	return ((64 - w) * e0 + w * e1 + 32) >> 6;
+}
+
+static inline uint32_t
+bptc_subsets(unsigned n_subsets, unsigned partition)
+{
+	return n_subsets == 1 ? 0 :
+		n_subsets == 2 ? bptc_partitions2[partition] :
+		bptc_partitions3[partition];
+}
+
+static inline bool
+bptc_is_anchor(unsigned n_subsets, unsigned partition, unsigned texel)
+{
+	return texel == 0 ||
+		(n_subsets == 2 && texel == bptc_anchors[0][partition]) ||
+		(n_subsets == 3 && (texel == bptc_anchors[1][partition] ||
+				    texel == bptc_anchors[2][partition]));
+}
+
+struct bptc_unorm_mode {
+	unsigned n_subsets;
+	unsigned n_partition_bits;
+	bool has_rotation_bits;
+	bool has_index_selection_bit;
+	unsigned n_color_bits;
+	unsigned n_alpha_bits;
+	bool has_endpoint_pbits;
+	bool has_shared_pbits;
+	unsigned n_index_bits;
+	unsigned n_secondary_index_bits;
+};
+
+static const struct bptc_unorm_mode bptc_unorm_modes[8] = {
+	{ 3, 4, false, false, 4, 0, true,  false, 3, 0 },
+	{ 2, 6, false, false, 6, 0, false, true,  3, 0 },
+	{ 3, 6, false, false, 5, 0, false, false, 2, 0 },
+	{ 2, 6, false, false, 7, 0, true,  false, 2, 0 },
+	{ 1, 0, true,  true,  5, 6, false, false, 2, 3 },
+	{ 1, 0, true,  false, 7, 8, false, false, 2, 2 },
+	{ 1, 0, false, false, 7, 7, true,  false, 4, 0 },
+	{ 2, 6, false, false, 5, 5, true,  false, 2, 0 },
+};
+
+static void
+decode_bptc_unorm(const uint8_t *src, float *rgba)
+{
+	const struct bptc_bits bits = { read_le64(src), read_le64(src + 8) };
+	const struct bptc_unorm_mode *mode;
+	unsigned offset, partition = 0, rotation = 0, selection = 0;
+	unsigned n_components, n_bits[4], i, j, c;
+	uint8_t endpoints[6][4];
+	uint8_t indices[2][BLOCK_TEXELS];
+	uint32_t subsets;
+
+	for (i = 0; i < 8 && !(src[0] & (1 << i)); i++)
+		;
+	if (i == 8) {
+		/* Reserved mode */
+		memset(rgba, 0, BLOCK_TEXELS * 4 * sizeof(float));
+		return;
+	}
+	mode = &bptc_unorm_modes[i];
+	offset = i + 1;
+
+	partition = bptc_extract(&bits, &offset, mode->n_partition_bits);
+	if (mode->has_rotation_bits)
+		rotation = bptc_extract(&bits, &offset, 2);
+	if (mode->has_index_selection_bit)
+		selection = bptc_extract(&bits, &offset, 1);
+
+	for (c = 0; c < 3; c++) {
+		for (j = 0; j < mode->n_subsets * 2; j++)
+			endpoints[j][c] = bptc_extract(&bits, &offset,
+						       mode->n_color_bits);
+		n_bits[c] = mode->n_color_bits;
+	}
+	if (mode->n_alpha_bits) {
+		for (j = 0; j < mode->n_subsets * 2; j++)
+			endpoints[j][3] = bptc_extract(&bits, &offset,
+						       mode->n_alpha_bits);
+		n_bits[3] = mode->n_alpha_bits;
+		n_components = 4;
+	} else {
+		for (j = 0; j < mode->n_subsets * 2; j++)
+			endpoints[j][3] = 255;
+		n_components = 3;
+	}
+
+	if (mode->has_endpoint_pbits || mode->has_shared_pbits) {
+		unsigned pbit = 0;
+
+		for (j = 0; j < mode->n_subsets * 2; j++) {
+			/* Shared p-bits are one per subset. */
+			if (!mode->has_shared_pbits || !(j & 1))
+				pbit = bptc_extract(&bits, &offset, 1);
+
+			for (c = 0; c < n_components; c++)
+				endpoints[j][c] = endpoints[j][c] << 1 | pbit;
+		}
+		for (c = 0; c < n_components; c++)
+			n_bits[c]++;
+	}
+
+	/* Replicate the high bits to make 8 bit values. */
+	for (j = 0; j < mode->n_subsets * 2; j++) {
+		for (c = 0; c < n_components; c++) {
+			const unsigned v = endpoints[j][c] << (8 - n_bits[c]);
+			endpoints[j][c] = v | v >> n_bits[c];
+		}
+	}
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		const unsigned n = mode->n_index_bits -
+			bptc_is_anchor(mode->n_subsets, partition, i);
+		indices[0][i] = bptc_extract(&bits, &offset, n);
+	}
+	for (i = 0; i < BLOCK_TEXELS && mode->n_secondary_index_bits; i++) {
+		const unsigned n = mode->n_secondary_index_bits - (i == 0);
+		indices[1][i] = bptc_extract(&bits, &offset, n);
+	}
+
+	subsets = bptc_subsets(mode->n_subsets, partition);
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		const unsigned s = (subsets >> (2 * i)) & 3;
+		const uint8_t *e0 = endpoints[2 * s], *e1 = endpoints[2 * s + 1];
+		unsigned color_index = indices[0][i];
+		unsigned color_bits = mode->n_index_bits;
+		unsigned alpha_index = color_index, alpha_bits = color_bits;
+		uint8_t texel[4];
+
+		if (mode->n_secondary_index_bits) {
+			alpha_index = indices[1][i];
+			alpha_bits = mode->n_secondary_index_bits;
+			if (selection) {
+				const unsigned t = color_index;
+				color_index = alpha_index;
+				alpha_index = t;
+				color_bits = alpha_bits;
+				alpha_bits = mode->n_index_bits;
+			}
+		}
+
+		for (c = 0; c < 3; c++)
+			texel[c] = bptc_interpolate(e0[c], e1[c], color_index,
+						    color_bits);
+		texel[3] = bptc_interpolate(e0[3], e1[3], alpha_index,
+					    alpha_bits);
+
+		if (rotation) {
+			const uint8_t t = texel[3];
+			texel[3] = texel[rotation - 1];
+			texel[rotation - 1] = t;
+		}
+
+		for (c = 0; c < 4; c++)
+			rgba[4 * i + c] = texel[c] / 255.0f;
+	}
+}
+
+struct bptc_float_bitfield {
+	int8_t endpoint;
+	uint8_t component;
+	uint8_t offset;
+	uint8_t n_bits;
+	bool reverse;
+};
+
+struct bptc_float_mode {
+	bool reserved;
+	bool transformed_endpoints;
+	unsigned n_partition_bits;
+	unsigned n_endpoint_bits;
+	unsigned n_index_bits;
+	unsigned n_delta_bits[3];
+	struct bptc_float_bitfield bitfields[24];
+};
+
+/* Indexed by the 2 bit mode, or 2 + the 5 bit mode with bit 1 removed. */
+static const struct bptc_float_mode bptc_float_modes[18] = {
+	/* 00 */
+	{ false, true, 5, 10, 3, { 5, 5, 5 },
+	  { { 2, 1, 4, 1, false }, { 2, 2, 4, 1, false },
+	    { 3, 2, 4, 1, false }, { 0, 0, 0, 10, false },
+	    { 0, 1, 0, 10, false }, { 0, 2, 0, 10, false },
+	    { 1, 0, 0, 5, false }, { 3, 1, 4, 1, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 5, false },
+	    { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 5, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false },
+	    { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 01 */
+	{ false, true, 5, 7, 3, { 6, 6, 6 },
+	  { { 2, 1, 5, 1, false }, { 3, 1, 4, 1, false },
+	    { 3, 1, 5, 1, false }, { 0, 0, 0, 7, false },
+	    { 3, 2, 0, 1, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 4, 1, false }, { 0, 1, 0, 7, false },
+	    { 2, 2, 5, 1, false }, { 3, 2, 2, 1, false },
+	    { 2, 1, 4, 1, false }, { 0, 2, 0, 7, false },
+	    { 3, 2, 3, 1, false }, { 3, 2, 5, 1, false },
+	    { 3, 2, 4, 1, false }, { 1, 0, 0, 6, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 6, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 6, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 6, false },
+	    { 3, 0, 0, 6, false },
+	    { -1 } } },
+	/* 00010 */
+	{ false, true, 5, 11, 3, { 5, 4, 4 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 5, false },
+	    { 0, 0, 10, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 4, false }, { 0, 1, 10, 1, false },
+	    { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 4, false }, { 0, 2, 10, 1, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 5, false }, { 3, 2, 2, 1, false },
+	    { 3, 0, 0, 5, false }, { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 00011 */
+	{ false, false, 0, 10, 4, { 10, 10, 10 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 10, false },
+	    { 1, 1, 0, 10, false }, { 1, 2, 0, 10, false },
+	    { -1 } } },
+	/* 00110 */
+	{ false, true, 5, 11, 3, { 4, 5, 4 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 4, false },
+	    { 0, 0, 10, 1, false }, { 3, 1, 4, 1, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 5, false },
+	    { 0, 1, 10, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 4, false }, { 0, 2, 10, 1, false },
+	    { 3, 2, 1, 1, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 4, false }, { 3, 2, 0, 1, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 4, false },
+	    { 2, 1, 4, 1, false }, { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 00111 */
+	{ false, true, 0, 11, 4, { 9, 9, 9 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 9, false },
+	    { 0, 0, 10, 1, false }, { 1, 1, 0, 9, false },
+	    { 0, 1, 10, 1, false }, { 1, 2, 0, 9, false },
+	    { 0, 2, 10, 1, false },
+	    { -1 } } },
+	/* 01010 */
+	{ false, true, 5, 11, 3, { 4, 4, 5 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 4, false },
+	    { 0, 0, 10, 1, false }, { 2, 2, 4, 1, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 4, false },
+	    { 0, 1, 10, 1, false }, { 3, 2, 0, 1, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 5, false },
+	    { 0, 2, 10, 1, false }, { 2, 2, 0, 4, false },
+	    { 2, 0, 0, 4, false }, { 3, 2, 1, 1, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 4, false },
+	    { 3, 2, 4, 1, false }, { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 01011 */
+	{ false, true, 0, 12, 4, { 8, 8, 8 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 8, false },
+	    { 0, 0, 10, 2, true }, { 1, 1, 0, 8, false },
+	    { 0, 1, 10, 2, true }, { 1, 2, 0, 8, false },
+	    { 0, 2, 10, 2, true },
+	    { -1 } } },
+	/* 01110 */
+	{ false, true, 5, 9, 3, { 5, 5, 5 },
+	  { { 0, 0, 0, 9, false }, { 2, 2, 4, 1, false },
+	    { 0, 1, 0, 9, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 9, false }, { 3, 2, 4, 1, false },
+	    { 1, 0, 0, 5, false }, { 3, 1, 4, 1, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 5, false },
+	    { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 5, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false },
+	    { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 01111 */
+	{ false, true, 0, 16, 4, { 4, 4, 4 },
+	  { { 0, 0, 0, 10, false }, { 0, 1, 0, 10, false },
+	    { 0, 2, 0, 10, false }, { 1, 0, 0, 4, false },
+	    { 0, 0, 10, 6, true }, { 1, 1, 0, 4, false },
+	    { 0, 1, 10, 6, true }, { 1, 2, 0, 4, false },
+	    { 0, 2, 10, 6, true },
+	    { -1 } } },
+	/* 10010 */
+	{ false, true, 5, 8, 3, { 6, 5, 5 },
+	  { { 0, 0, 0, 8, false }, { 3, 1, 4, 1, false },
+	    { 2, 2, 4, 1, false }, { 0, 1, 0, 8, false },
+	    { 3, 2, 2, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 8, false }, { 3, 2, 3, 1, false },
+	    { 3, 2, 4, 1, false }, { 1, 0, 0, 6, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 5, false },
+	    { 3, 2, 0, 1, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 5, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 6, false },
+	    { 3, 0, 0, 6, false },
+	    { -1 } } },
+	/* 10011 */
+	{ true },
+	/* 10110 */
+	{ false, true, 5, 8, 3, { 5, 6, 5 },
+	  { { 0, 0, 0, 8, false }, { 3, 2, 0, 1, false },
+	    { 2, 2, 4, 1, false }, { 0, 1, 0, 8, false },
+	    { 2, 1, 5, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 8, false }, { 3, 1, 5, 1, false },
+	    { 3, 2, 4, 1, false }, { 1, 0, 0, 5, false },
+	    { 3, 1, 4, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 6, false }, { 3, 1, 0, 4, false },
+	    { 1, 2, 0, 5, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false },
+	    { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 10111 */
+	{ true },
+	/* 11010 */
+	{ false, true, 5, 8, 3, { 5, 5, 6 },
+	  { { 0, 0, 0, 8, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 4, 1, false }, { 0, 1, 0, 8, false },
+	    { 2, 2, 5, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 8, false }, { 3, 2, 5, 1, false },
+	    { 3, 2, 4, 1, false }, { 1, 0, 0, 5, false },
+	    { 3, 1, 4, 1, false }, { 2, 1, 0, 4, false },
+	    { 1, 1, 0, 5, false }, { 3, 2, 0, 1, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 6, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 5, false },
+	    { 3, 2, 2, 1, false }, { 3, 0, 0, 5, false },
+	    { 3, 2, 3, 1, false },
+	    { -1 } } },
+	/* 11011 */
+	{ true },
+	/* 11110 */
+	{ false, false, 5, 6, 3, { 6, 6, 6 },
+	  { { 0, 0, 0, 6, false }, { 3, 1, 4, 1, false },
+	    { 3, 2, 0, 1, false }, { 3, 2, 1, 1, false },
+	    { 2, 2, 4, 1, false }, { 0, 1, 0, 6, false },
+	    { 2, 1, 5, 1, false }, { 2, 2, 5, 1, false },
+	    { 3, 2, 2, 1, false }, { 2, 1, 4, 1, false },
+	    { 0, 2, 0, 6, false }, { 3, 1, 5, 1, false },
+	    { 3, 2, 3, 1, false }, { 3, 2, 5, 1, false },
+	    { 3, 2, 4, 1, false }, { 1, 0, 0, 6, false },
+	    { 2, 1, 0, 4, false }, { 1, 1, 0, 6, false },
+	    { 3, 1, 0, 4, false }, { 1, 2, 0, 6, false },
+	    { 2, 2, 0, 4, false }, { 2, 0, 0, 6, false },
+	    { 3, 0, 0, 6, false },
+	    { -1 } } },
+	/* 11111 */
+	{ true },
+};
+
+static inline int
+sign_extend(int value, unsigned n_bits)
+{
+	return value & (1 << (n_bits - 1)) ? value - (1 << n_bits) : value;
+}
+
+static int
+bptc_unquantize(int value, unsigned n_bits, bool is_signed)
+{
+	if (is_signed) {
+		const bool negative = value < 0;
+
+		if (n_bits >= 16 || value == 0)
+			return value;
+		if (negative)
+			value = -value;
+		if (value >= (1 << (n_bits - 1)) - 1)
+			value = 0x7fff;
+		else
+			value = ((value << 15) + 0x4000) >> (n_bits - 1);
+		return negative ? -value : value;
+	} else {
+		if (n_bits >= 15 || value == 0)
+			return value;
+		if (value == (1 << n_bits) - 1)
+			return 0xffff;
+		return ((value << 15) + 0x4000) >> (n_bits - 1);
+	}
+}
+
+static uint16_t
+bptc_finish_unquantize(int value, bool is_signed)
+{
+	if (!is_signed)
+		return value * 31 / 64;
+	else if (value < 0)
+		return (-value * 31 / 32) | 0x8000;
+	else
+		return value * 31 / 32;
+}
+
+static void
+decode_bptc_float(const uint8_t *src, bool is_signed, float *rgba)
+{
+	const struct bptc_bits bits = { read_le64(src), read_le64(src + 8) };
+	const struct bptc_float_mode *mode;
+	const struct bptc_float_bitfield *field;
+	unsigned offset = 0, partition = 0, n_subsets, i, j, c;
+	int endpoints[4][3];
+	uint16_t halves[BLOCK_TEXELS * 3];
+	float rgb[BLOCK_TEXELS * 3];
+	uint32_t subsets;
+
+	i = bptc_extract(&bits, &offset, 2);
+	if (i & 2) {
+		i |= bptc_extract(&bits, &offset, 3) << 2;
+		i = 2 + ((i >> 2) << 1) + (i & 1);
+	}
+	mode = &bptc_float_modes[i];
+
+	if (mode->reserved) {
+		for (i = 0; i < BLOCK_TEXELS; i++)
+			set_texel(rgba + 4 * i, 0, 0, 0, 1);
+		return;
+	}
+
+	memset(endpoints, 0, sizeof(endpoints));
+	for (field = mode->bitfields; field->endpoint != -1; field++) {
+		unsigned value = bptc_extract(&bits, &offset, field->n_bits);
+
+		if (field->reverse) {
+			unsigned reversed = 0;
+
+			for (j = 0; j < field->n_bits; j++)
+				reversed |= ((value >> j) & 1) <<
+					(field->n_bits - 1 - j);
+			value = reversed;
+		}
+		endpoints[field->endpoint][field->component] |=
+			value << field->offset;
+	}
+
+	n_subsets = mode->n_partition_bits ? 2 : 1;
+
+	/* The other endpoints may be signed offsets from the first. */
+	if (mode->transformed_endpoints) {
+		for (j = 1; j < n_subsets * 2; j++) {
+			for (c = 0; c < 3; c++) {
+				const int delta = sign_extend(
+					endpoints[j][c],
+					mode->n_delta_bits[c]);
+				endpoints[j][c] = (endpoints[0][c] + delta) &
+					((1 << mode->n_endpoint_bits) - 1);
+			}
+		}
+	}
+
+	for (j = 0; j < n_subsets * 2; j++) {
+		for (c = 0; c < 3; c++) {
+			int value = endpoints[j][c];
+
+			if (is_signed)
+				value = sign_extend(value,
+						    mode->n_endpoint_bits);
+			endpoints[j][c] = bptc_unquantize(
+				value, mode->n_endpoint_bits, is_signed);
+		}
+	}
+
+	partition = bptc_extract(&bits, &offset, mode->n_partition_bits);
+	subsets = bptc_subsets(n_subsets, partition);
+
+	for (i = 0; i < BLOCK_TEXELS; i++) {
+		const unsigned s = (subsets >> (2 * i)) & 3;
+		const unsigned index = bptc_extract(
+			&bits, &offset, mode->n_index_bits -
+			bptc_is_anchor(n_subsets, partition, i));
+
+		for (c = 0; c < 3; c++) {
+			const int value = bptc_interpolate(
+				endpoints[2 * s][c], endpoints[2 * s + 1][c],
+				index, mode->n_index_bits);
+			halves[3 * i + c] =
+				bptc_finish_unquantize(value, is_signed);
+		}
+	}
+
+	piglit_convert_half_to_float(rgb, halves, BLOCK_TEXELS * 3);
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		set_texel(rgba + 4 * i, rgb[3 * i], rgb[3 * i + 1],
+			  rgb[3 * i + 2], 1.0f);
+}
+
+/* Formats */
+
+bool
+piglit_can_decompress(GLenum format)
+{
+	switch (format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_SIGNED_RED_RGTC1:
+	case GL_COMPRESSED_RG_RGTC2:
+	case GL_COMPRESSED_SIGNED_RG_RGTC2:
+	case GL_COMPRESSED_LUMINANCE_LATC1_EXT:
+	case GL_COMPRESSED_SIGNED_LUMINANCE_LATC1_EXT:
+	case GL_COMPRESSED_LUMINANCE_ALPHA_LATC2_EXT:
+	case GL_COMPRESSED_SIGNED_LUMINANCE_ALPHA_LATC2_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+	case GL_ETC1_RGB8_OES:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+	case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+	case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+	case GL_COMPRESSED_R11_EAC:
+	case GL_COMPRESSED_SIGNED_R11_EAC:
+	case GL_COMPRESSED_RG11_EAC:
+	case GL_COMPRESSED_SIGNED_RG11_EAC:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void
+fill_channels(float *rgba, int first, float value)
+{
+	unsigned i;
+	int c;
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		for (c = first; c < 4; c++)
+			rgba[4 * i + c] = c == 3 ? 1.0f : value;
+}
+
+static void
+copy_channel(float *rgba, int from, int to)
+{
+	unsigned i;
+
+	for (i = 0; i < BLOCK_TEXELS; i++)
+		rgba[4 * i + to] = rgba[4 * i + from];
+}
+
+void
+piglit_decompress_block(GLenum format, const void *block, float *rgba)
+{
+	const uint8_t *src = block;
+
+	switch (format) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		decode_dxt_color(src, true, false, rgba);
+		break;
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		decode_dxt_color(src, true, true, rgba);
+		break;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: {
+		const uint64_t alpha = read_le64(src);
+		unsigned i;
+
+		decode_dxt_color(src + 8, false, false, rgba);
+		for (i = 0; i < BLOCK_TEXELS; i++)
+			rgba[4 * i + 3] = ((alpha >> (4 * i)) & 0xf) / 15.0f;
+		break;
+	}
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		decode_dxt_color(src + 8, false, false, rgba);
+		decode_rgtc_channel(src, false, rgba + 3);
+		break;
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_SIGNED_RED_RGTC1:
+		decode_rgtc_channel(src,
+				    format == GL_COMPRESSED_SIGNED_RED_RGTC1,
+				    rgba);
+		fill_channels(rgba, 1, 0.0f);
+		break;
+	case GL_COMPRESSED_RG_RGTC2:
+	case GL_COMPRESSED_SIGNED_RG_RGTC2: {
+		const bool is_signed = format == GL_COMPRESSED_SIGNED_RG_RGTC2;
+
+		decode_rgtc_channel(src, is_signed, rgba);
+		decode_rgtc_channel(src + 8, is_signed, rgba + 1);
+		fill_channels(rgba, 2, 0.0f);
+		break;
+	}
+	case GL_COMPRESSED_LUMINANCE_LATC1_EXT:
+	case GL_COMPRESSED_SIGNED_LUMINANCE_LATC1_EXT:
+		decode_rgtc_channel(
+			src, format == GL_COMPRESSED_SIGNED_LUMINANCE_LATC1_EXT,
+			rgba);
+		fill_channels(rgba, 3, 0.0f);
+		copy_channel(rgba, 0, 1);
+		copy_channel(rgba, 0, 2);
+		break;
+	case GL_COMPRESSED_LUMINANCE_ALPHA_LATC2_EXT:
+	case GL_COMPRESSED_SIGNED_LUMINANCE_ALPHA_LATC2_EXT: {
+		const bool is_signed =
+			format == GL_COMPRESSED_SIGNED_LUMINANCE_ALPHA_LATC2_EXT;
+
+		decode_rgtc_channel(src, is_signed, rgba);
+		decode_rgtc_channel(src + 8, is_signed, rgba + 3);
+		copy_channel(rgba, 0, 1);
+		copy_channel(rgba, 0, 2);
+		break;
+	}
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		decode_bptc_unorm(src, rgba);
+		break;
+	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		decode_bptc_float(src,
+				  format == GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT,
+				  rgba);
+		break;
+	case GL_ETC1_RGB8_OES:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+		decode_etc2_rgb(src, false, rgba);
+		break;
+	case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+	case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+		decode_etc2_rgb(src, true, rgba);
+		break;
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+		decode_etc2_rgb(src + 8, false, rgba);
+		decode_eac_channel(src, EAC_ALPHA8, rgba + 3);
+		break;
+	case GL_COMPRESSED_R11_EAC:
+	case GL_COMPRESSED_SIGNED_R11_EAC:
+		decode_eac_channel(src, format == GL_COMPRESSED_R11_EAC ?
+				   EAC_R11 : EAC_SIGNED_R11, rgba);
+		fill_channels(rgba, 1, 0.0f);
+		break;
+	case GL_COMPRESSED_RG11_EAC:
+	case GL_COMPRESSED_SIGNED_RG11_EAC: {
+		const enum eac_kind kind = format == GL_COMPRESSED_RG11_EAC ?
+			EAC_R11 : EAC_SIGNED_R11;
+
+		decode_eac_channel(src, kind, rgba);
+		decode_eac_channel(src + 8, kind, rgba + 1);
+		fill_channels(rgba, 2, 0.0f);
+		break;
+	}
+	default:
+		assert(!"Unsupported compressed format");
+	}
+}
+
+/* Images */
+
+struct decode_job {
+	GLenum format;
+	unsigned width, height;
+	unsigned block_bytes;
+	const uint8_t *data;
+	float *rgba;
+};
+
+/**
+ * Decode the block rows from \p first_row to \p end_row, for
+ * piglit_parallel_for().
+ */
+static void
+decode_rows(unsigned first_row, unsigned end_row, void *data)
+{
+	const struct decode_job *job = data;
+	const unsigned blocks_x = (job->width + 3) / 4;
+	unsigned bx, by, x, y;
+
+	for (by = first_row; by < end_row; by++) {
+		const uint8_t *src = job->data +
+			(size_t) by * blocks_x * job->block_bytes;
+
+		for (bx = 0; bx < blocks_x; bx++) {
+			const unsigned w = MIN2(4, job->width - bx * 4);
+			const unsigned h = MIN2(4, job->height - by * 4);
+			float block[BLOCK_TEXELS * 4];
+
+			piglit_decompress_block(job->format,
+						src + bx * job->block_bytes,
+						block);
+
+			for (y = 0; y < h; y++) {
+				for (x = 0; x < w; x++) {
+					const size_t texel = (size_t)
+						(by * 4 + y) * job->width +
+						bx * 4 + x;
+
+					memcpy(job->rgba + 4 * texel,
+					       block + 4 * (y * 4 + x),
+					       4 * sizeof(float));
+				}
+			}
+		}
+	}
+}
+
+void
+piglit_decompress_image(GLenum format, unsigned width, unsigned height,
+			const void *data, float *rgba)
+{
+	const unsigned blocks_x = MAX2((width + 3) / 4, 1);
+	unsigned bw, bh, bytes;
+	struct decode_job job;
+
+	piglit_get_compressed_block_size(format, &bw, &bh, &bytes);
+	assert(bw == 4 && bh == 4);
+
+	job.format = format;
+	job.width = width;
+	job.height = height;
+	job.block_bytes = bytes;
+	job.data = data;
+	job.rgba = rgba;
+
+	piglit_parallel_for((height + 3) / 4,
+			    (MIN_BLOCKS_PER_THREAD + blocks_x - 1) / blocks_x,
+			    decode_rows, &job);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-compressed-decode.h
+ *
+ * Reference decoders for the block compressed texture formats, so that
+ * tests can compute the expected contents of compressed textures built
+ * from arbitrary data instead of shipping decompressed copies.
+ *
+ * Supported are S3TC (DXT1, DXT3, DXT5), RGTC, LATC, BPTC (both the unorm
+ * and the float formats), ETC1, and the ETC2 and EAC formats.  ASTC is not
+ * supported yet, see TODO.
+ *
+ * Images are decoded to RGBA floats in row-major texel order, one row of
+ * width texels after another, which is what
+ * glGetTexImage(GL_RGBA, GL_FLOAT) returns.  Nothing is converted from
+ * sRGB, and the luminance formats are returned as (L, L, L, A), also like
+ * glGetTexImage.
+ */
+
+#ifndef PIGLIT_COMPRESSED_DECODE_H
+#define PIGLIT_COMPRESSED_DECODE_H
+
+#include "piglit-util-gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Return whether \p format can be decoded.
+ */
+bool
+piglit_can_decompress(GLenum format);
+
+/**
+ * Decode a single block into \p rgba, which has room for bw * bh texels
+ * as returned by piglit_get_compressed_block_size().  The texels are in
+ * row-major order within the block.
+ */
+void
+piglit_decompress_block(GLenum format, const void *block, float *rgba);
+
+/**
+ * Decode a width x height image, whose blocks are tightly packed, into
+ * width * height RGBA texels.  Blocks are independent, so large images are
+ * split between threads.
+ */
+void
+piglit_decompress_image(GLenum format, unsigned width, unsigned height,
+			const void *data, float *rgba);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIGLIT_COMPRESSED_DECODE_H */
@@ -70,11 +70,38 @@ resolve_${f0.name}(void)
 >-------return piglit_dispatch_${f0.name};
 }
 
+#ifdef PIGLIT_DISPATCH_TRACE
+static PFN${f0.name.upper()}PROC real_${f0.name};
+static struct trace_count trace_count_${f0.name};
+
+static ${f0.c_return_type} APIENTRY
+trace_${f0.name}(${f0.c_named_param_list})
+{
+% if f0.c_return_type != 'void':
+>-------${f0.c_return_type} ret;
+% endif
+>-------int64_t start = trace_begin();
+>-------
+% if f0.c_return_type != 'void':
+........ret = .
+% endif
+...............real_${f0.name}(${f0.c_untyped_param_list});
+>-------trace_end(&trace_count_${f0.name}, start);
+% if f0.c_return_type != 'void':
+>-------return ret;
+% endif
+}
+#endif
+
 static ${f0.c_return_type} APIENTRY
 stub_${f0.name}(${f0.c_named_param_list})
 {
 >-------check_initialized();
 >-------piglit_dispatch_${f0.name} = resolve_${f0.name}();
+#ifdef PIGLIT_DISPATCH_TRACE
+>-------real_${f0.name} = piglit_dispatch_${f0.name};
+>-------piglit_dispatch_${f0.name} = trace_${f0.name};
+#endif
 >-------
 % if f0.c_return_type != 'void':
 ........return .
@@ -105,4 +132,13 @@ static void* (*const function_resolvers[])(void) = {
 >-------resolve_${f0.name},
 % endfor
 };
+
+#ifdef PIGLIT_DISPATCH_TRACE
+static const struct trace_function trace_functions[] = {
+% for alias_set in gl_registry.command_alias_map:
+<% f0 = alias_set.primary_command %>\
+>-------{ "${f0.name}", &trace_count_${f0.name} },
+% endfor
+};
+#endif
 </%block>\
@@ -126,8 +126,86 @@ check_extension(const char *name)
 	return piglit_is_extension_supported(name);
 }
 
+#ifdef PIGLIT_DISPATCH_TRACE
+
+/**
+ * The number of calls made to a function, and the nanoseconds spent in
+ * them if PIGLIT_DISPATCH_TIME is set.
+ *
+ * The counts are not atomic. Tests that call GL from several threads
+ * will get approximate counts.
+ */
+struct trace_count {
+	uint64_t calls;
+	int64_t time;
+};
+
+struct trace_function {
+	const char *name;
+	struct trace_count *count;
+};
+
+static bool trace_time = false;
+
+/**
+ * Generated code calls this function before calling a traced GL
+ * function.
+ */
+static inline int64_t
+trace_begin(void)
+{
+	return trace_time ? piglit_time_get_nano() : 0;
+}
+
+/**
+ * Generated code calls this function after calling a traced GL
+ * function.
+ */
+static inline void
+trace_end(struct trace_count *count, int64_t start)
+{
+	count->calls++;
+	if (trace_time)
+		count->time += piglit_time_get_nano() - start;
+}
+
+#endif /* PIGLIT_DISPATCH_TRACE */
+
 #include "piglit-dispatch-gen.c"
 
+#ifdef PIGLIT_DISPATCH_TRACE
+
+/**
+ * Report the functions that were called at least once, as the "gl_calls"
+ * member of a PIGLIT line.
+ */
+static void
+trace_report(void)
+{
+	const char *sep = "";
+	unsigned i;
+
+	printf("PIGLIT: {\"gl_calls\": {");
+	for (i = 0; i < ARRAY_SIZE(trace_functions); i++) {
+		const struct trace_count *count = trace_functions[i].count;
+
+		if (count->calls == 0)
+			continue;
+
+		printf("%s\"%s\": {\"count\": %llu", sep,
+		       trace_functions[i].name,
+		       (unsigned long long) count->calls);
+		if (trace_time)
+			printf(", \"time\": %.9f", count->time / 1.0e9);
+		printf("}");
+		sep = ", ";
+	}
+	printf("}}\n");
+	fflush(stdout);
+}
+
+#endif /* PIGLIT_DISPATCH_TRACE */
+
 /**
  * Initialize the dispatch mechanism.
  *
@@ -173,6 +251,13 @@ piglit_dispatch_init(piglit_dispatch_api api,
 	unsupported = unsupported_proc;
 	get_proc_address_failure = failure_proc;
 
+#ifdef PIGLIT_DISPATCH_TRACE
+	if (!is_initialized) {
+		trace_time = getenv("PIGLIT_DISPATCH_TIME") != NULL;
+		atexit(trace_report);
+	}
+#endif
+
 	/* No need to reset the dispatch pointers the first time */
 	if (is_initialized) {
 		reset_dispatch_pointers();
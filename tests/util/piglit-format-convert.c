@@ -0,0 +1,598 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-format-convert.c
+ *
+ * The half float conversions are branch free, and use SSE2 when the
+ * compiler targets it; both paths give bit identical results.  The sRGB
+ * conversions interpolate in tables which are built the first time they
+ * are needed.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "piglit-format-convert.h"
+
+static inline uint32_t
+float_bits(float f)
+{
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+static inline float
+bits_float(uint32_t u)
+{
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+static inline float
+clamp01(float x)
+{
+	/* NaN fails both comparisons and becomes 0. */
+	return x > 0.0f ? (x < 1.0f ? x : 1.0f) : 0.0f;
+}
+
+/* Half floats */
+
+static inline uint16_t
+float_to_half(float f)
+{
+	const uint32_t x = float_bits(f);
+	const uint32_t abs = x & 0x7fffffff;
+	uint32_t h;
+
+	if (abs > 0x7f800000)
+		h = 0x7c01;
+	else if (abs >= 0x47800000)
+		h = 0x7c00;
+	else if (abs >= 0x38800000)
+		h = (abs >> 13) - 0x1c000;
+	else
+		/* Exact for every half denorm, and 0 below them. */
+		h = (uint32_t) (fabsf(f) * 16777216.0f);
+
+	return ((x >> 16) & 0x8000) | h;
+}
+
+static inline float
+half_to_float(uint16_t h)
+{
+	const uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+	const uint32_t em = h & 0x7fff;
+
+	if (em >= 0x7c00)
+		return bits_float(sign | 0x7f800000 | (em & 0x3ff) << 13);
+	else if (em >= 0x400)
+		return bits_float(sign | ((em << 13) + 0x38000000));
+	else
+		return bits_float(sign | float_bits(em * (1.0f / 16777216.0f)));
+}
+
+#ifdef __SSE2__
+static inline __m128i
+select_epi32(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+void
+piglit_convert_float_to_half(uint16_t *dst, const float *src, size_t n)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i abs_mask = _mm_set1_epi32(0x7fffffff);
+	const __m128i sign_mask = _mm_set1_epi32(0x8000);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i abs = _mm_and_si128(x, abs_mask);
+		__m128i denorm = _mm_cvttps_epi32(
+			_mm_mul_ps(_mm_castsi128_ps(abs),
+				   _mm_set1_ps(16777216.0f)));
+		__m128i normal = _mm_sub_epi32(_mm_srli_epi32(abs, 13),
+					       _mm_set1_epi32(0x1c000));
+		__m128i h;
+
+		h = select_epi32(_mm_cmpgt_epi32(abs, _mm_set1_epi32(0x387fffff)),
+				 normal, denorm);
+		h = select_epi32(_mm_cmpgt_epi32(abs, _mm_set1_epi32(0x477fffff)),
+				 _mm_set1_epi32(0x7c00), h);
+		h = select_epi32(_mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7f800000)),
+				 _mm_set1_epi32(0x7c01), h);
+		h = _mm_or_si128(h, _mm_and_si128(_mm_srli_epi32(x, 16),
+						  sign_mask));
+
+		/* Sign extend the low halves so that the saturating pack
+		 * keeps them as they are.
+		 */
+		h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+		_mm_storel_epi64((__m128i *) (dst + i), _mm_packs_epi32(h, h));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = float_to_half(src[i]);
+}
+
+void
+piglit_convert_half_to_float(float *dst, const uint16_t *src, size_t n)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i em_mask = _mm_set1_epi32(0x7fff);
+	const __m128i bias = _mm_set1_epi32(0x38000000);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i h = _mm_unpacklo_epi16(
+			_mm_loadl_epi64((const __m128i *) (src + i)),
+			_mm_setzero_si128());
+		__m128i em = _mm_and_si128(h, em_mask);
+		__m128i normal = _mm_add_epi32(_mm_slli_epi32(em, 13), bias);
+		__m128i denorm = _mm_castps_si128(
+			_mm_mul_ps(_mm_cvtepi32_ps(em),
+				   _mm_set1_ps(1.0f / 16777216.0f)));
+		__m128i f;
+
+		f = select_epi32(_mm_cmpgt_epi32(em, _mm_set1_epi32(0x3ff)),
+				 normal, denorm);
+		f = select_epi32(_mm_cmpgt_epi32(em, _mm_set1_epi32(0x7bff)),
+				 _mm_add_epi32(normal, bias), f);
+		f = _mm_or_si128(f, _mm_slli_epi32(
+					 _mm_xor_si128(h, em), 16));
+
+		_mm_storeu_ps(dst + i, _mm_castsi128_ps(f));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = half_to_float(src[i]);
+}
+
+/* GL_RGB9_E5, from EXT_texture_shared_exponent */
+
+#define RGB9E5_EXP_BIAS			15
+#define RGB9E5_MANTISSA_BITS		9
+#define RGB9E5_MAX_VALID_BIASED_EXP	31
+#define MAX_RGB9E5_MANTISSA		511
+#define MAX_RGB9E5			(511.0f / 512.0f * 65536.0f)
+
+static inline float
+clamp_rgb9e5(float x)
+{
+	if (x > 0.0f)
+		return x >= MAX_RGB9E5 ? MAX_RGB9E5 : x;
+	/* NaN gets here too. */
+	return 0.0f;
+}
+
+static uint32_t
+encode_rgb9e5(const float *rgb)
+{
+	const float rc = clamp_rgb9e5(rgb[0]);
+	const float gc = clamp_rgb9e5(rgb[1]);
+	const float bc = clamp_rgb9e5(rgb[2]);
+	float maxrgb = rc > gc ? rc : gc;
+	int exp_shared, maxm, rm, gm, bm;
+	double denom;
+
+	maxrgb = maxrgb > bc ? maxrgb : bc;
+
+	/* The floor of log2, which is wrong for denorms and zero, but the
+	 * max with the smallest exponent hides that.
+	 */
+	exp_shared = (int) ((float_bits(maxrgb) >> 23) & 0xff) - 127;
+	if (exp_shared < -RGB9E5_EXP_BIAS - 1)
+		exp_shared = -RGB9E5_EXP_BIAS - 1;
+	exp_shared += 1 + RGB9E5_EXP_BIAS;
+	assert(exp_shared <= RGB9E5_MAX_VALID_BIASED_EXP);
+
+	denom = ldexp(1.0, exp_shared - RGB9E5_EXP_BIAS -
+		      RGB9E5_MANTISSA_BITS);
+	maxm = (int) floor(maxrgb / denom + 0.5);
+	if (maxm == MAX_RGB9E5_MANTISSA + 1) {
+		denom *= 2;
+		exp_shared += 1;
+		assert(exp_shared <= RGB9E5_MAX_VALID_BIASED_EXP);
+	}
+
+	rm = (int) floor(rc / denom + 0.5);
+	gm = (int) floor(gc / denom + 0.5);
+	bm = (int) floor(bc / denom + 0.5);
+	assert(rm <= MAX_RGB9E5_MANTISSA && gm <= MAX_RGB9E5_MANTISSA &&
+	       bm <= MAX_RGB9E5_MANTISSA);
+
+	return rm | gm << 9 | bm << 18 | (uint32_t) exp_shared << 27;
+}
+
+void
+piglit_convert_float3_to_rgb9e5(uint32_t *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = encode_rgb9e5(src + 3 * i);
+}
+
+void
+piglit_convert_rgb9e5_to_float3(float *dst, const uint32_t *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		const uint32_t v = src[i];
+		/* 2^(e - 15 - 9) is always a normal float. */
+		const float scale = bits_float(((v >> 27) + 127 - 24) << 23);
+
+		dst[3 * i + 0] = (v & 0x1ff) * scale;
+		dst[3 * i + 1] = ((v >> 9) & 0x1ff) * scale;
+		dst[3 * i + 2] = ((v >> 18) & 0x1ff) * scale;
+	}
+}
+
+/* GL_R11F_G11F_B10F, from EXT_packed_float */
+
+/**
+ * Convert a float to an unsigned float with 5 exponent bits and
+ * mantissa_bits mantissa bits, whose largest finite value is max.
+ *
+ * From the GL_EXT_packed_float spec:
+ *
+ *     "Additionally: negative infinity is converted to zero; positive
+ *      infinity is converted to positive infinity; and both positive and
+ *      negative NaN are converted to positive NaN."
+ *
+ *     "Likewise, finite positive values greater than 65024 (the maximum
+ *      finite representable unsigned 11-bit floating-point value) are
+ *      converted to 65024."
+ *
+ * Values below the smallest normal become 0.
+ */
+static inline uint32_t
+float_to_uf(float f, int mantissa_bits, float max)
+{
+	const uint32_t x = float_bits(f);
+	const int exponent = (int) ((x >> 23) & 0xff) - 127;
+	const uint32_t mantissa = x & 0x7fffff;
+
+	if (exponent == 128) {
+		if (mantissa)
+			return 31 << mantissa_bits | 1;
+		return x & 0x80000000 ? 0 : 31 << mantissa_bits;
+	} else if (x & 0x80000000) {
+		return 0;
+	} else if (f > max) {
+		return 30 << mantissa_bits | ((1 << mantissa_bits) - 1);
+	} else if (exponent > -15) {
+		return (uint32_t) (exponent + 15) << mantissa_bits |
+			mantissa >> (23 - mantissa_bits);
+	}
+	return 0;
+}
+
+static inline float
+uf_to_float(uint32_t v, int mantissa_bits)
+{
+	const uint32_t e = v >> mantissa_bits;
+	const uint32_t m = v & ((1 << mantissa_bits) - 1);
+
+	if (e == 0)
+		return m * bits_float((127 - 14 - mantissa_bits) << 23);
+	else if (e == 31)
+		return bits_float(0x7f800000 | m << (23 - mantissa_bits));
+	return bits_float((e + 127 - 15) << 23 | m << (23 - mantissa_bits));
+}
+
+void
+piglit_convert_float3_to_r11g11b10f(uint32_t *dst, const float *src,
+				    size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		const float *rgb = src + 3 * i;
+
+		dst[i] = float_to_uf(rgb[0], 6, 65024.0f) |
+			 float_to_uf(rgb[1], 6, 65024.0f) << 11 |
+			 float_to_uf(rgb[2], 5, 64512.0f) << 22;
+	}
+}
+
+void
+piglit_convert_r11g11b10f_to_float3(float *dst, const uint32_t *src,
+				    size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		const uint32_t v = src[i];
+
+		dst[3 * i + 0] = uf_to_float(v & 0x7ff, 6);
+		dst[3 * i + 1] = uf_to_float((v >> 11) & 0x7ff, 6);
+		dst[3 * i + 2] = uf_to_float(v >> 22, 5);
+	}
+}
+
+/* sRGB */
+
+/* Segments of the uniform [0, 1] table used for decoding. */
+#define SRGB_DECODE_SEGMENTS	4096
+
+/* The encoding table covers [2^-9, 1), which includes everything above the
+ * linear segment, with 2^SRGB_ENCODE_BITS segments per octave.
+ */
+#define SRGB_ENCODE_BITS	10
+#define SRGB_ENCODE_MIN		0x3b000000
+#define SRGB_ENCODE_SEGMENTS	(9 << SRGB_ENCODE_BITS)
+
+static float srgb_decode_table[SRGB_DECODE_SEGMENTS + 1];
+static float srgb_encode_table[SRGB_ENCODE_SEGMENTS + 1];
+static float srgb8_decode_table[256];
+/* srgb8_thresholds[c] is the smallest float which is encoded as c. */
+static float srgb8_thresholds[256];
+static int srgb_tables_ready;
+
+static double
+srgb_to_linear_exact(double s)
+{
+	if (s <= 0.04045)
+		return s / 12.92;
+	return pow((s + 0.055) / 1.055, 2.4);
+}
+
+static void
+init_srgb_tables(void)
+{
+	int i;
+
+	if (srgb_tables_ready)
+		return;
+
+	for (i = 0; i <= SRGB_DECODE_SEGMENTS; i++)
+		srgb_decode_table[i] = srgb_to_linear_exact(
+			(double) i / SRGB_DECODE_SEGMENTS);
+
+	/* Every segment is above the linear part, so use the power curve
+	 * for all of the nodes, including the first one.
+	 */
+	for (i = 0; i <= SRGB_ENCODE_SEGMENTS; i++) {
+		const double x = bits_float(SRGB_ENCODE_MIN +
+					    (i << (23 - SRGB_ENCODE_BITS)));
+		srgb_encode_table[i] = 1.055 * pow(x, 1.0 / 2.4) - 0.055;
+	}
+
+	srgb8_thresholds[0] = -INFINITY;
+	for (i = 0; i < 256; i++) {
+		srgb8_decode_table[i] = srgb_to_linear_exact(i / 255.0);
+
+		if (i > 0) {
+			const double t =
+				srgb_to_linear_exact((i - 0.5) / 255.0);
+			float f = t;
+
+			if (f < t)
+				f = nextafterf(f, INFINITY);
+			srgb8_thresholds[i] = f;
+		}
+	}
+
+	srgb_tables_ready = 1;
+}
+
+void
+piglit_convert_srgb_to_linear(float *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	init_srgb_tables();
+
+	for (i = 0; i < n; i++) {
+		const float t = clamp01(src[i]) * SRGB_DECODE_SEGMENTS;
+		int j = (int) t;
+		float a, b;
+
+		if (j == SRGB_DECODE_SEGMENTS)
+			j--;
+		a = srgb_decode_table[j];
+		b = srgb_decode_table[j + 1];
+		dst[i] = a + (b - a) * (t - j);
+	}
+}
+
+void
+piglit_convert_linear_to_srgb(float *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	init_srgb_tables();
+
+	for (i = 0; i < n; i++) {
+		const float x = clamp01(src[i]);
+
+		if (x < 0.0031308f) {
+			dst[i] = 12.92f * x;
+		} else if (x == 1.0f) {
+			dst[i] = 1.0f;
+		} else {
+			/* Within an octave x is linear in its mantissa, so
+			 * the low mantissa bits are the position in the
+			 * segment.
+			 */
+			const uint32_t off = float_bits(x) - SRGB_ENCODE_MIN;
+			const uint32_t j = off >> (23 - SRGB_ENCODE_BITS);
+			const float t = (off & ((1 << (23 - SRGB_ENCODE_BITS)) - 1)) *
+				(1.0f / (1 << (23 - SRGB_ENCODE_BITS)));
+			const float a = srgb_encode_table[j];
+			const float b = srgb_encode_table[j + 1];
+
+			dst[i] = a + (b - a) * t;
+		}
+	}
+}
+
+void
+piglit_convert_srgb8_to_linear(float *dst, const uint8_t *src, size_t n)
+{
+	size_t i;
+
+	init_srgb_tables();
+
+	for (i = 0; i < n; i++)
+		dst[i] = srgb8_decode_table[src[i]];
+}
+
+void
+piglit_convert_linear_to_srgb8(uint8_t *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	init_srgb_tables();
+
+	for (i = 0; i < n; i++) {
+		const float x = src[i];
+		unsigned c = 0, step;
+
+		/* The largest c whose threshold is <= x.  NaN compares
+		 * false everywhere and encodes as 0.
+		 */
+		for (step = 128; step; step >>= 1) {
+			if (x >= srgb8_thresholds[c + step])
+				c += step;
+		}
+		dst[i] = c;
+	}
+}
+
+/* Normalized integers */
+
+float
+piglit_unorm_to_float(unsigned bits, uint32_t v)
+{
+	const uint32_t max = ~0u >> (32 - bits);
+	return (float) v / (float) max;
+}
+
+float
+piglit_snorm_to_float(unsigned bits, int32_t v)
+{
+	const int32_t max = (int32_t) (~0u >> (33 - bits));
+	if (v < -max)
+		v = -max;
+	return (float) v / (float) max;
+}
+
+void
+piglit_convert_unorm8_to_float(float *dst, const uint8_t *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (float) src[i] / 255.0f;
+}
+
+void
+piglit_convert_unorm16_to_float(float *dst, const uint16_t *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (float) src[i] / 65535.0f;
+}
+
+void
+piglit_convert_snorm8_to_float(float *dst, const int8_t *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		const float f = (float) src[i] / 127.0f;
+		dst[i] = f < -1.0f ? -1.0f : f;
+	}
+}
+
+void
+piglit_convert_snorm16_to_float(float *dst, const int16_t *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		const float f = (float) src[i] / 32767.0f;
+		dst[i] = f < -1.0f ? -1.0f : f;
+	}
+}
+
+void
+piglit_convert_float_to_unorm8(uint8_t *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (uint8_t) (clamp01(src[i]) * 255.0f + 0.5f);
+}
+
+void
+piglit_convert_float_to_unorm16(uint16_t *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (uint16_t) (clamp01(src[i]) * 65535.0f + 0.5f);
+}
+
+static inline float
+clamp_snorm(float x)
+{
+	return x > -1.0f ? (x < 1.0f ? x : 1.0f) : (x == x ? -1.0f : 0.0f);
+}
+
+void
+piglit_convert_float_to_snorm8(int8_t *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (int8_t) floorf(clamp_snorm(src[i]) * 127.0f + 0.5f);
+}
+
+void
+piglit_convert_float_to_snorm16(int16_t *dst, const float *src, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = (int16_t) floorf(clamp_snorm(src[i]) * 32767.0f +
+					  0.5f);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-format-convert.h
+ *
+ * Conversions between floats and the packed, half float, sRGB and
+ * normalized representations used by texture and renderbuffer formats.
+ *
+ * Every conversion works on an array of n values (or n pixels, for the
+ * shared exponent and packed float formats, whose float side is 3 floats
+ * per pixel) so that the expected images of format tests can be built in
+ * one call. Source and destination may be the same array when both sides
+ * have the same size.
+ *
+ * None of this depends on GL, so it is part of piglitutil.
+ */
+
+#ifndef PIGLIT_FORMAT_CONVERT_H
+#define PIGLIT_FORMAT_CONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Half floats.  Floats are truncated towards zero, values too large for a
+ * half become infinity, and NaN becomes a NaN with the same sign. This
+ * matches piglit_half_from_float().
+ */
+void
+piglit_convert_float_to_half(uint16_t *dst, const float *src, size_t n);
+
+void
+piglit_convert_half_to_float(float *dst, const uint16_t *src, size_t n);
+
+/**
+ * GL_RGB9_E5, as specified by EXT_texture_shared_exponent.
+ */
+void
+piglit_convert_float3_to_rgb9e5(uint32_t *dst, const float *src, size_t n);
+
+void
+piglit_convert_rgb9e5_to_float3(float *dst, const uint32_t *src, size_t n);
+
+/**
+ * GL_R11F_G11F_B10F, as specified by EXT_packed_float.  Mantissas are
+ * truncated.
+ */
+void
+piglit_convert_float3_to_r11g11b10f(uint32_t *dst, const float *src,
+				    size_t n);
+
+void
+piglit_convert_r11g11b10f_to_float3(float *dst, const uint32_t *src,
+				    size_t n);
+
+/**
+ * sRGB encoding, using the formulas from the GL 3.0 spec, section 4.1.8.
+ * Values outside of [0, 1] are clamped.  The float conversions interpolate
+ * in tables, and are within 1e-6 of the exact results.  The 8-bit
+ * conversions are exact: linear_to_srgb8 rounds to the nearest code.
+ */
+void
+piglit_convert_srgb_to_linear(float *dst, const float *src, size_t n);
+
+void
+piglit_convert_linear_to_srgb(float *dst, const float *src, size_t n);
+
+void
+piglit_convert_srgb8_to_linear(float *dst, const uint8_t *src, size_t n);
+
+void
+piglit_convert_linear_to_srgb8(uint8_t *dst, const float *src, size_t n);
+
+/**
+ * Normalized integers.  An unsigned value v of b bits is v / (2^b - 1), and
+ * a signed value is max(v / (2^(b-1) - 1), -1).  Floats are clamped and
+ * rounded to the nearest value.
+ */
+float
+piglit_unorm_to_float(unsigned bits, uint32_t v);
+
+float
+piglit_snorm_to_float(unsigned bits, int32_t v);
+
+void
+piglit_convert_unorm8_to_float(float *dst, const uint8_t *src, size_t n);
+
+void
+piglit_convert_unorm16_to_float(float *dst, const uint16_t *src, size_t n);
+
+void
+piglit_convert_snorm8_to_float(float *dst, const int8_t *src, size_t n);
+
+void
+piglit_convert_snorm16_to_float(float *dst, const int16_t *src, size_t n);
+
+void
+piglit_convert_float_to_unorm8(uint8_t *dst, const float *src, size_t n);
+
+void
+piglit_convert_float_to_unorm16(uint16_t *dst, const float *src, size_t n);
+
+void
+piglit_convert_float_to_snorm8(int8_t *dst, const float *src, size_t n);
+
+void
+piglit_convert_float_to_snorm16(int16_t *dst, const float *src, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIGLIT_FORMAT_CONVERT_H */
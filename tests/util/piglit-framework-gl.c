@@ -177,18 +177,64 @@ piglit_gl_process_args(int *argc, char *argv[],
 static void
 destroy(void)
 {
+	piglit_phase_begin(PIGLIT_PHASE_TEARDOWN);
 	if (gl_fw->destroy)
 		gl_fw->destroy(gl_fw);
+	piglit_phase_end(PIGLIT_PHASE_TEARDOWN);
+
+	piglit_report_phases();
+}
+
+/* The test's own callbacks, which timed_config wraps in phases. */
+static void (*test_init)(int argc, char *argv[]);
+static enum piglit_result (*test_display)(void);
+static struct piglit_gl_test_config timed_config;
+
+static void
+timed_init(int argc, char *argv[])
+{
+	piglit_phase_end(PIGLIT_PHASE_FRAMEWORK);
+
+	piglit_phase_begin(PIGLIT_PHASE_INIT);
+	test_init(argc, argv);
+	piglit_phase_end(PIGLIT_PHASE_INIT);
+}
+
+static enum piglit_result
+timed_display(void)
+{
+	enum piglit_result result;
+
+	piglit_phase_end(PIGLIT_PHASE_FRAMEWORK);
+
+	piglit_phase_begin(PIGLIT_PHASE_DISPLAY);
+	result = test_display();
+	piglit_phase_end(PIGLIT_PHASE_DISPLAY);
+
+	return result;
 }
 
 void
 piglit_gl_test_run(int argc, char *argv[],
 		   const struct piglit_gl_test_config *config)
 {
+	piglit_phase_begin(PIGLIT_PHASE_FRAMEWORK);
+
 	piglit_width = config->window_width;
 	piglit_height = config->window_height;
 
-	gl_fw = piglit_gl_framework_factory(config);
+	/* Every framework calls init and display through the config, so
+	 * wrapping them here times them for all of the frameworks.
+	 */
+	timed_config = *config;
+	test_init = config->init;
+	test_display = config->display;
+	if (config->init)
+		timed_config.init = timed_init;
+	if (config->display)
+		timed_config.display = timed_display;
+
+	gl_fw = piglit_gl_framework_factory(&timed_config);
 	if (gl_fw == NULL) {
 		printf("piglit: error: failed to create "
 		       "piglit_gl_framework\n");
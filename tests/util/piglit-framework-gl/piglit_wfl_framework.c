@@ -514,7 +514,9 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 	assert(attrib_list);
 	make_context_description(ctx_desc, sizeof(ctx_desc),
 				 attrib_list, flavor);
+	piglit_phase_begin(PIGLIT_PHASE_CONFIG);
 	wfl_fw->config = waffle_config_choose(wfl_fw->display, attrib_list);
+	piglit_phase_end(PIGLIT_PHASE_CONFIG);
 	free(attrib_list);
 	if (!wfl_fw->config) {
 		wfl_log_error("waffle_config_choose");
@@ -523,8 +525,10 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 		goto fail;
 	}
 
+	piglit_phase_begin(PIGLIT_PHASE_CONTEXT);
 	wfl_fw->context = waffle_context_create(wfl_fw->config, NULL);
 	if (!wfl_fw->context) {
+		piglit_phase_end(PIGLIT_PHASE_CONTEXT);
 		wfl_log_error("waffle_context_create");
 		fprintf(stderr, "piglit: error: Failed to create "
 			"waffle_context for %s\n", ctx_desc);
@@ -538,7 +542,9 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 	wfl_checked_make_current(wfl_fw->display,
 	                         wfl_fw->window,
 	                         wfl_fw->context);
+	piglit_phase_end(PIGLIT_PHASE_CONTEXT);
 
+	piglit_phase_begin(PIGLIT_PHASE_DISPATCH);
 #ifdef PIGLIT_USE_OPENGL
 	piglit_dispatch_default_init(PIGLIT_DISPATCH_GL);
 #elif defined(PIGLIT_USE_OPENGL_ES1)
@@ -548,6 +554,7 @@ make_context_current_singlepass(struct piglit_wfl_framework *wfl_fw,
 #else
 #	error
 #endif
+	piglit_phase_end(PIGLIT_PHASE_DISPATCH);
 
 	ok = check_gl_version(test_config, flavor, ctx_desc);
 	if (!ok)
@@ -640,6 +647,7 @@ piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
 
 	bool ok = true;
 
+	piglit_phase_begin(PIGLIT_PHASE_PLATFORM);
 	if (is_waffle_initialized) {
 		assert(platform == initialized_platform);
 	} else {
@@ -659,6 +667,8 @@ piglit_wfl_framework_init(struct piglit_wfl_framework *wfl_fw,
 
 	wfl_fw->platform = platform;
 	wfl_fw->display = wfl_checked_display_connect(NULL);
+	piglit_phase_end(PIGLIT_PHASE_PLATFORM);
+
 	make_context_current(wfl_fw, test_config, partial_config_attrib_list);
 
 	return true;
@@ -0,0 +1,290 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-rasterizer.c
+ *
+ * Half-edge rasterization in 64-bit fixed point, based on
+ * http://devmaster.net/forums/topic/1145-advanced-rasterization
+ *
+ * The edge functions are linear in x, so instead of evaluating them at
+ * every pixel, each row solves them for the first and last covered pixel
+ * and fills the span in between, with SSE2 stores when the compiler
+ * targets it.  The result is exactly the set of pixels a per-pixel test
+ * gives.
+ */
+
+#include <limits.h>
+
+#include "piglit-rasterizer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Don't start a thread for fewer bounding box pixels than this. */
+#define MIN_PIXELS_PER_THREAD 16384
+
+struct edge {
+	/* Value at the center of pixel (minx, miny). */
+	int64_t c;
+	/* Change per row and per column. */
+	int64_t step_y, step_x;
+};
+
+struct setup {
+	struct edge edges[3];
+	int minx, maxx, miny, maxy;
+};
+
+/* Proper rounding of float to integer */
+static int64_t
+iround(float v)
+{
+	if (v > 0.0f)
+		v += 0.5f;
+	if (v < 0.0f)
+		v -= 0.5f;
+	return (int64_t) v;
+}
+
+/* Rounds towards minus infinity, for b > 0. */
+static int64_t
+floor_div(int64_t a, int64_t b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * Whether pixel centers on the edge going by (dx, dy) belong to the
+ * triangle, for a triangle with clockwise vertices.
+ */
+static bool
+owns_edge(enum piglit_fill_convention convention, int64_t dx, int64_t dy)
+{
+	switch (convention) {
+	case PIGLIT_FILL_BOTTOM_RIGHT:
+		return dy > 0 || (dy == 0 && dx > 0);
+	case PIGLIT_FILL_RIGHT_BOTTOM:
+		return dx < 0 || (dx == 0 && dy < 0);
+	case PIGLIT_FILL_LEFT_BOTTOM:
+		return dx < 0 || (dx == 0 && dy > 0);
+	case PIGLIT_FILL_BOTTOM_LEFT:
+		return dy < 0 || (dy == 0 && dx > 0);
+	case PIGLIT_FILL_TOP_LEFT:
+		return dy < 0 || (dy == 0 && dx < 0);
+	case PIGLIT_FILL_LEFT_TOP:
+		return dx > 0 || (dx == 0 && dy > 0);
+	case PIGLIT_FILL_RIGHT_TOP:
+		return dx > 0 || (dx == 0 && dy < 0);
+	case PIGLIT_FILL_TOP_RIGHT:
+		return dy > 0 || (dy == 0 && dx < 0);
+	}
+
+	assert(!"unknown fill convention");
+	return false;
+}
+
+/**
+ * Compute the edge functions of a triangle.  Returns false if its bounding
+ * box is outside the destination.
+ */
+static bool
+setup_triangle(const struct piglit_rasterizer *rast, const float *v,
+	       struct setup *setup)
+{
+	const int shift = rast->subpixel_bits;
+	const float one = (float) (1 << shift);
+	const float center_offset = -0.5f;
+	int64_t x[3], y[3], minx, maxx, miny, maxy, tmp;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		x[i] = iround(one * (v[2 * i] + center_offset));
+		y[i] = iround(one * (v[2 * i + 1] + center_offset));
+	}
+
+	/* Force clockwise vertex order */
+	if ((x[1] - x[0]) * (y[2] - y[1]) - (y[1] - y[0]) * (x[2] - x[1]) > 0) {
+		tmp = x[0]; x[0] = x[2]; x[2] = tmp;
+		tmp = y[0]; y[0] = y[2]; y[2] = tmp;
+	}
+
+	/* Bounding rectangle, in pixels */
+	minx = MAX2(MIN2(MIN2(x[0], x[1]), x[2]) >> shift, 0);
+	maxx = MIN2(MAX2(MAX2(x[0], x[1]), x[2]) >> shift,
+		    (int64_t) rast->width - 1);
+	miny = MAX2(MIN2(MIN2(y[0], y[1]), y[2]) >> shift, 0);
+	maxy = MIN2(MAX2(MAX2(y[0], y[1]), y[2]) >> shift,
+		    (int64_t) rast->height - 1);
+	if (minx > maxx || miny > maxy)
+		return false;
+
+	for (i = 0; i < 3; i++) {
+		const int j = (i + 1) % 3;
+		const int64_t dx = x[i] - x[j];
+		const int64_t dy = y[i] - y[j];
+		struct edge *e = &setup->edges[i];
+
+		e->c = dy * x[i] - dx * y[i];
+		if (owns_edge(rast->convention, dx, dy))
+			e->c++;
+
+		e->step_y = dx * ((int64_t) 1 << shift);
+		e->step_x = -dy * ((int64_t) 1 << shift);
+		e->c += e->step_y * miny + e->step_x * minx;
+	}
+
+	setup->minx = minx;
+	setup->maxx = maxx;
+	setup->miny = miny;
+	setup->maxy = maxy;
+	return true;
+}
+
+static void
+fill_span(uint32_t *dst, int n, uint32_t value)
+{
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128i v = _mm_set1_epi32(value);
+
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_si128((__m128i *) (dst + i), v);
+#endif
+
+	for (; i < n; i++)
+		dst[i] = value;
+}
+
+/**
+ * Fill the rows of \p setup in [first_row, end_row).  Each edge function
+ * c - k * step is positive for k below c / step if the step is positive,
+ * or above it if the step is negative, so the covered columns of a row
+ * are an intersection of three ranges.
+ */
+static void
+rasterize_rows(const struct piglit_rasterizer *rast,
+	       const struct setup *setup, int first_row, int end_row,
+	       uint32_t value)
+{
+	const int64_t last = setup->maxx - setup->minx;
+	int y, i;
+
+	first_row = MAX2(first_row, setup->miny);
+	end_row = MIN2(end_row, setup->maxy + 1);
+
+	for (y = first_row; y < end_row; y++) {
+		int64_t lo = 0, hi = last;
+
+		for (i = 0; i < 3 && lo <= hi; i++) {
+			const struct edge *e = &setup->edges[i];
+			const int64_t c = e->c + e->step_y * (y - setup->miny);
+			const int64_t step = -e->step_x;
+
+			if (step == 0) {
+				if (c <= 0)
+					hi = -1;
+			} else if (step > 0) {
+				hi = MIN2(hi, floor_div(c - 1, step));
+			} else {
+				lo = MAX2(lo, floor_div(-c, -step) + 1);
+			}
+		}
+
+		if (lo <= hi) {
+			fill_span(rast->buffer + (size_t) y * rast->stride +
+				  setup->minx + lo, hi - lo + 1, value);
+		}
+	}
+}
+
+void
+piglit_rasterize_triangle(const struct piglit_rasterizer *rast,
+			  const float vertices[6], uint32_t value)
+{
+	struct setup setup;
+
+	if (setup_triangle(rast, vertices, &setup))
+		rasterize_rows(rast, &setup, setup.miny, setup.maxy + 1, value);
+}
+
+struct batch_job {
+	const struct piglit_rasterizer *rast;
+	const struct setup *setups;
+	const uint32_t *values;
+	unsigned count;
+};
+
+/**
+ * Rasterize the rows from \p first_row to \p end_row, for
+ * piglit_parallel_for().  The loop over triangles is the outer one, so
+ * every pixel still sees the triangles in order.
+ */
+static void
+rasterize_slice(unsigned first_row, unsigned end_row, void *data)
+{
+	const struct batch_job *job = data;
+	unsigned i;
+
+	for (i = 0; i < job->count; i++) {
+		rasterize_rows(job->rast, &job->setups[i], first_row, end_row,
+			       job->values[i]);
+	}
+}
+
+void
+piglit_rasterize_triangles(const struct piglit_rasterizer *rast,
+			   const float *vertices, unsigned count,
+			   const uint32_t *values)
+{
+	struct setup *setups = malloc(count * sizeof(*setups));
+	uint32_t *setup_values = malloc(count * sizeof(*setup_values));
+	struct batch_job job;
+	uint64_t pixels = 0;
+	unsigned i, n = 0, min_rows;
+
+	for (i = 0; i < count; i++) {
+		struct setup *s = &setups[n];
+
+		if (setup_triangle(rast, vertices + 6 * i, s)) {
+			pixels += (uint64_t) (s->maxx - s->minx + 1) *
+				  (s->maxy - s->miny + 1);
+			setup_values[n++] = values[i];
+		}
+	}
+
+	job.rast = rast;
+	job.setups = setups;
+	job.values = setup_values;
+	job.count = n;
+
+	/* As if the pixels were spread evenly over the rows. */
+	min_rows = MIN2((uint64_t) MIN_PIXELS_PER_THREAD * rast->height /
+			(pixels + 1) + 1, UINT_MAX);
+	piglit_parallel_for(rast->height, min_rows, rasterize_slice, &job);
+
+	free(setup_values);
+	free(setups);
+}
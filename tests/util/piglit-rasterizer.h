@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-rasterizer.h
+ *
+ * A reference triangle rasterizer, for tests that compare the fragments GL
+ * produces against the ones the spec allows.
+ *
+ * Vertices are snapped to a fixed point grid with the given number of
+ * sub-pixel bits, and a pixel is covered when its center is strictly inside
+ * all three edges, or lies on an edge that the fill convention gives to the
+ * triangle.  Covered pixels are set to a 32-bit value; nothing is blended.
+ */
+
+#ifndef PIGLIT_RASTERIZER_H
+#define PIGLIT_RASTERIZER_H
+
+#include "piglit-util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Which edges own the pixel centers that lie on them.  "Bottom left" means
+ * that bottom horizontal edges and left facing edges belong to the
+ * triangle; "left bottom" that left vertical edges and bottom facing edges
+ * do, and so on.
+ *
+ * The order is that of the eight triangles around a pixel center, starting
+ * with the one right of the center and going counter-clockwise, see
+ * get_filling_convention() in triangle-rasterization.cpp.
+ */
+enum piglit_fill_convention {
+	PIGLIT_FILL_BOTTOM_LEFT,
+	PIGLIT_FILL_LEFT_BOTTOM,
+	PIGLIT_FILL_RIGHT_BOTTOM,
+	PIGLIT_FILL_BOTTOM_RIGHT,
+	PIGLIT_FILL_TOP_RIGHT,
+	PIGLIT_FILL_RIGHT_TOP,
+	PIGLIT_FILL_LEFT_TOP,
+	PIGLIT_FILL_TOP_LEFT
+};
+
+struct piglit_rasterizer {
+	unsigned subpixel_bits;
+	enum piglit_fill_convention convention;
+
+	/**
+	 * The destination, with pixel (x, y) at buffer[y * stride + x].
+	 * Nothing outside width x height is written.
+	 */
+	uint32_t *buffer;
+	unsigned width, height, stride;
+};
+
+/**
+ * Set the pixels covered by the triangle at \p vertices, given as three
+ * (x, y) pairs in window coordinates, to \p value.
+ */
+void
+piglit_rasterize_triangle(const struct piglit_rasterizer *rast,
+			  const float vertices[6], uint32_t value);
+
+/**
+ * Rasterize \p count triangles, laid out as for
+ * glVertexPointer(2, GL_FLOAT, 0, vertices) and GL_TRIANGLES, setting the
+ * pixels covered by triangle i to values[i].  Where triangles overlap, the
+ * later one wins, as if they were drawn one at a time.  Large batches are
+ * split between threads by ranges of rows.
+ */
+void
+piglit_rasterize_triangles(const struct piglit_rasterizer *rast,
+			   const float *vertices, unsigned count,
+			   const uint32_t *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIGLIT_RASTERIZER_H */
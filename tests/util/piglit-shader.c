@@ -22,6 +22,7 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
 
 #include "piglit-util-gl.h"
 
@@ -118,6 +119,150 @@ shader_name(GLenum target)
    return "error";
 }
 
+/**
+ * Whether PIGLIT_SHADER_TIMING is set to something other than 0.
+ */
+static bool
+shader_timing_enabled(void)
+{
+	static int enabled = -1;
+
+	if (enabled < 0) {
+		const char *env = getenv("PIGLIT_SHADER_TIMING");
+		enabled = env != NULL && strcmp(env, "0") != 0;
+	}
+
+	return enabled;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+/** 64-bit FNV-1a */
+static uint64_t
+hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = data;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static uint64_t
+shader_source_hash(GLuint shader)
+{
+	GLchar *source;
+	GLint size = 0;
+	uint64_t hash;
+
+	glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &size);
+	if (size <= 0)
+		return FNV_OFFSET;
+
+	source = malloc(size);
+	glGetShaderSource(shader, size, NULL, source);
+	hash = hash_bytes(FNV_OFFSET, source, strlen(source));
+	free(source);
+
+	return hash;
+}
+
+/**
+ * Hash the sources of every shader attached to a program. The order of the
+ * attached shaders is up to the driver, so the hashes are combined in a way
+ * that doesn't depend on it.
+ */
+static uint64_t
+program_source_hash(GLuint prog)
+{
+	GLuint *shaders;
+	GLint count = 0;
+	uint64_t sum = 0;
+	int i;
+
+	glGetProgramiv(prog, GL_ATTACHED_SHADERS, &count);
+	if (count <= 0)
+		return FNV_OFFSET;
+
+	shaders = malloc(count * sizeof(GLuint));
+	glGetAttachedShaders(prog, count, NULL, shaders);
+	for (i = 0; i < count; i++)
+		sum += shader_source_hash(shaders[i]);
+	free(shaders);
+
+	return hash_bytes(FNV_OFFSET, &sum, sizeof(sum));
+}
+
+static void
+report_shader_time(const char *stage, uint64_t hash, int64_t nsec)
+{
+	printf("PIGLIT: {\"shader_time\": [{\"stage\": \"%s\", "
+	       "\"hash\": \"%016" PRIx64 "\", \"time\": %.9f}]}\n",
+	       stage, hash, nsec / 1.0e9);
+	fflush(stdout);
+}
+
+/**
+ * Compile a shader object.
+ *
+ * This is glCompileShader(), except that if PIGLIT_SHADER_TIMING is set in
+ * the environment the time the driver took is reported to the framework,
+ * along with a hash of the source. The compile status is queried inside of
+ * the timed region, since that is what waits for a driver that compiles in
+ * parallel.
+ */
+void
+piglit_compile_shader_object(GLuint shader)
+{
+	int64_t start, end;
+	GLint ok, type;
+
+	if (!shader_timing_enabled()) {
+		glCompileShader(shader);
+		return;
+	}
+
+	start = piglit_time_get_nano();
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	end = piglit_time_get_nano();
+
+	glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+	report_shader_time(shader_name(type), shader_source_hash(shader),
+			   end - start);
+}
+
+/**
+ * Link a program object.
+ *
+ * This is glLinkProgram(), with the same timing as
+ * piglit_compile_shader_object(). The hash is of the sources of all of the
+ * attached shaders, so it must be called before they are detached.
+ */
+void
+piglit_link_program(GLuint prog)
+{
+	int64_t start, end;
+	GLint ok;
+
+	if (!shader_timing_enabled()) {
+		glLinkProgram(prog);
+		return;
+	}
+
+	start = piglit_time_get_nano();
+	glLinkProgram(prog);
+	glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+	end = piglit_time_get_nano();
+
+	report_shader_time("link", program_source_hash(prog), end - start);
+}
+
 /**
  * Convenience function to compile a GLSL shader.
  */
@@ -131,7 +276,7 @@ piglit_compile_shader_text_nothrow(GLenum target, const char *text)
 
 	prog = glCreateShader(target);
 	glShaderSource(prog, 1, (const GLchar **) &text, NULL);
-	glCompileShader(prog);
+	piglit_compile_shader_object(prog);
 
 	glGetShaderiv(prog, GL_COMPILE_STATUS, &ok);
 
@@ -258,7 +403,7 @@ GLint piglit_link_simple_program(GLint vs, GLint fs)
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_POS, "piglit_vertex");
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_TEX, "piglit_texcoord");
 
-	glLinkProgram(prog);
+	piglit_link_program(prog);
 
 	if (!piglit_link_check_status(prog)) {
 		glDeleteProgram(prog);
@@ -352,7 +497,7 @@ GLint piglit_link_simple_program_multiple_shaders(GLint shader1, ...)
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_POS, "piglit_vertex");
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_TEX, "piglit_texcoord");
 
-	glLinkProgram(prog);
+	piglit_link_program(prog);
 
 	if (!piglit_link_check_status(prog)) {
 		glDeleteProgram(prog);
@@ -452,7 +597,7 @@ piglit_build_simple_program_multiple_shaders(GLenum target1,
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_POS, "piglit_vertex");
 	glBindAttribLocation(prog, PIGLIT_ATTRIB_TEX, "piglit_texcoord");
 
-	glLinkProgram(prog);
+	piglit_link_program(prog);
 
 	if (!piglit_link_check_status(prog)) {
 		glDeleteProgram(prog);
@@ -30,6 +30,8 @@
  */
 void piglit_get_glsl_version(bool *es, int* major, int* minor);
 
+void piglit_compile_shader_object(GLuint shader);
+void piglit_link_program(GLuint prog);
 GLuint piglit_compile_shader(GLenum target, const char *filename);
 GLuint piglit_compile_shader_text_nothrow(GLenum target, const char *text);
 GLuint piglit_compile_shader_text(GLenum target, const char *text);
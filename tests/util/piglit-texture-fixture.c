@@ -0,0 +1,536 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-texture-fixture.c
+ *
+ * None of the patterns varies much along a row, and most rows are copies
+ * of another one, so images are built from runs of a texel and then whole
+ * rows and layers are copied.  Both are done by doubling memcpy()s.
+ */
+
+#include "piglit-texture-fixture.h"
+
+#define REPLICATE_BLOCK_SIZE (64 * 1024)
+
+static const float color_wheel[4][4] = {
+	{1, 0, 0, 1}, /* red */
+	{0, 1, 0, 1}, /* green */
+	{0, 0, 1, 1}, /* blue */
+	{1, 1, 1, 1}, /* white */
+};
+
+struct cache_entry {
+	struct piglit_fixture_desc desc;
+	struct piglit_fixture_chain chain;
+	struct cache_entry *next;
+};
+
+/* Most recently used first. */
+static struct cache_entry *cache;
+static size_t cache_size;
+static size_t cache_limit = PIGLIT_FIXTURE_CACHE_LIMIT;
+static unsigned cache_misses;
+
+void
+piglit_fixture_init_desc(struct piglit_fixture_desc *desc,
+			 enum piglit_fixture_pattern pattern, GLenum target,
+			 int width, int height, int depth, bool mip,
+			 GLenum format, GLenum type)
+{
+	/* Clear the padding too, descriptions are compared with memcmp. */
+	memset(desc, 0, sizeof(*desc));
+	desc->pattern = pattern;
+	desc->target = target;
+	desc->width = width;
+	desc->height = height;
+	desc->depth = depth;
+	desc->mip = mip;
+	desc->format = format;
+	desc->type = type;
+}
+
+static size_t
+texel_size(const struct piglit_fixture_desc *desc)
+{
+	switch (desc->type) {
+	case GL_UNSIGNED_BYTE:
+		return 4;
+	case GL_FLOAT:
+		return desc->format == GL_RGBA ? 16 : 4;
+	case GL_UNSIGNED_INT_24_8:
+		return 4;
+	case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+		return 8;
+	default:
+		assert(!"unsupported fixture type");
+		return 0;
+	}
+}
+
+/**
+ * Repeat the first \p size bytes of \p dst until there are \p count
+ * copies.
+ */
+static void
+replicate(void *dst, size_t size, size_t count)
+{
+	const size_t total = size * count;
+	size_t block = size, done = size;
+
+	while (done < total) {
+		const size_t n = MIN2(block, total - done);
+
+		memcpy((char *) dst + done, dst, n);
+		done += n;
+
+		/* Stop doubling while the source still fits in the cache. */
+		if (block < REPLICATE_BLOCK_SIZE)
+			block = done;
+	}
+}
+
+static void
+fill_texels(void *dst, const void *texel, size_t size, size_t count)
+{
+	if (count == 0)
+		return;
+
+	memcpy(dst, texel, size);
+	replicate(dst, size, count);
+}
+
+/**
+ * Convert \p color to a texel of \p type.  Unsigned bytes are truncated,
+ * like piglit_checkerboard_texture() always did.
+ */
+static void
+pack_color(GLenum type, const float color[4], uint8_t *texel)
+{
+	unsigned c;
+
+	if (type == GL_UNSIGNED_BYTE) {
+		for (c = 0; c < 4; c++)
+			texel[c] = color[c] * 255;
+	} else {
+		memcpy(texel, color, 4 * sizeof(float));
+	}
+}
+
+static bool
+rgbw_is_block_compressed(GLenum internalformat)
+{
+	switch (internalformat) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGB_FXT1_3DFX:
+	case GL_COMPRESSED_RGBA_FXT1_3DFX:
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_SIGNED_RED_RGTC1:
+	case GL_COMPRESSED_RG_RGTC2:
+	case GL_COMPRESSED_SIGNED_RG_RGTC2:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Red, green, blue and white texels of \p desc.
+ */
+static void
+rgbw_colors(const struct piglit_fixture_desc *desc, uint8_t colors[4][16])
+{
+	static const GLubyte ubyte_colors[4][4] = {
+		{255, 0, 0, 0},
+		{0, 255, 0, 64},
+		{0, 0, 255, 128},
+		{255, 255, 255, 255},
+	};
+	float float_colors[4][4] = {
+		{1.0, 0.0, 0.0, 0.0},
+		{0.0, 1.0, 0.0, 0.25},
+		{0.0, 0.0, 1.0, 0.5},
+		{1.0, 1.0, 1.0, 1.0},
+	};
+	unsigned i, c;
+
+	if (desc->type == GL_UNSIGNED_BYTE) {
+		for (i = 0; i < 4; i++) {
+			memcpy(colors[i], ubyte_colors[i], 4);
+			if (!desc->alpha)
+				colors[i][3] = 255;
+		}
+		return;
+	}
+
+	for (i = 0; i < 4; i++) {
+		if (!desc->alpha)
+			float_colors[i][3] = 1.0;
+
+		for (c = 0; c < 4; c++) {
+			switch (desc->basetype) {
+			case GL_UNSIGNED_NORMALIZED:
+				break;
+			case GL_SIGNED_NORMALIZED:
+				float_colors[i][c] = float_colors[i][c] * 2 - 1;
+				break;
+			case GL_FLOAT:
+				float_colors[i][c] = float_colors[i][c] * 10 - 5;
+				break;
+			default:
+				assert(0);
+			}
+		}
+
+		memcpy(colors[i], float_colors[i], sizeof(float_colors[i]));
+	}
+}
+
+static void
+rgbw_image(const struct piglit_fixture_desc *desc, int w, int h,
+	   uint8_t *dst)
+{
+	const size_t ts = texel_size(desc);
+	const size_t row = w * ts;
+	const int size = MAX2(w, h);
+	uint8_t colors[4][16];
+
+	rgbw_colors(desc, colors);
+
+	/* Blocks don't fit into the quadrants of the smallest levels, so
+	 * they are solid instead.
+	 */
+	if (desc->type == GL_FLOAT &&
+	    rgbw_is_block_compressed(desc->internalformat) &&
+	    (size == 4 || size == 2 || size == 1)) {
+		fill_texels(dst, colors[size == 4 ? 0 : size == 2 ? 1 : 2],
+			    ts, w * h);
+		return;
+	}
+
+	if (h / 2 > 0) {
+		fill_texels(dst, colors[0], ts, w / 2);
+		fill_texels(dst + w / 2 * ts, colors[1], ts, w - w / 2);
+		replicate(dst, row, h / 2);
+		dst += h / 2 * row;
+	}
+
+	fill_texels(dst, colors[2], ts, w / 2);
+	fill_texels(dst + w / 2 * ts, colors[3], ts, w - w / 2);
+	replicate(dst, row, h - h / 2);
+}
+
+static void
+checkerboard_image(const struct piglit_fixture_desc *desc, int w, int h,
+		   uint8_t *dst)
+{
+	const size_t ts = texel_size(desc);
+	const size_t row = w * ts;
+	uint8_t colors[2][16];
+	int x, y;
+
+	pack_color(desc->type, desc->colors[0], colors[0]);
+	pack_color(desc->type, desc->colors[1], colors[1]);
+
+	for (y = 0; y < h; y += desc->square_height) {
+		const unsigned square_row = y / desc->square_height;
+
+		for (x = 0; x < w; x += desc->square_width) {
+			const unsigned square_col = x / desc->square_width;
+
+			fill_texels(dst + x * ts,
+				    colors[(square_row ^ square_col) & 1], ts,
+				    MIN2(desc->square_width, (unsigned) (w - x)));
+		}
+
+		replicate(dst, row, MIN2(desc->square_height,
+					 (unsigned) (h - y)));
+		dst += desc->square_height * row;
+	}
+}
+
+static void
+depth_gradient_image(const struct piglit_fixture_desc *desc, int w, int h,
+		     uint8_t *dst)
+{
+	int x;
+
+	for (x = 0; x < w; x++) {
+		const float val = (float)(x) / (w - 1);
+
+		switch (desc->type) {
+		case GL_FLOAT:
+			((float *) dst)[x] = val;
+			break;
+		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+			((float *) dst)[x * 2] = val;
+			((uint32_t *) dst)[x * 2 + 1] = 0;
+			break;
+		case GL_UNSIGNED_INT_24_8:
+			((uint32_t *) dst)[x] = 0xffffff00 * val;
+			break;
+		default:
+			assert(!"unsupported depth type");
+		}
+	}
+
+	replicate(dst, w * texel_size(desc), h);
+}
+
+static void
+generate_level(const struct piglit_fixture_desc *desc, unsigned level,
+	       int w, int h, int d, uint8_t *dst)
+{
+	const size_t ts = texel_size(desc);
+	uint8_t texel[16];
+	int layers, layer;
+	size_t layer_texels;
+
+	switch (desc->pattern) {
+	case PIGLIT_FIXTURE_RGBW:
+		rgbw_image(desc, w, h, dst);
+		break;
+	case PIGLIT_FIXTURE_CHECKERBOARD:
+		checkerboard_image(desc, w, h, dst);
+		break;
+	case PIGLIT_FIXTURE_DEPTH_GRADIENT:
+		depth_gradient_image(desc, w, h, dst);
+		break;
+	case PIGLIT_FIXTURE_LEVEL_COLORS:
+		pack_color(desc->type,
+			   color_wheel[level % ARRAY_SIZE(color_wheel)],
+			   texel);
+		fill_texels(dst, texel, ts, (size_t) w * h * d);
+		return;
+	case PIGLIT_FIXTURE_LAYER_COLORS:
+		layers = desc->target == GL_TEXTURE_1D_ARRAY ? h : d;
+		layer_texels = (size_t) w * h * d / layers;
+
+		for (layer = 0; layer < layers; layer++) {
+			pack_color(desc->type,
+				   color_wheel[layer % ARRAY_SIZE(color_wheel)],
+				   texel);
+			fill_texels(dst + layer * layer_texels * ts, texel, ts,
+				    layer_texels);
+		}
+		return;
+	}
+
+	/* The other patterns are the same in every layer. */
+	replicate(dst, (size_t) w * h * ts, d);
+}
+
+void
+piglit_fixture_generate_image(const struct piglit_fixture_desc *desc,
+			      void *data)
+{
+	generate_level(desc, 0, desc->width, desc->height, desc->depth, data);
+}
+
+static void
+generate_chain(const struct piglit_fixture_desc *desc,
+	       struct piglit_fixture_chain *chain)
+{
+	const bool shrink_h = desc->target != GL_TEXTURE_1D &&
+			      desc->target != GL_TEXTURE_1D_ARRAY;
+	const bool shrink_d = desc->target == GL_TEXTURE_3D;
+	const size_t ts = texel_size(desc);
+	int w = desc->width, h = desc->height, d = desc->depth;
+	int size = MAX2(w, MAX2(shrink_h ? h : 1, shrink_d ? d : 1));
+	unsigned i;
+
+	/* Lay the levels out first, so that one allocation will do. */
+	chain->num_levels = 0;
+	chain->size = 0;
+	for (; size > 0; size >>= 1) {
+		struct piglit_fixture_level *level =
+			&chain->levels[chain->num_levels++];
+
+		assert(chain->num_levels <= PIGLIT_FIXTURE_MAX_LEVELS);
+		level->width = w;
+		level->height = h;
+		level->depth = d;
+		level->offset = chain->size;
+		chain->size += (size_t) w * h * d * ts;
+
+		if (!desc->mip)
+			break;
+
+		w = MAX2(w / 2, 1);
+		if (shrink_h)
+			h = MAX2(h / 2, 1);
+		if (shrink_d)
+			d = MAX2(d / 2, 1);
+	}
+
+	chain->data = malloc(chain->size);
+	for (i = 0; i < chain->num_levels; i++) {
+		const struct piglit_fixture_level *level = &chain->levels[i];
+
+		generate_level(desc, i, level->width, level->height,
+			       level->depth,
+			       (uint8_t *) chain->data + level->offset);
+	}
+}
+
+/**
+ * Free the least recently used chains until the cache fits in its limit.
+ * The most recently used one is kept, as the caller may still use it.
+ */
+static void
+evict(void)
+{
+	while (cache_size > cache_limit && cache && cache->next) {
+		struct cache_entry **last = &cache;
+
+		while ((*last)->next)
+			last = &(*last)->next;
+
+		cache_size -= (*last)->chain.size;
+		free((*last)->chain.data);
+		free(*last);
+		*last = NULL;
+	}
+}
+
+const struct piglit_fixture_chain *
+piglit_fixture_get(const struct piglit_fixture_desc *desc)
+{
+	struct cache_entry **link, *entry;
+
+	if (cache_limit == 0)
+		piglit_fixture_clear_cache();
+
+	for (link = &cache; *link; link = &(*link)->next) {
+		entry = *link;
+		if (memcmp(&entry->desc, desc, sizeof(*desc)) == 0) {
+			*link = entry->next;
+			entry->next = cache;
+			cache = entry;
+			return &entry->chain;
+		}
+	}
+
+	entry = malloc(sizeof(*entry));
+	entry->desc = *desc;
+	generate_chain(desc, &entry->chain);
+	entry->next = cache;
+	cache = entry;
+	cache_size += entry->chain.size;
+	cache_misses++;
+
+	evict();
+
+	return &entry->chain;
+}
+
+void
+piglit_fixture_upload(const struct piglit_fixture_desc *desc,
+		      const struct piglit_fixture_chain *chain,
+		      GLenum internalformat, bool use_pbo)
+{
+	GLuint pbo = 0;
+	unsigned i;
+
+	if (use_pbo) {
+		glGenBuffers(1, &pbo);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, chain->size, chain->data,
+			     GL_STATIC_DRAW);
+	}
+
+	for (i = 0; i < chain->num_levels; i++) {
+		const struct piglit_fixture_level *level = &chain->levels[i];
+		const void *pixels = use_pbo ?
+			(const void *) (uintptr_t) level->offset :
+			(const uint8_t *) chain->data + level->offset;
+
+		switch (desc->target) {
+		case GL_TEXTURE_1D:
+			glTexImage1D(desc->target, i, internalformat,
+				     level->width, 0,
+				     desc->format, desc->type, pixels);
+			break;
+		case GL_TEXTURE_2D_ARRAY:
+		case GL_TEXTURE_3D:
+			glTexImage3D(desc->target, i, internalformat,
+				     level->width, level->height,
+				     level->depth, 0,
+				     desc->format, desc->type, pixels);
+			break;
+		default:
+			glTexImage2D(desc->target, i, internalformat,
+				     level->width, level->height, 0,
+				     desc->format, desc->type, pixels);
+			break;
+		}
+	}
+
+	if (use_pbo) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &pbo);
+	}
+}
+
+void
+piglit_fixture_set_cache_limit(size_t limit)
+{
+	cache_limit = limit;
+	evict();
+}
+
+size_t
+piglit_fixture_cache_size(void)
+{
+	return cache_size;
+}
+
+unsigned
+piglit_fixture_cache_misses(void)
+{
+	return cache_misses;
+}
+
+void
+piglit_fixture_clear_cache(void)
+{
+	while (cache) {
+		struct cache_entry *next = cache->next;
+
+		free(cache->chain.data);
+		free(cache);
+		cache = next;
+	}
+	cache_size = 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-texture-fixture.h
+ *
+ * Generation of the images behind piglit_rgbw_texture(),
+ * piglit_checkerboard_texture(), piglit_depth_texture() and friends.
+ *
+ * A fixture is a whole mip chain, generated in one buffer.  Chains are
+ * cached, so tests that loop over formats only generate each image once.
+ * The cache holds up to PIGLIT_FIXTURE_CACHE_LIMIT bytes, beyond that the
+ * least recently used chains are freed.
+ */
+
+#ifndef PIGLIT_TEXTURE_FIXTURE_H
+#define PIGLIT_TEXTURE_FIXTURE_H
+
+#include "piglit-util-gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIGLIT_FIXTURE_MAX_LEVELS 16
+
+/**
+ * The default limit of the cache, in bytes.  The cache only saves work
+ * for tests that upload the same images again, which are small, so it
+ * doesn't need to hold more than a few of them.
+ */
+#define PIGLIT_FIXTURE_CACHE_LIMIT (16 * 1024 * 1024)
+
+enum piglit_fixture_pattern {
+	/** Red, green, blue and white quadrants, see piglit_rgbw_image(). */
+	PIGLIT_FIXTURE_RGBW,
+	/** Two alternating colors. */
+	PIGLIT_FIXTURE_CHECKERBOARD,
+	/** Depth going from 0.0 on the left to 1.0 on the right. */
+	PIGLIT_FIXTURE_DEPTH_GRADIENT,
+	/** Red, green, blue and white levels, then again. */
+	PIGLIT_FIXTURE_LEVEL_COLORS,
+	/** Red, green, blue and white layers, then again. */
+	PIGLIT_FIXTURE_LAYER_COLORS
+};
+
+/**
+ * What to generate.  This is also the cache key, so it must be set up
+ * with piglit_fixture_init_desc(), which clears the fields that the
+ * pattern doesn't use.
+ */
+struct piglit_fixture_desc {
+	enum piglit_fixture_pattern pattern;
+
+	/**
+	 * Decides how the levels shrink and how they are uploaded.  For
+	 * GL_TEXTURE_1D_ARRAY, \c height is the number of layers.
+	 */
+	GLenum target;
+	int width, height, depth;
+	bool mip;
+
+	/**
+	 * GL_RGBA with GL_FLOAT or GL_UNSIGNED_BYTE, or for depth,
+	 * GL_DEPTH_COMPONENT with GL_FLOAT, or GL_DEPTH_STENCIL with
+	 * GL_UNSIGNED_INT_24_8 or GL_FLOAT_32_UNSIGNED_INT_24_8_REV.
+	 */
+	GLenum format, type;
+
+	/** PIGLIT_FIXTURE_RGBW parameters, see piglit_rgbw_image(). */
+	GLenum internalformat;
+	bool alpha;
+	GLenum basetype;
+
+	/** PIGLIT_FIXTURE_CHECKERBOARD parameters. */
+	unsigned square_width, square_height;
+	float colors[2][4];
+};
+
+struct piglit_fixture_level {
+	int width, height, depth;
+	/** Where the level starts in piglit_fixture_chain::data. */
+	size_t offset;
+};
+
+struct piglit_fixture_chain {
+	unsigned num_levels;
+	struct piglit_fixture_level levels[PIGLIT_FIXTURE_MAX_LEVELS];
+	size_t size;
+	void *data;
+};
+
+void
+piglit_fixture_init_desc(struct piglit_fixture_desc *desc,
+			 enum piglit_fixture_pattern pattern, GLenum target,
+			 int width, int height, int depth, bool mip,
+			 GLenum format, GLenum type);
+
+/**
+ * Return the chain described by \p desc, generating it if it isn't in the
+ * cache yet.  The chain belongs to the cache and must not be modified.  It
+ * stays valid until the next call to piglit_fixture_get() or
+ * piglit_fixture_clear_cache().
+ */
+const struct piglit_fixture_chain *
+piglit_fixture_get(const struct piglit_fixture_desc *desc);
+
+/**
+ * Generate level 0 of \p desc into \p data, bypassing the cache.  \p data
+ * must have room for width * height * depth texels.
+ */
+void
+piglit_fixture_generate_image(const struct piglit_fixture_desc *desc,
+			      void *data);
+
+/**
+ * Specify the levels of the texture bound to \p desc->target from
+ * \p chain, with glTexImage*D.  If \p use_pbo is true, the whole chain is
+ * copied into a pixel unpack buffer first.
+ */
+void
+piglit_fixture_upload(const struct piglit_fixture_desc *desc,
+		      const struct piglit_fixture_chain *chain,
+		      GLenum internalformat, bool use_pbo);
+
+/**
+ * Set the number of bytes the cache may hold, and free the least recently
+ * used chains until it fits.  The most recently used chain is always kept,
+ * even if it is larger than the limit on its own.
+ *
+ * A limit of 0 disables the cache: every piglit_fixture_get() generates
+ * its chain again, and only keeps it until the next call.
+ */
+void
+piglit_fixture_set_cache_limit(size_t limit);
+
+/**
+ * The number of bytes of the chains in the cache.
+ */
+size_t
+piglit_fixture_cache_size(void);
+
+/**
+ * The number of chains that piglit_fixture_get() had to generate.
+ */
+unsigned
+piglit_fixture_cache_misses(void);
+
+/**
+ * Free all cached chains.
+ */
+void
+piglit_fixture_clear_cache(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIGLIT_TEXTURE_FIXTURE_H */
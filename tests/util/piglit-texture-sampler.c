@@ -0,0 +1,356 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-texture-sampler.c
+ *
+ * Wrapping follows the GL spec: the mirror and legacy clamp modes first
+ * adjust the coordinate, then each texel index picked by the filter is
+ * wrapped on its own, which may select the border color.  Texels are
+ * weighted as four floats at a time, with SSE when the compiler targets it.
+ */
+
+#include "piglit-texture-sampler.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+/* Don't start a thread for fewer samples than this.  It is above the
+ * size of the tiles that texwrap samples one at a time, which are over
+ * too quickly for a thread to pay off.
+ */
+#define MIN_SAMPLES_PER_THREAD 65536
+
+/* Texel index that stands for the border color. */
+#define BORDER -1
+
+struct sampler {
+	const struct piglit_sampler_texture *tex;
+	const struct piglit_sampler_state *state;
+	int size[3];
+};
+
+static void
+init_sampler(struct sampler *s, const struct piglit_sampler_texture *tex,
+	     const struct piglit_sampler_state *state)
+{
+	assert(tex->dimensions >= 1 && tex->dimensions <= 3);
+	assert(tex->components == 1 || tex->components == 4);
+	assert(tex->type == PIGLIT_SAMPLER_FLOAT ||
+	       state->filter == GL_NEAREST);
+
+	s->tex = tex;
+	s->state = state;
+	s->size[0] = tex->width;
+	s->size[1] = tex->dimensions >= 2 ? tex->height : 1;
+	s->size[2] = tex->dimensions >= 3 ? tex->depth : 1;
+}
+
+static bool
+is_mirror_clamp(GLenum wrap)
+{
+	return wrap == GL_MIRROR_CLAMP_EXT ||
+	       wrap == GL_MIRROR_CLAMP_TO_EDGE_EXT ||
+	       wrap == GL_MIRROR_CLAMP_TO_BORDER_EXT;
+}
+
+/**
+ * Apply the part of \p wrap that acts on the coordinate.
+ */
+static float
+wrap_coord(GLenum wrap, float u, int size)
+{
+	if (is_mirror_clamp(wrap))
+		u = fabsf(u);
+	if (wrap == GL_CLAMP || wrap == GL_MIRROR_CLAMP_EXT)
+		u = CLAMP(u, 0.0f, (float) size);
+	return u;
+}
+
+static int
+positive_mod(int a, int b)
+{
+	const int r = a % b;
+
+	return r < 0 ? r + b : r;
+}
+
+/**
+ * Map texel index \p i into [0, size), or to BORDER.
+ */
+static int
+wrap_index(GLenum wrap, GLenum filter, int i, int size)
+{
+	switch (wrap) {
+	case GL_REPEAT:
+		return positive_mod(i, size);
+	case GL_MIRRORED_REPEAT:
+		i = positive_mod(i, 2 * size);
+		return i < size ? i : 2 * size - 1 - i;
+	case GL_CLAMP:
+	case GL_MIRROR_CLAMP_EXT:
+		/* wrap_coord() clamped the coordinate to [0, size], the
+		 * edges of the texture.  Nearest filtering stays inside,
+		 * but a linear filter there reaches half way into the
+		 * border: the texel at -1 or at size, which is the border.
+		 */
+		if (filter == GL_LINEAR)
+			return i < 0 || i >= size ? BORDER : i;
+		return CLAMP(i, 0, size - 1);
+	case GL_CLAMP_TO_BORDER:
+	case GL_MIRROR_CLAMP_TO_BORDER_EXT:
+		return i < 0 || i >= size ? BORDER : i;
+	case GL_CLAMP_TO_EDGE:
+	case GL_MIRROR_CLAMP_TO_EDGE_EXT:
+		return CLAMP(i, 0, size - 1);
+	default:
+		assert(!"unknown wrap mode");
+		return 0;
+	}
+}
+
+static void
+set_one(enum piglit_sampler_type type, union piglit_sampler_texel *t,
+	unsigned c)
+{
+	if (type == PIGLIT_SAMPLER_FLOAT)
+		t->f[c] = 1.0f;
+	else
+		t->u[c] = 1;
+}
+
+static void
+fetch(const struct sampler *s, const int idx[3],
+      union piglit_sampler_texel *t)
+{
+	const struct piglit_sampler_texture *tex = s->tex;
+	const uint32_t *data = tex->data;
+	size_t offset;
+
+	if (idx[0] == BORDER || idx[1] == BORDER || idx[2] == BORDER) {
+		*t = s->state->border;
+		return;
+	}
+
+	offset = ((size_t) idx[2] * s->size[1] + idx[1]) * s->size[0] +
+		 idx[0];
+
+	if (tex->components == 1) {
+		t->u[0] = t->u[1] = t->u[2] = data[offset];
+		set_one(tex->type, t, 3);
+	} else {
+		memcpy(t, data + 4 * offset, sizeof(*t));
+	}
+
+	if (tex->srgb)
+		piglit_convert_srgb_to_linear(t->f, t->f, 3);
+}
+
+static void
+sample_nearest(const struct sampler *s, const float coord[3],
+	       union piglit_sampler_texel *result)
+{
+	int idx[3] = { 0, 0, 0 };
+	unsigned d;
+
+	for (d = 0; d < s->tex->dimensions; d++) {
+		const GLenum wrap = s->state->wrap[d];
+		const float u = wrap_coord(wrap, coord[d], s->size[d]);
+
+		idx[d] = wrap_index(wrap, GL_NEAREST, (int) floorf(u),
+				    s->size[d]);
+	}
+
+	fetch(s, idx, result);
+}
+
+static void
+sample_linear(const struct sampler *s, const float coord[3],
+	      union piglit_sampler_texel *result)
+{
+	const unsigned dims = s->tex->dimensions;
+	int idx0[3] = { 0, 0, 0 }, idx1[3] = { 0, 0, 0 };
+	float frac[3] = { 0, 0, 0 };
+	unsigned d, k;
+#ifdef __SSE__
+	__m128 sum = _mm_setzero_ps();
+#else
+	float sum[4] = { 0, 0, 0, 0 };
+	unsigned c;
+#endif
+
+	for (d = 0; d < dims; d++) {
+		const GLenum wrap = s->state->wrap[d];
+		const float u = wrap_coord(wrap, coord[d], s->size[d]) - 0.5f;
+		const float i = floorf(u);
+
+		frac[d] = u - i;
+		idx0[d] = wrap_index(wrap, GL_LINEAR, (int) i, s->size[d]);
+		idx1[d] = wrap_index(wrap, GL_LINEAR, (int) i + 1,
+				     s->size[d]);
+	}
+
+	/* Weight the 2, 4 or 8 texels around the coordinate. */
+	for (k = 0; k < 1u << dims; k++) {
+		union piglit_sampler_texel texel;
+		int idx[3] = { 0, 0, 0 };
+		float weight = 1.0f;
+
+		for (d = 0; d < dims; d++) {
+			if (k & (1 << d)) {
+				idx[d] = idx1[d];
+				weight *= frac[d];
+			} else {
+				idx[d] = idx0[d];
+				weight *= 1.0f - frac[d];
+			}
+		}
+
+		fetch(s, idx, &texel);
+#ifdef __SSE__
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(texel.f),
+						 _mm_set1_ps(weight)));
+#else
+		for (c = 0; c < 4; c++)
+			sum[c] += texel.f[c] * weight;
+#endif
+	}
+
+#ifdef __SSE__
+	_mm_storeu_ps(result->f, sum);
+#else
+	memcpy(result->f, sum, sizeof(sum));
+#endif
+}
+
+static void
+apply_swizzle(const struct sampler *s, union piglit_sampler_texel *t)
+{
+	const GLenum *swizzle = s->state->swizzle;
+	const union piglit_sampler_texel orig = *t;
+	unsigned c;
+
+	if (!swizzle[0] && !swizzle[1] && !swizzle[2] && !swizzle[3])
+		return;
+
+	for (c = 0; c < 4; c++) {
+		switch (swizzle[c]) {
+		case GL_RED:
+		case GL_GREEN:
+		case GL_BLUE:
+		case GL_ALPHA:
+			t->u[c] = orig.u[swizzle[c] - GL_RED];
+			break;
+		case GL_ZERO:
+			t->u[c] = 0;
+			break;
+		case GL_ONE:
+			set_one(s->tex->type, t, c);
+			break;
+		default:
+			assert(!"unknown swizzle");
+		}
+	}
+}
+
+static void
+sample(const struct sampler *s, const float coord[3],
+       union piglit_sampler_texel *result)
+{
+	if (s->state->filter == GL_LINEAR)
+		sample_linear(s, coord, result);
+	else
+		sample_nearest(s, coord, result);
+
+	apply_swizzle(s, result);
+}
+
+void
+piglit_sample_texture(const struct piglit_sampler_texture *tex,
+		      const struct piglit_sampler_state *state,
+		      const float coord[3],
+		      union piglit_sampler_texel *result)
+{
+	struct sampler s;
+
+	init_sampler(&s, tex, state);
+	sample(&s, coord, result);
+}
+
+struct grid_job {
+	const struct sampler *sampler;
+	const float *origin, *dx, *dy;
+	unsigned width;
+	union piglit_sampler_texel *result;
+};
+
+/**
+ * Sample the rows from \p first_row to \p end_row, for
+ * piglit_parallel_for().
+ */
+static void
+sample_rows(unsigned first_row, unsigned end_row, void *data)
+{
+	const struct grid_job *job = data;
+	unsigned x, y, d;
+
+	for (y = first_row; y < end_row; y++) {
+		for (x = 0; x < job->width; x++) {
+			float coord[3];
+
+			for (d = 0; d < 3; d++) {
+				coord[d] = job->origin[d] +
+					   x * job->dx[d] + y * job->dy[d];
+			}
+
+			sample(job->sampler, coord,
+			       &job->result[y * job->width + x]);
+		}
+	}
+}
+
+void
+piglit_sample_texture_grid(const struct piglit_sampler_texture *tex,
+			   const struct piglit_sampler_state *state,
+			   const float origin[3],
+			   const float dx[3], const float dy[3],
+			   unsigned width, unsigned height,
+			   union piglit_sampler_texel *result)
+{
+	struct sampler s;
+	struct grid_job job;
+
+	init_sampler(&s, tex, state);
+
+	job.sampler = &s;
+	job.origin = origin;
+	job.dx = dx;
+	job.dy = dy;
+	job.width = width;
+	job.result = result;
+
+	piglit_parallel_for(height,
+			    (MIN_SAMPLES_PER_THREAD + width - 1) / MAX2(width, 1),
+			    sample_rows, &job);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2015 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file piglit-texture-sampler.h
+ *
+ * A reference texture sampler, so that wrap and filter tests can compute
+ * the image they expect instead of open coding the wrap modes.
+ *
+ * It samples a single level of a 1D, 2D or 3D texture with NEAREST or
+ * LINEAR filtering, any of the GL wrap modes, a border color and a texture
+ * swizzle.  Coordinates are in texels, i.e. they are already multiplied by
+ * the size of the texture, so rectangle textures need nothing special.
+ */
+
+#ifndef PIGLIT_TEXTURE_SAMPLER_H
+#define PIGLIT_TEXTURE_SAMPLER_H
+
+#include "piglit-util-gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * One texel, sample or border color.  Which member is valid depends on the
+ * type of the texture.
+ */
+union piglit_sampler_texel {
+	float f[4];
+	int32_t i[4];
+	uint32_t u[4];
+};
+
+enum piglit_sampler_type {
+	PIGLIT_SAMPLER_FLOAT,
+	PIGLIT_SAMPLER_INT,
+	PIGLIT_SAMPLER_UINT
+};
+
+struct piglit_sampler_texture {
+	/** 32-bit texels, tightly packed, with x varying fastest. */
+	const void *data;
+	enum piglit_sampler_type type;
+
+	/**
+	 * 4 for RGBA data, or 1 for depth and stencil data, which is
+	 * sampled as (v, v, v, 1).
+	 */
+	unsigned components;
+
+	/** 1, 2 or 3.  The sizes of the unused dimensions are ignored. */
+	unsigned dimensions;
+	int width, height, depth;
+
+	/** Convert RGB from sRGB to linear before filtering. */
+	bool srgb;
+};
+
+struct piglit_sampler_state {
+	/** Wrap modes for S, T and R. */
+	GLenum wrap[3];
+
+	/**
+	 * GL_NEAREST or GL_LINEAR, for both minification and
+	 * magnification.  Integer textures can only use GL_NEAREST.
+	 */
+	GLenum filter;
+
+	/** In the type of the texture. */
+	union piglit_sampler_texel border;
+
+	/**
+	 * As for GL_TEXTURE_SWIZZLE_RGBA, or all zero for no swizzle.
+	 */
+	GLenum swizzle[4];
+};
+
+/**
+ * Sample \p tex at \p coord.  Coordinates beyond the dimensions of the
+ * texture are ignored.
+ */
+void
+piglit_sample_texture(const struct piglit_sampler_texture *tex,
+		      const struct piglit_sampler_state *state,
+		      const float coord[3],
+		      union piglit_sampler_texel *result);
+
+/**
+ * Sample \p tex on a width x height grid, where sample (x, y) is taken at
+ * origin + x * dx + y * dy and stored at result[y * width + x].  Large
+ * grids are split between threads.
+ */
+void
+piglit_sample_texture_grid(const struct piglit_sampler_texture *tex,
+			   const struct piglit_sampler_state *state,
+			   const float origin[3],
+			   const float dx[3], const float dy[3],
+			   unsigned width, unsigned height,
+			   union piglit_sampler_texel *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIGLIT_TEXTURE_SAMPLER_H */
@@ -22,6 +22,7 @@
  */
 
 #include "piglit-util-gl.h"
+#include "piglit-texture-fixture.h"
 #include <ctype.h>
 
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
@@ -35,13 +36,6 @@
  */
 static const char **gl_extensions = NULL;
 
-static const float color_wheel[4][4] = {
-	{1, 0, 0, 1}, /* red */
-	{0, 1, 0, 1}, /* green */
-	{0, 0, 1, 1}, /* blue */
-	{1, 1, 1, 1}, /* white */
-};
-
 bool piglit_is_core_profile;
 
 bool piglit_is_gles(void)
@@ -297,93 +291,17 @@ piglit_set_tolerance_for_bits(int rbits, int gbits, int bbits, int abits)
 	}
 }
 
-typedef union { GLfloat f; GLint i; } fi_type;
-
 /**
  * Convert a 4-byte float to a 2-byte half float.
- * Based on code from:
- * http://www.opengl.org/discussion_boards/ubb/Forum3/HTML/008786.html
  *
- * Taken over from Mesa.
+ * See piglit_convert_float_to_half() for converting whole arrays.
  */
 unsigned short
 piglit_half_from_float(float val)
 {
-	const fi_type fi = {val};
-	const int flt_m = fi.i & 0x7fffff;
-	const int flt_e = (fi.i >> 23) & 0xff;
-	const int flt_s = (fi.i >> 31) & 0x1;
-	int s, e, m = 0;
-	unsigned short result;
-
-	/* sign bit */
-	s = flt_s;
-
-	/* handle special cases */
-	if ((flt_e == 0) && (flt_m == 0)) {
-		/* zero */
-		/* m = 0; - already set */
-		e = 0;
-	}
-	else if ((flt_e == 0) && (flt_m != 0)) {
-		/* denorm -- denorm float maps to 0 half */
-		/* m = 0; - already set */
-		e = 0;
-	}
-	else if ((flt_e == 0xff) && (flt_m == 0)) {
-		/* infinity */
-		/* m = 0; - already set */
-		e = 31;
-	}
-	else if ((flt_e == 0xff) && (flt_m != 0)) {
-		/* NaN */
-		m = 1;
-		e = 31;
-	}
-	else {
-		/* regular number */
-		const int new_exp = flt_e - 127;
-		if (new_exp < -24) {
-			/* this maps to 0 */
-			/* m = 0; - already set */
-			e = 0;
-		}
-		else if (new_exp < -14) {
-			/* this maps to a denorm */
-			/* 2^-exp_val*/
-			unsigned int exp_val = (unsigned int) (-14 - new_exp);
-
-			e = 0;
-			switch (exp_val) {
-			case 0:
-				/* m = 0; - already set */
-				break;
-			case 1: m = 512 + (flt_m >> 14); break;
-			case 2: m = 256 + (flt_m >> 15); break;
-			case 3: m = 128 + (flt_m >> 16); break;
-			case 4: m = 64 + (flt_m >> 17); break;
-			case 5: m = 32 + (flt_m >> 18); break;
-			case 6: m = 16 + (flt_m >> 19); break;
-			case 7: m = 8 + (flt_m >> 20); break;
-			case 8: m = 4 + (flt_m >> 21); break;
-			case 9: m = 2 + (flt_m >> 22); break;
-			case 10: m = 1; break;
-			}
-		}
-		else if (new_exp > 15) {
-			/* map this value to infinity */
-			/* m = 0; - already set */
-			e = 31;
-		}
-		else {
-			/* regular */
-			e = new_exp + 15;
-			m = flt_m >> 13;
-		}
-	}
-
-	result = (s << 15) | (e << 10) | m;
-	return result;
+	uint16_t h;
+	piglit_convert_float_to_half(&h, &val, 1);
+	return h;
 }
 
 int
@@ -450,6 +368,13 @@ piglit_get_compressed_block_size(GLenum format,
 	case GL_COMPRESSED_SIGNED_RED_RGTC1:
 	case GL_COMPRESSED_LUMINANCE_LATC1_EXT:
 	case GL_COMPRESSED_SIGNED_LUMINANCE_LATC1_EXT:
+	case GL_ETC1_RGB8_OES:
+	case GL_COMPRESSED_RGB8_ETC2:
+	case GL_COMPRESSED_SRGB8_ETC2:
+	case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+	case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+	case GL_COMPRESSED_R11_EAC:
+	case GL_COMPRESSED_SIGNED_R11_EAC:
 		*bw = *bh = 4;
 		*bytes = 8;
 		return true;
@@ -466,6 +391,10 @@ piglit_get_compressed_block_size(GLenum format,
 	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
 	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
 	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+	case GL_COMPRESSED_RGBA8_ETC2_EAC:
+	case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+	case GL_COMPRESSED_RG11_EAC:
+	case GL_COMPRESSED_SIGNED_RG11_EAC:
 		*bw = *bh = 4;
 		*bytes = 16;
 		return true;
@@ -1029,7 +958,7 @@ piglit_get_luminance_intensity_bits(GLenum internalformat, int *bits)
 /* Wrapper around glReadPixels that always returns floats; reads and converts
  * GL_UNSIGNED_BYTE on GLES.  If pixels == NULL, malloc a float array of the
  * appropriate size, otherwise use the one provided. */
-static GLfloat *
+GLfloat *
 piglit_read_pixels_float(GLint x, GLint y, GLsizei width, GLsizei height,
                          GLenum format, GLfloat *pixels)
 {
@@ -2111,44 +2040,18 @@ piglit_checkerboard_texture(GLuint tex, unsigned level,
 			    const float *black, const float *white)
 {
 	static const GLfloat border_color[4] = { 1.0, 0.0, 0.0, 1.0 };
-	unsigned i;
-	unsigned j;
-	void *tex_data;
-	char *texel;
-	unsigned pixel_size;
-	GLubyte black_b[4], white_b[4];
-	const void *black_data, *white_data;
-
-	if (piglit_is_gles()) {
-		pixel_size = 4 * sizeof(GLubyte);
-		for (i = 0; i < 4; i++) {
-			black_b[i] = black[i] * 255;
-			white_b[i] = white[i] * 255;
-		}
-		black_data = black_b;
-		white_data = white_b;
-	} else {
-		pixel_size = 4 * sizeof(float);
-		black_data = black;
-		white_data = white;
-	}
-	texel = tex_data = malloc(width * height * pixel_size);
-
-	for (i = 0; i < height; i++) {
-		const unsigned row = i / vert_square_size;
-
-		for (j = 0; j < width; j++) {
-			const unsigned col = j / horiz_square_size;
-
-			if ((row ^ col) & 1) {
-				memcpy(texel, white_data, pixel_size);
-			} else {
-				memcpy(texel, black_data, pixel_size);
-			}
-
-			texel += pixel_size;
-		}
-	}
+	struct piglit_fixture_desc desc;
+	const struct piglit_fixture_chain *chain;
+
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_CHECKERBOARD,
+				 GL_TEXTURE_2D, width, height, 1, false,
+				 GL_RGBA,
+				 piglit_is_gles() ? GL_UNSIGNED_BYTE : GL_FLOAT);
+	desc.square_width = horiz_square_size;
+	desc.square_height = vert_square_size;
+	memcpy(desc.colors[0], black, sizeof(desc.colors[0]));
+	memcpy(desc.colors[1], white, sizeof(desc.colors[1]));
+	chain = piglit_fixture_get(&desc);
 
 	if (tex == 0) {
 		glGenTextures(1, &tex);
@@ -2177,7 +2080,7 @@ piglit_checkerboard_texture(GLuint tex, unsigned level,
 	}
 
 	glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA,
-		     piglit_is_gles() ? GL_UNSIGNED_BYTE : GL_FLOAT, tex_data);
+		     desc.type, chain->data);
 
 	return tex;
 }
@@ -2188,8 +2091,7 @@ piglit_checkerboard_texture(GLuint tex, unsigned level,
 GLuint
 piglit_miptree_texture()
 {
-	GLfloat *data;
-	int size, i, level;
+	struct piglit_fixture_desc desc;
 	GLuint tex;
 
 	glGenTextures(1, &tex);
@@ -2200,18 +2102,11 @@ piglit_miptree_texture()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
 			GL_NEAREST_MIPMAP_NEAREST);
 
-	for (level = 0; level < 4; ++level) {
-		size = 8 >> level;
-
-		data = malloc(size*size*4*sizeof(GLfloat));
-		for (i = 0; i < size * size; ++i) {
-			memcpy(data + 4 * i, color_wheel[level],
-			       4 * sizeof(GLfloat));
-		}
-		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA,
-			     size, size, 0, GL_RGBA, GL_FLOAT, data);
-		free(data);
-	}
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_LEVEL_COLORS,
+				 GL_TEXTURE_2D, 8, 8, 1, true,
+				 GL_RGBA, GL_FLOAT);
+	piglit_fixture_upload(&desc, piglit_fixture_get(&desc), GL_RGBA,
+			      false);
 	return tex;
 }
 
@@ -2233,96 +2128,15 @@ GLfloat *
 piglit_rgbw_image(GLenum internalFormat, int w, int h,
 		  GLboolean alpha, GLenum basetype)
 {
-	float red[4]   = {1.0, 0.0, 0.0, 0.0};
-	float green[4] = {0.0, 1.0, 0.0, 0.25};
-	float blue[4]  = {0.0, 0.0, 1.0, 0.5};
-	float white[4] = {1.0, 1.0, 1.0, 1.0};
-	GLfloat *data;
-	int x, y;
-
-	if (!alpha) {
-		red[3] = 1.0;
-		green[3] = 1.0;
-		blue[3] = 1.0;
-		white[3] = 1.0;
-	}
-
-	switch (basetype) {
-	case GL_UNSIGNED_NORMALIZED:
-		break;
-
-	case GL_SIGNED_NORMALIZED:
-		for (x = 0; x < 4; x++) {
-			red[x] = red[x] * 2 - 1;
-			green[x] = green[x] * 2 - 1;
-			blue[x] = blue[x] * 2 - 1;
-			white[x] = white[x] * 2 - 1;
-		}
-		break;
-
-	case GL_FLOAT:
-		for (x = 0; x < 4; x++) {
-			red[x] = red[x] * 10 - 5;
-			green[x] = green[x] * 10 - 5;
-			blue[x] = blue[x] * 10 - 5;
-			white[x] = white[x] * 10 - 5;
-		}
-		break;
-
-	default:
-		assert(0);
-	}
-
-	data = malloc(w * h * 4 * sizeof(GLfloat));
-
-	for (y = 0; y < h; y++) {
-		for (x = 0; x < w; x++) {
-			const int size = w > h ? w : h;
-			const float *color;
-
-			if (x < w / 2 && y < h / 2)
-				color = red;
-			else if (y < h / 2)
-				color = green;
-			else if (x < w / 2)
-				color = blue;
-			else
-				color = white;
-
-			switch (internalFormat) {
-			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
-			case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
-			case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
-			case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
-			case GL_COMPRESSED_RGB_FXT1_3DFX:
-			case GL_COMPRESSED_RGBA_FXT1_3DFX:
-			case GL_COMPRESSED_RED_RGTC1:
-			case GL_COMPRESSED_SIGNED_RED_RGTC1:
-			case GL_COMPRESSED_RG_RGTC2:
-			case GL_COMPRESSED_SIGNED_RG_RGTC2:
-			case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
-			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
-			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
-			case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
-			case GL_COMPRESSED_RGBA_BPTC_UNORM:
-			case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
-			case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
-			case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
-				if (size == 4)
-					color = red;
-				else if (size == 2)
-					color = green;
-				else if (size == 1)
-					color = blue;
-				break;
-			default:
-				break;
-			}
+	struct piglit_fixture_desc desc;
+	GLfloat *data = malloc(w * h * 4 * sizeof(GLfloat));
 
-			memcpy(data + (y * w + x) * 4, color,
-			       4 * sizeof(float));
-		}
-	}
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_RGBW, GL_TEXTURE_2D,
+				 w, h, 1, false, GL_RGBA, GL_FLOAT);
+	desc.internalformat = internalFormat;
+	desc.alpha = alpha;
+	desc.basetype = basetype;
+	piglit_fixture_generate_image(&desc, data);
 
 	return data;
 }
@@ -2330,39 +2144,13 @@ piglit_rgbw_image(GLenum internalFormat, int w, int h,
 GLubyte *
 piglit_rgbw_image_ubyte(int w, int h, GLboolean alpha)
 {
-	GLubyte red[4]   = {255, 0, 0, 0};
-	GLubyte green[4] = {0, 255, 0, 64};
-	GLubyte blue[4]  = {0, 0, 255, 128};
-	GLubyte white[4] = {255, 255, 255, 255};
-	GLubyte *data;
-	int x, y;
-
-	if (!alpha) {
-		red[3] = 255;
-		green[3] = 255;
-		blue[3] = 255;
-		white[3] = 255;
-	}
+	struct piglit_fixture_desc desc;
+	GLubyte *data = malloc(w * h * 4 * sizeof(GLubyte));
 
-	data = malloc(w * h * 4 * sizeof(GLubyte));
-
-	for (y = 0; y < h; y++) {
-		for (x = 0; x < w; x++) {
-			const GLubyte *color;
-
-			if (x < w / 2 && y < h / 2)
-				color = red;
-			else if (y < h / 2)
-				color = green;
-			else if (x < w / 2)
-				color = blue;
-			else
-				color = white;
-
-			memcpy(data + (y * w + x) * 4, color,
-			       4 * sizeof(GLubyte));
-		}
-	}
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_RGBW, GL_TEXTURE_2D,
+				 w, h, 1, false, GL_RGBA, GL_UNSIGNED_BYTE);
+	desc.alpha = alpha;
+	piglit_fixture_generate_image(&desc, data);
 
 	return data;
 }
@@ -2379,7 +2167,7 @@ GLuint
 piglit_rgbw_texture(GLenum internalFormat, int w, int h, GLboolean mip,
 		    GLboolean alpha, GLenum basetype)
 {
-	int size, level;
+	struct piglit_fixture_desc desc;
 	GLuint tex;
 	GLenum teximage_type;
 
@@ -2412,29 +2200,13 @@ piglit_rgbw_texture(GLenum internalFormat, int w, int h, GLboolean mip,
 				GL_NEAREST);
 	}
 
-	for (level = 0, size = w > h ? w : h; size > 0; level++, size >>= 1) {
-		void *data;
-
-		if (teximage_type == GL_UNSIGNED_BYTE)
-			data = piglit_rgbw_image_ubyte(w, h, alpha);
-		else
-			data = piglit_rgbw_image(internalFormat, w, h,
-			                         alpha, basetype);
-
-		glTexImage2D(GL_TEXTURE_2D, level,
-			     internalFormat,
-			     w, h, 0,
-			     GL_RGBA, teximage_type, data);
-		free(data);
-
-		if (!mip)
-			break;
-
-		if (w > 1)
-			w >>= 1;
-		if (h > 1)
-			h >>= 1;
-	}
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_RGBW, GL_TEXTURE_2D,
+				 w, h, 1, mip, GL_RGBA, teximage_type);
+	desc.internalformat = internalFormat;
+	desc.alpha = alpha;
+	desc.basetype = basetype;
+	piglit_fixture_upload(&desc, piglit_fixture_get(&desc), internalFormat,
+			      false);
 
 	return tex;
 }
@@ -2455,10 +2227,7 @@ piglit_rgbw_texture(GLenum internalFormat, int w, int h, GLboolean mip,
 GLuint
 piglit_depth_texture(GLenum target, GLenum internalformat, int w, int h, int d, GLboolean mip)
 {
-	void *data;
-	float *f = NULL, *f2 = NULL;
-	unsigned int  *i = NULL;
-	int size, x, y, level, layer;
+	struct piglit_fixture_desc desc;
 	GLuint tex;
 	GLenum type, format;
 
@@ -2477,80 +2246,36 @@ piglit_depth_texture(GLenum target, GLenum internalformat, int w, int h, int d,
 		glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
 				GL_NEAREST);
 	}
-	data = malloc(w * h * 4 * sizeof(GLfloat));
 
 	if (internalformat == GL_DEPTH_STENCIL_EXT ||
 	    internalformat == GL_DEPTH24_STENCIL8_EXT) {
 		format = GL_DEPTH_STENCIL_EXT;
 		type = GL_UNSIGNED_INT_24_8_EXT;
-		i = data;
 	} else if (internalformat == GL_DEPTH32F_STENCIL8) {
 		format = GL_DEPTH_STENCIL;
 		type = GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
-		f2 = data;
 	} else {
 		format = GL_DEPTH_COMPONENT;
 		type = GL_FLOAT;
-		f = data;
 	}
 
-	for (level = 0, size = w > h ? w : h; size > 0; level++, size >>= 1) {
-		for (y = 0; y < h; y++) {
-			for (x = 0; x < w; x++) {
-				float val = (float)(x) / (w - 1);
-				if (f)
-					f[y * w + x] = val;
-				else if (f2)
-					f2[(y * w + x)*2] = val;
-				else
-					i[y * w + x] = 0xffffff00 * val;
-			}
-		}
-
-		switch (target) {
-		case GL_TEXTURE_1D:
-			glTexImage1D(target, level,
-				     internalformat,
-				     w, 0,
-				     format, type, data);
-			break;
-
-		case GL_TEXTURE_1D_ARRAY:
-		case GL_TEXTURE_2D:
-		case GL_TEXTURE_RECTANGLE:
-			glTexImage2D(target, level,
-				     internalformat,
-				     w, h, 0,
-				     format, type, data);
-			break;
-
-		case GL_TEXTURE_2D_ARRAY:
-			glTexImage3D(target, level,
-				     internalformat,
-				     w, h, d, 0,
-				     format, type, NULL);
-			for (layer = 0; layer < d; layer++) {
-				glTexSubImage3D(target, level,
-						0, 0, layer, w, h, 1,
-						format, type, data);
-			}
-			break;
-
-		default:
-			assert(0);
-		}
-
-		if (!mip)
-			break;
-
-		if (w > 1)
-			w >>= 1;
-		if (target != GL_TEXTURE_1D &&
-		    target != GL_TEXTURE_1D_ARRAY &&
-		    h > 1)
-			h >>= 1;
+	switch (target) {
+	case GL_TEXTURE_1D:
+	case GL_TEXTURE_1D_ARRAY:
+	case GL_TEXTURE_2D:
+	case GL_TEXTURE_RECTANGLE:
+		d = 1;
+		break;
+	case GL_TEXTURE_2D_ARRAY:
+		break;
+	default:
+		assert(0);
 	}
-	free(data);
+
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_DEPTH_GRADIENT, target,
+				 w, h, d, mip, format, type);
+	piglit_fixture_upload(&desc, piglit_fixture_get(&desc), internalformat,
+			      false);
 	return tex;
 }
 
@@ -2562,13 +2287,17 @@ GLuint
 piglit_array_texture(GLenum target, GLenum internalformat,
 		     int w, int h, int d, GLboolean mip)
 {
-	float *data;
-	int size, i, level, layer;
+	struct piglit_fixture_desc desc;
 	GLuint tex;
-	GLenum type = GL_FLOAT, format = GL_RGBA;
 
 	if (target == GL_TEXTURE_1D_ARRAY) {
 		assert(h == 1);
+		/* The fixture, like glTexImage2D, takes the layers of a 1D
+		 * array as its rows, so this is the same w x d texture with
+		 * d layers as before.
+		 */
+		h = d;
+		d = 1;
 	}
 	else {
 		assert(target == GL_TEXTURE_2D_ARRAY);
@@ -2589,52 +2318,11 @@ piglit_array_texture(GLenum target, GLenum internalformat,
 		glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
 				GL_NEAREST);
 	}
-	data = malloc(w * h * 4 * sizeof(GLfloat));
-
-	size = w > h ? w : h;
 
-	for (level = 0; size > 0; level++, size >>= 1) {
-
-		/* Create mipmap level */
-		if (target == GL_TEXTURE_1D_ARRAY) {
-			glTexImage2D(target, level, internalformat,
-				     w, d, 0, format, type, NULL);
-		}
-		else {
-			glTexImage3D(target, level, internalformat,
-				     w, h, d, 0, format, type, NULL);
-		}
-
-		for (layer = 0; layer < d; layer++) {
-			/* Set whole layer to one color */
-			for (i = 0; i < w * h; i++) {
-				memcpy(data + 4 * i,
-				       color_wheel[layer %
-						   ARRAY_SIZE(color_wheel)],
-				       sizeof(color_wheel[0]));
-			}
-
-			if (target == GL_TEXTURE_1D_ARRAY) {
-				glTexSubImage2D(target, level,
-						0, layer, w, 1,
-						format, type, data);
-			}
-			else {
-				glTexSubImage3D(target, level,
-						0, 0, layer, w, h, 1,
-						format, type, data);
-			}
-		}
-
-		if (!mip)
-			break;
-
-		if (w > 1)
-			w >>= 1;
-		if (h > 1)
-			h >>= 1;
-	}
-	free(data);
+	piglit_fixture_init_desc(&desc, PIGLIT_FIXTURE_LAYER_COLORS, target,
+				 w, h, d, mip, GL_RGBA, GL_FLOAT);
+	piglit_fixture_upload(&desc, piglit_fixture_get(&desc), internalformat,
+			      false);
 	return tex;
 }
 
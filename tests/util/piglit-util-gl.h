@@ -38,6 +38,7 @@ extern "C" {
 
 #include "piglit-framework-gl.h"
 #include "piglit-shader.h"
+#include "piglit-format-convert.h"
 
 extern const uint8_t fdo_bitmap[];
 extern const unsigned int fdo_bitmap_width;
@@ -131,6 +132,9 @@ void piglit_require_extension(const char *name);
 void piglit_require_not_extension(const char *name);
 unsigned piglit_num_components(GLenum base_format);
 bool piglit_get_luminance_intensity_bits(GLenum internalformat, int *bits);
+GLfloat *piglit_read_pixels_float(GLint x, GLint y, GLsizei width,
+				  GLsizei height, GLenum format,
+				  GLfloat *pixels);
 int piglit_probe_pixel_rgb_silent(int x, int y, const float* expected, float *out_probe);
 int piglit_probe_pixel_rgba_silent(int x, int y, const float* expected, float *out_probe);
 int piglit_probe_pixel_rgb(int x, int y, const float* expected);
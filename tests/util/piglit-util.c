@@ -66,6 +66,12 @@
 # define USE_STDIO
 #endif
 
+#if defined(PIGLIT_HAS_PTHREADS) && defined(HAVE_UNISTD_H)
+#include <pthread.h>
+#include <unistd.h>
+#define USE_THREADS
+#endif
+
 #include "piglit-util.h"
 
 
@@ -246,6 +252,93 @@ piglit_result_to_string(enum piglit_result result)
         return "Unknown result";
 }
 
+static const char *phase_names[PIGLIT_PHASE_COUNT] = {
+	"framework",
+	"platform",
+	"config",
+	"context",
+	"dispatch",
+	"init",
+	"display",
+	"teardown",
+};
+
+static int64_t phase_start[PIGLIT_PHASE_COUNT];
+static int64_t phase_total[PIGLIT_PHASE_COUNT];
+static bool phase_running[PIGLIT_PHASE_COUNT];
+static bool phase_recorded[PIGLIT_PHASE_COUNT];
+static bool phase_reported[PIGLIT_PHASE_COUNT];
+
+void
+piglit_phase_begin(enum piglit_phase phase)
+{
+	assert(phase < PIGLIT_PHASE_COUNT);
+
+	phase_start[phase] = piglit_time_get_nano();
+	phase_running[phase] = true;
+}
+
+void
+piglit_phase_end(enum piglit_phase phase)
+{
+	assert(phase < PIGLIT_PHASE_COUNT);
+
+	if (!phase_running[phase])
+		return;
+
+	phase_total[phase] += piglit_time_get_nano() - phase_start[phase];
+	phase_running[phase] = false;
+	phase_recorded[phase] = true;
+}
+
+/**
+ * Print the recorded phases that haven't been reported yet, as the members
+ * of a json object, and end any that are still running.
+ */
+static void
+print_phases(void)
+{
+	const char *sep = "";
+	int i;
+
+	for (i = 0; i < PIGLIT_PHASE_COUNT; i++) {
+		piglit_phase_end(i);
+		if (!phase_recorded[i] || phase_reported[i])
+			continue;
+
+		printf("%s\"%s\": %.9f", sep, phase_names[i],
+		       phase_total[i] / 1.0e9);
+		phase_reported[i] = true;
+		sep = ", ";
+	}
+}
+
+static bool
+have_unreported_phases(void)
+{
+	int i;
+
+	for (i = 0; i < PIGLIT_PHASE_COUNT; i++) {
+		if ((phase_recorded[i] || phase_running[i]) &&
+		    !phase_reported[i])
+			return true;
+	}
+
+	return false;
+}
+
+void
+piglit_report_phases(void)
+{
+	if (!have_unreported_phases())
+		return;
+
+	printf("PIGLIT: {\"phases\": {");
+	print_phases();
+	printf("}}\n");
+	fflush(stdout);
+}
+
 void
 piglit_report_result(enum piglit_result result)
 {
@@ -259,7 +352,13 @@ piglit_report_result(enum piglit_result result)
 
 	fflush(stderr);
 
-	printf("PIGLIT: {\"result\": \"%s\" }\n", result_str);
+	printf("PIGLIT: {\"result\": \"%s\"", result_str);
+	if (have_unreported_phases()) {
+		printf(", \"phases\": {");
+		print_phases();
+		printf("}");
+	}
+	printf(" }\n");
 	fflush(stdout);
 
 	switch(result) {
@@ -813,3 +912,69 @@ piglit_free_aligned(void *p)
 	free(p);
 #endif
 }
+
+
+#ifdef USE_THREADS
+struct parallel_job {
+	void (*func)(unsigned first, unsigned end, void *data);
+	void *data;
+	unsigned first, end;
+};
+
+static void *
+parallel_thread(void *data)
+{
+	const struct parallel_job *job = data;
+
+	job->func(job->first, job->end, job->data);
+	return NULL;
+}
+#endif
+
+
+void
+piglit_parallel_for(unsigned count, unsigned min_per_thread,
+		    void (*func)(unsigned first, unsigned end, void *data),
+		    void *data)
+{
+#ifdef USE_THREADS
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned n_threads = count / MAX2(min_per_thread, 1);
+	unsigned i;
+
+	if (cpus > 0)
+		n_threads = MIN2(n_threads, (unsigned) cpus);
+
+	if (n_threads >= 2) {
+		pthread_t *threads = malloc(n_threads * sizeof(*threads));
+		struct parallel_job *jobs = malloc(n_threads * sizeof(*jobs));
+		bool *started = malloc(n_threads * sizeof(*started));
+
+		/* The last range is done by this thread. */
+		for (i = 0; i < n_threads; i++) {
+			jobs[i].func = func;
+			jobs[i].data = data;
+			jobs[i].first = (uint64_t) count * i / n_threads;
+			jobs[i].end = (uint64_t) count * (i + 1) / n_threads;
+			started[i] = i < n_threads - 1 &&
+				     pthread_create(&threads[i], NULL,
+						    parallel_thread,
+						    &jobs[i]) == 0;
+			if (!started[i])
+				func(jobs[i].first, jobs[i].end, data);
+		}
+		for (i = 0; i < n_threads; i++) {
+			if (started[i])
+				pthread_join(threads[i], NULL);
+		}
+
+		free(started);
+		free(jobs);
+		free(threads);
+		return;
+	}
+#endif
+
+	if (count > 0)
+		func(0, count, data);
+}
@@ -334,6 +334,51 @@ piglit_time_is_monotonic();
 int64_t
 piglit_time_get_nano(void);
 
+/**
+ * The phases of a test run that the framework times.
+ *
+ * \sa piglit_phase_begin
+ */
+enum piglit_phase {
+	/** Everything before piglit_init(), including the phases below */
+	PIGLIT_PHASE_FRAMEWORK,
+	/** Window system platform initialization and display connection */
+	PIGLIT_PHASE_PLATFORM,
+	/** Choosing a framebuffer config */
+	PIGLIT_PHASE_CONFIG,
+	/** Creating the context and window and making them current */
+	PIGLIT_PHASE_CONTEXT,
+	/** piglit_dispatch_init() */
+	PIGLIT_PHASE_DISPATCH,
+	PIGLIT_PHASE_INIT,
+	PIGLIT_PHASE_DISPLAY,
+	PIGLIT_PHASE_TEARDOWN,
+	PIGLIT_PHASE_COUNT,
+};
+
+/**
+ * \brief Start timing a phase of the test run.
+ *
+ * The time of each phase is accumulated between piglit_phase_begin() and
+ * piglit_phase_end(), and is reported by piglit_report_result() in the
+ * "phases" member of the result. A phase that is still running when the
+ * result is reported is ended at that point.
+ */
+void
+piglit_phase_begin(enum piglit_phase phase);
+
+void
+piglit_phase_end(enum piglit_phase phase);
+
+/**
+ * \brief Report the phases that ended after the result was reported.
+ *
+ * This is for phases such as teardown, that run after
+ * piglit_report_result().
+ */
+void
+piglit_report_phases(void);
+
 const char**
 piglit_split_string_to_array(const char *string, const char *separators);
 
@@ -364,6 +409,18 @@ piglit_alloc_aligned(size_t alignment, size_t size);
 void
 piglit_free_aligned(void *p);
 
+/**
+ * Call \p func on ranges [first, end) that together cover [0, count), each
+ * from its own thread.  There is a thread per CPU at most, and each range
+ * has at least \p min_per_thread items, so without threads or with too
+ * few items, this is a single call for the whole range.  Returns once all
+ * the calls have returned.
+ */
+void
+piglit_parallel_for(unsigned count, unsigned min_per_thread,
+		    void (*func)(unsigned first, unsigned end, void *data),
+		    void *data);
+
 
 #ifdef __cplusplus
 } /* end extern "C" */
@@ -41,14 +41,24 @@
  * follows ("float", "int", or "uint"), and COUNT is the vector length
  * of the data (e.g. "3" for vec3 data).
  *
- * The data follows the column headers in space-separated form.  "#"
- * can be used for comments, as in shell scripts.
+ * The data follows the column headers in space-separated form, with
+ * one row per line and one value per component.  "#" can be used for
+ * comments, as in shell scripts.
  *
  * To process textual vertex data, call the function
  * setup_vbo_from_text(), passing the int identifying the linked
  * program, and the string containing the vertex data.  The return
  * value is the number of rows of vertex data found.
  *
+ * Instead of rows of text, the column headers may be followed by a
+ * single line of the form "file PATH".  The rows are then read from
+ * PATH, as raw binary data laid out like the vertex_data array below:
+ * no padding, and in the byte order of the machine running the test.
+ * The file is mapped and uploaded as it is, without any parsing.
+ * Relative paths are taken relative to the directory of the base path
+ * passed to setup_vbo_from_text_with_base(), or to the current
+ * directory for setup_vbo_from_text().
+ *
  * If an error occurs, setup_vbo_from_text() will print out a
  * description of the error and exit with PIGLIT_FAIL.
  *
@@ -86,6 +96,7 @@
  * \endcode
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <errno.h>
@@ -94,6 +105,15 @@
 #include "piglit-util-gl.h"
 #include "piglit-vbo.h"
 
+#if defined(HAVE_FCNTL_H) && defined(HAVE_SYS_STAT_H) && defined(HAVE_SYS_TYPES_H) && defined(HAVE_UNISTD_H) && !defined(_WIN32)
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define USE_MMAP
+#endif
+
 /**
  * Currently all the attribute types we support (int, uint, and float)
  * are 4 bytes in width.
@@ -137,7 +157,8 @@ class vertex_attrib_description
 {
 public:
 	vertex_attrib_description(GLuint prog, const char *text);
-	bool parse_datum(const char **text, void *data) const;
+	bool parse_datum(const char **text, const char *end, bool terminated,
+			 void *data) const;
 	void setup(size_t *offset, size_t stride) const;
 
 	/**
@@ -224,22 +245,213 @@ vertex_attrib_description::vertex_attrib_description(GLuint prog,
 }
 
 
+/**
+ * True for the characters that may follow a number in a data row.
+ */
+static inline bool
+ends_datum(const char *text, const char *end)
+{
+	return text == end || isspace(*text) || *text == '#';
+}
+
+
+/**
+ * Parse a plain decimal number, e.g. "-1.25" or "3e-2", without
+ * strtod().  Only numbers with at most 15 significant digits and a
+ * decimal exponent of at most 22 are accepted: both are then exact
+ * doubles, so a single multiplication or division rounds the same way
+ * strtod() does.  Anything else returns false and is left to strtod().
+ */
+static bool
+parse_simple_double(const char **text, const char *end, double *value)
+{
+#if FLT_EVAL_METHOD == 0
+	static const double powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+		1e21, 1e22
+	};
+	const char *p = *text;
+	bool negative = false, any_digits = false;
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+
+	for (; p < end && isdigit(*p); p++) {
+		any_digits = true;
+		if (mantissa == 0 && *p == '0')
+			continue;
+		if (++digits > 15)
+			return false;
+		mantissa = mantissa * 10 + (*p - '0');
+	}
+
+	if (p < end && *p == '.') {
+		for (p++; p < end && isdigit(*p); p++) {
+			any_digits = true;
+			exponent--;
+			if (mantissa == 0 && *p == '0')
+				continue;
+			if (++digits > 15)
+				return false;
+			mantissa = mantissa * 10 + (*p - '0');
+		}
+	}
+
+	if (!any_digits)
+		return false;
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		bool negative_exponent = false;
+		int e = 0;
+
+		p++;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative_exponent = *p++ == '-';
+		if (p == end || !isdigit(*p))
+			return false;
+		for (; p < end && isdigit(*p); p++) {
+			if (e > 100)
+				return false;
+			e = e * 10 + (*p - '0');
+		}
+		exponent += negative_exponent ? -e : e;
+	}
+
+	if (!ends_datum(p, end))
+		return false;
+
+	if (mantissa == 0) {
+		*value = 0.0;
+	} else if (exponent >= 0 && exponent <= 22) {
+		*value = (double) mantissa * powers_of_ten[exponent];
+	} else if (exponent < 0 && exponent >= -22) {
+		*value = (double) mantissa / powers_of_ten[-exponent];
+	} else {
+		return false;
+	}
+
+	if (negative)
+		*value = -*value;
+	*text = p;
+	return true;
+#else
+	/* Intermediate results may be rounded twice. */
+	return false;
+#endif
+}
+
+
+/**
+ * Parse a decimal integer of at most 9 digits without strtol(), which
+ * also leaves octal and hexadecimal numbers to strtol().
+ */
+static bool
+parse_simple_int(const char **text, const char *end, int64_t *value)
+{
+	const char *p = *text;
+	bool negative = false;
+	int64_t v = 0;
+	int digits = 0;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+
+	if (p < end && *p == '0' && p + 1 < end && !ends_datum(p + 1, end))
+		return false;
+
+	for (; p < end && isdigit(*p); p++) {
+		if (++digits > 9)
+			return false;
+		v = v * 10 + (*p - '0');
+	}
+
+	if (digits == 0 || !ends_datum(p, end))
+		return false;
+
+	*value = negative ? -v : v;
+	*text = p;
+	return true;
+}
+
+
 /**
  * Parse a single number (floating point or integral) from one of the
  * data rows, and store it in the location pointed to by \c data.
- * Update \c text to point to the next character of input.
+ * Update \c text to point to the next character of input.  \c end is
+ * the end of the row; the number must be followed by a space, a
+ * comment or the end of the row.
+ *
+ * Plain decimal numbers are parsed directly, and everything else with
+ * strtod() or strtol(), which need the text to end in a character that
+ * isn't part of a number.  That holds for every row but the last one of
+ * the input, whose last number is copied first if \c terminated is
+ * false.
  *
  * If there is a parse failure, print a description of the problem and
  * then return false.  Otherwise return true.
  */
 bool
-vertex_attrib_description::parse_datum(const char **text, void *data) const
+vertex_attrib_description::parse_datum(const char **text, const char *end,
+				       bool terminated, void *data) const
 {
+	char copy[64];
+	const char *start = *text;
 	char *endptr;
+	double d;
+	int64_t i;
+
+	switch (this->data_type) {
+	case GL_FLOAT:
+		if (parse_simple_double(text, end, &d)) {
+			*((GLfloat *) data) = (float) d;
+			return true;
+		}
+		break;
+	case GL_DOUBLE:
+		if (parse_simple_double(text, end, &d)) {
+			/* Doubles are only 4-byte aligned after 32-bit columns */
+			memcpy(data, &d, sizeof(GLdouble));
+			return true;
+		}
+		break;
+	case GL_INT:
+		if (parse_simple_int(text, end, &i)) {
+			*((GLint *) data) = (GLint) i;
+			return true;
+		}
+		break;
+	case GL_UNSIGNED_INT:
+		if (parse_simple_int(text, end, &i)) {
+			*((GLuint *) data) = (GLuint) i;
+			return true;
+		}
+		break;
+	default:
+		assert(!"Unexpected data type");
+		return false;
+	}
+
+	if (!terminated) {
+		const char *token_end = start;
+
+		while (!ends_datum(token_end, end))
+			token_end++;
+		if ((size_t) (token_end - start) >= sizeof(copy)) {
+			printf("Value too long\n");
+			return false;
+		}
+		memcpy(copy, start, token_end - start);
+		copy[token_end - start] = '\0';
+		start = copy;
+	}
+
 	errno = 0;
 	switch (this->data_type) {
 	case GL_FLOAT: {
-		double value = strtod(*text, &endptr);
+		double value = strtod(start, &endptr);
 		if (errno == ERANGE) {
 			printf("Could not parse as double\n");
 			return false;
@@ -248,16 +460,16 @@ vertex_attrib_description::parse_datum(const char **text, void *data) const
 		break;
 	}
 	case GL_DOUBLE: {
-		double value = strtod(*text, &endptr);
+		double value = strtod(start, &endptr);
 		if (errno == ERANGE) {
 			printf("Could not parse as double\n");
 			return false;
 		}
-		*((GLdouble *) data) = value;
+		memcpy(data, &value, sizeof(GLdouble));
 		break;
 	}
 	case GL_INT: {
-		long value = strtol(*text, &endptr, 0);
+		long value = strtol(start, &endptr, 0);
 		if (errno == ERANGE) {
 			printf("Could not parse as signed integer\n");
 			return false;
@@ -265,8 +477,8 @@ vertex_attrib_description::parse_datum(const char **text, void *data) const
 		*((GLint *) data) = (GLint) value;
 		break;
 	}
-	case GL_UNSIGNED_INT: {
-		unsigned long value = strtoul(*text, &endptr, 0);
+	default: {
+		unsigned long value = strtoul(start, &endptr, 0);
 		if (errno == ERANGE) {
 			printf("Could not parse as unsigned integer\n");
 			return false;
@@ -274,11 +486,15 @@ vertex_attrib_description::parse_datum(const char **text, void *data) const
 		*((GLuint *) data) = (GLuint) value;
 		break;
 	}
-	default:
-		assert(!"Unexpected data type");
-		endptr = NULL;
-		break;
 	}
+
+	/* Map the end of the copy back to the input */
+	endptr = (char *) *text + (endptr - start);
+	if (endptr == *text || !ends_datum(endptr, end)) {
+		printf("Could not parse as a number\n");
+		return false;
+	}
+
 	*text = endptr;
 	return true;
 }
@@ -330,18 +546,25 @@ vertex_attrib_description::setup(size_t *offset, size_t stride) const
 class vbo_data
 {
 public:
-	vbo_data(std::string const &text, GLuint prog);
+	vbo_data(const char *text_start, const char *text_end, GLuint prog,
+		 const char *base_path);
+	~vbo_data();
 	size_t setup() const;
 
 private:
-	void parse_header_line(const std::string &line, GLuint prog);
-	void parse_data_line(const std::string &line, unsigned int line_num);
-	void parse_line(std::string line, unsigned int line_num, GLuint prog);
+	vbo_data(const vbo_data &);
+	vbo_data &operator=(const vbo_data &);
+
+	void parse_header_line(const char *line, const char *end, GLuint prog);
+	void parse_data_line(const char *line, const char *end,
+			     unsigned int line_num);
+	void read_file(const char *line, const char *end,
+		       unsigned int line_num, const char *base_path);
 
 	/**
-	 * True if the header line has already been parsed.
+	 * End of the input text.
 	 */
-	bool header_seen;
+	const char *input_end;
 
 	/**
 	 * Description of each attribute.
@@ -349,9 +572,14 @@ private:
 	std::vector<vertex_attrib_description> attribs;
 
 	/**
-	 * Raw data buffer containing parsed numbers.
+	 * Raw data buffer containing parsed numbers, or the mapped file.
+	 */
+	char *raw_data;
+
+	/**
+	 * Size of the mapping, if raw_data is a mapped file, otherwise 0.
 	 */
-	std::vector<char> raw_data;
+	size_t mapped_size;
 
 	/**
 	 * Number of bytes in each row of raw_data.
@@ -365,15 +593,34 @@ private:
 };
 
 
-
-static bool
-is_blank_line(const std::string &line)
+/**
+ * Return the end of the line starting at \c line, not counting any
+ * end-of-line comment, and set \c next to the start of the next line.
+ */
+static const char *
+find_line_end(const char *line, const char *end, const char **next)
 {
-	for (size_t i = 0; i < line.size(); ++i) {
-		if (!isspace(line[i]))
-			return false;
+	const char *eol = (const char *) memchr(line, '\n', end - line);
+	const char *comment;
+
+	if (eol == NULL) {
+		eol = end;
+		*next = end;
+	} else {
+		*next = eol + 1;
 	}
-	return true;
+
+	comment = (const char *) memchr(line, '#', eol - line);
+	return comment ? comment : eol;
+}
+
+
+static const char *
+skip_spaces(const char *text, const char *end)
+{
+	while (text < end && isspace(*text))
+		++text;
+	return text;
 }
 
 
@@ -385,109 +632,241 @@ is_blank_line(const std::string &line)
  * then exit with PIGLIT_FAIL.
  */
 void
-vbo_data::parse_header_line(const std::string &line, GLuint prog)
+vbo_data::parse_header_line(const char *line, const char *end, GLuint prog)
 {
-	size_t pos = 0;
+	const char *pos = skip_spaces(line, end);
+
 	this->stride = 0;
-	while (pos < line.size()) {
-		if (isspace(line[pos])) {
-			++pos;
-		} else {
-			size_t column_header_end = pos;
-			int mul;
-			while (column_header_end < line.size() &&
-			       !isspace(line[column_header_end]))
-				++column_header_end;
-			std::string column_header = line.substr(
-				pos, column_header_end - pos);
-			vertex_attrib_description desc(
-				prog, column_header.c_str());
-			attribs.push_back(desc);
-			mul = (desc.data_type == GL_DOUBLE) ? 2 : 1;
-			this->stride += ATTRIBUTE_SIZE * desc.count * mul;
-			pos = column_header_end + 1;
-		}
+	while (pos < end) {
+		const char *column_header_end = pos;
+		int mul;
+
+		while (column_header_end < end && !isspace(*column_header_end))
+			++column_header_end;
+		std::string column_header(pos, column_header_end);
+		vertex_attrib_description desc(prog, column_header.c_str());
+		attribs.push_back(desc);
+		mul = (desc.data_type == GL_DOUBLE) ? 2 : 1;
+		this->stride += ATTRIBUTE_SIZE * desc.count * mul;
+		pos = skip_spaces(column_header_end, end);
 	}
 }
 
 
 /**
- * Convert a data row into binary form and append it to this->raw_data.
+ * Convert a data row into binary form and append it to this->raw_data,
+ * which has room for it.
  *
  * If there is a parse failure, print a description of the problem and
  * then exit with PIGLIT_FAIL.
  */
 void
-vbo_data::parse_data_line(const std::string &line, unsigned int line_num)
+vbo_data::parse_data_line(const char *line, const char *end,
+			  unsigned int line_num)
 {
-	/* Allocate space in raw_data for this line */
-	size_t old_size = this->raw_data.size();
-	this->raw_data.resize(old_size + this->stride);
-	char *data_ptr = &this->raw_data[old_size];
+	char *data_ptr = this->raw_data + this->num_rows * this->stride;
+	const bool terminated = end != this->input_end;
+	const char *line_ptr = line;
 
-	const char *line_ptr = line.c_str();
 	for (size_t i = 0; i < this->attribs.size(); ++i) {
+		int mul = (this->attribs[i].data_type == GL_DOUBLE) ? 2 : 1;
+
 		for (size_t j = 0; j < this->attribs[i].count; ++j) {
-			int mul = (this->attribs[i].data_type == GL_DOUBLE) ? 2 : 1;
-			if (!this->attribs[i].parse_datum(&line_ptr,
+			line_ptr = skip_spaces(line_ptr, end);
+			if (line_ptr == end) {
+				printf("At line %u of [vertex data] section\n",
+				       line_num);
+				printf("Not enough values in row\n");
+				piglit_report_result(PIGLIT_FAIL);
+			}
+			if (!this->attribs[i].parse_datum(&line_ptr, end,
+							  terminated,
 							  data_ptr)) {
 				printf("At line %u of [vertex data] section\n",
 				       line_num);
-				printf("Offending text: %s\n", line_ptr);
+				printf("Offending text: %.*s\n",
+				       (int) (end - line_ptr), line_ptr);
 				piglit_report_result(PIGLIT_FAIL);
 			}
 			data_ptr += ATTRIBUTE_SIZE * mul;
 		}
 	}
 
+	line_ptr = skip_spaces(line_ptr, end);
+	if (line_ptr != end) {
+		printf("At line %u of [vertex data] section\n", line_num);
+		printf("Too many values in row: %.*s\n",
+		       (int) (end - line_ptr), line_ptr);
+		piglit_report_result(PIGLIT_FAIL);
+	}
+
 	++this->num_rows;
 }
 
 
 /**
- * Parse a line of input text.
+ * Load this->raw_data from the file named by a "file PATH" line, whose
+ * text after "file" is \c line.
  *
- * If there is a parse failure, print a description of the problem and
+ * If the file can't be read, print a description of the problem and
  * then exit with PIGLIT_FAIL.
  */
 void
-vbo_data::parse_line(std::string line, unsigned int line_num, GLuint prog)
+vbo_data::read_file(const char *line, const char *end,
+		    unsigned int line_num, const char *base_path)
 {
-	/* Ignore end-of-line comments */
-	line = line.substr(0, line.find('#'));
+	const char *name_start = skip_spaces(line, end);
+	const char *name_end = end;
+	std::string filename;
+	size_t size;
 
-	/* Ignore blank or comment-only lines */
-	if (is_blank_line(line))
-		return;
+	while (name_end > name_start && isspace(name_end[-1]))
+		--name_end;
 
-	if (!this->header_seen) {
-		this->header_seen = true;
-		parse_header_line(line, prog);
-	} else {
-		parse_data_line(line, line_num);
+	if (name_start == name_end) {
+		printf("At line %u of [vertex data] section\n", line_num);
+		printf("Missing file name\n");
+		piglit_report_result(PIGLIT_FAIL);
+	}
+
+	/* Relative paths are relative to the directory of base_path */
+	if (base_path != NULL && *name_start != '/') {
+		const char *slash = strrchr(base_path, '/');
+#ifdef _WIN32
+		const char *backslash = strrchr(base_path, '\\');
+		if (backslash != NULL && (slash == NULL || backslash > slash))
+			slash = backslash;
+#endif
+		if (slash != NULL)
+			filename.assign(base_path, slash + 1);
+	}
+	filename.append(name_start, name_end);
+
+#ifdef USE_MMAP
+	struct stat st;
+	int fd = open(filename.c_str(), O_RDONLY);
+
+	if (fd == -1 || fstat(fd, &st) != 0) {
+		printf("Could not open vertex data file %s\n",
+		       filename.c_str());
+		piglit_report_result(PIGLIT_FAIL);
+	}
+
+	size = st.st_size;
+	if (size != 0) {
+		void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			printf("Could not map vertex data file %s\n",
+			       filename.c_str());
+			piglit_report_result(PIGLIT_FAIL);
+		}
+		this->raw_data = (char *) map;
+		this->mapped_size = size;
+	}
+	close(fd);
+#else
+	FILE *file = fopen(filename.c_str(), "rb");
+	long file_size;
+
+	if (file == NULL || fseek(file, 0, SEEK_END) != 0 ||
+	    (file_size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+		printf("Could not open vertex data file %s\n",
+		       filename.c_str());
+		piglit_report_result(PIGLIT_FAIL);
 	}
+
+	size = file_size;
+	this->raw_data = (char *) malloc(size);
+	if (size != 0 && fread(this->raw_data, 1, size, file) != size) {
+		printf("Could not read vertex data file %s\n",
+		       filename.c_str());
+		piglit_report_result(PIGLIT_FAIL);
+	}
+	fclose(file);
+#endif
+
+	if (this->stride == 0 || size % this->stride != 0) {
+		printf("Size of vertex data file %s (%lu bytes) is not a "
+		       "multiple of the row size (%lu bytes)\n",
+		       filename.c_str(), (unsigned long) size,
+		       (unsigned long) this->stride);
+		piglit_report_result(PIGLIT_FAIL);
+	}
+	this->num_rows = size / this->stride;
+}
+
+
+static bool
+is_file_line(const char *line, const char *end)
+{
+	return end - line > 4 && strncmp(line, "file", 4) == 0 &&
+	       isspace(line[4]);
 }
 
 
 /**
- * Parse the input but don't execute any GL commands.
+ * Parse the input but don't execute any GL commands.  The rows are
+ * parsed straight into a buffer that is allocated once, after the
+ * header, with room for one row per remaining line.
  *
  * If there is a parse failure, print a description of the problem and
  * then exit with PIGLIT_FAIL.
  */
-vbo_data::vbo_data(const std::string &text, GLuint prog)
-	: header_seen(false), stride(0), num_rows(0)
+vbo_data::vbo_data(const char *text_start, const char *text_end,
+		   GLuint prog, const char *base_path)
+	: input_end(text_end), raw_data(NULL), mapped_size(0), stride(0),
+	  num_rows(0)
 {
+	const char *pos = text_start;
 	unsigned int line_num = 1;
+	bool header_seen = false;
+	bool file_seen = false;
+
+	while (pos < text_end) {
+		const char *next;
+		const char *end = find_line_end(pos, text_end, &next);
+		const char *line = skip_spaces(pos, end);
+
+		/* Ignore blank or comment-only lines */
+		if (line == end) {
+			/* Nothing */
+		} else if (!header_seen) {
+			header_seen = true;
+			parse_header_line(line, end, prog);
+
+			size_t max_rows = std::count(next, text_end, '\n') + 1;
+			this->raw_data = (char *) malloc(max_rows * this->stride);
+		} else if (file_seen || is_file_line(line, end)) {
+			if (file_seen || this->num_rows != 0) {
+				printf("At line %u of [vertex data] section\n",
+				       line_num);
+				printf("A vertex data file must be the only "
+				       "data\n");
+				piglit_report_result(PIGLIT_FAIL);
+			}
+			file_seen = true;
+			free(this->raw_data);
+			this->raw_data = NULL;
+			read_file(line + 4, end, line_num, base_path);
+		} else {
+			parse_data_line(line, end, line_num);
+		}
+
+		pos = next;
+		line_num++;
+	}
+}
+
 
-	size_t pos = 0;
-	while (pos < text.size()) {
-		size_t end_of_line = text.find('\n', pos);
-		if (end_of_line == std::string::npos)
-			end_of_line = text.size();
-		parse_line(text.substr(pos, end_of_line), line_num++, prog);
-		pos = end_of_line + 1;
+vbo_data::~vbo_data()
+{
+#ifdef USE_MMAP
+	if (this->mapped_size != 0) {
+		munmap(this->raw_data, this->mapped_size);
+		return;
 	}
+#endif
+	free(this->raw_data);
 }
 
 
@@ -502,7 +881,7 @@ vbo_data::setup() const
 	glGenBuffers(1, &buffer_handle);
 	glBindBuffer(GL_ARRAY_BUFFER, buffer_handle);
 	glBufferData(GL_ARRAY_BUFFER, this->stride * this->num_rows,
-		     &this->raw_data[0], GL_STATIC_DRAW);
+		     this->raw_data, GL_STATIC_DRAW);
 
 	size_t offset = 0;
 	for (size_t i = 0; i < attribs.size(); ++i)
@@ -526,9 +905,21 @@ vbo_data::setup() const
  */
 size_t
 setup_vbo_from_text(GLuint prog, const char *text_start, const char *text_end)
+{
+	return setup_vbo_from_text_with_base(prog, text_start, text_end, NULL);
+}
+
+
+/**
+ * Like setup_vbo_from_text(), but vertex data files are looked up
+ * relative to the directory of base_path, which is usually the test
+ * script that the text comes from.
+ */
+size_t
+setup_vbo_from_text_with_base(GLuint prog, const char *text_start,
+			      const char *text_end, const char *base_path)
 {
 	if (text_end == NULL)
 		text_end = text_start + strlen(text_start);
-	std::string text(text_start, text_end);
-	return vbo_data(text, prog).setup();
+	return vbo_data(text_start, text_end, prog, base_path).setup();
 }
@@ -26,6 +26,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "config.h"
+
+#if defined(HAVE_FCNTL_H) && defined(HAVE_SYS_STAT_H) && defined(HAVE_SYS_TYPES_H) && defined(HAVE_UNISTD_H) && !defined(_WIN32)
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define USE_MMAP
+#endif
+
 #include "piglit_ktx.h"
 #include "piglit-util-gl.h"
 
@@ -68,6 +79,21 @@ struct piglit_ktx {
 	/** \brief The raw KTX data. */
 	void *data;
 
+	/**
+	 * \brief Length of the file mapping at data.
+	 *
+	 * If 0, data was allocated with malloc().
+	 */
+	size_t mapped_size;
+
+	/**
+	 * \brief Number of owners.
+	 *
+	 * The cache of piglit_ktx_read_file_cached() owns a reference to each
+	 * of its entries in addition to the callers.
+	 */
+	int refcount;
+
 	/**
 	 * \brief Array of images.
 	 *
@@ -96,9 +122,17 @@ piglit_ktx_destroy(struct piglit_ktx *self)
 	if (self == NULL)
 		return;
 
+	if (--self->refcount > 0)
+		return;
+
 	if (self->images != NULL)
 		free(self->images);
 
+#ifdef USE_MMAP
+	if (self->mapped_size != 0)
+		munmap(self->data, self->mapped_size);
+	else
+#endif
 	if (self->data)
 		free(self->data);
 
@@ -422,21 +456,57 @@ piglit_ktx_parse_data(struct piglit_ktx *self)
 	return ok;
 }
 
-struct piglit_ktx*
-piglit_ktx_read_file(const char *filename)
+#ifdef USE_MMAP
+
+/**
+ * \brief Map the file into memory.
+ *
+ * The images then point into the page cache, and nothing is copied until
+ * glTexImage().
+ */
+static bool
+piglit_ktx_read_file_data(struct piglit_ktx *self, const char *filename)
 {
-	struct piglit_ktx *self;
+	struct stat st;
+	void *map;
+	int fd;
 
+	fd = open(filename, O_RDONLY);
+	if (fd == -1) {
+		piglit_ktx_error("failed to open file: %s", filename);
+		return false;
+	}
+
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		piglit_ktx_error("errors in reading file: %s", filename);
+		return false;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		piglit_ktx_error("failed to map file: %s", filename);
+		return false;
+	}
+
+	self->data = map;
+	self->mapped_size = st.st_size;
+	self->info.size = st.st_size;
+	return true;
+}
+
+#else
+
+static bool
+piglit_ktx_read_file_data(struct piglit_ktx *self, const char *filename)
+{
 	FILE *file = NULL;
 	size_t size_read = 0;
 
 	bool ok = true;
 	int error = 0;
 
-	self = calloc(1, sizeof(*self));
-	if (self == NULL)
-		goto out_of_memory;
-
 	file = fopen(filename, "rb");
 	if (file == NULL)
 		goto bad_open;
@@ -453,15 +523,10 @@ piglit_ktx_read_file(const char *filename)
 	if (self->data == NULL)
 		goto out_of_memory;
 
-	/*
-	 * On Unix, one should mmap() here rather than copy. But this code
-	 * needs to support Windows too.
-	 */
 	size_read = fread(self->data, 1, self->info.size, file);
 	if (size_read < self->info.size)
 		goto bad_read;
 
-	ok = piglit_ktx_parse_data(self);
 	goto end;
 
 out_of_memory:
@@ -483,14 +548,85 @@ end:
 	if (file != NULL)
 		fclose(file);
 
-	if (!ok) {
+	return ok;
+}
+
+#endif /* USE_MMAP */
+
+struct piglit_ktx*
+piglit_ktx_read_file(const char *filename)
+{
+	struct piglit_ktx *self;
+
+	self = calloc(1, sizeof(*self));
+	if (self == NULL) {
+		piglit_ktx_error("%s", "out of memory");
+		return NULL;
+	}
+
+	self->refcount = 1;
+
+	if (!piglit_ktx_read_file_data(self, filename) ||
+	    !piglit_ktx_parse_data(self)) {
 		piglit_ktx_destroy(self);
-		self = NULL;
+		return NULL;
 	}
 
 	return self;
 }
 
+struct piglit_ktx_cache_entry {
+	char *filename;
+	struct piglit_ktx *ktx;
+	struct piglit_ktx_cache_entry *next;
+};
+
+static struct piglit_ktx_cache_entry *piglit_ktx_cache;
+
+struct piglit_ktx*
+piglit_ktx_read_file_cached(const char *filename)
+{
+	struct piglit_ktx_cache_entry *entry;
+	struct piglit_ktx *ktx;
+
+	for (entry = piglit_ktx_cache; entry != NULL; entry = entry->next) {
+		if (strcmp(entry->filename, filename) == 0) {
+			++entry->ktx->refcount;
+			return entry->ktx;
+		}
+	}
+
+	ktx = piglit_ktx_read_file(filename);
+	if (ktx == NULL)
+		return NULL;
+
+	entry = malloc(sizeof(*entry));
+	if (entry == NULL)
+		return ktx;
+
+	entry->filename = strdup(filename);
+	entry->ktx = ktx;
+	entry->next = piglit_ktx_cache;
+	piglit_ktx_cache = entry;
+
+	/* The cache keeps its own reference. */
+	++ktx->refcount;
+	return ktx;
+}
+
+void
+piglit_ktx_clear_cache(void)
+{
+	while (piglit_ktx_cache != NULL) {
+		struct piglit_ktx_cache_entry *entry = piglit_ktx_cache;
+
+		piglit_ktx_cache = entry->next;
+		piglit_ktx_destroy(entry->ktx);
+		free(entry->filename);
+		free(entry);
+	}
+}
+
 struct piglit_ktx*
 ktx_file_read_bytes(const void *bytes , size_t size)
 {
@@ -503,6 +639,7 @@ ktx_file_read_bytes(const void *bytes , size_t size)
 		return NULL;
 	}
 
+	self->refcount = 1;
 	self->info.size = size;
 	memcpy(self->data, bytes, size);
 
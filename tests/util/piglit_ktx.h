@@ -185,19 +185,47 @@ struct piglit_ktx_image {
 	/** \} */
 };
 
+/**
+ * \brief Release a reference to KTX data.
+ *
+ * The data is freed when the last reference is released.
+ */
 void
 piglit_ktx_destroy(struct piglit_ktx *self);
 
 /**
  * \brief Read KTX data from a file.
  *
- * The file is read until EOF.
+ * The file is read until EOF.  On POSIX systems the file is mapped
+ * read-only rather than copied, so piglit_ktx_image::data points into the
+ * mapping.
  *
  * Return null on error, including I/O error and invalid data.
  */
 struct piglit_ktx*
 piglit_ktx_read_file(const char *filename);
 
+/**
+ * \brief Read KTX data from a file, reusing it across calls.
+ *
+ * The first call for \a filename reads the file with piglit_ktx_read_file().
+ * Later calls with the same \a filename return the same object without
+ * touching the file.  Callers still release their reference with
+ * piglit_ktx_destroy(); the cache keeps the data alive until
+ * piglit_ktx_clear_cache().
+ *
+ * This is for tests that load the same reference images several times, for
+ * example once per subtest.  It is not thread safe.
+ */
+struct piglit_ktx*
+piglit_ktx_read_file_cached(const char *filename);
+
+/**
+ * \brief Release the cache's references to KTX data.
+ */
+void
+piglit_ktx_clear_cache(void);
+
 /**
  * \brief Read KTX data from a byte array.
  *